@@ -1,6 +1,16 @@
 if (${CMAKE_SYSTEM_NAME} MATCHES "Linux")
     function (libgearbox_compile_definitions RESULT)
-        set (${RESULT} "-DPLATFORM_LINUX" PARENT_SCOPE)
+        set (DEFINITIONS "-DPLATFORM_LINUX")
+
+        if (LIBGEARBOX_CURL_MULTI)
+            list (APPEND DEFINITIONS "-DLIBGEARBOX_CURL_MULTI")
+        endif ()
+
+        if (LIBGEARBOX_EPOLL_HTTP)
+            list (APPEND DEFINITIONS "-DLIBGEARBOX_EPOLL_HTTP")
+        endif ()
+
+        set (${RESULT} ${DEFINITIONS} PARENT_SCOPE)
     endfunction ()
 
     find_package (PkgConfig QUIET REQUIRED)
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_CALL_OPTIONS_H
+#define LIBGEARBOX_CALL_OPTIONS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <libgearbox_global.h>
+
+namespace gearbox
+{
+    class GEARBOX_API CancellationToken
+    {
+    public:
+        CancellationToken();
+
+    public:
+        void cancel();
+        bool cancelled() const;
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled_;
+
+    private:
+        friend class CallOptions;
+    };
+
+    class GEARBOX_API CallOptions
+    {
+    public:
+        using clock_t = std::chrono::steady_clock;
+
+    public:
+        CallOptions();
+        CallOptions(const CancellationToken &token);
+
+    public:
+        CallOptions &setTimeout(std::int32_t milliseconds);
+        CallOptions &setDeadline(clock_t::time_point deadline);
+        CallOptions &setCancellationToken(const CancellationToken &token);
+
+    public:
+        bool hasDeadline() const;
+        clock_t::time_point deadline() const;
+        bool expired() const;
+
+        bool hasCancellationToken() const;
+        bool cancelled() const;
+
+    private:
+        clock_t::time_point deadline_;
+        bool hasDeadline_;
+        std::shared_ptr<const std::atomic<bool>> cancelled_;
+    };
+}
+
+#endif // LIBGEARBOX_CALL_OPTIONS_H
@@ -116,7 +116,7 @@ namespace gearbox
 
             GearboxSessionInvalid = 600,
             GearboxTorrentInvalid,
-            GearboxReserved_1,
+            GearboxCallCancelled,
             GearboxReserved_2,
             GearboxReserved_3,
             GearboxReserved_4,
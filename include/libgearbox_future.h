@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+
+#ifndef LIBGEARBOX_FUTURE_H
+#define LIBGEARBOX_FUTURE_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define LIBGEARBOX_COROUTINES
+#endif
+#endif
+
+#include <libgearbox_global.h>
+
+namespace gearbox
+{
+    template <typename T> class Future
+    {
+    public:
+        class State
+        {
+        public:
+            virtual ~State() = default;
+
+        public:
+            virtual bool ready() const = 0;
+            virtual void wait() const = 0;
+            virtual bool waitFor(std::chrono::milliseconds timeout) const = 0;
+            virtual void onReady(std::function<void()> &&callback) = 0;
+            virtual T take() = 0;
+        };
+
+    public:
+        explicit Future(std::shared_ptr<State> state) : state_(std::move(state))
+        {
+        }
+        Future(Future &&) noexcept(true) = default;
+        Future &operator=(Future &&) noexcept(true) = default;
+        ~Future() noexcept(true) = default;
+
+    public:
+        inline bool valid() const { return static_cast<bool>(state_); }
+        inline bool ready() const { return state_->ready(); }
+        inline void wait() const { state_->wait(); }
+        inline bool waitFor(std::chrono::milliseconds timeout) const
+        {
+            return state_->waitFor(timeout);
+        }
+
+        inline T get()
+        {
+            auto state = std::move(state_);
+            state->wait();
+            return state->take();
+        }
+
+        inline void then(std::function<void(T &&)> callback)
+        {
+            auto state = std::move(state_);
+            auto self = state.get();
+            self->onReady([state, callback]() { callback(state->take()); });
+        }
+
+#ifdef LIBGEARBOX_COROUTINES
+    public:
+        inline bool await_ready() const { return state_->ready(); }
+        inline void await_suspend(std::coroutine_handle<> handle)
+        {
+            state_->onReady([handle]() { handle.resume(); });
+        }
+        inline T await_resume() { return get(); }
+#endif
+
+    private:
+        std::shared_ptr<State> state_;
+
+    private:
+        DISABLE_COPY(Future)
+    };
+}
+
+#endif // LIBGEARBOX_FUTURE_H
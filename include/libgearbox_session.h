@@ -25,17 +25,25 @@
 #ifndef LIBGEARBOX_SESSION_H
 #define LIBGEARBOX_SESSION_H
 
+#include <functional>
+#include <initializer_list>
 #include <memory>
 #include <vector>
 
 #include <libgearbox_global.h>
 
+#include <libgearbox_call_options.h>
+#include <libgearbox_future.h>
 #include <libgearbox_return_type.h>
 #include <libgearbox_torrent.h>
 
 namespace gearbox
 {
     class SessionPrivate;
+    namespace session
+    {
+        struct Response;
+    }
 
     class GEARBOX_API Session
     {
@@ -56,6 +64,18 @@ namespace gearbox
             Ignore
         };
 
+        enum class Compression
+        {
+            Enabled,
+            Disabled
+        };
+
+        enum class HttpVersion
+        {
+            Http1_1,
+            Http2
+        };
+
         struct Statistics
         {
             std::int32_t totalTorrentCount;
@@ -65,6 +85,40 @@ namespace gearbox
             std::int32_t uploadSpeed;
         };
 
+        struct ConnectionStatistics
+        {
+            std::uint64_t reusedConnections;
+            std::uint64_t newConnections;
+            std::uint64_t receivedBytes;
+            std::uint64_t decodedBytes;
+            std::uint64_t dnsLookups;
+            double connectionHitRate;
+            double dnsHitRate;
+        };
+
+        /* The outcome of one of the calls a bulk mutation is split into */
+        struct BatchResult
+        {
+            std::vector<std::int32_t> ids;
+            Error error;
+        };
+
+        class GEARBOX_API TorrentIds
+        {
+        public:
+            TorrentIds(std::vector<std::int32_t> ids);
+            TorrentIds(std::initializer_list<std::int32_t> ids);
+            TorrentIds(const std::vector<Torrent> &torrents);
+            TorrentIds(
+                const std::vector<std::reference_wrapper<Torrent>> &torrents);
+
+        public:
+            const std::vector<std::int32_t> &ids() const;
+
+        private:
+            std::vector<std::int32_t> ids_;
+        };
+
     public:
         Session();
         Session(Session &&other);
@@ -85,11 +139,111 @@ namespace gearbox
                 std::string &&password = "");
 
     public:
-        ReturnType<Statistics> statistics() const;
-        ReturnType<std::vector<gearbox::Torrent>> torrents() const;
-        ReturnType<std::vector<std::int32_t>> recentlyRemoved() const;
+        ReturnType<Statistics> statistics(
+            const CallOptions &options = CallOptions()) const;
+        ReturnType<std::vector<gearbox::Torrent>> torrents(
+            const CallOptions &options = CallOptions()) const;
+        ReturnType<std::vector<gearbox::Torrent>> torrents(
+            FieldSet fields,
+            const CallOptions &options = CallOptions()) const;
+        ReturnType<std::vector<std::int32_t>> recentlyRemoved(
+            const CallOptions &options = CallOptions()) const;
+        Error updateTorrentStats(
+            std::vector<std::reference_wrapper<Torrent>> &torrents,
+            const CallOptions &options = CallOptions());
         Error updateTorrentStats(
-            std::vector<std::reference_wrapper<Torrent>> &torrents);
+            std::vector<std::reference_wrapper<Torrent>> &torrents,
+            FieldSet fields,
+            const CallOptions &options = CallOptions());
+        Error forEachTorrent(
+            const std::function<void(gearbox::Torrent &&)> &callback,
+            const CallOptions &options = CallOptions()) const;
+
+    public:
+        std::vector<BatchResult> startTorrents(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> startTorrentsNow(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> stopTorrents(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> verifyTorrents(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> askForMorePeers(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> removeTorrents(
+            const TorrentIds &torrents,
+            Torrent::LocalDataAction action =
+                Torrent::LocalDataAction::KeepFiles,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> queueMoveUp(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> queueMoveDown(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> queueMoveTop(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        std::vector<BatchResult> queueMoveBottom(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+
+    public:
+        Future<ReturnType<Statistics>> statisticsAsync(
+            const CallOptions &options = CallOptions()) const;
+        Future<ReturnType<std::vector<gearbox::Torrent>>> torrentsAsync(
+            const CallOptions &options = CallOptions()) const;
+        Future<ReturnType<std::vector<gearbox::Torrent>>> torrentsAsync(
+            FieldSet fields,
+            const CallOptions &options = CallOptions()) const;
+        Future<ReturnType<std::vector<std::int32_t>>> recentlyRemovedAsync(
+            const CallOptions &options = CallOptions()) const;
+        Future<Error> updateTorrentStatsAsync(
+            std::vector<std::reference_wrapper<Torrent>> &torrents,
+            const CallOptions &options = CallOptions());
+        Future<Error> updateTorrentStatsAsync(
+            std::vector<std::reference_wrapper<Torrent>> &torrents,
+            FieldSet fields,
+            const CallOptions &options = CallOptions());
+
+    public:
+        Future<std::vector<BatchResult>> startTorrentsAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> startTorrentsNowAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> stopTorrentsAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> verifyTorrentsAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> askForMorePeersAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> removeTorrentsAsync(
+            const TorrentIds &torrents,
+            Torrent::LocalDataAction action =
+                Torrent::LocalDataAction::KeepFiles,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> queueMoveUpAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> queueMoveDownAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> queueMoveTopAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
+        Future<std::vector<BatchResult>> queueMoveBottomAsync(
+            const TorrentIds &torrents,
+            const CallOptions &options = CallOptions());
 
     public:
         const std::string &host() const;
@@ -119,9 +273,44 @@ namespace gearbox
 
         void setSSLErrorHandling(SSLErrorHandling value);
 
+        bool compressionEnabled() const;
+        void setCompression(Compression value);
+
+        HttpVersion httpVersion() const;
+        void setHttpVersion(HttpVersion value);
+
+        const std::string &unixSocketPath() const;
+        void setUnixSocketPath(const std::string &path);
+
+        std::int32_t maxIdleConnections() const;
+        void setMaxIdleConnections(std::int32_t value);
+
+        std::int32_t idleConnectionTimeout() const;
+        void setIdleConnectionTimeout(std::int32_t value);
+
+        std::int32_t maxTorrentsPerCall() const;
+        void setMaxTorrentsPerCall(std::int32_t value);
+
+        std::int32_t coalescingWindow() const;
+        void setCoalescingWindow(std::int32_t value);
+
+        ConnectionStatistics connectionStatistics() const;
+        void shareConnections(const Session &other);
+
+    private:
+        static Error updateTorrentStats(
+            const std::weak_ptr<SessionPrivate> &session,
+            std::vector<std::reference_wrapper<Torrent>> &torrents,
+            FieldSet fields,
+            session::Response &&response,
+            const CallOptions &options);
+
     private:
         std::shared_ptr<SessionPrivate> priv_;
 
+    private:
+        friend class TorrentStore;
+
     private:
         DISABLE_COPY(Session)
     };
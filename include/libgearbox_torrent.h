@@ -31,8 +31,10 @@
 #include <string>
 #include <vector>
 
+#include <libgearbox_call_options.h>
 #include <libgearbox_file.h>
 #include <libgearbox_folder.h>
+#include <libgearbox_future.h>
 #include <libgearbox_global.h>
 #include <libgearbox_return_type.h>
 
@@ -40,6 +42,11 @@ namespace gearbox
 {
     class TorrentPrivate;
     class FolderPrivate;
+    class FieldSet;
+    namespace session
+    {
+        struct Response;
+    }
 
     class GEARBOX_API Torrent
     {
@@ -68,6 +75,24 @@ namespace gearbox
             DeleteFiles
         };
 
+        enum class Field : std::uint32_t
+        {
+            Id,
+            Name,
+            BytesDownloaded,
+            PercentDone,
+            UploadRatio,
+            BytesUploaded,
+            DownloadSpeed,
+            UploadSpeed,
+            Status,
+            Size,
+            DownloadDir,
+            Eta,
+            QueuePosition,
+            Count
+        };
+
     public:
         explicit Torrent(TorrentPrivate *priv);
         Torrent(Torrent &&);
@@ -82,21 +107,65 @@ namespace gearbox
         bool valid() const;
 
     public:
-        Error start();
-        Error startNow();
-        Error stop();
-        Error verify();
-        Error askForMorePeers();
-        Error remove(LocalDataAction action = LocalDataAction::KeepFiles);
-        Error queueMoveUp();
-        Error queueMoveDown();
-        Error queueMoveTop();
-        Error queueMoveBottom();
-        Error update();
+        Error start(const CallOptions &options = CallOptions());
+        Error startNow(const CallOptions &options = CallOptions());
+        Error stop(const CallOptions &options = CallOptions());
+        Error verify(const CallOptions &options = CallOptions());
+        Error askForMorePeers(const CallOptions &options = CallOptions());
+        Error remove(LocalDataAction action = LocalDataAction::KeepFiles,
+                     const CallOptions &options = CallOptions());
+        Error queueMoveUp(const CallOptions &options = CallOptions());
+        Error queueMoveDown(const CallOptions &options = CallOptions());
+        Error queueMoveTop(const CallOptions &options = CallOptions());
+        Error queueMoveBottom(const CallOptions &options = CallOptions());
+        Error update(const CallOptions &options = CallOptions());
+        Error update(FieldSet fields,
+                     const CallOptions &options = CallOptions());
         Error setWantedFiles(
-            const std::vector<std::reference_wrapper<const File>> &files);
+            const std::vector<std::reference_wrapper<const File>> &files,
+            const CallOptions &options = CallOptions());
         Error setSkippedFiles(
-            const std::vector<std::reference_wrapper<const File>> &files);
+            const std::vector<std::reference_wrapper<const File>> &files,
+            const CallOptions &options = CallOptions());
+
+    public:
+        Future<Error> startAsync(const CallOptions &options = CallOptions());
+        Future<Error> startNowAsync(const CallOptions &options = CallOptions());
+        Future<Error> stopAsync(const CallOptions &options = CallOptions());
+        Future<Error> verifyAsync(const CallOptions &options = CallOptions());
+        Future<Error> askForMorePeersAsync(
+            const CallOptions &options = CallOptions());
+        Future<Error> removeAsync(
+            LocalDataAction action = LocalDataAction::KeepFiles,
+            const CallOptions &options = CallOptions());
+        Future<Error> queueMoveUpAsync(
+            const CallOptions &options = CallOptions());
+        Future<Error> queueMoveDownAsync(
+            const CallOptions &options = CallOptions());
+        Future<Error> queueMoveTopAsync(
+            const CallOptions &options = CallOptions());
+        Future<Error> queueMoveBottomAsync(
+            const CallOptions &options = CallOptions());
+        Future<Error> updateAsync(const CallOptions &options = CallOptions());
+        Future<Error> updateAsync(FieldSet fields,
+                                  const CallOptions &options = CallOptions());
+        Future<Error> setWantedFilesAsync(
+            const std::vector<std::reference_wrapper<const File>> &files,
+            const CallOptions &options = CallOptions());
+        Future<Error> setSkippedFilesAsync(
+            const std::vector<std::reference_wrapper<const File>> &files,
+            const CallOptions &options = CallOptions());
+        Future<ReturnType<Folder>> contentAsync(
+            const CallOptions &options = CallOptions()) const;
+        Future<ReturnType<std::vector<File>>> filesAsync(
+            const CallOptions &options = CallOptions()) const;
+        Future<Error> setQueuePositionAsync(
+            std::int32_t position,
+            const CallOptions &options = CallOptions());
+        Future<Error> setDownloadDirAsync(
+            const std::string &path,
+            MoveType move = MoveType::SearchForExistingFiles,
+            const CallOptions &options = CallOptions());
 
     public:
         std::int32_t id() const;
@@ -110,25 +179,94 @@ namespace gearbox
         Status status() const;
         std::uint64_t size() const;
         std::int32_t eta() const;
-        ReturnType<Folder> content() const;
-        ReturnType<std::vector<File>> files() const;
+        ReturnType<Folder> content(
+            const CallOptions &options = CallOptions()) const;
+        ReturnType<std::vector<File>> files(
+            const CallOptions &options = CallOptions()) const;
 
         std::int32_t queuePosition() const;
-        Error setQueuePosition(std::int32_t position);
+        Error setQueuePosition(std::int32_t position,
+                               const CallOptions &options = CallOptions());
 
         std::string downloadDir() const;
         Error setDownloadDir(const std::string &path,
-                             MoveType move = MoveType::SearchForExistingFiles);
+                             MoveType move = MoveType::SearchForExistingFiles,
+                             const CallOptions &options = CallOptions());
+
+    private:
+        static ReturnType<Folder> toContent(const std::string &name,
+                                            session::Response &&response,
+                                            const CallOptions &options);
+        static ReturnType<std::vector<File>> toFiles(
+            session::Response &&response,
+            const CallOptions &options);
 
     private:
         std::unique_ptr<TorrentPrivate> priv_;
 
     private:
         friend class Session;
+        friend class TorrentStorePrivate;
 
     private:
         DISABLE_COPY(Torrent)
     };
+
+    class FieldSet
+    {
+    public:
+        constexpr FieldSet() noexcept : bits_(0) {}
+        constexpr FieldSet(Torrent::Field field) noexcept
+          : bits_(std::uint32_t{ 1 } << static_cast<std::uint32_t>(field))
+        {
+        }
+
+    public:
+        static constexpr FieldSet all() noexcept
+        {
+            return FieldSet(FieldSet(Torrent::Field::Count).bits_ - 1);
+        }
+
+    public:
+        constexpr FieldSet operator|(FieldSet other) const noexcept
+        {
+            return FieldSet(bits_ | other.bits_);
+        }
+        constexpr FieldSet operator&(FieldSet other) const noexcept
+        {
+            return FieldSet(bits_ & other.bits_);
+        }
+        constexpr bool operator==(FieldSet other) const noexcept
+        {
+            return bits_ == other.bits_;
+        }
+        constexpr bool operator!=(FieldSet other) const noexcept
+        {
+            return bits_ != other.bits_;
+        }
+
+    public:
+        constexpr bool contains(Torrent::Field field) const noexcept
+        {
+            return (bits_ & FieldSet(field).bits_) != 0;
+        }
+        constexpr bool empty() const noexcept { return bits_ == 0; }
+        constexpr std::uint32_t bits() const noexcept { return bits_; }
+
+    private:
+        constexpr explicit FieldSet(std::uint32_t bits) noexcept : bits_(bits)
+        {
+        }
+
+    private:
+        std::uint32_t bits_;
+    };
+
+    constexpr FieldSet operator|(Torrent::Field lhs,
+                                 Torrent::Field rhs) noexcept
+    {
+        return FieldSet(lhs) | FieldSet(rhs);
+    }
 }
 
 #endif // LIBGEARBOX_TORRENT_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_INDEX_H
+#define LIBGEARBOX_TORRENT_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libgearbox_global.h>
+
+#include <libgearbox_torrent.h>
+#include <libgearbox_torrent_snapshot.h>
+#include <libgearbox_torrent_table.h>
+
+namespace gearbox
+{
+    class GEARBOX_API TorrentIndex
+    {
+    public:
+        enum class Comparison
+        {
+            Less,
+            LessOrEqual,
+            Equal,
+            NotEqual,
+            GreaterOrEqual,
+            Greater
+        };
+
+        enum class Order
+        {
+            Ascending,
+            Descending
+        };
+
+        struct Group
+        {
+            std::string downloadDir;
+            std::size_t count;
+            std::uint64_t size;
+            std::uint64_t bytesDownloaded;
+            std::uint64_t downloadSpeed;
+            std::uint64_t uploadSpeed;
+        };
+
+        class GEARBOX_API Query
+        {
+        public:
+            Query &whereStatus(std::vector<Torrent::Status> statuses);
+            Query &where(Torrent::Field field,
+                         Comparison comparison,
+                         double value);
+            Query &whereDownloadDir(std::string directory);
+            Query &orderBy(Torrent::Field field,
+                           Order order = Order::Ascending);
+            Query &page(std::size_t offset, std::size_t count);
+
+        public:
+            std::vector<TorrentSnapshot::entry_t> select() const;
+            std::size_t count() const;
+            std::vector<Group> groupByDownloadDir() const;
+
+        private:
+            struct Condition
+            {
+                Torrent::Field field;
+                Comparison comparison;
+                double value;
+            };
+
+        private:
+            explicit Query(const TorrentIndex &index);
+
+            /* The rows of the index that match every condition */
+            std::vector<std::uint32_t> rows() const;
+
+        private:
+            const TorrentIndex *index_;
+            std::uint32_t statuses_;
+            std::vector<Condition> conditions_;
+            std::vector<std::string> directories_;
+            Torrent::Field orderField_;
+            Order order_;
+            std::size_t offset_;
+            std::size_t count_;
+
+        private:
+            friend class TorrentIndex;
+        };
+
+    public:
+        explicit TorrentIndex(std::shared_ptr<const TorrentSnapshot> snapshot);
+
+    public:
+        Query query() const;
+
+        std::size_t size() const;
+        const TorrentSnapshot &snapshot() const;
+
+    private:
+        std::shared_ptr<const TorrentSnapshot> snapshot_;
+        TorrentTable columns_;
+        std::vector<std::vector<std::uint64_t>> keys_;
+        std::vector<std::string> directories_;
+        std::vector<std::uint32_t> directoryIndices_;
+
+    private:
+        DISABLE_COPY(TorrentIndex)
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_INDEX_H
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_POLLER_H
+#define LIBGEARBOX_TORRENT_POLLER_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include <libgearbox_global.h>
+
+#include <libgearbox_error.h>
+
+namespace gearbox
+{
+    class TorrentPollerPrivate;
+    class TorrentStore;
+
+    class GEARBOX_API TorrentPoller
+    {
+    public:
+        static constexpr const std::int32_t DEFAULT_ACTIVE_INTERVAL{ 1000 };
+        static constexpr const std::int32_t DEFAULT_IDLE_INTERVAL{ 10000 };
+        static constexpr const std::int32_t DEFAULT_STOPPED_INTERVAL{ 60000 };
+        static constexpr const std::int32_t DEFAULT_JITTER{ 10 };
+
+    public:
+        enum class Tier
+        {
+            Active,
+            Idle,
+            Stopped
+        };
+
+        using error_handler_t = std::function<void(const Error &)>;
+
+    public:
+        explicit TorrentPoller(TorrentStore &store);
+        ~TorrentPoller() noexcept(true);
+
+    public:
+        void start();
+        void stop();
+        bool running() const;
+
+        void setErrorHandler(error_handler_t handler);
+
+    public:
+        std::int32_t interval(Tier tier) const;
+        void setInterval(Tier tier, std::int32_t milliseconds);
+
+        std::int32_t jitter() const;
+        void setJitter(std::int32_t percent);
+
+        std::int32_t latency() const;
+
+    private:
+        std::unique_ptr<TorrentPollerPrivate> priv_;
+
+    private:
+        DISABLE_COPY(TorrentPoller)
+        DISABLE_MOVE(TorrentPoller)
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_POLLER_H
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_SNAPSHOT_H
+#define LIBGEARBOX_TORRENT_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libgearbox_global.h>
+
+#include <libgearbox_torrent.h>
+
+namespace gearbox
+{
+    class GEARBOX_API TorrentSnapshot
+    {
+    public:
+        struct Entry
+        {
+            std::int32_t id;
+            std::string name;
+            std::uint64_t bytesDownloaded;
+            double percentDone;
+            double uploadRatio;
+            std::uint64_t bytesUploaded;
+            std::uint64_t downloadSpeed;
+            std::uint64_t uploadSpeed;
+            Torrent::Status status;
+            std::uint64_t size;
+            std::string downloadDir;
+            std::int32_t eta;
+            std::int32_t queuePosition;
+        };
+
+        using entry_t = std::shared_ptr<const Entry>;
+        using const_iterator = std::vector<entry_t>::const_iterator;
+
+    public:
+        TorrentSnapshot();
+        TorrentSnapshot(std::vector<entry_t> entries, std::uint64_t version);
+        explicit TorrentSnapshot(const std::vector<Torrent> &torrents);
+
+    public:
+        static entry_t entry(const Torrent &torrent);
+
+    public:
+        std::uint64_t version() const;
+        std::size_t size() const;
+        bool empty() const;
+
+        const Entry &at(std::size_t index) const;
+        const Entry *find(std::int32_t id) const;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+    private:
+        std::vector<entry_t> entries_;
+        std::uint64_t version_;
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_SNAPSHOT_H
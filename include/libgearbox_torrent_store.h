@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_STORE_H
+#define LIBGEARBOX_TORRENT_STORE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <libgearbox_global.h>
+
+#include <libgearbox_call_options.h>
+#include <libgearbox_error.h>
+#include <libgearbox_torrent.h>
+#include <libgearbox_torrent_snapshot.h>
+
+namespace gearbox
+{
+    class Session;
+    class TorrentStorePrivate;
+
+    class GEARBOX_API TorrentStore
+    {
+    public:
+        struct Change
+        {
+            enum class Kind
+            {
+                Added,
+                Updated,
+                Removed
+            };
+
+            std::int32_t id;
+            Kind kind;
+            FieldSet fields;
+        };
+
+        using change_handler_t =
+            std::function<void(const std::vector<Change> &)>;
+
+    public:
+        explicit TorrentStore(const Session &session);
+        ~TorrentStore() noexcept(true);
+
+    public:
+        Error sync(const CallOptions &options = CallOptions());
+        Error refresh(const std::vector<std::int32_t> &ids,
+                      const CallOptions &options = CallOptions());
+        void reset();
+        void setChangeHandler(change_handler_t handler);
+
+    public:
+        bool synced() const;
+        std::size_t size() const;
+        Torrent *find(std::int32_t id);
+        const Torrent *find(std::int32_t id) const;
+        std::vector<std::reference_wrapper<Torrent>> torrents();
+        std::shared_ptr<const TorrentSnapshot> snapshot() const;
+
+    private:
+        std::unique_ptr<TorrentStorePrivate> priv_;
+
+    private:
+        DISABLE_COPY(TorrentStore)
+        DISABLE_MOVE(TorrentStore)
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_STORE_H
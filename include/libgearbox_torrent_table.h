@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_TABLE_H
+#define LIBGEARBOX_TORRENT_TABLE_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <libgearbox_global.h>
+
+#include <libgearbox_session.h>
+#include <libgearbox_torrent.h>
+#include <libgearbox_torrent_snapshot.h>
+
+namespace gearbox
+{
+    class GEARBOX_API TorrentTable
+    {
+    public:
+        /* Torrent::Status::Stopped through Torrent::Status::Seed */
+        static constexpr const std::size_t STATUS_COUNT{ 7 };
+
+        using status_counts_t = std::array<std::size_t, STATUS_COUNT>;
+
+    public:
+        TorrentTable();
+        explicit TorrentTable(const TorrentSnapshot &snapshot);
+        explicit TorrentTable(const std::vector<Torrent> &torrents);
+        explicit TorrentTable(
+            const std::vector<std::reference_wrapper<Torrent>> &torrents);
+
+    public:
+        std::size_t size() const;
+        bool empty() const;
+
+        const std::vector<std::int32_t> &ids() const;
+        const std::vector<std::uint64_t> &bytesDownloaded() const;
+        const std::vector<double> &percentDone() const;
+        const std::vector<std::uint64_t> &downloadSpeeds() const;
+        const std::vector<std::uint64_t> &uploadSpeeds() const;
+        const std::vector<std::uint8_t> &statuses() const;
+        const std::vector<std::uint64_t> &sizes() const;
+        const std::vector<std::int32_t> &etas() const;
+        const std::vector<std::int32_t> &queuePositions() const;
+
+    public:
+        std::uint64_t sum(Torrent::Field field) const;
+        double average(Torrent::Field field) const;
+        status_counts_t countByStatus() const;
+        std::vector<std::size_t> histogram(
+            Torrent::Field field,
+            const std::vector<double> &bounds) const;
+        Session::Statistics statistics() const;
+
+    private:
+        void reserve(std::size_t size);
+        void append(const Torrent &torrent);
+
+    private:
+        std::vector<std::int32_t> ids_;
+        std::vector<std::uint64_t> bytesDownloaded_;
+        std::vector<double> percentDone_;
+        std::vector<std::uint64_t> downloadSpeeds_;
+        std::vector<std::uint64_t> uploadSpeeds_;
+        std::vector<std::uint8_t> statuses_;
+        std::vector<std::uint64_t> sizes_;
+        std::vector<std::int32_t> etas_;
+        std::vector<std::int32_t> queuePositions_;
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_TABLE_H
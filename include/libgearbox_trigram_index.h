@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TRIGRAM_INDEX_H
+#define LIBGEARBOX_TRIGRAM_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <libgearbox_global.h>
+
+#include <libgearbox_file.h>
+#include <libgearbox_torrent_snapshot.h>
+#include <libgearbox_torrent_store.h>
+
+namespace gearbox
+{
+    class GEARBOX_API TrigramIndex
+    {
+    public:
+        using key_t = std::int32_t;
+
+    public:
+        TrigramIndex();
+        TrigramIndex(TrigramIndex &&) = default;
+        ~TrigramIndex() = default;
+        TrigramIndex &operator=(TrigramIndex &&) = default;
+
+    public:
+        void insert(key_t key, const std::string &text);
+        bool erase(key_t key);
+        void clear();
+
+        void update(const TorrentSnapshot &snapshot);
+        void update(const TorrentSnapshot &snapshot,
+                    const std::vector<TorrentStore::Change> &changes);
+        void update(const std::vector<File> &files);
+
+    public:
+        std::vector<key_t> find(const std::string &pattern) const;
+
+        bool contains(key_t key) const;
+        std::size_t size() const;
+        bool empty() const;
+        std::size_t memoryUsage() const;
+
+    private:
+        using trigram_t = std::uint32_t;
+
+        struct Document
+        {
+            key_t key;
+            std::string text;
+        };
+
+    private:
+        std::vector<Document>::iterator lookup(key_t key);
+
+        /* Replaces the text of key, unless it is the same but for case, */
+        /* and returns its position. The position it is expected at is   */
+        /* tried before looking for it.                                  */
+        std::size_t assign(key_t key,
+                           const std::string &text,
+                           std::size_t hint);
+
+        void index(key_t key, const std::string &folded);
+        void unindex(key_t key, const std::string &folded);
+
+    private:
+        /* The texts, folded, ordered by key */
+        std::vector<Document> documents_;
+        std::unordered_map<trigram_t, std::vector<key_t>> postings_;
+
+    private:
+        DISABLE_COPY(TrigramIndex)
+    };
+}
+
+#endif // LIBGEARBOX_TRIGRAM_INDEX_H
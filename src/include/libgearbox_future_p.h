@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+
+#ifndef LIBGEARBOX_FUTURE_P_H
+#define LIBGEARBOX_FUTURE_P_H
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "libgearbox_future.h"
+
+namespace gearbox
+{
+    /* Fulfilled with the raw result of a request, which is only turned into */
+    /* the value of the future by the thread that ends up consuming it.      */
+    template <typename Raw, typename T>
+    class FutureState : public Future<T>::State
+    {
+    public:
+        using transform_t = std::function<T(Raw &&)>;
+
+    public:
+        explicit FutureState(transform_t &&transform)
+          : mutex_(), condition_(), ready_(false), value_(), continuation_(),
+            transform_(std::move(transform))
+        {
+        }
+
+    public:
+        void setValue(Raw &&value)
+        {
+            std::function<void()> continuation;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                value_.reset(new Raw(std::move(value)));
+                ready_ = true;
+                continuation = std::move(continuation_);
+            }
+
+            condition_.notify_all();
+            if (continuation) continuation();
+        }
+
+    public:
+        bool ready() const override
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return ready_;
+        }
+
+        void wait() const override
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_.wait(lock, [this]() { return ready_; });
+        }
+
+        bool waitFor(std::chrono::milliseconds timeout) const override
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            return condition_.wait_for(lock, timeout,
+                                       [this]() { return ready_; });
+        }
+
+        void onReady(std::function<void()> &&callback) override
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!ready_)
+                {
+                    continuation_ = std::move(callback);
+                    return;
+                }
+            }
+
+            callback();
+        }
+
+        T take() override
+        {
+            std::unique_ptr<Raw> value;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this]() { return ready_; });
+                value = std::move(value_);
+            }
+
+            return transform_(std::move(*value));
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        mutable std::condition_variable condition_;
+        bool ready_;
+        std::unique_ptr<Raw> value_;
+        std::function<void()> continuation_;
+        transform_t transform_;
+    };
+
+    template <typename Raw, typename T>
+    Future<T> makeReadyFuture(Raw &&value,
+                              std::function<T(Raw &&)> &&transform)
+    {
+        auto state =
+            std::make_shared<FutureState<Raw, T>>(std::move(transform));
+        state->setValue(std::move(value));
+        return Future<T>(std::move(state));
+    }
+}
+
+#endif // LIBGEARBOX_FUTURE_P_H
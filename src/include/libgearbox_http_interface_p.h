@@ -26,8 +26,13 @@
 #define LIBGEARBOX_HTTP_INTERFACE_H
 
 #include <chrono>
+#include <cstring>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -46,6 +51,11 @@ namespace gearbox
         using header_array_t =
             std::map<std::string, std::string, common::CaseInsensitiveCompare>;
         using milliseconds_t = decltype(std::chrono::milliseconds(0));
+        using body_handler_t = std::function<void(const char *, std::size_t)>;
+        using abort_handler_t = std::function<bool()>;
+        /* Given what resumes the transfer, from any thread, if it pauses it */
+        using pause_handler_t =
+            std::function<bool(const std::function<void()> &)>;
         using port_t = std::int32_t;
 
         enum class RequestType
@@ -60,6 +70,12 @@ namespace gearbox
             Ignore
         };
 
+        enum class Version
+        {
+            Http1_1,
+            Http2
+        };
+
         struct Status
         {
             enum Code
@@ -195,20 +211,135 @@ namespace gearbox
             }
         };
 
+        /* A header value, pointing into the headers it was looked up in; */
+        /* only valid for as long as those are neither changed nor gone.  */
+        struct HeaderValue
+        {
+            const char *data;
+            std::size_t size;
+
+            inline bool empty() const { return size == 0; }
+            inline std::string str() const
+            {
+                return empty() ? std::string() : std::string(data, size);
+            }
+            inline operator std::string() const { return str(); }
+
+            inline bool operator==(const char *other) const
+            {
+                return (std::strlen(other) == size) &&
+                       (empty() ||
+                        (std::char_traits<char>::compare(data, other, size) ==
+                         0));
+            }
+            inline bool operator==(const std::string &other) const
+            {
+                return (other.size() == size) &&
+                       (empty() || (other.compare(0, size, data, size) == 0));
+            }
+            template <typename T> inline bool operator!=(const T &other) const
+            {
+                return !(*this == other);
+            }
+        };
+
+        /* Response headers kept as offsets into a single buffer, so keeping */
+        /* a header costs no allocation of its own. With a filter set, only */
+        /* the headers named in it are kept, the rest are skipped as they   */
+        /* are parsed without ever being copied.                            */
+        /* Copies share the buffer. clear() keeps it, and its capacity, once */
+        /* no other copy refers to it, which is how the pooled handles      */
+        /* reuse theirs from one response to the next.                      */
+        class ResponseHeaders
+        {
+        public:
+            ResponseHeaders();
+            ResponseHeaders(const header_array_t &headers);
+
+        public:
+            /* Keeps every header if names is null */
+            void setFilter(std::shared_ptr<const std::vector<std::string>> names);
+
+            /* Parses a raw header line, a status line starts a new response */
+            void parseLine(const char *line, std::size_t size);
+            void insert(const char *name,
+                        std::size_t nameSize,
+                        const char *value,
+                        std::size_t valueSize);
+            void clear();
+
+        public:
+            inline bool empty() const { return size() == 0; }
+            inline std::size_t size() const
+            {
+                return storage_ ? storage_->entries.size() : 0;
+            }
+            std::size_t count(const std::string &name) const;
+
+            /* Returns an empty value for headers that are not there */
+            HeaderValue operator[](const char *name) const;
+            HeaderValue operator[](const std::string &name) const;
+
+            /* Mainly meant for debugging, copies every header into a map */
+            header_array_t toMap() const;
+
+        private:
+            struct Entry
+            {
+                std::size_t nameOffset;
+                std::size_t nameSize;
+                std::size_t valueOffset;
+                std::size_t valueSize;
+            };
+
+            struct Storage
+            {
+                std::string bytes;
+                std::vector<Entry> entries;
+            };
+
+            bool wanted(const char *name, std::size_t size) const;
+            HeaderValue find(const char *name, std::size_t size) const;
+
+            /* Detaches the storage from the copies that share it, if any */
+            Storage &writable();
+
+        private:
+            std::shared_ptr<Storage> storage_;
+            std::shared_ptr<const std::vector<std::string>> filter_;
+        };
+
         struct RequestResult
         {
             Status status;
             struct
             {
-                header_array_t headers;
+                ResponseHeaders headers;
                 std::string text;
             } response;
             double elapsed;
             Error error;
+            struct
+            {
+                std::uint64_t received; /* as sent by the server */
+                std::uint64_t decoded;
+            } bytes;
+        };
+
+        struct ConnectionStatistics
+        {
+            std::uint64_t reusedConnections;
+            std::uint64_t newConnections;
+            std::uint64_t receivedBytes;
+            std::uint64_t decodedBytes;
+            std::uint64_t dnsLookups; /* that missed the DNS cache */
         };
 
         template <class Implementation> class Interface
         {
+        public:
+            using Request = typename Implementation::Request;
+
         public:
             explicit Interface(const std::string &userAgent)
               : implementation_(userAgent)
@@ -291,6 +422,37 @@ namespace gearbox
                 implementation_.setSSLErrorHandling(value);
             }
 
+            inline bool compressionEnabled() const
+            {
+                return implementation_.compressionEnabled();
+            }
+            inline void enableCompression()
+            {
+                implementation_.enableCompression();
+            }
+            inline void disableCompression()
+            {
+                implementation_.disableCompression();
+            }
+
+            inline Version httpVersion() const
+            {
+                return implementation_.httpVersion();
+            }
+            inline void setHttpVersion(Version value)
+            {
+                implementation_.setHttpVersion(value);
+            }
+
+            inline const std::string &unixSocketPath() const
+            {
+                return implementation_.unixSocketPath();
+            }
+            inline void setUnixSocketPath(const std::string &path)
+            {
+                implementation_.setUnixSocketPath(path);
+            }
+
             inline const milliseconds_t &timeout() const
             {
                 return implementation_.timeout();
@@ -300,6 +462,34 @@ namespace gearbox
                 implementation_.setTimeout(value);
             }
 
+            inline std::size_t maxIdleConnections() const
+            {
+                return implementation_.maxIdleConnections();
+            }
+            inline void setMaxIdleConnections(std::size_t value)
+            {
+                implementation_.setMaxIdleConnections(value);
+            }
+
+            inline milliseconds_t idleConnectionTimeout() const
+            {
+                return implementation_.idleConnectionTimeout();
+            }
+            inline void setIdleConnectionTimeout(milliseconds_t value)
+            {
+                implementation_.setIdleConnectionTimeout(value);
+            }
+
+            inline ConnectionStatistics connectionStatistics() const
+            {
+                return implementation_.connectionStatistics();
+            }
+
+            inline void shareConnectionPool(const Interface &other)
+            {
+                implementation_.shareConnectionPool(other.implementation_);
+            }
+
         private:
             TYPE_HAS_METHOD(Implementation::Request, send, RequestResult());
             TYPE_HAS_METHOD(Implementation::Request,
@@ -330,6 +520,233 @@ namespace gearbox
                 return implementation_.createRequest();
             }
 
+            /* Only the named response headers are kept, all of them if names  */
+            /* is empty. Implementations that can't filter keep all of them.   */
+            inline void setCapturedHeaders(std::vector<std::string> names)
+            {
+                applyCapturedHeaders(implementation_, std::move(names), 0);
+            }
+
+            /* Makes the body of a successful response go to handler, chunk by  */
+            /* chunk as it arrives, instead of into the text of the result.     */
+            /* Implementations that can't stream leave the body in the text.   */
+            inline void setBodyHandler(Request &request,
+                                       body_handler_t handler)
+            {
+                applyBodyHandler(request, std::move(handler), 0);
+            }
+
+            /* Polled before each chunk of a streamed body is handed over. A  */
+            /* transfer the handler returns true for is paused, without      */
+            /* blocking the transport, until the function it was given is    */
+            /* invoked. Implementations that run every transfer on a thread  */
+            /* of its own never pause, the body handler is free to block.    */
+            inline void setPauseHandler(Request &request,
+                                        pause_handler_t handler)
+            {
+                applyPauseHandler(request, std::move(handler), 0);
+            }
+
+            /* Applies to this request alone, instead of the timeout set on */
+            /* the instance. Implementations that can't do that ignore it.  */
+            inline void setTimeout(Request &request, milliseconds_t value)
+            {
+                applyTimeout(request, value, 0);
+            }
+
+            /* The handler is polled while the request is in flight, and the */
+            /* transfer aborted as soon as it returns true. Implementations  */
+            /* that can't abort a transfer let it run to completion.         */
+            inline void setAbortHandler(Request &request,
+                                        abort_handler_t handler)
+            {
+                applyAbortHandler(request, std::move(handler), 0);
+            }
+
+            /* Has writer fill the body of the request in, straight into the */
+            /* buffer the request sends from if the implementation lends it, */
+            /* otherwise into a string then passed to setBody().             */
+            template <typename Writer>
+            inline void writeBody(Request &request, Writer &&writer)
+            {
+                applyBodyWriter(request, writer, 0);
+            }
+
+            /* Hands the request over to the event loop of the implementation, */
+            /* if it has one, otherwise the request is sent from a thread of   */
+            /* its own. The callback is invoked from whichever thread ran it.  */
+            inline void sendAsync(
+                Request &&request,
+                std::function<void(RequestResult &&)> callback)
+            {
+                dispatchAsync(request, std::move(callback), 0);
+            }
+
+            /* Has callback invoked once delay is over, from the event loop of */
+            /* the implementation if it has one, otherwise from a thread of  */
+            /* its own.                                                       */
+            inline void schedule(milliseconds_t delay,
+                                 std::function<void()> callback)
+            {
+                dispatchTimer(implementation_, delay, std::move(callback), 0);
+            }
+
+            /* Tells if the calling thread is the one the implementation runs */
+            /* its event loop on, waiting there for another request would    */
+            /* never return. Always false for implementations without one.    */
+            inline bool isTransportThread() const
+            {
+                return checkTransportThread(implementation_, 0);
+            }
+
+        private:
+            template <typename I>
+            static auto applyCapturedHeaders(I &implementation,
+                                             std::vector<std::string> &&names,
+                                             int)
+                -> decltype(implementation.setCapturedHeaders(std::move(names)))
+            {
+                implementation.setCapturedHeaders(std::move(names));
+            }
+
+            template <typename I>
+            static void applyCapturedHeaders(I &,
+                                             std::vector<std::string> &&,
+                                             long)
+            {
+            }
+
+            template <typename R>
+            static auto applyBodyHandler(R &request,
+                                         body_handler_t &&handler,
+                                         int)
+                -> decltype(request.setBodyHandler(std::move(handler)))
+            {
+                request.setBodyHandler(std::move(handler));
+            }
+
+            template <typename R>
+            static void applyBodyHandler(R &, body_handler_t &&, long)
+            {
+            }
+
+            template <typename R, typename Writer>
+            static auto applyBodyWriter(R &request, Writer &writer, int)
+                -> decltype(writer(request.bodyBuffer()))
+            {
+                writer(request.bodyBuffer());
+            }
+
+            template <typename R, typename Writer>
+            static void applyBodyWriter(R &request, Writer &writer, long)
+            {
+                std::string body;
+                writer(body);
+                request.setBody(body);
+            }
+
+            template <typename R>
+            static auto applyPauseHandler(R &request,
+                                          pause_handler_t &&handler,
+                                          int)
+                -> decltype(request.setPauseHandler(std::move(handler)))
+            {
+                request.setPauseHandler(std::move(handler));
+            }
+
+            template <typename R>
+            static void applyPauseHandler(R &, pause_handler_t &&, long)
+            {
+            }
+
+            template <typename R>
+            static auto applyTimeout(R &request, milliseconds_t value, int)
+                -> decltype(request.setTimeout(value))
+            {
+                request.setTimeout(value);
+            }
+
+            template <typename R>
+            static void applyTimeout(R &, milliseconds_t, long)
+            {
+            }
+
+            template <typename R>
+            static auto applyAbortHandler(R &request,
+                                          abort_handler_t &&handler,
+                                          int)
+                -> decltype(request.setAbortHandler(std::move(handler)))
+            {
+                request.setAbortHandler(std::move(handler));
+            }
+
+            template <typename R>
+            static void applyAbortHandler(R &, abort_handler_t &&, long)
+            {
+            }
+
+            template <typename I>
+            static auto dispatchTimer(I &implementation,
+                                      milliseconds_t delay,
+                                      std::function<void()> &&callback,
+                                      int)
+                -> decltype(implementation.schedule(delay, std::move(callback)))
+            {
+                implementation.schedule(delay, std::move(callback));
+            }
+
+            template <typename I>
+            static void dispatchTimer(I &,
+                                      milliseconds_t delay,
+                                      std::function<void()> &&callback,
+                                      long)
+            {
+                std::thread(
+                    [delay](std::function<void()> c) {
+                        std::this_thread::sleep_for(delay);
+                        c();
+                    },
+                    std::move(callback))
+                    .detach();
+            }
+
+            template <typename I>
+            static auto checkTransportThread(const I &implementation, int)
+                -> decltype(implementation.isTransportThread())
+            {
+                return implementation.isTransportThread();
+            }
+
+            template <typename I>
+            static bool checkTransportThread(const I &, long)
+            {
+                return false;
+            }
+
+            template <typename R>
+            static auto dispatchAsync(
+                R &request,
+                std::function<void(RequestResult &&)> &&callback,
+                int) -> decltype(request.sendAsync(std::move(callback)))
+            {
+                request.sendAsync(std::move(callback));
+            }
+
+            template <typename R>
+            static void dispatchAsync(
+                R &request,
+                std::function<void(RequestResult &&)> &&callback,
+                long)
+            {
+                std::thread(
+                    [](R r,
+                       std::function<void(RequestResult &&)> c) {
+                        c(r.send());
+                    },
+                    std::move(request), std::move(callback))
+                    .detach();
+            }
+
         private:
             Implementation implementation_;
 
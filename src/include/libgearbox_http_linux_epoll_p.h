@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_HTTP_LINUX_EPOLL_P_H
+#define LIBGEARBOX_HTTP_LINUX_EPOLL_P_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "libgearbox_global.h"
+#include "libgearbox_http_interface_p.h"
+
+namespace gearbox
+{
+    /* A minimal HTTP/1.1 client tailored to the Transmission RPC. Requests  */
+    /* go over kept-alive, non-blocking sockets that are waited on through  */
+    /* epoll. It only speaks plain HTTP with Basic authentication and reads */
+    /* bodies delimited by Content-Length or chunked; there is no TLS, no    */
+    /* compression, no redirects and no HTTP/2.                              */
+    class EpollHttp
+    {
+    private:
+        using milliseconds_t = gearbox::http::milliseconds_t;
+        using http_header_t = gearbox::http::header_t;
+        using http_header_array_t = gearbox::http::header_array_t;
+        using http_body_handler_t = gearbox::http::body_handler_t;
+        using http_abort_handler_t = gearbox::http::abort_handler_t;
+        using http_port_t = gearbox::http::port_t;
+        using http_ssl_error_handling_t = gearbox::http::SSLErrorHandling;
+        using http_status_t = gearbox::http::Status;
+        using http_error_t = gearbox::http::Error;
+        using http_request_result_t = gearbox::http::RequestResult;
+        using http_connection_statistics_t =
+            gearbox::http::ConnectionStatistics;
+
+    public:
+        explicit EpollHttp(const std::string &userAgent);
+        EpollHttp(EpollHttp &&) noexcept(true);
+        EpollHttp &operator=(EpollHttp &&) noexcept(true);
+        ~EpollHttp();
+
+    public:
+        const std::string &host() const;
+        void setHost(const std::string &hostname);
+        void setHost(std::string &&hostname);
+
+        http_port_t port() const;
+        void setPort(http_port_t port);
+
+        const std::string &path() const;
+        void setPath(const std::string &path);
+        void setPath(std::string &&path);
+
+        bool authenticationRequired() const;
+        void enableAuthentication();
+        void disableAuthentication();
+        const std::string &username() const;
+        void setUsername(const std::string &username);
+        void setUsername(std::string &&username);
+
+        const std::string &password() const;
+        void setPassword(const std::string &password);
+        void setPassword(std::string &&password);
+
+        /* Nothing to verify without TLS, kept for the sake of the interface */
+        void setSSLErrorHandling(http_ssl_error_handling_t value);
+
+        const std::string &unixSocketPath() const;
+        void setUnixSocketPath(const std::string &path);
+
+        const std::vector<std::string> &capturedHeaders() const;
+        void setCapturedHeaders(std::vector<std::string> names);
+
+        const milliseconds_t &timeout() const;
+        void setTimeout(milliseconds_t value);
+
+        std::size_t maxIdleConnections() const;
+        void setMaxIdleConnections(std::size_t value);
+
+        milliseconds_t idleConnectionTimeout() const;
+        void setIdleConnectionTimeout(milliseconds_t value);
+
+        http_connection_statistics_t connectionStatistics() const;
+
+        /* Makes this instance use the open connections and the resolved */
+        /* addresses of other. Safe to call while requests are created   */
+        /* from other threads.                                           */
+        void shareConnectionPool(const EpollHttp &other);
+
+    private:
+        /* A socket along with the epoll instance that waits on it, the */
+        /* events it is registered for are kept to skip needless calls  */
+        /* to epoll_ctl().                                              */
+        struct Connection
+        {
+            int socket;
+            int epoll;
+            std::uint32_t events;
+        };
+
+        /* Where, and how, requests are sent. Rebuilt, rather than changed, */
+        /* whenever a setting it depends on changes so that requests can    */
+        /* hold on to it while they are in flight.                          */
+        struct Target
+        {
+            bool supported;           /* false for anything but http:// */
+            std::string name;         /* as handed to getaddrinfo()     */
+            std::string service;
+            std::string unixSocketPath;
+            std::string endpoint;     /* connections are only reused    */
+                                      /* for the same endpoint          */
+            std::string path;
+            std::string fields;       /* Host, User-Agent, Authorization */
+        };
+
+        struct ConnectionPool
+        {
+            using clock_t = std::chrono::steady_clock;
+
+            struct IdleConnection
+            {
+                Connection connection;
+                std::string endpoint;
+                clock_t::time_point releaseTime;
+            };
+
+            struct Address
+            {
+                sockaddr_storage storage;
+                socklen_t size;
+            };
+
+            struct ResolvedHost
+            {
+                std::string endpoint;
+                std::vector<Address> addresses;
+                clock_t::time_point resolveTime;
+            };
+
+            ConnectionPool();
+            ~ConnectionPool();
+
+            bool acquire(const std::string &endpoint, Connection &connection);
+            void release(const std::string &endpoint, Connection connection);
+            void clear();
+
+            /* Looks the target up unless it was resolved recently enough, */
+            /* returns false if it couldn't be resolved.                    */
+            bool resolve(const Target &target, std::vector<Address> &addresses);
+
+            /* Moves the address that could be connected to up front, so the */
+            /* next connection tries it first.                               */
+            void prefer(const Target &target, const Address &address);
+
+            /* Removes, and returns, the connections that have been idle for */
+            /* too long or that exceed maxIdle. Expects mutex to be locked.  */
+            std::vector<Connection> takeStale(clock_t::time_point now);
+
+            std::mutex mutex;
+            std::vector<IdleConnection> idle;
+            std::vector<ResolvedHost> hosts;
+            std::size_t maxIdle;
+            milliseconds_t idleTimeout;
+            std::atomic<std::uint64_t> reusedConnections;
+            std::atomic<std::uint64_t> newConnections;
+            std::atomic<std::uint64_t> receivedBytes;
+            std::atomic<std::uint64_t> dnsLookups;
+
+        private:
+            DISABLE_COPY(ConnectionPool)
+            DISABLE_MOVE(ConnectionPool)
+        };
+
+    public:
+        class Request
+        {
+        public:
+            Request(std::shared_ptr<ConnectionPool> pool,
+                    std::shared_ptr<const Target> target,
+                    milliseconds_t timeout,
+                    std::shared_ptr<const std::vector<std::string>>
+                        capturedHeaders = nullptr);
+            Request(Request &&) noexcept(true);
+            Request &operator=(Request &&) noexcept(true);
+            ~Request();
+
+        public:
+            void setBody(const std::string &data);
+            void setHeaders(const http_header_array_t &headers);
+            void setHeader(const http_header_t &header);
+            void setBodyHandler(http_body_handler_t handler);
+
+            /* Overrides the timeout of the instance for this request */
+            void setTimeout(milliseconds_t value);
+
+            /* Polled while waiting on the socket, every 100ms at most */
+            void setAbortHandler(http_abort_handler_t handler);
+
+        public:
+            http_request_result_t send();
+
+        private:
+            using clock_t = ConnectionPool::clock_t;
+
+            enum class Wait
+            {
+                Ready,
+                TimedOut,
+                Aborted,
+                Failed
+            };
+
+            class Transfer;
+
+            Wait wait(Connection &connection,
+                      std::uint32_t events,
+                      clock_t::time_point deadline);
+            http_error_t connect(Connection &connection,
+                                 clock_t::time_point deadline);
+            http_error_t exchange(Connection &connection,
+                                  Transfer &transfer,
+                                  clock_t::time_point deadline);
+            void writeHead(std::string &head) const;
+
+        private:
+            std::shared_ptr<ConnectionPool> pool_;
+            std::shared_ptr<const Target> target_;
+            milliseconds_t timeout_;
+            http_header_array_t headers_;
+            std::string body_;
+            bool hasBody_;
+            http_body_handler_t bodyHandler_;
+            http_abort_handler_t abortHandler_;
+            std::shared_ptr<const std::vector<std::string>> capturedHeaders_;
+
+        private:
+            DISABLE_COPY(Request)
+        };
+        Request createRequest();
+
+    private:
+        void updateTarget();
+
+    private:
+        std::string userAgent_;
+        std::string hostname_;
+        http_port_t port_;
+        std::string path_;
+        bool authenticationEnabled_;
+        struct
+        {
+            std::string username;
+            std::string password;
+        } authentication_;
+        std::string unixSocketPath_;
+        std::shared_ptr<const Target> target_;
+        std::shared_ptr<const std::vector<std::string>> capturedHeaders_;
+        milliseconds_t timeout_;
+
+    private:
+        /* The pool can be replaced by shareConnectionPool from another */
+        /* thread, it is only read through this                         */
+        std::shared_ptr<ConnectionPool> pool() const;
+
+    private:
+        std::shared_ptr<ConnectionPool> pool_;
+
+    private:
+        DISABLE_COPY(EpollHttp)
+    };
+}
+
+#endif // LIBGEARBOX_HTTP_LINUX_EPOLL_P_H
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+
+#ifndef LIBGEARBOX_HTTP_LINUX_MULTI_P_H
+#define LIBGEARBOX_HTTP_LINUX_MULTI_P_H
+
+#include <functional>
+#include <memory>
+
+#include <curl/curl.h>
+
+#include "libgearbox_global.h"
+#include "libgearbox_http_interface_p.h"
+#include "libgearbox_http_linux_p.h"
+
+namespace gearbox
+{
+    /* Same as CUrlHttp, except that requests are not performed on the      */
+    /* calling thread. A single transport thread, shared by all instances,  */
+    /* drives every request that is in flight through a curl_multi handle.  */
+    class CUrlMultiHttp : public CUrlHttp
+    {
+    private:
+        using http_request_result_t = gearbox::http::RequestResult;
+        using completion_t = std::function<void(http_request_result_t &&)>;
+
+        class Engine;
+
+    public:
+        explicit CUrlMultiHttp(const std::string &userAgent);
+        CUrlMultiHttp(CUrlMultiHttp &&) noexcept(true);
+        CUrlMultiHttp &operator=(CUrlMultiHttp &&) noexcept(true);
+        ~CUrlMultiHttp();
+
+    public:
+        class Request : public CUrlHttp::Request
+        {
+        public:
+            Request(CUrlHttp::Request &&request, Engine *engine);
+            Request(Request &&) noexcept(true);
+            Request &operator=(Request &&) noexcept(true);
+            ~Request();
+
+        public:
+            /* Blocks until the transport thread completes the request */
+            http_request_result_t send();
+
+            /* Returns immediately, the request is moved out of this instance */
+            /* and callback is invoked from the transport thread.             */
+            void sendAsync(completion_t callback);
+
+        private:
+            Engine *engine_;
+            Transfer transfer_;
+            completion_t callback_;
+            bool detached_;
+
+        private:
+            friend class CUrlMultiHttp::Engine;
+
+        private:
+            DISABLE_COPY(Request)
+        };
+        Request createRequest();
+
+        /* Has callback invoked from the transport thread once delay is */
+        /* over. It is not for callback to block the transport.         */
+        void schedule(milliseconds_t delay, std::function<void()> callback);
+
+        /* Completion callbacks are invoked from the transport thread */
+        bool isTransportThread() const;
+
+    private:
+        Engine *engine_;
+
+    private:
+        DISABLE_COPY(CUrlMultiHttp)
+    };
+}
+
+#endif // LIBGEARBOX_HTTP_LINUX_MULTI_P_H
@@ -25,6 +25,12 @@
 #ifndef LIBGEARBOX_HTTP_WIN_P_H
 #define LIBGEARBOX_HTTP_WIN_P_H
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include <curl/curl.h>
 
 #include "libgearbox_global.h"
@@ -38,12 +44,19 @@ namespace gearbox
         using milliseconds_t = gearbox::http::milliseconds_t;
         using http_header_t = gearbox::http::header_t;
         using http_header_array_t = gearbox::http::header_array_t;
+        using http_response_headers_t = gearbox::http::ResponseHeaders;
+        using http_body_handler_t = gearbox::http::body_handler_t;
+        using http_pause_handler_t = gearbox::http::pause_handler_t;
+        using http_abort_handler_t = gearbox::http::abort_handler_t;
         using http_port_t = gearbox::http::port_t;
         using http_request_t = gearbox::http::RequestType;
         using http_ssl_error_handling_t = gearbox::http::SSLErrorHandling;
+        using http_version_t = gearbox::http::Version;
         using http_status_t = gearbox::http::Status;
         using http_error_t = gearbox::http::Error;
         using http_request_result_t = gearbox::http::RequestResult;
+        using http_connection_statistics_t =
+            gearbox::http::ConnectionStatistics;
 
     public:
         explicit CUrlHttp(const std::string &userAgent);
@@ -76,35 +89,207 @@ namespace gearbox
 
         void setSSLErrorHandling(http_ssl_error_handling_t value);
 
+        bool compressionEnabled() const;
+        void enableCompression();
+        void disableCompression();
+
+        http_version_t httpVersion() const;
+        void setHttpVersion(http_version_t value);
+
+        /* Requests go through the socket at path, when set, instead of */
+        /* connecting to the host; the URL is still sent as is.         */
+        const std::string &unixSocketPath() const;
+        void setUnixSocketPath(const std::string &path);
+
+        const std::vector<std::string> &capturedHeaders() const;
+        void setCapturedHeaders(std::vector<std::string> names);
+
         const milliseconds_t &timeout() const;
         void setTimeout(milliseconds_t value);
 
+        std::size_t maxIdleConnections() const;
+        void setMaxIdleConnections(std::size_t value);
+
+        milliseconds_t idleConnectionTimeout() const;
+        void setIdleConnectionTimeout(milliseconds_t value);
+
+        http_connection_statistics_t connectionStatistics() const;
+
+        /* Makes this instance use the connection pool of other, and with */
+        /* it the same idle connections, DNS cache and TLS sessions. The   */
+        /* pool settings and statistics are then those of the shared pool. */
+        /* Safe to call while requests are created from other threads.     */
+        void shareConnectionPool(const CUrlHttp &other);
+
+    private:
+        /* Keeps idle easy handles, and with them their open connections, */
+        /* around so that subsequent requests skip the TCP and TLS setup.  */
+        struct ConnectionPool
+        {
+            using clock_t = std::chrono::steady_clock;
+
+            /* The body buffer of the last request sent on a handle, and the  */
+            /* one its response headers were read into, stay with it, so the */
+            /* next request can use them without allocating.                 */
+            struct IdleHandle
+            {
+                CURL *handle;
+                clock_t::time_point releaseTime;
+                std::string body;
+                http_response_headers_t responseHeaders;
+            };
+
+            ConnectionPool();
+            ~ConnectionPool();
+
+            CURL *acquire(std::string &body,
+                          http_response_headers_t &responseHeaders);
+            void release(CURL *handle,
+                         std::string &&body,
+                         http_response_headers_t &&responseHeaders);
+            void clear();
+
+            /* Removes, and returns, the handles that have been idle for too */
+            /* long or that exceed maxIdle. Expects mutex to be locked.      */
+            std::vector<CURL *> takeStale(clock_t::time_point now);
+
+            std::mutex mutex;
+            std::vector<IdleHandle> idle;
+            std::size_t maxIdle;
+            milliseconds_t idleTimeout;
+            std::atomic<std::uint64_t> reusedConnections;
+            std::atomic<std::uint64_t> newConnections;
+            std::atomic<std::uint64_t> receivedBytes;
+            std::atomic<std::uint64_t> decodedBytes;
+            std::atomic<std::uint64_t> dnsLookups;
+            /* The DNS cache and TLS sessions of every handle of the pool.  */
+            /* Connections stay with their handle, or with the curl_multi   */
+            /* handle driving it: cURL doesn't support a connection cache   */
+            /* shared by transfers that run on different threads.          */
+            CURLSH *share;
+            std::recursive_mutex shareMutex;
+
+        private:
+            DISABLE_COPY(ConnectionPool)
+            DISABLE_MOVE(ConnectionPool)
+        };
+
     public:
         class Request
         {
         public:
-            Request(CURL *handle);
+            Request(CURL *handle,
+                    std::shared_ptr<ConnectionPool> pool = nullptr,
+                    std::string &&body = std::string(),
+                    std::shared_ptr<const std::vector<std::string>>
+                        capturedHeaders = nullptr,
+                    http_response_headers_t &&responseHeaders =
+                        http_response_headers_t());
             Request(Request &&) noexcept(true);
             Request &operator=(Request &&) noexcept(true);
             ~Request();
 
         public:
             void setBody(const std::string &data);
+            /* Swaps the body in, the caller gets the pooled buffer back */
+            void setBody(std::string &&data);
+            /* The pooled buffer, emptied, to serialize the body into */
+            std::string &bodyBuffer();
             void setHeaders(const http_header_array_t &headers);
             void setHeader(const http_header_t &header);
+            void setBodyHandler(http_body_handler_t handler);
+
+            /* Only transfers driven by CUrlMultiHttp can be resumed, and so */
+            /* paused, the handler is never polled otherwise.                */
+            void setPauseHandler(http_pause_handler_t handler);
+
+            /* Overrides the timeout of the instance for this request */
+            void setTimeout(milliseconds_t value);
+
+            /* Polled by cURL's progress callback, at least once a second */
+            void setAbortHandler(http_abort_handler_t handler);
 
         public:
             http_request_result_t send();
 
+        private:
+            /* Holds what a single transfer writes into; it has to stay at the */
+            /* same address from prepare() until finish() returns.             */
+            struct Transfer
+            {
+                enum class Body
+                {
+                    Undecided,
+                    Text,
+                    Streamed
+                };
+
+                CURL *handle = nullptr;
+                http_response_headers_t responseHeaders;
+                std::string text;
+                const http_body_handler_t *bodyHandler = nullptr;
+                const http_abort_handler_t *abortHandler = nullptr;
+                const http_pause_handler_t *pauseHandler = nullptr;
+                /* Set by whoever drives the transfer if it can be resumed */
+                std::function<void()> resume;
+                Body body = Body::Undecided;
+                std::uint64_t streamedBytes = 0;
+            };
+
+            /* Forwards the body of a successful response to the body handler, */
+            /* any other response is kept in the text of the transfer.         */
+            static std::size_t streamCallback(void *ptr,
+                                              std::size_t size,
+                                              std::size_t nmemb,
+                                              Transfer *transfer);
+
+            /* Aborts the transfer once the abort handler returns true */
+            static int progressCallback(Transfer *transfer,
+                                        curl_off_t,
+                                        curl_off_t,
+                                        curl_off_t,
+                                        curl_off_t);
+
+            void prepare(Transfer &transfer);
+            http_request_result_t finish(Transfer &transfer, CURLcode code);
+
         private:
             CURL *handle_;
             http_header_array_t headers_;
+            /* Rebuilt when the headers change, not on every transfer */
+            curl_slist *headerList_;
+            /* cURL sends straight from here, it is only pointed at the  */
+            /* body in prepare() since moving the request can move it.   */
+            std::string body_;
+            bool hasBody_;
+            http_body_handler_t bodyHandler_;
+            http_pause_handler_t pauseHandler_;
+            http_abort_handler_t abortHandler_;
+            std::shared_ptr<const std::vector<std::string>> capturedHeaders_;
+            /* Lent to each transfer, the result shares it with the handle */
+            http_response_headers_t responseHeaders_;
+            std::shared_ptr<ConnectionPool> pool_;
+
+        private:
+            void updateHeaderList();
+
+        private:
+            friend class CUrlMultiHttp;
 
         private:
             DISABLE_COPY(Request)
         };
         Request createRequest();
 
+    private:
+        /* The pool can be replaced by shareConnectionPool from another */
+        /* thread, it is only read through this                         */
+        std::shared_ptr<ConnectionPool> pool() const;
+
+        /* Both are only rebuilt when the settings they depend on change */
+        void updateUrl();
+        void updateCredentials();
+
     private:
         std::string hostname_;
         http_port_t port_;
@@ -115,11 +300,22 @@ namespace gearbox
             std::string username;
             std::string password;
         } authentication_;
+        std::string url_;
+        std::string credentials_;
         bool sslErrorHandlingEnabled_;
+        bool compressionEnabled_;
+        http_version_t httpVersion_;
+        std::string unixSocketPath_;
+        /* Shared with the requests in flight, replaced rather than changed */
+        std::shared_ptr<const std::vector<std::string>> capturedHeaders_;
         milliseconds_t timeout_;
 
     private:
         CURL *handle_;
+        std::shared_ptr<ConnectionPool> pool_;
+
+    private:
+        friend class CUrlMultiHttp;
 
     private:
         DISABLE_COPY(CUrlHttp)
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_JSON_STREAM_P_H
+#define LIBGEARBOX_JSON_STREAM_P_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "libgearbox_global.h"
+
+namespace gearbox
+{
+    /* Scans a JSON document that is fed in chunks of any size and hands over */
+    /* each object, or array, in the array found at path as soon as it closes. */
+    /* Everything else is kept, with that array left empty, in the remainder  */
+    /* so it can be parsed once the whole document is in. Only the element   */
+    /* being received is ever buffered, besides the remainder.               */
+    class JsonArrayStream
+    {
+    public:
+        using element_handler_t = std::function<void(std::string &&)>;
+
+    public:
+        JsonArrayStream(std::vector<std::string> path,
+                        element_handler_t handler);
+
+    public:
+        void feed(const char *data, std::size_t size);
+
+        inline const std::string &remainder() const { return remainder_; }
+        inline bool failed() const { return failed_; }
+
+    private:
+        struct Level
+        {
+            bool array;
+            bool expectingKey;
+            std::string key;
+        };
+
+        bool atPath() const;
+        std::string *destination();
+
+    private:
+        std::vector<std::string> path_;
+        element_handler_t handler_;
+
+        std::vector<Level> levels_;
+        bool inString_;
+        bool escaped_;
+        bool readingKey_;
+        std::string key_;
+
+        /* Depth at which the elements of the array are, 0 until it is found */
+        std::size_t elementDepth_;
+        std::string element_;
+        std::string remainder_;
+        bool failed_;
+
+    private:
+        DISABLE_COPY(JsonArrayStream)
+        DISABLE_MOVE(JsonArrayStream)
+    };
+}
+
+#endif // LIBGEARBOX_JSON_STREAM_P_H
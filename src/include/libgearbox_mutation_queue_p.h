@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_MUTATION_QUEUE_P_H
+#define LIBGEARBOX_MUTATION_QUEUE_P_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "libgearbox_call_options.h"
+#include "libgearbox_error.h"
+#include "libgearbox_global.h"
+
+namespace gearbox
+{
+    /* Collects the mutations, e.g. torrent-start, that come in within a    */
+    /* short window and merges those with the same method and arguments    */
+    /* into a single batch, with the union of their ids. A start, or stop, */
+    /* of an id that is still queued to be stopped, or started, takes its  */
+    /* place. The mutation that opens the window makes its caller the      */
+    /* leader, which collects the batches once the window is over and has  */
+    /* them sent, in the order in which they were opened.                  */
+    class MutationQueue
+    {
+    public:
+        using completion_t = std::function<void(Error &&)>;
+
+        struct Mutation
+        {
+            std::string method;
+            /* Everything but the ids, as serialized JSON */
+            std::string arguments;
+            std::vector<std::int32_t> ids;
+            CallOptions options;
+            completion_t done;
+        };
+
+        /* Mutations left without ids were taken over by the others, */
+        /* they complete along with them.                            */
+        struct Batch
+        {
+            std::string method;
+            std::string arguments;
+            std::vector<Mutation> mutations;
+
+            /* The ids of all of the mutations, in order and without repeats */
+            std::vector<std::int32_t> ids() const;
+        };
+
+    public:
+        MutationQueue();
+
+    public:
+        std::chrono::milliseconds window() const;
+
+        /* A window of 0 disables the queue, and has the current window */
+        /* closed right away.                                           */
+        void setWindow(std::chrono::milliseconds window);
+
+        /* Returns true if the mutation opened a new window, its caller is */
+        /* then expected to call collect().                                 */
+        bool push(Mutation &&mutation);
+
+        /* Waits for the window to close and returns what was queued */
+        std::vector<Batch> collect();
+
+        /* Same as collect() without the wait, nothing is returned while */
+        /* the window is still open.                                    */
+        std::vector<Batch> collectDue();
+
+        /* How long until the window closes, rounded up, 0 if none is open */
+        std::chrono::milliseconds remaining();
+
+    private:
+        /* Expects mutex_ to be locked */
+        void supersede(Mutation &mutation, std::vector<Mutation> &taken);
+
+    private:
+        std::atomic<std::int64_t> window_;
+
+        std::mutex mutex_;
+        std::condition_variable closed_;
+        std::chrono::steady_clock::time_point deadline_;
+        bool open_;
+        std::vector<Batch> batches_;
+
+    private:
+        DISABLE_COPY(MutationQueue)
+        DISABLE_MOVE(MutationQueue)
+    };
+}
+
+#endif // LIBGEARBOX_MUTATION_QUEUE_P_H
@@ -25,6 +25,10 @@
 #ifndef LIBGEARBOX_SESSION_P_H
 #define LIBGEARBOX_SESSION_P_H
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include <json.hpp>
@@ -35,8 +39,22 @@
 #include "libgearbox_http_win_p.h"
 using HttpRequestHandler = gearbox::http::Interface<gearbox::WinHttp>;
 #elif defined(PLATFORM_LINUX)
+#if defined(LIBGEARBOX_EPOLL_HTTP)
+#include "libgearbox_http_linux_epoll_p.h"
+using HttpRequestHandler = gearbox::http::Interface<gearbox::EpollHttp>;
+#else
+#if defined(LIBGEARBOX_CURL_MULTI)
+#include "libgearbox_http_linux_multi_p.h"
+using HttpRequestHandler = gearbox::http::Interface<gearbox::CUrlMultiHttp>;
+#else
 #include "libgearbox_http_linux_p.h"
 using HttpRequestHandler = gearbox::http::Interface<gearbox::CUrlHttp>;
+#endif
+#define LIBGEARBOX_HTTP2
+#define LIBGEARBOX_HTTP_COMPRESSION
+#endif
+#define LIBGEARBOX_HTTP_CONNECTION_POOL
+#define LIBGEARBOX_HTTP_UNIX_SOCKET
 #elif defined(PLATFORM_MACOS)
 #include "libgearbox_http_macos_p.h"
 using HttpRequestHandler = gearbox::http::Interface<gearbox::CocoaHttp>;
@@ -47,7 +65,13 @@ using HttpRequestHandler = gearbox::http::Interface<gearbox::HttpUWP>;
 #error "Unsupported platform"
 #endif
 
+#include "libgearbox_call_options.h"
 #include "libgearbox_error.h"
+#include "libgearbox_future_p.h"
+#include "libgearbox_json_stream_p.h"
+#include "libgearbox_mutation_queue_p.h"
+#include "libgearbox_session.h"
+#include "libgearbox_session_token_p.h"
 
 namespace gearbox
 {
@@ -95,6 +119,19 @@ namespace gearbox
             Error error;
         };
 
+        /* Long loops over the data of a response only check every so often */
+        /* whether the call they belong to was interrupted.                  */
+        constexpr std::size_t INTERRUPTION_CHECK_INTERVAL{ 1024 };
+
+        inline bool interrupted(const CallOptions &options)
+        {
+            return options.cancelled() || options.expired();
+        }
+
+        /* Returns the error a call ends with once it is cancelled or past */
+        /* its deadline, no error otherwise.                               */
+        Error interruption(const CallOptions &options);
+
         struct Statistics
         {
             ATTRIBUTE(std::int32_t, activeTorrentCount)
@@ -110,7 +147,7 @@ namespace gearbox
         };
     }
 
-    class SessionPrivate
+    class SessionPrivate : public std::enable_shared_from_this<SessionPrivate>
     {
         friend class Session;
 
@@ -132,11 +169,144 @@ namespace gearbox
     public:
         session::Response sendRequest(
             const std::string &method,
-            nlohmann::json arguments = nlohmann::json());
+            nlohmann::json arguments = nlohmann::json(),
+            const CallOptions &options = CallOptions());
+
+        /* The transform runs on whichever thread consumes the future */
+        template <typename T>
+        Future<T> sendRequestAsync(
+            const std::string &method,
+            nlohmann::json arguments,
+            std::function<T(session::Response &&)> transform,
+            const CallOptions &options = CallOptions())
+        {
+            auto state = std::make_shared<FutureState<session::Response, T>>(
+                std::move(transform));
+            auto call = std::make_shared<PendingCall>();
+            call->method = method;
+            call->arguments = std::move(arguments);
+            call->options = options;
+            call->callback = [state](session::Response &&response) {
+                state->setValue(std::move(response));
+            };
+            sendRequestAsync(call);
+
+            return Future<T>(std::move(state));
+        }
+
+        /* Hands over each element of the array at path in the response as */
+        /* it is received, the response delivered to callback is left with */
+        /* that array empty. Both run on the transport thread. shouldPause  */
+        /* can hold the transfer back, see http::Interface::setPauseHandler. */
+        void streamRequest(
+            const std::string &method,
+            nlohmann::json arguments,
+            std::vector<std::string> path,
+            JsonArrayStream::element_handler_t onElement,
+            gearbox::http::pause_handler_t shouldPause,
+            std::function<void(session::Response &&)> callback,
+            const CallOptions &options = CallOptions());
+
+        /* Sends method once for every maxTorrentsPerCall_ of the ids, each */
+        /* along with arguments, and reports the outcome of every call.     */
+        std::vector<Session::BatchResult> sendBatch(
+            const std::string &method,
+            const std::vector<std::int32_t> &ids,
+            const nlohmann::json &arguments,
+            const CallOptions &options = CallOptions());
+
+        /* Mutations of single torrents, e.g. torrent-start, go through the */
+        /* coalescing queue while it is enabled, they are sent right away   */
+        /* otherwise. arguments are expected to hold the ids.               */
+        Error sendMutation(const std::string &method,
+                           nlohmann::json arguments,
+                           const CallOptions &options = CallOptions());
+        Future<Error> sendMutationAsync(
+            const std::string &method,
+            nlohmann::json arguments,
+            const CallOptions &options = CallOptions());
+
+        /* Same as sendBatch, with all of the calls in flight at once */
+        Future<std::vector<Session::BatchResult>> sendBatchAsync(
+            const std::string &method,
+            const std::vector<std::int32_t> &ids,
+            const nlohmann::json &arguments,
+            const CallOptions &options = CallOptions());
+
+        /* torrent-get asks for the "table" format until the daemon answers */
+        /* with objects, which those that don't support it always do.       */
+        bool tableFormat() const { return tableFormat_; }
+        void disableTableFormat() { tableFormat_ = false; }
+
+    private:
+        struct PendingCall
+        {
+            std::string method;
+            nlohmann::json arguments;
+            CallOptions options;
+            std::int32_t attempt = 0;
+            SessionToken::Ticket ticket;
+            session::Response response;
+            std::function<void(session::Response &&)> callback;
+            std::unique_ptr<JsonArrayStream> stream;
+            gearbox::http::pause_handler_t shouldPause;
+        };
+
+        void sendRequestAsync(std::shared_ptr<PendingCall> call);
+
+        std::vector<std::vector<std::int32_t>> splitIds(
+            const std::vector<std::int32_t> &ids) const;
+
+        /* Has the mutation queued. If it opened a window, that window is  */
+        /* sent once it is over: by the calling thread, or from a timer of */
+        /* the transport if detached.                                      */
+        void queueMutation(const std::string &method,
+                           nlohmann::json arguments,
+                           const CallOptions &options,
+                           MutationQueue::completion_t done,
+                           bool detached);
+
+        /* Sends the batches one after the other from the calling thread */
+        void sendMutations(std::vector<MutationQueue::Batch> batches);
+
+        /* Same without blocking, each batch is sent from the completion */
+        /* of the previous one.                                          */
+        void sendMutationsAsync(
+            std::shared_ptr<std::vector<MutationQueue::Batch>> batches,
+            std::size_t index = 0);
+
+        /* Appends the JSON of the call to body */
+        void writeRequestBody(std::string &body,
+                              const std::string &method,
+                              const nlohmann::json &arguments) const;
+        /* The body is serialized straight into the buffer the request sends */
+        /* from, pooled along with the connection where the transport can.  */
+        HttpRequestHandler::Request createRequest(
+            const std::string &method,
+            const nlohmann::json &arguments);
+
+        /* Bounds the next attempt by what is left until the deadline of the */
+        /* call, and has the transfer aborted once the call is cancelled.    */
+        void applyCallOptions(HttpRequestHandler::Request &request,
+                              const CallOptions &options);
+
+        /* Returns false if the request has to be sent again, which is the */
+        /* case after a 409 and the session token has been taken care of.  */
+        bool processResult(gearbox::http::RequestResult &result,
+                           const SessionToken::Ticket &ticket,
+                           session::Response &response,
+                           const CallOptions &options,
+                           JsonArrayStream *stream = nullptr);
+        void logResponse(const std::string &method,
+                         const nlohmann::json &arguments,
+                         const session::Response &response) const;
 
     private:
-        std::string sessionId_;
+        SessionToken sessionToken_;
         HttpRequestHandler http_;
+        std::int32_t maxTorrentsPerCall_;
+        MutationQueue mutations_;
+        std::atomic<bool> tableFormat_;
     };
 }
 
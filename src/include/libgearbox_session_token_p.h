@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_SESSION_TOKEN_P_H
+#define LIBGEARBOX_SESSION_TOKEN_P_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "libgearbox_call_options.h"
+#include "libgearbox_global.h"
+
+namespace gearbox
+{
+    /* The X-Transmission-Session-Id shared by every request of a session.  */
+    /* Reading it takes no lock, it is copied out of a seqlock. Until it is */
+    /* known a single request, the leader, goes out to learn it while the  */
+    /* others wait. Once the daemon rotates it, the first request rejected */
+    /* with the token it was sent with replaces it; the other requests that */
+    /* were in flight with the same token pick up the new one.              */
+    class SessionToken
+    {
+    public:
+        using resume_t = std::function<void()>;
+
+        struct Ticket
+        {
+            std::string value;
+            std::uint64_t generation = 0;
+            bool leader = false;
+        };
+
+    public:
+        SessionToken();
+
+    public:
+        /* Returns false, without the ticket, if the token is being learnt by */
+        /* another request. resume is then called, from whichever thread    */
+        /* ends up completing that request, once it is worth trying again.   */
+        bool tryAcquire(Ticket &ticket, resume_t resume = nullptr);
+
+        /* Same as tryAcquire() except that it waits for the leader instead, */
+        /* returns false if the call is interrupted in the meantime.         */
+        bool acquire(Ticket &ticket, const CallOptions &options);
+
+        /* Never waits: same as tryAcquire() if it succeeds, otherwise the  */
+        /* ticket carries the token as currently known, without the lead.  */
+        /* For threads the leader can only complete on, waiting there would */
+        /* never return.                                                    */
+        void acquireNow(Ticket &ticket);
+
+        /* To be called once the request with ticket got a 409, along with */
+        /* the token the daemon sent with it.                               */
+        void replace(const Ticket &ticket, const std::string &value);
+
+        /* To be called once the request with ticket is done without a 409; */
+        /* responded tells if it got a response at all.                     */
+        void release(const Ticket &ticket, bool responded);
+
+        /* How many times the token has been replaced */
+        std::uint64_t replacements() const;
+
+    private:
+        /* Tokens up to this size are kept in the seqlock, Transmission's */
+        /* are 48 characters long. Longer ones are read under the mutex.  */
+        static constexpr std::size_t WORD_COUNT{ 16 };
+        static constexpr std::size_t MAX_SIZE{ WORD_COUNT * 8 };
+
+        std::uint64_t read(std::string &value) const;
+
+        /* Expects mutex_ to be locked */
+        void write(const std::string &value);
+        void wakeUp(std::unique_lock<std::mutex> &lock);
+
+    private:
+        std::atomic<std::uint64_t> sequence_;
+        std::atomic<std::size_t> size_;
+        std::array<std::atomic<std::uint64_t>, WORD_COUNT> words_;
+        std::atomic<bool> known_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable learnt_;
+        std::string overflow_;
+        bool learning_;
+        std::vector<resume_t> waiting_;
+
+    private:
+        DISABLE_COPY(SessionToken)
+        DISABLE_MOVE(SessionToken)
+    };
+}
+
+#endif // LIBGEARBOX_SESSION_TOKEN_P_H
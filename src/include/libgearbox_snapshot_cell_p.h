@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_SNAPSHOT_CELL_P_H
+#define LIBGEARBOX_SNAPSHOT_CELL_P_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "libgearbox_global.h"
+
+namespace gearbox
+{
+    /* Publishes an immutable value to any number of reader threads, RCU   */
+    /* style. Loading takes no lock and a fixed number of atomic operations */
+    /* and leaves the reader with a reference of its own. Each reader      */
+    /* counts itself in a slot of its thread, under the current phase,     */
+    /* while it copies the reference. Publishing swaps the value, then     */
+    /* flips the phase twice, each time waiting for the readers of the     */
+    /* phase it left to be done, before it drops the reference of the cell */
+    /* to the previous value. Which lives on until its last reader is done */
+    /* with it.                                                            */
+    template <typename T> class SnapshotCell
+    {
+    public:
+        static constexpr std::size_t SLOT_COUNT{ 64 };
+
+    public:
+        explicit SnapshotCell(std::shared_ptr<const T> value)
+          : current_(new Node{ std::move(value) }), phase_(0), slots_(),
+            publishing_()
+        {
+            for (auto &slot : slots_)
+            {
+                slot.readers[0] = 0;
+                slot.readers[1] = 0;
+            }
+        }
+
+        ~SnapshotCell() noexcept(true) { delete current_.load(); }
+
+    public:
+        std::shared_ptr<const T> load() const
+        {
+            auto &slot = slots_[slotIndex()];
+            const auto phase = phase_.load();
+
+            ++slot.readers[phase];
+            std::shared_ptr<const T> value = current_.load()->value;
+            --slot.readers[phase];
+
+            return value;
+        }
+
+        void publish(std::shared_ptr<const T> value)
+        {
+            std::lock_guard<std::mutex> lock(publishing_);
+
+            auto previous = current_.exchange(new Node{ std::move(value) });
+
+            /* A reader that loaded the phase before one of the flips may */
+            /* still count itself under it, and see the previous value.   */
+            for (int flip = 0; flip < 2; ++flip)
+            {
+                const auto drained = phase_.load();
+                phase_ = drained ^ 1;
+                for (const auto &slot : slots_)
+                {
+                    while (slot.readers[drained] != 0)
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            delete previous;
+        }
+
+    private:
+        struct Node
+        {
+            std::shared_ptr<const T> value;
+        };
+
+        /* Readers on different slots don't share a cache line. Padded */
+        /* rather than aligned, an over-aligned member would make every */
+        /* class holding a cell over-aligned too, and its new unaligned */
+        /* before C++17.                                                */
+        static constexpr std::size_t CACHE_LINE_SIZE{ 64 };
+
+        struct Slot
+        {
+            std::atomic<std::uint32_t> readers[2];
+            char padding[CACHE_LINE_SIZE -
+                         2 * sizeof(std::atomic<std::uint32_t>)];
+        };
+
+        /* Threads are given slots in turn, the first time they load from */
+        /* a cell of T                                                    */
+        static std::size_t slotIndex()
+        {
+            static std::atomic<std::size_t> next{ 0 };
+            thread_local const std::size_t index = next++ % SLOT_COUNT;
+            return index;
+        }
+
+    private:
+        std::atomic<Node *> current_;
+        std::atomic<std::size_t> phase_;
+        mutable std::array<Slot, SLOT_COUNT> slots_;
+        std::mutex publishing_;
+
+    private:
+        DISABLE_COPY(SnapshotCell)
+        DISABLE_MOVE(SnapshotCell)
+    };
+
+    template <typename T> constexpr std::size_t SnapshotCell<T>::SLOT_COUNT;
+    template <typename T>
+    constexpr std::size_t SnapshotCell<T>::CACHE_LINE_SIZE;
+}
+
+#endif // LIBGEARBOX_SNAPSHOT_CELL_P_H
@@ -28,12 +28,14 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <sequential.h>
 
 #include "libgearbox_file_p.h"
 #include "libgearbox_session_p.h"
+#include "libgearbox_torrent.h"
 
 namespace gearbox
 {
@@ -109,6 +111,31 @@ namespace gearbox
             INIT_ATTRIBUTES(ids, location, move)
         };
 
+        /* The header of a torrent-get response in the "table" format, the */
+        /* names of the columns are looked up once and each row is then    */
+        /* decoded by position. Unknown columns are skipped.               */
+        class Table
+        {
+        public:
+            explicit Table(const nlohmann::json &header);
+
+        public:
+            /* Returns the id in row, -1 if it has none */
+            std::int32_t id(const nlohmann::json &row) const;
+
+            /* Writes the cells of row, in fields, that differ from torrent */
+            /* into it, strings keep the capacity they have. Returns the    */
+            /* fields that changed.                                         */
+            FieldSet refresh(const nlohmann::json &row,
+                             TorrentPrivate &torrent,
+                             FieldSet fields = FieldSet::all()) const;
+
+        private:
+            /* Torrent::Field::Count for the columns that are not known */
+            std::vector<Torrent::Field> fields_;
+            std::size_t idColumn_;
+        };
+
     public:
         TorrentPrivate();
         TorrentPrivate(TorrentPrivate &&other);
@@ -116,6 +143,45 @@ namespace gearbox
         TorrentPrivate(const TorrentPrivate &other);
         TorrentPrivate &operator=(const TorrentPrivate &other);
 
+    public:
+        /* The attributes are in the same order as gearbox::Torrent::Field */
+        static std::vector<const char *> attribute_names(FieldSet fields);
+
+        /* Decodes the torrents in the arguments of a torrent-get response, */
+        /* in whichever format the daemon answered with.                    */
+        static std::vector<TorrentPrivate> decode(
+            const nlohmann::json &arguments,
+            const std::weak_ptr<SessionPrivate> &session);
+
+        /* Returns the rows of a torrent-get response in the "table"      */
+        /* format, the first one being the header. Returns nullptr if the */
+        /* daemon answered with objects, the session then stops asking    */
+        /* for the table format.                                          */
+        static const nlohmann::json *tableRows(
+            const nlohmann::json &arguments,
+            const std::weak_ptr<SessionPrivate> &session);
+
+        /* Decodes the torrents of a torrent-get response in the "table" */
+        /* format, the first row holds the names of the columns.         */
+        static std::vector<TorrentPrivate> fromTable(
+            const nlohmann::json &rows);
+
+        /* Returns the fields in which other differs from this one */
+        FieldSet differences(const TorrentPrivate &other) const;
+
+        /* Takes over the attributes in fields from other, keeps the rest */
+        void update(TorrentPrivate &&other, FieldSet fields);
+
+        /* Takes over the attributes in fields that differ from other, */
+        /* returns those that changed.                                  */
+        FieldSet refresh(TorrentPrivate &&other, FieldSet fields);
+
+    private:
+        template <std::size_t... Index>
+        void assign(TorrentPrivate &&other,
+                    FieldSet fields,
+                    std::index_sequence<Index...>);
+
     public:
         std::weak_ptr<SessionPrivate> session_;
     };
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_POLLER_P_H
+#define LIBGEARBOX_TORRENT_POLLER_P_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "libgearbox_call_options.h"
+#include "libgearbox_torrent.h"
+#include "libgearbox_torrent_poller.h"
+#include "libgearbox_torrent_store.h"
+
+namespace gearbox
+{
+    /* Keeps a TorrentStore up to date from a thread of its own. Each      */
+    /* torrent is due again after the interval of its tier; the torrents  */
+    /* that are due are refreshed with a single torrent-get. A sync of the */
+    /* store, every so often, picks up the torrents that were added,      */
+    /* removed or woke up in the meantime.                                */
+    class TorrentPollerPrivate
+    {
+    public:
+        using clock_t = std::chrono::steady_clock;
+        using Tier = TorrentPoller::Tier;
+
+        /* A tier is never polled more often than this many round trips,  */
+        /* the daemon spends at most about a tenth of its time on a poller */
+        static constexpr std::int32_t LATENCY_MULTIPLE{ 10 };
+
+        /* Each failure in a row doubles the wait, up to this many times */
+        static constexpr std::int32_t MAX_FAILURE_BACKOFF{ 6 };
+
+    public:
+        explicit TorrentPollerPrivate(TorrentStore &store);
+
+    public:
+        static Tier tier(const Torrent &torrent);
+
+        /* The interval of tier, stretched to keep up with the latency */
+        clock_t::duration interval(Tier tier) const;
+
+        /* Spreads duration by up to jitter percent, either way */
+        clock_t::duration jittered(clock_t::duration duration);
+
+        /* Folds the round trip of a call into the average latency */
+        void observe(clock_t::duration roundTrip);
+
+        /* Syncs the store, or refreshes the torrents that are due, and */
+        /* returns when the next poll is due.                            */
+        clock_t::time_point poll(clock_t::time_point now,
+                                 const CallOptions &options);
+
+        void run();
+
+    public:
+        TorrentStore &store_;
+
+        std::array<std::atomic<std::int32_t>, 3> intervals_;
+        std::atomic<std::int32_t> jitter_;
+        /* In microseconds */
+        std::atomic<std::int64_t> latency_;
+
+        /* Only touched by the polling thread while it runs */
+        std::unordered_map<std::int32_t, clock_t::time_point> due_;
+        clock_t::time_point nextSync_;
+        std::int32_t failures_;
+        std::minstd_rand random_;
+        TorrentPoller::error_handler_t errorHandler_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        bool stopping_;
+        CancellationToken cancellation_;
+        std::thread thread_;
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_POLLER_P_H
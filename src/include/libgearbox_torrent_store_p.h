@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifndef LIBGEARBOX_TORRENT_STORE_P_H
+#define LIBGEARBOX_TORRENT_STORE_P_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <json.hpp>
+
+#include "libgearbox_call_options.h"
+#include "libgearbox_error.h"
+#include "libgearbox_session_p.h"
+#include "libgearbox_snapshot_cell_p.h"
+#include "libgearbox_torrent.h"
+#include "libgearbox_torrent_snapshot.h"
+#include "libgearbox_torrent_store.h"
+
+namespace gearbox
+{
+    class TorrentStorePrivate
+    {
+    public:
+        /* The daemon only reports torrents, and removals, as recently */
+        /* active for this long                                        */
+        static constexpr std::chrono::seconds RECENTLY_ACTIVE_WINDOW{ 60 };
+
+    public:
+        explicit TorrentStorePrivate(std::weak_ptr<SessionPrivate> session);
+
+    public:
+        /* Applies the arguments of a torrent-get response. Torrents that */
+        /* are already known are updated in place, a full response drops */
+        /* those it doesn't list, a recently-active one those that are    */
+        /* listed as removed, one for the requested ids those it left    */
+        /* out. Returns what changed, torrents that were sent but are the */
+        /* same as before are not touched.                                */
+        std::vector<TorrentStore::Change> apply(
+            const nlohmann::json &arguments,
+            bool full,
+            const std::vector<std::int32_t> &requested = {});
+
+        /* Sends a torrent-get for every torrent if full, else for the     */
+        /* requested ids or, without any, for the recently active ones;   */
+        /* applies the response and has the changes reported.             */
+        Error fetch(bool full,
+                    const std::vector<std::int32_t> &requested,
+                    const CallOptions &options);
+
+        /* Publishes a snapshot with the changes applied to the previous */
+        /* one, whose entries it shares for the torrents that didn't.   */
+        void publish(const std::vector<TorrentStore::Change> &changes);
+
+    public:
+        std::weak_ptr<SessionPrivate> session_;
+        std::unordered_map<std::int32_t, Torrent> torrents_;
+        std::chrono::steady_clock::time_point lastSync_;
+        bool synced_;
+        TorrentStore::change_handler_t changeHandler_;
+        SnapshotCell<TorrentSnapshot> snapshot_;
+    };
+}
+
+#endif // LIBGEARBOX_TORRENT_STORE_P_H
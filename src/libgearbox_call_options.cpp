@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::CancellationToken
+    \brief Lets a call be cancelled from any thread while it is in flight
+
+    Copies of a token share the same state, cancelling any one of them
+    cancels every call that was made with any of them. A token can't be
+    reset, once cancelled it stays that way.
+
+    Example:
+    ```
+    gearbox::CancellationToken token;
+    auto content = torrent.contentAsync(token);
+
+    // Later, from whichever thread, when the content is no longer needed
+    token.cancel();
+    ```
+*/
+
+/*!
+    \class gearbox::CallOptions
+    \brief Per-call settings, a deadline and a gearbox::CancellationToken
+
+    Every method of gearbox::Session and gearbox::Torrent that sends a request
+    takes an optional instance of this class. A default constructed one sets
+    neither, the call then runs until it completes or gearbox::Session::timeout
+    elapses.
+
+    A call that is cancelled, or still running at its deadline, stops at the
+    next opportunity; the transfer is aborted, and the parsing of the response
+    and the creation of the objects returned by the call are cut short. It
+    then returns gearbox::Error::Code::GearboxCallCancelled, respectively
+    gearbox::Error::Code::RequestOperationTimedOut, and no data.
+*/
+
+#include "libgearbox_call_options.h"
+
+using namespace gearbox;
+
+/*!
+    Constructs a gearbox::CancellationToken that is not cancelled
+*/
+CancellationToken::CancellationToken()
+  : cancelled_(std::make_shared<std::atomic<bool>>(false))
+{
+}
+
+/*!
+    Cancels every call made with this token, or a copy of it.
+
+    This method is thread-safe.
+*/
+void CancellationToken::cancel() { cancelled_->store(true); }
+
+/*!
+    Returns whether the token has been cancelled.
+
+    This method is thread-safe.
+*/
+bool CancellationToken::cancelled() const { return cancelled_->load(); }
+
+/*!
+    Constructs a gearbox::CallOptions with neither a deadline nor a
+    gearbox::CancellationToken
+*/
+CallOptions::CallOptions() : deadline_(), hasDeadline_(false), cancelled_() {}
+
+/*!
+    Constructs a gearbox::CallOptions that lets the call be cancelled through
+    token, without a deadline
+*/
+CallOptions::CallOptions(const CancellationToken &token)
+  : deadline_(), hasDeadline_(false), cancelled_(token.cancelled_)
+{
+}
+
+/*!
+    Sets the deadline to the given number of milliseconds from now.
+
+    The deadline covers the whole of the call, every request it sends and the
+    processing of the response, and replaces gearbox::Session::timeout for it.
+*/
+CallOptions &CallOptions::setTimeout(std::int32_t milliseconds)
+{
+    return setDeadline(clock_t::now() +
+                       std::chrono::milliseconds(milliseconds));
+}
+
+/*!
+    Sets the point in time by which the call has to be complete.
+
+    The deadline covers the whole of the call, every request it sends and the
+    processing of the response, and replaces gearbox::Session::timeout for it.
+*/
+CallOptions &CallOptions::setDeadline(clock_t::time_point deadline)
+{
+    deadline_ = deadline;
+    hasDeadline_ = true;
+
+    return *this;
+}
+
+/*!
+    Lets the call be cancelled through token.
+*/
+CallOptions &CallOptions::setCancellationToken(const CancellationToken &token)
+{
+    cancelled_ = token.cancelled_;
+
+    return *this;
+}
+
+/*!
+    Returns whether a deadline was set.
+*/
+bool CallOptions::hasDeadline() const { return hasDeadline_; }
+
+/*!
+    Returns the deadline, only meaningful if gearbox::CallOptions::hasDeadline
+    returns true.
+*/
+CallOptions::clock_t::time_point CallOptions::deadline() const
+{
+    return deadline_;
+}
+
+/*!
+    Returns whether the deadline has passed, always false without a deadline.
+*/
+bool CallOptions::expired() const
+{
+    return hasDeadline_ && (clock_t::now() >= deadline_);
+}
+
+/*!
+    Returns whether a gearbox::CancellationToken was set.
+*/
+bool CallOptions::hasCancellationToken() const
+{
+    return static_cast<bool>(cancelled_);
+}
+
+/*!
+    Returns whether the gearbox::CancellationToken was cancelled, always false
+    without one.
+
+    This method is thread-safe.
+*/
+bool CallOptions::cancelled() const { return cancelled_ && cancelled_->load(); }
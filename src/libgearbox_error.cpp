@@ -263,8 +263,8 @@
     \var gearbox::Error::GearboxTorrentInvalid
     \brief The instance of gearbox::Torrent is invalid
 
-    \var gearbox::Error::GearboxReserved_1
-    \brief Reserved for future use
+    \var gearbox::Error::GearboxCallCancelled
+    \brief The call was cancelled through the gearbox::CancellationToken it was made with
 
     \var gearbox::Error::GearboxReserved_2
     \brief Reserved for future use
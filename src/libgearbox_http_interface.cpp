@@ -25,7 +25,9 @@
 #include "libgearbox_http_interface_p.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <cstring>
 
 using namespace gearbox::http;
 
@@ -239,3 +241,201 @@ gearbox::http::Status::Status(std::int32_t code)
             break;
     }
 }
+
+namespace
+{
+    /* Header names are plain ASCII, no need to go through the locale */
+    inline char toLowerAscii(char c)
+    {
+        return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    bool equalsIgnoreCase(const char *s1,
+                          std::size_t size1,
+                          const char *s2,
+                          std::size_t size2)
+    {
+        return (size1 == size2) &&
+               std::equal(s1, s1 + size1, s2, [](char c1, char c2) {
+                   return toLowerAscii(c1) == toLowerAscii(c2);
+               });
+    }
+
+    bool isBlank(char c) { return (c == ' ') || (c == '\t'); }
+
+    /* Tells if nothing else refers to what pointer does. Another thread */
+    /* could have let go of it last, it is then safe to change only once */
+    /* the changes that thread made are visible.                         */
+    template <typename T> bool isUnique(const std::shared_ptr<T> &pointer)
+    {
+        if (pointer.use_count() != 1) return false;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+}
+
+ResponseHeaders::ResponseHeaders() : storage_(), filter_() {}
+
+ResponseHeaders::ResponseHeaders(const header_array_t &headers)
+  : storage_(), filter_()
+{
+    for (const auto &header : headers)
+    {
+        insert(header.first.data(), header.first.size(), header.second.data(),
+               header.second.size());
+    }
+}
+
+void ResponseHeaders::setFilter(
+    std::shared_ptr<const std::vector<std::string>> names)
+{
+    filter_ = std::move(names);
+}
+
+void ResponseHeaders::parseLine(const char *line, std::size_t size)
+{
+    /* Headers of a previous response, e.g. a redirect, are of no interest */
+    if ((size >= 5) && std::equal(line, line + 5, "HTTP/"))
+    {
+        clear();
+        return;
+    }
+
+    const auto end = line + size;
+    const auto separator = std::find(line, end, ':');
+    if (separator == end) return;
+
+    const auto nameSize = static_cast<std::size_t>(separator - line);
+    if (!wanted(line, nameSize)) return;
+
+    auto valueBegin = separator + 1;
+    auto valueEnd = end;
+    while ((valueBegin < valueEnd) && isBlank(*valueBegin)) ++valueBegin;
+    while ((valueEnd > valueBegin) &&
+           (isBlank(valueEnd[-1]) || (valueEnd[-1] == '\r') ||
+            (valueEnd[-1] == '\n')))
+    {
+        --valueEnd;
+    }
+
+    insert(line, nameSize, valueBegin,
+           static_cast<std::size_t>(valueEnd - valueBegin));
+}
+
+void ResponseHeaders::insert(const char *name,
+                             std::size_t nameSize,
+                             const char *value,
+                             std::size_t valueSize)
+{
+    auto &storage = writable();
+    auto &bytes = storage.bytes;
+
+    const Entry entry{ bytes.size(), nameSize, bytes.size() + nameSize,
+                       valueSize };
+    bytes.append(name, nameSize);
+    bytes.append(value, valueSize);
+
+    /* Same as the map did, a repeated header replaces the previous one */
+    for (auto &existing : storage.entries)
+    {
+        if (equalsIgnoreCase(bytes.data() + existing.nameOffset,
+                             existing.nameSize, name, nameSize))
+        {
+            existing = entry;
+            return;
+        }
+    }
+
+    storage.entries.push_back(entry);
+}
+
+void ResponseHeaders::clear()
+{
+    /* The copies that still refer to the storage keep it to themselves */
+    if (isUnique(storage_))
+    {
+        storage_->bytes.clear();
+        storage_->entries.clear();
+    }
+    else
+    {
+        storage_.reset();
+    }
+}
+
+std::size_t ResponseHeaders::count(const std::string &name) const
+{
+    return (find(name.data(), name.size()).data != nullptr) ? 1 : 0;
+}
+
+HeaderValue ResponseHeaders::operator[](const char *name) const
+{
+    return find(name, std::strlen(name));
+}
+
+HeaderValue ResponseHeaders::operator[](const std::string &name) const
+{
+    return find(name.data(), name.size());
+}
+
+header_array_t ResponseHeaders::toMap() const
+{
+    header_array_t headers;
+    if (!storage_) return headers;
+
+    const auto &bytes = storage_->bytes;
+    for (const auto &entry : storage_->entries)
+    {
+        headers[bytes.substr(entry.nameOffset, entry.nameSize)] =
+            bytes.substr(entry.valueOffset, entry.valueSize);
+    }
+
+    return headers;
+}
+
+bool ResponseHeaders::wanted(const char *name, std::size_t size) const
+{
+    if (!filter_) return true;
+
+    for (const auto &wantedName : *filter_)
+    {
+        if (equalsIgnoreCase(name, size, wantedName.data(), wantedName.size()))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+HeaderValue ResponseHeaders::find(const char *name, std::size_t size) const
+{
+    if (!storage_) return { nullptr, 0 };
+
+    const auto bytes = storage_->bytes.data();
+    for (const auto &entry : storage_->entries)
+    {
+        if (equalsIgnoreCase(bytes + entry.nameOffset, entry.nameSize, name,
+                             size))
+        {
+            return { bytes + entry.valueOffset, entry.valueSize };
+        }
+    }
+
+    return { nullptr, 0 };
+}
+
+ResponseHeaders::Storage &ResponseHeaders::writable()
+{
+    if (!storage_)
+    {
+        storage_ = std::make_shared<Storage>();
+    }
+    else if (!isUnique(storage_))
+    {
+        storage_ = std::make_shared<Storage>(*storage_);
+    }
+
+    return *storage_;
+}
@@ -38,6 +38,16 @@ namespace
 {
     using namespace gearbox::http;
 
+    constexpr std::size_t DEFAULT_MAX_IDLE_CONNECTIONS{ 4 };
+    constexpr std::int64_t DEFAULT_IDLE_CONNECTION_TIMEOUT{ 30000 };
+    constexpr const char ACCEPTED_ENCODINGS[]{ "gzip, deflate" };
+
+    /* Saves a round trip on larger bodies, the server is not going to turn */
+    /* a request down before seeing its body anyway. Shared by the requests */
+    /* that set no headers of their own, cURL never writes to the list.     */
+    char NO_EXPECT[]{ "Expect:" };
+    curl_slist NO_EXPECT_LIST{ NO_EXPECT, nullptr };
+
     struct CUrlInitializer
     {
         CUrlInitializer() { curl_global_init(CURL_GLOBAL_ALL); }
@@ -145,38 +155,226 @@ namespace
         return size * nmemb;
     }
 
-    /* Appends a key-value pair, represented by ptr, of length size * nmemb, to the data map. */
-    /* This function is called by CUrl for each line in the header of a response.             */
+    /* Hands a line, represented by ptr, of length size * nmemb, to the header store.  */
+    /* This function is called by CUrl for each line in the header of a response.      */
     std::size_t headerCallback(void *ptr,
                                std::size_t size,
                                std::size_t nmemb,
-                               header_array_t *data)
+                               ResponseHeaders *data)
+    {
+        data->parseLine(static_cast<const char *>(ptr), size * nmemb);
+        return size * nmemb;
+    }
+
+    void cleanupHandles(const std::vector<CURL *> &handles)
     {
-        std::string header(static_cast<char *>(ptr), size * nmemb);
-        auto found = header.find("HTTP/");
-        if (found == std::string::npos)
+        for (auto handle : handles)
         {
-            auto separatorPos = header.find_first_of(':');
-            if (separatorPos != std::string::npos)
-            {
-                auto value = header.substr(separatorPos + 2);
-                (*data)[header.substr(0, separatorPos)] =
-                    value.substr(0, value.size() - 2);
-                /* Ignore CL/RF at the end of the header line             ^^^^^^^^^^^^^^^^ */
-            }
+            curl_easy_cleanup(handle);
         }
-        else
+    }
+
+    /* One recursive mutex guards the whole share; cURL may lock the share */
+    /* itself while it already holds the lock of the connection cache.    */
+    void lockShare(CURL *, curl_lock_data, curl_lock_access, void *mutex)
+    {
+        static_cast<std::recursive_mutex *>(mutex)->lock();
+    }
+
+    void unlockShare(CURL *, curl_lock_data, void *mutex)
+    {
+        static_cast<std::recursive_mutex *>(mutex)->unlock();
+    }
+
+    /* Only called when a host name is not found in the DNS cache */
+    int countLookup(void *, void *, void *lookups)
+    {
+        ++*static_cast<std::atomic<std::uint64_t> *>(lookups);
+        return 0;
+    }
+
+    void setMaxConnectionAge(CURL *handle, milliseconds_t idleTimeout)
+    {
+#if LIBCURL_VERSION_NUM >= 0x074100
+        /* Keep cURL's own connection cache in line with the pool, so that */
+        /* a connection is not dropped while its handle is still pooled.   */
+        const auto seconds =
+            std::chrono::duration_cast<std::chrono::seconds>(idleTimeout +
+                                                             999ms);
+        curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN,
+                         static_cast<long>(seconds.count()));
+#else
+        static_cast<void>(handle);
+        static_cast<void>(idleTimeout);
+#endif
+    }
+
+    std::uint64_t receivedBodySize(CURL *handle)
+    {
+#if LIBCURL_VERSION_NUM >= 0x073700
+        curl_off_t size = 0;
+        curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &size);
+#else
+        double size = 0;
+        curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD, &size);
+#endif
+        return size > 0 ? static_cast<std::uint64_t>(size) : 0;
+    }
+
+    void applyHttpVersion(CURL *handle,
+                          http::Version version,
+                          const std::string &hostname)
+    {
+#if LIBCURL_VERSION_NUM >= 0x073100
+        long httpVersion = CURL_HTTP_VERSION_1_1;
+        long pipeWait = 0L;
+        if (version == http::Version::Http2)
         {
-            data->clear();
+            /* Over TLS HTTP/2 is negotiated and falls back to HTTP/1.1 if  */
+            /* the server doesn't support it; there is nothing to negotiate */
+            /* with over plain HTTP so the server has to speak HTTP/2.      */
+            const bool secure = hostname.compare(0, 8, "https://") == 0;
+            httpVersion = secure ? CURL_HTTP_VERSION_2TLS :
+                                   CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE;
+
+            /* Wait for a connection that is still being set up, rather than */
+            /* opening another one, so that the requests can be multiplexed. */
+            pipeWait = 1L;
         }
-        return size * nmemb;
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, httpVersion);
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, pipeWait);
+#else
+        static_cast<void>(handle);
+        static_cast<void>(version);
+        static_cast<void>(hostname);
+#endif
+    }
+}
+
+CUrlHttp::ConnectionPool::ConnectionPool()
+  : mutex(), idle(), maxIdle(DEFAULT_MAX_IDLE_CONNECTIONS),
+    idleTimeout(DEFAULT_IDLE_CONNECTION_TIMEOUT), reusedConnections(0),
+    newConnections(0), receivedBytes(0), decodedBytes(0), dnsLookups(0),
+    share(curl_share_init()), shareMutex()
+{
+    if (share != nullptr)
+    {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, &lockShare);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, &unlockShare);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, &shareMutex);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+}
+
+CUrlHttp::ConnectionPool::~ConnectionPool()
+{
+    clear();
+
+    /* Only possible once no handle refers to it anymore */
+    if (share != nullptr) curl_share_cleanup(share);
+}
+
+CURL *CUrlHttp::ConnectionPool::acquire(
+    std::string &body,
+    http_response_headers_t &responseHeaders)
+{
+    CURL *handle = nullptr;
+    std::vector<CURL *> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stale = takeStale(clock_t::now());
+        if (!idle.empty())
+        {
+            /* The most recently released handle is the most likely to */
+            /* still have a live connection.                            */
+            handle = idle.back().handle;
+            body = std::move(idle.back().body);
+            responseHeaders = std::move(idle.back().responseHeaders);
+            idle.pop_back();
+        }
+    }
+
+    cleanupHandles(stale);
+    return handle;
+}
+
+void CUrlHttp::ConnectionPool::release(
+    CURL *handle,
+    std::string &&body,
+    http_response_headers_t &&responseHeaders)
+{
+    const auto now = clock_t::now();
+    std::vector<CURL *> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stale = takeStale(now);
+        if (idle.size() < maxIdle)
+        {
+            /* Keeps the capacity, and with it the allocation, around */
+            body.clear();
+            idle.push_back(
+                { handle, now, std::move(body), std::move(responseHeaders) });
+            handle = nullptr;
+        }
+    }
+
+    if (handle != nullptr)
+    {
+        stale.push_back(handle);
     }
+    cleanupHandles(stale);
+}
+
+void CUrlHttp::ConnectionPool::clear()
+{
+    std::vector<CURL *> handles;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        handles.reserve(idle.size());
+        for (const auto &idleHandle : idle)
+        {
+            handles.push_back(idleHandle.handle);
+        }
+        idle.clear();
+    }
+
+    cleanupHandles(handles);
+}
+
+std::vector<CURL *> CUrlHttp::ConnectionPool::takeStale(
+    clock_t::time_point now)
+{
+    /* Handles are released in chronological order so the oldest ones are */
+    /* always at the front.                                                */
+    std::size_t count = 0;
+    while ((count < idle.size()) &&
+           ((idle.size() - count > maxIdle) ||
+            (now - idle[count].releaseTime >= idleTimeout)))
+    {
+        ++count;
+    }
+
+    std::vector<CURL *> stale;
+    stale.reserve(count);
+    for (std::size_t it = 0; it < count; ++it)
+    {
+        stale.push_back(idle[it].handle);
+    }
+    idle.erase(idle.begin(), idle.begin() + count);
+
+    return stale;
 }
 
 CUrlHttp::CUrlHttp(const std::string &userAgent)
   : hostname_(), port_(-1), path_("/"), authenticationEnabled_(false),
-    authentication_(), sslErrorHandlingEnabled_(true), timeout_(),
-    handle_(nullptr)
+    authentication_(), url_(), credentials_(), sslErrorHandlingEnabled_(true),
+    compressionEnabled_(true), httpVersion_(http_version_t::Http1_1),
+    unixSocketPath_(), capturedHeaders_(), timeout_(),
+    handle_(nullptr), pool_(std::make_shared<ConnectionPool>())
 {
     handle_ = curl_easy_init();
     if (handle_ != nullptr)
@@ -189,6 +387,9 @@ CUrlHttp::CUrlHttp(const std::string &userAgent)
         curl_easy_setopt(handle_, CURLOPT_TCP_KEEPALIVE, 1L);
         curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, &writeCallback);
         curl_easy_setopt(handle_, CURLOPT_HEADERFUNCTION, &headerCallback);
+        setMaxConnectionAge(handle_, pool_->idleTimeout);
+        updateUrl();
+        updateCredentials();
     }
     else
     {
@@ -210,22 +411,39 @@ CUrlHttp::~CUrlHttp()
 
 const std::string &CUrlHttp::host() const { return hostname_; }
 
-void CUrlHttp::setHost(const std::string &hostname) { hostname_ = hostname; }
+void CUrlHttp::setHost(const std::string &hostname)
+{
+    hostname_ = hostname;
+    updateUrl();
+}
 
 void CUrlHttp::setHost(std::string &&hostname)
 {
     hostname_ = std::move(hostname);
+    updateUrl();
 }
 
 CUrlHttp::http_port_t CUrlHttp::port() const { return port_; }
 
-void CUrlHttp::setPort(http_port_t port) { port_ = port; }
+void CUrlHttp::setPort(http_port_t port)
+{
+    port_ = port;
+    updateUrl();
+}
 
 const std::string &CUrlHttp::path() const { return path_; }
 
-void CUrlHttp::setPath(const std::string &path) { path_ = path; }
+void CUrlHttp::setPath(const std::string &path)
+{
+    path_ = path;
+    updateUrl();
+}
 
-void CUrlHttp::setPath(std::string &&path) { path_ = std::move(path); }
+void CUrlHttp::setPath(std::string &&path)
+{
+    path_ = std::move(path);
+    updateUrl();
+}
 
 bool CUrlHttp::authenticationRequired() const { return authenticationEnabled_; }
 
@@ -242,12 +460,14 @@ void CUrlHttp::setUsername(const std::string &username)
 {
     authenticationEnabled_ = true;
     authentication_.username = username;
+    updateCredentials();
 }
 
 void CUrlHttp::setUsername(std::string &&username)
 {
     authenticationEnabled_ = true;
     authentication_.username = std::move(username);
+    updateCredentials();
 }
 
 const std::string &CUrlHttp::password() const
@@ -259,12 +479,14 @@ void CUrlHttp::setPassword(const std::string &password)
 {
     authenticationEnabled_ = true;
     authentication_.password = password;
+    updateCredentials();
 }
 
 void CUrlHttp::setPassword(std::string &&password)
 {
     authenticationEnabled_ = true;
     authentication_.password = std::move(password);
+    updateCredentials();
 }
 
 void CUrlHttp::setSSLErrorHandling(http_ssl_error_handling_t value)
@@ -282,6 +504,56 @@ void CUrlHttp::setSSLErrorHandling(http_ssl_error_handling_t value)
     }
 }
 
+bool CUrlHttp::compressionEnabled() const { return compressionEnabled_; }
+
+void CUrlHttp::enableCompression() { compressionEnabled_ = true; }
+
+void CUrlHttp::disableCompression() { compressionEnabled_ = false; }
+
+CUrlHttp::http_version_t CUrlHttp::httpVersion() const
+{
+    return httpVersion_;
+}
+
+void CUrlHttp::setHttpVersion(http_version_t value) { httpVersion_ = value; }
+
+const std::string &CUrlHttp::unixSocketPath() const
+{
+    return unixSocketPath_;
+}
+
+void CUrlHttp::setUnixSocketPath(const std::string &path)
+{
+#if LIBCURL_VERSION_NUM < 0x072800
+    if (!path.empty())
+    {
+        LOG_WARN("cURL {} does not support Unix domain sockets, requests "
+                 "keep going to the host",
+                 LIBCURL_VERSION);
+    }
+#endif
+    unixSocketPath_ = path;
+}
+
+const std::vector<std::string> &CUrlHttp::capturedHeaders() const
+{
+    static const std::vector<std::string> all;
+    return capturedHeaders_ ? *capturedHeaders_ : all;
+}
+
+void CUrlHttp::setCapturedHeaders(std::vector<std::string> names)
+{
+    if (names.empty())
+    {
+        capturedHeaders_.reset();
+    }
+    else
+    {
+        capturedHeaders_ =
+            std::make_shared<const std::vector<std::string>>(std::move(names));
+    }
+}
+
 const milliseconds_t &CUrlHttp::timeout() const { return timeout_; }
 
 void CUrlHttp::setTimeout(milliseconds_t value)
@@ -290,24 +562,149 @@ void CUrlHttp::setTimeout(milliseconds_t value)
     curl_easy_setopt(handle_, CURLOPT_TIMEOUT_MS, timeout_.count());
 }
 
-CUrlHttp::Request::Request(CURL *handle) : handle_(handle), headers_() {}
+std::size_t CUrlHttp::maxIdleConnections() const
+{
+    const auto pool = this->pool();
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return pool->maxIdle;
+}
 
-CUrlHttp::Request::Request(Request &&) noexcept(true) = default;
-CUrlHttp::Request &CUrlHttp::Request::operator=(Request &&) noexcept(true) =
-    default;
+void CUrlHttp::setMaxIdleConnections(std::size_t value)
+{
+    const auto pool = this->pool();
+    std::vector<CURL *> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->maxIdle = value;
+        stale = pool->takeStale(ConnectionPool::clock_t::now());
+    }
+
+    cleanupHandles(stale);
+}
+
+milliseconds_t CUrlHttp::idleConnectionTimeout() const
+{
+    const auto pool = this->pool();
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return pool->idleTimeout;
+}
+
+void CUrlHttp::setIdleConnectionTimeout(milliseconds_t value)
+{
+    const auto pool = this->pool();
+    std::vector<CURL *> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->idleTimeout = value;
+        stale = pool->takeStale(ConnectionPool::clock_t::now());
+    }
+
+    cleanupHandles(stale);
+    setMaxConnectionAge(handle_, value);
+}
+
+CUrlHttp::http_connection_statistics_t CUrlHttp::connectionStatistics() const
+{
+    const auto pool = this->pool();
+    return { pool->reusedConnections.load(), pool->newConnections.load(),
+             pool->receivedBytes.load(), pool->decodedBytes.load(),
+             pool->dnsLookups.load() };
+}
+
+void CUrlHttp::shareConnectionPool(const CUrlHttp &other)
+{
+    /* Requests in flight keep the previous pool alive until they are done */
+    std::atomic_store(&pool_, other.pool());
+}
+
+std::shared_ptr<CUrlHttp::ConnectionPool> CUrlHttp::pool() const
+{
+    return std::atomic_load(&pool_);
+}
+
+CUrlHttp::Request::Request(
+    CURL *handle,
+    std::shared_ptr<ConnectionPool> pool,
+    std::string &&body,
+    std::shared_ptr<const std::vector<std::string>> capturedHeaders,
+    http_response_headers_t &&responseHeaders)
+  : handle_(handle), headers_(), headerList_(nullptr),
+    body_(std::move(body)), hasBody_(false),
+    bodyHandler_(), pauseHandler_(), abortHandler_(),
+    capturedHeaders_(std::move(capturedHeaders)),
+    responseHeaders_(std::move(responseHeaders)), pool_(std::move(pool))
+{
+}
+
+CUrlHttp::Request::Request(Request &&other) noexcept(true)
+  : handle_(other.handle_), headers_(std::move(other.headers_)),
+    headerList_(other.headerList_), body_(std::move(other.body_)), hasBody_(other.hasBody_),
+    bodyHandler_(std::move(other.bodyHandler_)),
+    pauseHandler_(std::move(other.pauseHandler_)),
+    abortHandler_(std::move(other.abortHandler_)),
+    capturedHeaders_(std::move(other.capturedHeaders_)),
+    responseHeaders_(std::move(other.responseHeaders_)),
+    pool_(std::move(other.pool_))
+{
+    other.handle_ = nullptr;
+    other.headerList_ = nullptr;
+}
+
+CUrlHttp::Request &CUrlHttp::Request::operator=(Request &&other) noexcept(true)
+{
+    std::swap(handle_, other.handle_);
+    std::swap(headers_, other.headers_);
+    std::swap(headerList_, other.headerList_);
+    std::swap(body_, other.body_);
+    std::swap(hasBody_, other.hasBody_);
+    std::swap(bodyHandler_, other.bodyHandler_);
+    std::swap(pauseHandler_, other.pauseHandler_);
+    std::swap(abortHandler_, other.abortHandler_);
+    std::swap(capturedHeaders_, other.capturedHeaders_);
+    std::swap(responseHeaders_, other.responseHeaders_);
+    std::swap(pool_, other.pool_);
+
+    return *this;
+}
 
 CUrlHttp::Request::~Request()
 {
+    curl_slist_free_all(headerList_);
     if (handle_ != nullptr)
     {
-        curl_easy_cleanup(handle_);
+        if (pool_)
+        {
+            pool_->release(handle_, std::move(body_),
+                           std::move(responseHeaders_));
+        }
+        else
+        {
+            curl_easy_cleanup(handle_);
+        }
     }
 }
 
 void gearbox::CUrlHttp::Request::setBody(const std::string &data)
 {
-    curl_easy_setopt(handle_, CURLOPT_POSTFIELDSIZE, data.size());
-    curl_easy_setopt(handle_, CURLOPT_COPYPOSTFIELDS, data.c_str());
+    body_.assign(data);
+    hasBody_ = true;
+}
+
+void gearbox::CUrlHttp::Request::setBody(std::string &&data)
+{
+    body_.swap(data);
+    data.clear();
+    hasBody_ = true;
+}
+
+std::string &gearbox::CUrlHttp::Request::bodyBuffer()
+{
+    body_.clear();
+    hasBody_ = true;
+
+    return body_;
 }
 
 void gearbox::CUrlHttp::Request::setHeaders(
@@ -317,80 +714,295 @@ void gearbox::CUrlHttp::Request::setHeaders(
     {
         headers_[header.first] = header.second;
     }
+    updateHeaderList();
 }
 
 void gearbox::CUrlHttp::Request::setHeader(
     const CUrlHttp::http_header_t &header)
 {
     headers_[header.first] = header.second;
+    updateHeaderList();
+}
+
+void gearbox::CUrlHttp::Request::updateHeaderList()
+{
+    curl_slist_free_all(headerList_);
+    headerList_ = nullptr;
+
+    std::string line;
+    for (const auto &header : headers_)
+    {
+        line.assign(header.first).append(": ").append(header.second);
+        headerList_ = curl_slist_append(headerList_, line.c_str());
+    }
+    /* Blanks the header cURL only ever adds itself along with a body */
+    if (headers_.find("Expect") == headers_.end())
+    {
+        headerList_ = curl_slist_append(headerList_, NO_EXPECT);
+    }
+}
+
+void gearbox::CUrlHttp::Request::setBodyHandler(
+    CUrlHttp::http_body_handler_t handler)
+{
+    bodyHandler_ = std::move(handler);
+}
+
+void gearbox::CUrlHttp::Request::setPauseHandler(
+    CUrlHttp::http_pause_handler_t handler)
+{
+    pauseHandler_ = std::move(handler);
+}
+
+void gearbox::CUrlHttp::Request::setTimeout(CUrlHttp::milliseconds_t value)
+{
+    if (handle_ != nullptr)
+    {
+        curl_easy_setopt(handle_, CURLOPT_TIMEOUT_MS,
+                         static_cast<long>(value.count()));
+    }
+}
+
+void gearbox::CUrlHttp::Request::setAbortHandler(
+    CUrlHttp::http_abort_handler_t handler)
+{
+    abortHandler_ = std::move(handler);
+}
+
+std::size_t CUrlHttp::Request::streamCallback(void *ptr,
+                                              std::size_t size,
+                                              std::size_t nmemb,
+                                              Transfer *transfer)
+{
+    /* The status line, and with it the response code, is in by the time */
+    /* the first chunk of the body arrives.                              */
+    if (transfer->body == Transfer::Body::Undecided)
+    {
+        long status = 0;
+        curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &status);
+        transfer->body = (status == http::Status::OK) ? Transfer::Body::Streamed :
+                                                        Transfer::Body::Text;
+    }
+
+    if (transfer->body == Transfer::Body::Text)
+    {
+        return writeCallback(ptr, size, nmemb, &transfer->text);
+    }
+
+    /* cURL hands the same chunk over again once the transfer is resumed */
+    if ((transfer->pauseHandler != nullptr) && transfer->resume &&
+        (*transfer->pauseHandler)(transfer->resume))
+    {
+        return CURL_WRITEFUNC_PAUSE;
+    }
+
+    (*transfer->bodyHandler)(static_cast<char *>(ptr), size * nmemb);
+    transfer->streamedBytes += size * nmemb;
+    return size * nmemb;
+}
+
+int CUrlHttp::Request::progressCallback(Transfer *transfer,
+                                        curl_off_t,
+                                        curl_off_t,
+                                        curl_off_t,
+                                        curl_off_t)
+{
+    /* Anything but 0 makes cURL fail with CURLE_ABORTED_BY_CALLBACK */
+    return (*transfer->abortHandler)() ? 1 : 0;
 }
 
 CUrlHttp::http_request_result_t CUrlHttp::Request::send()
+{
+    Transfer transfer;
+    auto errCode = CURLE_FAILED_INIT;
+
+    if (handle_ != nullptr)
+    {
+        prepare(transfer);
+        errCode = curl_easy_perform(handle_);
+    }
+
+    return finish(transfer, errCode);
+}
+
+void CUrlHttp::Request::prepare(Transfer &transfer)
+{
+    curl_slist *headers = headerList_;
+    if (hasBody_)
+    {
+        if (headers == nullptr)
+        {
+            headers = &NO_EXPECT_LIST;
+        }
+        curl_easy_setopt(handle_, CURLOPT_POSTFIELDSIZE_LARGE,
+                         static_cast<curl_off_t>(body_.size()));
+        curl_easy_setopt(handle_, CURLOPT_POSTFIELDS, body_.data());
+    }
+    curl_easy_setopt(handle_, CURLOPT_HTTPHEADER, headers);
+    if (bodyHandler_)
+    {
+        transfer.handle = handle_;
+        transfer.bodyHandler = &bodyHandler_;
+        if (pauseHandler_) transfer.pauseHandler = &pauseHandler_;
+        curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, &streamCallback);
+        curl_easy_setopt(handle_, CURLOPT_WRITEDATA, &transfer);
+    }
+    else
+    {
+        curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, &writeCallback);
+        curl_easy_setopt(handle_, CURLOPT_WRITEDATA, &transfer.text);
+    }
+    if (abortHandler_)
+    {
+        transfer.abortHandler = &abortHandler_;
+        curl_easy_setopt(handle_, CURLOPT_XFERINFOFUNCTION, &progressCallback);
+        curl_easy_setopt(handle_, CURLOPT_XFERINFODATA, &transfer);
+        curl_easy_setopt(handle_, CURLOPT_NOPROGRESS, 0L);
+    }
+    else
+    {
+        /* A pooled handle may still have the callback of a previous request */
+        curl_easy_setopt(handle_, CURLOPT_NOPROGRESS, 1L);
+    }
+    /* Reuses the buffer of the previous response on the handle, unless */
+    /* its result still holds on to it.                                 */
+    transfer.responseHeaders = std::move(responseHeaders_);
+    transfer.responseHeaders.clear();
+    transfer.responseHeaders.setFilter(capturedHeaders_);
+    curl_easy_setopt(handle_, CURLOPT_HEADERDATA, &transfer.responseHeaders);
+}
+
+CUrlHttp::http_request_result_t CUrlHttp::Request::finish(Transfer &transfer,
+                                                          CURLcode code)
 {
     using namespace gearbox::http;
     std::int32_t httpStatus = gearbox::http::Status::Unknown;
-    http_header_array_t responseHeaders;
-    std::string text;
     http_error_t err = { Error::Code::InternalError,
                          "An internal connection handle is invalid. "
                          "This is most likely due to operating an a moved or "
                          "otherwise invalidated "
                          "instance of this object" };
     double elapsed = 0;
+    std::uint64_t receivedBytes = 0;
+    std::uint64_t decodedBytes = 0;
 
     if (handle_ != nullptr)
     {
-        curl_slist *headers = nullptr;
-        ;
-        std::vector<std::string> formatedHeaders;
-
-        for (const auto &header : headers_)
-        {
-            formatedHeaders.emplace_back(
-                fmt::format("{}: {}", header.first, header.second));
-            headers =
-                curl_slist_append(headers, formatedHeaders.back().c_str());
-        }
-        curl_easy_setopt(handle_, CURLOPT_HTTPHEADER, headers);
-        curl_easy_setopt(handle_, CURLOPT_WRITEDATA, &text);
-        curl_easy_setopt(handle_, CURLOPT_HEADERDATA, &responseHeaders);
-
-        auto errCode = curl_easy_perform(handle_);
-        err = fromCUrlError(errCode);
+        err = fromCUrlError(code);
 
         curl_easy_getinfo(handle_, CURLINFO_RESPONSE_CODE, &httpStatus);
         curl_easy_getinfo(handle_, CURLINFO_TOTAL_TIME, &elapsed);
 
-        if (text.back() == '\n')
+        /* cURL decodes the body as it arrives, before it reaches the write */
+        /* callback, while its download counter sees the body as received.  */
+        receivedBytes = receivedBodySize(handle_);
+        decodedBytes = transfer.text.size() + transfer.streamedBytes;
+
+        if ((code == CURLE_OK) && pool_)
+        {
+            long connects = 0;
+            curl_easy_getinfo(handle_, CURLINFO_NUM_CONNECTS, &connects);
+            if (connects > 0)
+            {
+                pool_->newConnections += static_cast<std::uint64_t>(connects);
+            }
+            else
+            {
+                ++pool_->reusedConnections;
+            }
+
+            pool_->receivedBytes += receivedBytes;
+            pool_->decodedBytes += decodedBytes;
+        }
+
+        if (!transfer.text.empty() && (transfer.text.back() == '\n'))
         {
-            text = text.substr(0, text.size() - 1);
+            transfer.text.pop_back();
         }
 
-        curl_slist_free_all(headers);
+        /* The header list is only read while the transfer runs */
+        curl_easy_setopt(handle_, CURLOPT_HTTPHEADER,
+                         static_cast<curl_slist *>(nullptr));
     }
 
-    return {
-        http_status_t(httpStatus), { responseHeaders, text }, elapsed, err
-    };
+    /* The result shares the buffer the headers were read into, the handle */
+    /* gets to reuse it once the result is gone.                           */
+    responseHeaders_ = transfer.responseHeaders;
+
+    return { http_status_t(httpStatus),
+             { std::move(transfer.responseHeaders), std::move(transfer.text) },
+             elapsed,
+             err,
+             { receivedBytes, decodedBytes } };
 }
 
 CUrlHttp::Request CUrlHttp::createRequest()
 {
-    auto curl = curl_easy_duphandle(handle_);
+    const auto pool = this->pool();
 
-    std::string url = fmt::format(
-        "{}{}{}", hostname_, port_ > 0 ? fmt::format(":{}", port_) : "", path_);
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    std::string body;
+    http_response_headers_t responseHeaders;
+    auto curl = pool->acquire(body, responseHeaders);
+    if (curl != nullptr)
+    {
+        /* A pooled handle still carries the options of its previous request, */
+        /* reset the request method and re-apply the settings that could have */
+        /* changed since the handle was released.                              */
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
+        curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 0L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_.count());
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER,
+                         sslErrorHandlingEnabled_ ? 1L : 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST,
+                         sslErrorHandlingEnabled_ ? 1L : 0L);
+        setMaxConnectionAge(curl, idleConnectionTimeout());
+    }
+    else
+    {
+        curl = curl_easy_duphandle(handle_);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
+    applyHttpVersion(curl, httpVersion_, hostname_);
+    curl_easy_setopt(curl, CURLOPT_SHARE, pool->share);
+#if LIBCURL_VERSION_NUM >= 0x073b00
+    curl_easy_setopt(curl, CURLOPT_RESOLVER_START_FUNCTION, &countLookup);
+    curl_easy_setopt(curl, CURLOPT_RESOLVER_START_DATA, &pool->dnsLookups);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072800
+    /* Connections are only reused for requests going to the same socket */
+    curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH,
+                     unixSocketPath_.empty() ? static_cast<char *>(nullptr) :
+                                               unixSocketPath_.c_str());
+#endif
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING,
+                     compressionEnabled_ ? ACCEPTED_ENCODINGS :
+                                           static_cast<char *>(nullptr));
 
     if (authenticationEnabled_)
     {
-        curl_easy_setopt(curl, CURLOPT_USERPWD,
-                         fmt::format("{}:{}", authentication_.username,
-                                     authentication_.password)
-                             .c_str());
+        curl_easy_setopt(curl, CURLOPT_USERPWD, credentials_.c_str());
     }
+    else
+    {
+        curl_easy_setopt(curl, CURLOPT_USERPWD, static_cast<char *>(nullptr));
+    }
+
+    return { curl, pool, std::move(body), capturedHeaders_,
+             std::move(responseHeaders) };
+}
 
-    return { curl };
+void CUrlHttp::updateUrl()
+{
+    url_ = fmt::format("{}{}{}", hostname_,
+                       port_ > 0 ? fmt::format(":{}", port_) : "", path_);
+}
+
+void CUrlHttp::updateCredentials()
+{
+    credentials_ = fmt::format("{}:{}", authentication_.username,
+                               authentication_.password);
 }
 
 #endif // PLATFORM_LINUX
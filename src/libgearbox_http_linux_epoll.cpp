@@ -0,0 +1,1344 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#ifdef PLATFORM_LINUX
+#include "libgearbox_http_linux_epoll_p.h"
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "libgearbox_logger_p.h"
+
+using namespace gearbox;
+using namespace std::chrono_literals;
+
+namespace
+{
+    using namespace gearbox::http;
+
+    constexpr std::size_t DEFAULT_MAX_IDLE_CONNECTIONS{ 4 };
+    constexpr std::int64_t DEFAULT_IDLE_CONNECTION_TIMEOUT{ 30000 };
+    constexpr std::int64_t DNS_CACHE_TIMEOUT{ 60000 };
+    constexpr int ABORT_POLL_INTERVAL_MS{ 100 };
+    constexpr std::size_t RECEIVE_BUFFER_SIZE{ 16384 };
+    /* Longer status, header or chunk size lines are not going to come */
+    /* from a Transmission daemon.                                     */
+    constexpr std::size_t MAX_LINE_SIZE{ 16384 };
+
+    const Error SUCCESS{ Error::Code::NoError, "" };
+
+    inline char toLowerAscii(char c)
+    {
+        return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') :
+                                            c;
+    }
+
+    bool startsWithIgnoreCase(const char *s,
+                              std::size_t size,
+                              const char *prefix,
+                              std::size_t prefixSize)
+    {
+        return (size >= prefixSize) &&
+               std::equal(prefix, prefix + prefixSize, s, [](char c1, char c2) {
+                   return toLowerAscii(c1) == toLowerAscii(c2);
+               });
+    }
+
+    bool containsIgnoreCase(const char *s,
+                            std::size_t size,
+                            const char *token,
+                            std::size_t tokenSize)
+    {
+        for (std::size_t it = 0; it + tokenSize <= size; ++it)
+        {
+            if (startsWithIgnoreCase(s + it, size - it, token, tokenSize))
+                return true;
+        }
+        return false;
+    }
+
+    std::string toBase64(const std::string &data)
+    {
+        static constexpr const char ALPHABET[]{
+            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"
+        };
+
+        std::string result;
+        result.reserve((data.size() + 2) / 3 * 4);
+        std::size_t it = 0;
+        for (; it + 2 < data.size(); it += 3)
+        {
+            const auto bits = (static_cast<std::uint8_t>(data[it]) << 16) |
+                              (static_cast<std::uint8_t>(data[it + 1]) << 8) |
+                              static_cast<std::uint8_t>(data[it + 2]);
+            result += ALPHABET[(bits >> 18) & 0x3f];
+            result += ALPHABET[(bits >> 12) & 0x3f];
+            result += ALPHABET[(bits >> 6) & 0x3f];
+            result += ALPHABET[bits & 0x3f];
+        }
+        if (it < data.size())
+        {
+            const bool two = (it + 1 < data.size());
+            const auto bits =
+                (static_cast<std::uint8_t>(data[it]) << 16) |
+                (two ? static_cast<std::uint8_t>(data[it + 1]) << 8 : 0);
+            result += ALPHABET[(bits >> 18) & 0x3f];
+            result += ALPHABET[(bits >> 12) & 0x3f];
+            result += two ? ALPHABET[(bits >> 6) & 0x3f] : '=';
+            result += '=';
+        }
+
+        return result;
+    }
+
+    void closeConnection(int socket, int epoll)
+    {
+        if (epoll >= 0) ::close(epoll);
+        if (socket >= 0) ::close(socket);
+    }
+}
+
+/* Parses a response as it arrives. The body of a successful response goes */
+/* to the body handler, if there is one, the body of any other response is */
+/* kept in the text.                                                       */
+class EpollHttp::Request::Transfer
+{
+public:
+    enum class State
+    {
+        StatusLine,
+        Headers,
+        Body,
+        ChunkSize,
+        ChunkData,
+        ChunkEnd,
+        Trailers,
+        UntilClose,
+        Complete,
+        Invalid
+    };
+
+public:
+    explicit Transfer(const http_body_handler_t *handler = nullptr)
+      : state(State::StatusLine), status(http_status_t::Unknown),
+        keepAlive(false), chunked(false), hasContentLength(false),
+        remaining(0), line(), headers(), text(), bodyHandler(handler),
+        streamed(false), bodyBytes(0), receivedBytes(0)
+    {
+    }
+
+    /* Returns false once the response turns out to be invalid */
+    bool feed(const char *data, std::size_t size);
+
+    /* The peer closed the connection, which only ends a response that is */
+    /* delimited by it.                                                   */
+    void close();
+
+    inline bool complete() const { return state == State::Complete; }
+
+public:
+    State state;
+    std::int32_t status;
+    bool keepAlive;
+    bool chunked;
+    bool hasContentLength;
+    std::uint64_t remaining; /* of the body, or of the current chunk */
+    std::string line;        /* the start of a line split across reads */
+    gearbox::http::ResponseHeaders headers;
+    std::string text;
+    const http_body_handler_t *bodyHandler;
+    bool streamed;
+    std::uint64_t bodyBytes;
+    std::uint64_t receivedBytes;
+
+private:
+    void parseLine(const char *data, std::size_t size);
+    void parseStatusLine(const char *data, std::size_t size);
+    void parseHeader(const char *data, std::size_t size);
+    void parseChunkSize(const char *data, std::size_t size);
+    void endHeaders();
+    void deliver(const char *data, std::size_t size);
+};
+
+bool EpollHttp::Request::Transfer::feed(const char *data, std::size_t size)
+{
+    const auto end = data + size;
+    receivedBytes += size;
+
+    while ((data < end) && (state != State::Complete) &&
+           (state != State::Invalid))
+    {
+        switch (state)
+        {
+            case State::Body:
+            case State::ChunkData:
+            {
+                const auto available = static_cast<std::uint64_t>(end - data);
+                const auto count =
+                    static_cast<std::size_t>(std::min(remaining, available));
+                deliver(data, count);
+                data += count;
+                remaining -= count;
+                if (remaining == 0)
+                {
+                    state = (state == State::Body) ? State::Complete :
+                                                     State::ChunkEnd;
+                }
+                break;
+            }
+            case State::UntilClose:
+                deliver(data, static_cast<std::size_t>(end - data));
+                data = end;
+                break;
+            default:
+            {
+                /* Everything else is made of lines */
+                const auto newline = std::find(data, end, '\n');
+                if (newline == end)
+                {
+                    if (line.size() + static_cast<std::size_t>(end - data) >
+                        MAX_LINE_SIZE)
+                    {
+                        state = State::Invalid;
+                        break;
+                    }
+                    line.append(data, end);
+                    data = end;
+                    break;
+                }
+
+                /* Only lines split across reads are copied */
+                const char *lineData = data;
+                auto lineSize = static_cast<std::size_t>(newline - data);
+                if (!line.empty())
+                {
+                    line.append(data, newline);
+                    lineData = line.data();
+                    lineSize = line.size();
+                }
+                data = newline + 1;
+
+                if ((lineSize > 0) && (lineData[lineSize - 1] == '\r'))
+                {
+                    --lineSize;
+                }
+                parseLine(lineData, lineSize);
+                line.clear();
+                break;
+            }
+        }
+    }
+
+    return state != State::Invalid;
+}
+
+void EpollHttp::Request::Transfer::close()
+{
+    if (state == State::UntilClose)
+    {
+        state = State::Complete;
+    }
+    else if (state != State::Complete)
+    {
+        state = State::Invalid;
+    }
+    keepAlive = false;
+}
+
+void EpollHttp::Request::Transfer::parseLine(const char *data,
+                                             std::size_t size)
+{
+    switch (state)
+    {
+        case State::StatusLine:
+            parseStatusLine(data, size);
+            break;
+        case State::Headers:
+            if (size == 0)
+            {
+                endHeaders();
+            }
+            else
+            {
+                parseHeader(data, size);
+            }
+            break;
+        case State::ChunkSize:
+            parseChunkSize(data, size);
+            break;
+        case State::ChunkEnd:
+            state = (size == 0) ? State::ChunkSize : State::Invalid;
+            break;
+        case State::Trailers:
+            /* Trailer fields carry nothing of interest */
+            if (size == 0) state = State::Complete;
+            break;
+        default:
+            break;
+    }
+}
+
+void EpollHttp::Request::Transfer::parseStatusLine(const char *data,
+                                                   std::size_t size)
+{
+    /* "HTTP/1.x 200 OK", the reason phrase is optional */
+    if ((size < 12) || !std::equal(data, data + 7, "HTTP/1.") ||
+        (data[8] != ' '))
+    {
+        state = State::Invalid;
+        return;
+    }
+
+    std::int32_t code = 0;
+    for (std::size_t it = 9; it < 12; ++it)
+    {
+        if ((data[it] < '0') || (data[it] > '9'))
+        {
+            state = State::Invalid;
+            return;
+        }
+        code = code * 10 + (data[it] - '0');
+    }
+
+    status = code;
+    keepAlive = (data[7] == '1');
+    chunked = false;
+    hasContentLength = false;
+    headers.parseLine(data, size);
+    state = State::Headers;
+}
+
+void EpollHttp::Request::Transfer::parseHeader(const char *data,
+                                               std::size_t size)
+{
+    static constexpr const char CONTENT_LENGTH[]{ "Content-Length:" };
+    static constexpr const char TRANSFER_ENCODING[]{ "Transfer-Encoding:" };
+    static constexpr const char CONNECTION[]{ "Connection:" };
+
+    /* The headers that delimit the body are needed whether they are */
+    /* captured or not.                                              */
+    if (startsWithIgnoreCase(data, size, CONTENT_LENGTH,
+                             sizeof(CONTENT_LENGTH) - 1))
+    {
+        remaining = 0;
+        hasContentLength = false;
+        for (auto it = sizeof(CONTENT_LENGTH) - 1; it < size; ++it)
+        {
+            if ((data[it] >= '0') && (data[it] <= '9'))
+            {
+                remaining = remaining * 10 +
+                            static_cast<std::uint64_t>(data[it] - '0');
+                hasContentLength = true;
+            }
+            else if ((data[it] != ' ') && (data[it] != '\t'))
+            {
+                state = State::Invalid;
+                return;
+            }
+        }
+    }
+    else if (startsWithIgnoreCase(data, size, TRANSFER_ENCODING,
+                                  sizeof(TRANSFER_ENCODING) - 1))
+    {
+        chunked = containsIgnoreCase(data, size, "chunked", 7);
+    }
+    else if (startsWithIgnoreCase(data, size, CONNECTION,
+                                  sizeof(CONNECTION) - 1))
+    {
+        if (containsIgnoreCase(data, size, "close", 5))
+        {
+            keepAlive = false;
+        }
+        else if (containsIgnoreCase(data, size, "keep-alive", 10))
+        {
+            keepAlive = true;
+        }
+    }
+
+    headers.parseLine(data, size);
+}
+
+void EpollHttp::Request::Transfer::parseChunkSize(const char *data,
+                                                  std::size_t size)
+{
+    /* Chunk extensions, after a ';', are ignored */
+    std::size_t digits = 0;
+    remaining = 0;
+    for (; digits < size; ++digits)
+    {
+        const auto c = toLowerAscii(data[digits]);
+        if ((c >= '0') && (c <= '9'))
+        {
+            remaining = (remaining << 4) | static_cast<std::uint64_t>(c - '0');
+        }
+        else if ((c >= 'a') && (c <= 'f'))
+        {
+            remaining =
+                (remaining << 4) | static_cast<std::uint64_t>(c - 'a' + 10);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if ((digits == 0) || (digits > 15))
+    {
+        state = State::Invalid;
+        return;
+    }
+    state = (remaining > 0) ? State::ChunkData : State::Trailers;
+}
+
+void EpollHttp::Request::Transfer::endHeaders()
+{
+    /* Interim responses are followed by the actual one */
+    if ((status >= 100) && (status < 200))
+    {
+        state = State::StatusLine;
+        return;
+    }
+
+    streamed = (bodyHandler != nullptr) && (status == http_status_t::OK);
+
+    if ((status == http_status_t::NoContent) ||
+        (status == http_status_t::NotModified))
+    {
+        state = State::Complete;
+    }
+    else if (chunked)
+    {
+        state = State::ChunkSize;
+    }
+    else if (hasContentLength)
+    {
+        state = (remaining > 0) ? State::Body : State::Complete;
+    }
+    else
+    {
+        /* The body runs until the server closes the connection */
+        keepAlive = false;
+        state = State::UntilClose;
+    }
+}
+
+void EpollHttp::Request::Transfer::deliver(const char *data,
+                                           std::size_t size)
+{
+    if (streamed)
+    {
+        (*bodyHandler)(data, size);
+    }
+    else
+    {
+        text.append(data, size);
+    }
+    bodyBytes += size;
+}
+
+EpollHttp::ConnectionPool::ConnectionPool()
+  : mutex(), idle(), hosts(), maxIdle(DEFAULT_MAX_IDLE_CONNECTIONS),
+    idleTimeout(DEFAULT_IDLE_CONNECTION_TIMEOUT), reusedConnections(0),
+    newConnections(0), receivedBytes(0), dnsLookups(0)
+{
+}
+
+EpollHttp::ConnectionPool::~ConnectionPool() { clear(); }
+
+bool EpollHttp::ConnectionPool::acquire(const std::string &endpoint,
+                                        Connection &connection)
+{
+    bool found = false;
+    std::vector<Connection> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stale = takeStale(clock_t::now());
+
+        /* The most recently released connection is the most likely to */
+        /* still be open on the other end.                              */
+        for (auto it = idle.rbegin(); it != idle.rend(); ++it)
+        {
+            if (it->endpoint == endpoint)
+            {
+                connection = it->connection;
+                idle.erase(std::next(it).base());
+                found = true;
+                break;
+            }
+        }
+    }
+
+    for (const auto &c : stale)
+    {
+        closeConnection(c.socket, c.epoll);
+    }
+    return found;
+}
+
+void EpollHttp::ConnectionPool::release(const std::string &endpoint,
+                                        Connection connection)
+{
+    const auto now = clock_t::now();
+    std::vector<Connection> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stale = takeStale(now);
+        if (idle.size() < maxIdle)
+        {
+            idle.push_back({ connection, endpoint, now });
+            connection.socket = -1;
+            connection.epoll = -1;
+        }
+    }
+
+    closeConnection(connection.socket, connection.epoll);
+    for (const auto &c : stale)
+    {
+        closeConnection(c.socket, c.epoll);
+    }
+}
+
+void EpollHttp::ConnectionPool::clear()
+{
+    std::vector<IdleConnection> connections;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        connections.swap(idle);
+    }
+
+    for (const auto &c : connections)
+    {
+        closeConnection(c.connection.socket, c.connection.epoll);
+    }
+}
+
+bool EpollHttp::ConnectionPool::resolve(const Target &target,
+                                        std::vector<Address> &addresses)
+{
+    const auto now = clock_t::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto &host : hosts)
+        {
+            if ((host.endpoint == target.endpoint) &&
+                (now - host.resolveTime < milliseconds_t(DNS_CACHE_TIMEOUT)))
+            {
+                addresses = host.addresses;
+                return true;
+            }
+        }
+    }
+
+    addresses.clear();
+    if (!target.unixSocketPath.empty())
+    {
+        /* Nothing to look up, the path is the address */
+        Address address{};
+        auto unixAddress = reinterpret_cast<sockaddr_un *>(&address.storage);
+        if (target.unixSocketPath.size() >= sizeof(unixAddress->sun_path))
+            return false;
+
+        unixAddress->sun_family = AF_UNIX;
+        std::copy(target.unixSocketPath.begin(), target.unixSocketPath.end(),
+                  unixAddress->sun_path);
+        address.size = sizeof(sockaddr_un);
+        addresses.push_back(address);
+    }
+    else
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *result = nullptr;
+
+        ++dnsLookups;
+        if (getaddrinfo(target.name.c_str(), target.service.c_str(), &hints,
+                        &result) != 0)
+        {
+            return false;
+        }
+        for (auto it = result; it != nullptr; it = it->ai_next)
+        {
+            Address address{};
+            std::copy_n(reinterpret_cast<const char *>(it->ai_addr),
+                        it->ai_addrlen,
+                        reinterpret_cast<char *>(&address.storage));
+            address.size = it->ai_addrlen;
+            addresses.push_back(address);
+        }
+        freeaddrinfo(result);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto host = std::find_if(hosts.begin(), hosts.end(),
+                             [&target](const ResolvedHost &h) {
+                                 return h.endpoint == target.endpoint;
+                             });
+    if (host == hosts.end())
+    {
+        hosts.push_back({ target.endpoint, addresses, now });
+    }
+    else
+    {
+        host->addresses = addresses;
+        host->resolveTime = now;
+    }
+
+    return !addresses.empty();
+}
+
+void EpollHttp::ConnectionPool::prefer(const Target &target,
+                                       const Address &address)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &host : hosts)
+    {
+        if (host.endpoint != target.endpoint) continue;
+
+        auto preferred = std::find_if(
+            host.addresses.begin(), host.addresses.end(),
+            [&address](const Address &a) {
+                return (a.size == address.size) &&
+                       std::equal(reinterpret_cast<const char *>(&a.storage),
+                                  reinterpret_cast<const char *>(&a.storage) +
+                                      a.size,
+                                  reinterpret_cast<const char *>(
+                                      &address.storage));
+            });
+        if (preferred != host.addresses.end())
+        {
+            std::rotate(host.addresses.begin(), preferred, preferred + 1);
+        }
+        break;
+    }
+}
+
+std::vector<EpollHttp::Connection> EpollHttp::ConnectionPool::takeStale(
+    clock_t::time_point now)
+{
+    /* Connections are released in chronological order so the oldest ones */
+    /* are always at the front.                                            */
+    std::size_t count = 0;
+    while ((count < idle.size()) &&
+           ((idle.size() - count > maxIdle) ||
+            (now - idle[count].releaseTime >= idleTimeout)))
+    {
+        ++count;
+    }
+
+    std::vector<Connection> stale;
+    stale.reserve(count);
+    for (std::size_t it = 0; it < count; ++it)
+    {
+        stale.push_back(idle[it].connection);
+    }
+    idle.erase(idle.begin(), idle.begin() + count);
+
+    return stale;
+}
+
+EpollHttp::EpollHttp(const std::string &userAgent)
+  : userAgent_(userAgent), hostname_(), port_(-1), path_("/"),
+    authenticationEnabled_(false), authentication_(), unixSocketPath_(),
+    target_(), capturedHeaders_(), timeout_(),
+    pool_(std::make_shared<ConnectionPool>())
+{
+    updateTarget();
+}
+
+EpollHttp::EpollHttp(EpollHttp &&) noexcept(true) = default;
+EpollHttp &EpollHttp::operator=(EpollHttp &&) noexcept(true) = default;
+EpollHttp::~EpollHttp() = default;
+
+const std::string &EpollHttp::host() const { return hostname_; }
+
+void EpollHttp::setHost(const std::string &hostname)
+{
+    hostname_ = hostname;
+    updateTarget();
+}
+
+void EpollHttp::setHost(std::string &&hostname)
+{
+    hostname_ = std::move(hostname);
+    updateTarget();
+}
+
+EpollHttp::http_port_t EpollHttp::port() const { return port_; }
+
+void EpollHttp::setPort(http_port_t port)
+{
+    port_ = port;
+    updateTarget();
+}
+
+const std::string &EpollHttp::path() const { return path_; }
+
+void EpollHttp::setPath(const std::string &path)
+{
+    path_ = path;
+    updateTarget();
+}
+
+void EpollHttp::setPath(std::string &&path)
+{
+    path_ = std::move(path);
+    updateTarget();
+}
+
+bool EpollHttp::authenticationRequired() const
+{
+    return authenticationEnabled_;
+}
+
+void EpollHttp::enableAuthentication()
+{
+    authenticationEnabled_ = true;
+    updateTarget();
+}
+
+void EpollHttp::disableAuthentication()
+{
+    authenticationEnabled_ = false;
+    updateTarget();
+}
+
+const std::string &EpollHttp::username() const
+{
+    return authentication_.username;
+}
+
+void EpollHttp::setUsername(const std::string &username)
+{
+    authenticationEnabled_ = true;
+    authentication_.username = username;
+    updateTarget();
+}
+
+void EpollHttp::setUsername(std::string &&username)
+{
+    authenticationEnabled_ = true;
+    authentication_.username = std::move(username);
+    updateTarget();
+}
+
+const std::string &EpollHttp::password() const
+{
+    return authentication_.password;
+}
+
+void EpollHttp::setPassword(const std::string &password)
+{
+    authenticationEnabled_ = true;
+    authentication_.password = password;
+    updateTarget();
+}
+
+void EpollHttp::setPassword(std::string &&password)
+{
+    authenticationEnabled_ = true;
+    authentication_.password = std::move(password);
+    updateTarget();
+}
+
+void EpollHttp::setSSLErrorHandling(http_ssl_error_handling_t)
+{
+}
+
+const std::string &EpollHttp::unixSocketPath() const
+{
+    return unixSocketPath_;
+}
+
+void EpollHttp::setUnixSocketPath(const std::string &path)
+{
+    unixSocketPath_ = path;
+    updateTarget();
+}
+
+const std::vector<std::string> &EpollHttp::capturedHeaders() const
+{
+    static const std::vector<std::string> all;
+    return capturedHeaders_ ? *capturedHeaders_ : all;
+}
+
+void EpollHttp::setCapturedHeaders(std::vector<std::string> names)
+{
+    if (names.empty())
+    {
+        capturedHeaders_.reset();
+    }
+    else
+    {
+        capturedHeaders_ =
+            std::make_shared<const std::vector<std::string>>(std::move(names));
+    }
+}
+
+const milliseconds_t &EpollHttp::timeout() const { return timeout_; }
+
+void EpollHttp::setTimeout(milliseconds_t value) { timeout_ = value; }
+
+std::size_t EpollHttp::maxIdleConnections() const
+{
+    const auto pool = this->pool();
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return pool->maxIdle;
+}
+
+void EpollHttp::setMaxIdleConnections(std::size_t value)
+{
+    const auto pool = this->pool();
+    std::vector<Connection> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->maxIdle = value;
+        stale = pool->takeStale(ConnectionPool::clock_t::now());
+    }
+
+    for (const auto &c : stale)
+    {
+        closeConnection(c.socket, c.epoll);
+    }
+}
+
+milliseconds_t EpollHttp::idleConnectionTimeout() const
+{
+    const auto pool = this->pool();
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    return pool->idleTimeout;
+}
+
+void EpollHttp::setIdleConnectionTimeout(milliseconds_t value)
+{
+    const auto pool = this->pool();
+    std::vector<Connection> stale;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->idleTimeout = value;
+        stale = pool->takeStale(ConnectionPool::clock_t::now());
+    }
+
+    for (const auto &c : stale)
+    {
+        closeConnection(c.socket, c.epoll);
+    }
+}
+
+EpollHttp::http_connection_statistics_t EpollHttp::connectionStatistics()
+    const
+{
+    /* Bodies are never compressed, they are received as they are decoded */
+    const auto pool = this->pool();
+    return { pool->reusedConnections.load(), pool->newConnections.load(),
+             pool->receivedBytes.load(), pool->receivedBytes.load(),
+             pool->dnsLookups.load() };
+}
+
+void EpollHttp::shareConnectionPool(const EpollHttp &other)
+{
+    /* Requests in flight keep the previous pool alive until they are done */
+    std::atomic_store(&pool_, other.pool());
+}
+
+std::shared_ptr<EpollHttp::ConnectionPool> EpollHttp::pool() const
+{
+    return std::atomic_load(&pool_);
+}
+
+EpollHttp::Request::Request(
+    std::shared_ptr<ConnectionPool> pool,
+    std::shared_ptr<const Target> target,
+    milliseconds_t timeout,
+    std::shared_ptr<const std::vector<std::string>> capturedHeaders)
+  : pool_(std::move(pool)), target_(std::move(target)), timeout_(timeout),
+    headers_(), body_(), hasBody_(false), bodyHandler_(), abortHandler_(),
+    capturedHeaders_(std::move(capturedHeaders))
+{
+}
+
+EpollHttp::Request::Request(Request &&) noexcept(true) = default;
+EpollHttp::Request &EpollHttp::Request::operator=(Request &&) noexcept(
+    true) = default;
+EpollHttp::Request::~Request() = default;
+
+void EpollHttp::Request::setBody(const std::string &data)
+{
+    body_.assign(data);
+    hasBody_ = true;
+}
+
+void EpollHttp::Request::setHeaders(const http_header_array_t &headers)
+{
+    for (const auto &header : headers)
+    {
+        headers_[header.first] = header.second;
+    }
+}
+
+void EpollHttp::Request::setHeader(const http_header_t &header)
+{
+    headers_[header.first] = header.second;
+}
+
+void EpollHttp::Request::setBodyHandler(http_body_handler_t handler)
+{
+    bodyHandler_ = std::move(handler);
+}
+
+void EpollHttp::Request::setTimeout(milliseconds_t value) { timeout_ = value; }
+
+void EpollHttp::Request::setAbortHandler(http_abort_handler_t handler)
+{
+    abortHandler_ = std::move(handler);
+}
+
+EpollHttp::http_request_result_t EpollHttp::Request::send()
+{
+    const auto start = clock_t::now();
+    const auto deadline = (timeout_.count() > 0) ? start + timeout_ :
+                                                   clock_t::time_point::max();
+
+    Transfer transfer(bodyHandler_ ? &bodyHandler_ : nullptr);
+    transfer.headers.setFilter(capturedHeaders_);
+
+    http_error_t err{ Error::Code::InternalError,
+                      "An internal connection handle is invalid. "
+                      "This is most likely due to operating an a moved or "
+                      "otherwise invalidated "
+                      "instance of this object" };
+    if (pool_ && target_)
+    {
+        err = target_->supported ?
+                  SUCCESS :
+                  http_error_t{ Error::Code::UnsupportedProtocol,
+                                "Only plain HTTP is supported" };
+    }
+
+    Connection connection{ -1, -1, 0 };
+    bool reused = false;
+    if (!err)
+    {
+        reused = pool_->acquire(target_->endpoint, connection);
+        if (!reused) err = connect(connection, deadline);
+    }
+    if (!err)
+    {
+        err = exchange(connection, transfer, deadline);
+
+        /* The server may have closed a kept-alive connection just before */
+        /* the request went out, it is sent again over a new one.         */
+        if ((err.errorCode == Error::Code::RetryRequest) && reused)
+        {
+            closeConnection(connection.socket, connection.epoll);
+            connection = { -1, -1, 0 };
+            reused = false;
+            err = connect(connection, deadline);
+            if (!err) err = exchange(connection, transfer, deadline);
+        }
+        if (err.errorCode == Error::Code::RetryRequest)
+        {
+            err = { Error::Code::ResponseInvalid,
+                    "Server returned nothing (no headers, no data)" };
+        }
+    }
+
+    if (!err)
+    {
+        if (reused)
+        {
+            ++pool_->reusedConnections;
+        }
+        else
+        {
+            ++pool_->newConnections;
+        }
+        pool_->receivedBytes += transfer.bodyBytes;
+    }
+
+    if (!err && transfer.keepAlive)
+    {
+        pool_->release(target_->endpoint, connection);
+    }
+    else
+    {
+        closeConnection(connection.socket, connection.epoll);
+    }
+
+    if (!transfer.text.empty() && (transfer.text.back() == '\n'))
+    {
+        transfer.text.pop_back();
+    }
+
+    const std::chrono::duration<double> elapsed = clock_t::now() - start;
+    return { http_status_t(transfer.status),
+             { std::move(transfer.headers), std::move(transfer.text) },
+             elapsed.count(),
+             err,
+             { transfer.bodyBytes, transfer.bodyBytes } };
+}
+
+EpollHttp::Request::Wait EpollHttp::Request::wait(
+    Connection &connection,
+    std::uint32_t events,
+    clock_t::time_point deadline)
+{
+    if (connection.events != events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = connection.socket;
+        if (epoll_ctl(connection.epoll, EPOLL_CTL_MOD, connection.socket,
+                      &event) != 0)
+        {
+            return Wait::Failed;
+        }
+        connection.events = events;
+    }
+
+    for (;;)
+    {
+        if (abortHandler_ && abortHandler_()) return Wait::Aborted;
+
+        int waitMs = -1;
+        if (deadline != clock_t::time_point::max())
+        {
+            const auto remaining =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - clock_t::now() + 999us);
+            if (remaining.count() <= 0) return Wait::TimedOut;
+            waitMs = static_cast<int>(
+                std::min<std::int64_t>(remaining.count(), 0x7fffffff));
+        }
+        if (abortHandler_)
+        {
+            waitMs = (waitMs < 0) ? ABORT_POLL_INTERVAL_MS :
+                                    std::min(waitMs, ABORT_POLL_INTERVAL_MS);
+        }
+
+        /* Errors and hang-ups are reported as well, the next read or */
+        /* write on the socket tells which it was.                    */
+        epoll_event ready;
+        const auto count = epoll_wait(connection.epoll, &ready, 1, waitMs);
+        if (count > 0) return Wait::Ready;
+        if ((count < 0) && (errno != EINTR)) return Wait::Failed;
+    }
+}
+
+EpollHttp::http_error_t EpollHttp::Request::connect(
+    Connection &connection,
+    clock_t::time_point deadline)
+{
+    std::vector<ConnectionPool::Address> addresses;
+    if (!pool_->resolve(*target_, addresses))
+    {
+        return { Error::Code::HostResolutionFailure,
+                 "Couldn't resolve host name" };
+    }
+
+    http_error_t err{ Error::Code::ConnectionFailure,
+                      "Couldn't connect to server" };
+    for (const auto &address : addresses)
+    {
+        const auto family = address.storage.ss_family;
+        connection.socket =
+            ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        connection.epoll = epoll_create1(EPOLL_CLOEXEC);
+        if ((connection.socket < 0) || (connection.epoll < 0))
+        {
+            closeConnection(connection.socket, connection.epoll);
+            connection = { -1, -1, 0 };
+            return { Error::Code::InternalError,
+                     "Failed to create a socket" };
+        }
+
+        if (family != AF_UNIX)
+        {
+            /* Head and body go out in a single write, there is nothing */
+            /* to gain from holding back small segments.                */
+            int noDelay = 1;
+            setsockopt(connection.socket, IPPROTO_TCP, TCP_NODELAY, &noDelay,
+                       sizeof(noDelay));
+        }
+
+        epoll_event event{};
+        event.events = EPOLLOUT;
+        event.data.fd = connection.socket;
+        epoll_ctl(connection.epoll, EPOLL_CTL_ADD, connection.socket, &event);
+        connection.events = EPOLLOUT;
+
+        auto result = ::connect(
+            connection.socket,
+            reinterpret_cast<const sockaddr *>(&address.storage),
+            address.size);
+        if ((result != 0) && ((errno == EINPROGRESS) || (errno == EAGAIN)))
+        {
+            const auto ready = wait(connection, EPOLLOUT, deadline);
+            if (ready == Wait::TimedOut)
+            {
+                err = { Error::Code::OperationTimedOut,
+                        "Timeout was reached" };
+            }
+            else if (ready == Wait::Aborted)
+            {
+                err = { Error::Code::UnknownError, "Request aborted" };
+            }
+            else
+            {
+                int error = 0;
+                socklen_t size = sizeof(error);
+                getsockopt(connection.socket, SOL_SOCKET, SO_ERROR, &error,
+                           &size);
+                result = (ready == Wait::Ready) && (error == 0) ? 0 : -1;
+            }
+        }
+
+        if (result == 0)
+        {
+            pool_->prefer(*target_, address);
+            return SUCCESS;
+        }
+
+        closeConnection(connection.socket, connection.epoll);
+        connection = { -1, -1, 0 };
+        if (err.errorCode != Error::Code::ConnectionFailure) break;
+    }
+
+    return err;
+}
+
+EpollHttp::http_error_t EpollHttp::Request::exchange(
+    Connection &connection,
+    Transfer &transfer,
+    clock_t::time_point deadline)
+{
+    std::string head;
+    writeHead(head);
+
+    /* Head and body are sent straight from where they are, together */
+    iovec parts[2]{
+        { const_cast<char *>(head.data()), head.size() },
+        { const_cast<char *>(body_.data()), hasBody_ ? body_.size() : 0 }
+    };
+    msghdr message{};
+    message.msg_iov = parts;
+    message.msg_iovlen = 2;
+
+    auto pending = parts[0].iov_len + parts[1].iov_len;
+    bool sentAny = false;
+    while (pending > 0)
+    {
+        const auto sent = sendmsg(connection.socket, &message, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+            {
+                const auto ready = wait(connection, EPOLLOUT, deadline);
+                if (ready == Wait::Ready) continue;
+                if (ready == Wait::TimedOut)
+                    return { Error::Code::OperationTimedOut,
+                             "Timeout was reached" };
+                if (ready == Wait::Aborted)
+                    return { Error::Code::UnknownError, "Request aborted" };
+            }
+            else if (errno == EINTR)
+            {
+                continue;
+            }
+            else if (!sentAny && ((errno == EPIPE) || (errno == ECONNRESET)))
+            {
+                return { Error::Code::RetryRequest, "Connection closed" };
+            }
+            return { Error::Code::NetworkSendFailure,
+                     "Failed sending data to the peer" };
+        }
+
+        sentAny = true;
+        pending -= static_cast<std::size_t>(sent);
+        auto consumed = static_cast<std::size_t>(sent);
+        while ((consumed > 0) && (message.msg_iovlen > 0))
+        {
+            const auto count = std::min(consumed, message.msg_iov->iov_len);
+            message.msg_iov->iov_base =
+                static_cast<char *>(message.msg_iov->iov_base) + count;
+            message.msg_iov->iov_len -= count;
+            consumed -= count;
+            if (message.msg_iov->iov_len == 0)
+            {
+                ++message.msg_iov;
+                --message.msg_iovlen;
+            }
+        }
+    }
+
+    /* The response can't be there yet, wait for it right away */
+    char buffer[RECEIVE_BUFFER_SIZE];
+    auto ready = wait(connection, EPOLLIN, deadline);
+    while (!transfer.complete())
+    {
+        if (ready == Wait::TimedOut)
+            return { Error::Code::OperationTimedOut, "Timeout was reached" };
+        if (ready == Wait::Aborted)
+            return { Error::Code::UnknownError, "Request aborted" };
+        if (ready == Wait::Failed)
+            return { Error::Code::NetworkReceiveError,
+                     "Failure when receiving data from the peer" };
+
+        const auto received =
+            recv(connection.socket, buffer, sizeof(buffer), 0);
+        if (received > 0)
+        {
+            if (!transfer.feed(buffer, static_cast<std::size_t>(received)))
+            {
+                return { Error::Code::ResponseInvalid, "Weird server reply" };
+            }
+            continue;
+        }
+
+        if (received == 0)
+        {
+            if (transfer.receivedBytes == 0)
+                return { Error::Code::RetryRequest, "Connection closed" };
+
+            transfer.close();
+            if (!transfer.complete())
+                return { Error::Code::NetworkReceiveError,
+                         "Failure when receiving data from the peer" };
+            break;
+        }
+
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+        {
+            ready = wait(connection, EPOLLIN, deadline);
+        }
+        else if (errno != EINTR)
+        {
+            if ((transfer.receivedBytes == 0) && (errno == ECONNRESET))
+                return { Error::Code::RetryRequest, "Connection closed" };
+
+            return { Error::Code::NetworkReceiveError,
+                     "Failure when receiving data from the peer" };
+        }
+    }
+
+    return SUCCESS;
+}
+
+void EpollHttp::Request::writeHead(std::string &head) const
+{
+    static constexpr const char CONTENT_LENGTH[]{ "Content-Length: " };
+
+    std::size_t size = target_->path.size() + target_->fields.size() + 64;
+    for (const auto &header : headers_)
+    {
+        size += header.first.size() + header.second.size() + 4;
+    }
+    head.reserve(size);
+
+    head += hasBody_ ? "POST " : "GET ";
+    head += target_->path;
+    head += " HTTP/1.1\r\n";
+    head += target_->fields;
+    for (const auto &header : headers_)
+    {
+        head += header.first;
+        head += ": ";
+        head += header.second;
+        head += "\r\n";
+    }
+    if (hasBody_)
+    {
+        head += CONTENT_LENGTH;
+        head += std::to_string(body_.size());
+        head += "\r\n";
+    }
+    head += "\r\n";
+}
+
+EpollHttp::Request EpollHttp::createRequest()
+{
+    return { pool(), target_, timeout_, capturedHeaders_ };
+}
+
+void EpollHttp::updateTarget()
+{
+    auto target = std::make_shared<Target>();
+
+    /* Only the authority of the host is kept, e.g. "localhost" out of */
+    /* "http://localhost/"                                             */
+    auto authority = hostname_;
+    target->supported = true;
+    const auto scheme = authority.find("://");
+    if (scheme != std::string::npos)
+    {
+        target->supported = startsWithIgnoreCase(authority.data(), scheme,
+                                                 "http", 4) &&
+                            (scheme == 4);
+        authority.erase(0, scheme + 3);
+    }
+    authority.erase(std::min(authority.find('/'), authority.size()));
+
+    target->name = authority;
+    if ((target->name.size() > 1) && (target->name.front() == '[') &&
+        (target->name.back() == ']'))
+    {
+        /* IPv6 literal */
+        target->name = target->name.substr(1, target->name.size() - 2);
+    }
+    target->service = std::to_string(port_ > 0 ? port_ : 80);
+    target->unixSocketPath = unixSocketPath_;
+    target->endpoint = unixSocketPath_.empty() ?
+                           fmt::format("{}:{}", target->name, target->service) :
+                           fmt::format("unix:{}", unixSocketPath_);
+    target->path = path_.empty() ? "/" : path_;
+
+    target->fields = fmt::format(
+        "Host: {}{}\r\nUser-Agent: {}\r\nAccept: */*\r\n", authority,
+        port_ > 0 ? fmt::format(":{}", port_) : "", userAgent_);
+    if (authenticationEnabled_)
+    {
+        target->fields += fmt::format(
+            "Authorization: Basic {}\r\n",
+            toBase64(fmt::format("{}:{}", authentication_.username,
+                                 authentication_.password)));
+    }
+
+    target_ = std::move(target);
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+
+#ifdef PLATFORM_LINUX
+#include "libgearbox_http_linux_multi_p.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "libgearbox_logger_p.h"
+
+using namespace gearbox;
+
+namespace
+{
+    /* Upper bound for how long the transport thread sleeps when there is */
+    /* nothing to do; it is woken up early whenever a request is queued.  */
+    constexpr int MAX_WAIT_MS{ 1000 };
+}
+
+/* Owns the curl_multi handle and the thread that drives it. Requests are */
+/* queued from any thread and only ever touched by the transport thread   */
+/* until they complete.                                                   */
+class CUrlMultiHttp::Engine
+{
+public:
+    static Engine &instance();
+
+public:
+    Engine();
+    ~Engine();
+
+public:
+    void submit(Request *request);
+    void schedule(std::chrono::steady_clock::time_point when,
+                  std::function<void()> callback);
+    bool isTransportThread() const;
+
+private:
+    void run();
+    void wakeUp();
+    void adoptSubmitted();
+    void completeFinished();
+
+    /* Continues a transfer paused by its pause handler, unless it is done */
+    void resume(Request *request);
+    void complete(Request *request, CURLcode code);
+
+    /* Runs the timers that are due, returns how long the transport can */
+    /* sleep until the next one, in milliseconds.                       */
+    int fireTimers();
+
+private:
+    CURLM *multi_;
+    int wakeupPipe_[2];
+    std::atomic<bool> running_;
+
+    std::mutex mutex_;
+    std::vector<Request *> submitted_;
+    std::multimap<std::chrono::steady_clock::time_point, std::function<void()>>
+        timers_;
+
+    /* Only accessed from the transport thread */
+    std::unordered_set<Request *> active_;
+
+    std::thread thread_;
+
+private:
+    DISABLE_COPY(Engine)
+    DISABLE_MOVE(Engine)
+};
+
+CUrlMultiHttp::Engine &CUrlMultiHttp::Engine::instance()
+{
+    static Engine engine;
+    return engine;
+}
+
+CUrlMultiHttp::Engine::Engine()
+  : multi_(curl_multi_init()), wakeupPipe_{ -1, -1 }, running_(true),
+    mutex_(), submitted_(), timers_(), active_(), thread_()
+{
+    if (pipe2(wakeupPipe_, O_NONBLOCK | O_CLOEXEC) != 0)
+    {
+        LOG_FATAL("Failed to create the wake-up pipe of the HTTP transport");
+    }
+
+    /* Lets requests of sessions that use HTTP/2 share a single connection */
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+    thread_ = std::thread(&Engine::run, this);
+}
+
+CUrlMultiHttp::Engine::~Engine()
+{
+    running_ = false;
+    wakeUp();
+    thread_.join();
+
+    /* Nobody is left to drive these, fail them so no caller waits forever */
+    adoptSubmitted();
+    for (auto request : std::vector<Request *>(active_.begin(), active_.end()))
+    {
+        curl_multi_remove_handle(multi_, request->handle_);
+        active_.erase(request);
+        complete(request, CURLE_ABORTED_BY_CALLBACK);
+    }
+
+    curl_multi_cleanup(multi_);
+    close(wakeupPipe_[0]);
+    close(wakeupPipe_[1]);
+}
+
+void CUrlMultiHttp::Engine::submit(Request *request)
+{
+    request->prepare(request->transfer_);
+    curl_easy_setopt(request->handle_, CURLOPT_PRIVATE, request);
+    if (request->transfer_.pauseHandler != nullptr)
+    {
+        request->transfer_.resume = [this, request]() {
+            schedule(std::chrono::steady_clock::now(),
+                     [this, request]() { resume(request); });
+        };
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitted_.push_back(request);
+    }
+
+    wakeUp();
+}
+
+void CUrlMultiHttp::Engine::schedule(std::chrono::steady_clock::time_point when,
+                                     std::function<void()> callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        timers_.emplace(when, std::move(callback));
+    }
+
+    wakeUp();
+}
+
+bool CUrlMultiHttp::Engine::isTransportThread() const
+{
+    return std::this_thread::get_id() == thread_.get_id();
+}
+
+void CUrlMultiHttp::Engine::run()
+{
+    while (running_)
+    {
+        adoptSubmitted();
+
+        int runningHandles = 0;
+        curl_multi_perform(multi_, &runningHandles);
+        completeFinished();
+        const auto wait = fireTimers();
+
+        curl_waitfd wakeup{ wakeupPipe_[0], CURL_WAIT_POLLIN, 0 };
+        curl_multi_wait(multi_, &wakeup, 1, wait, nullptr);
+        if (wakeup.revents != 0)
+        {
+            char buffer[64];
+            while (read(wakeupPipe_[0], buffer, sizeof(buffer)) > 0)
+            {
+            }
+        }
+    }
+}
+
+void CUrlMultiHttp::Engine::wakeUp()
+{
+    /* A full pipe already guarantees a wake-up, so errors can be ignored */
+    const char byte = 0;
+    static_cast<void>(write(wakeupPipe_[1], &byte, 1));
+}
+
+void CUrlMultiHttp::Engine::adoptSubmitted()
+{
+    std::vector<Request *> submitted;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitted.swap(submitted_);
+    }
+
+    for (auto request : submitted)
+    {
+        auto result = curl_multi_add_handle(multi_, request->handle_);
+        if (result == CURLM_OK)
+        {
+            active_.insert(request);
+        }
+        else
+        {
+            LOG_ERROR("Failed to queue HTTP request: {}",
+                      curl_multi_strerror(result));
+            complete(request, CURLE_FAILED_INIT);
+        }
+    }
+}
+
+void CUrlMultiHttp::Engine::completeFinished()
+{
+    int queued = 0;
+    while (auto message = curl_multi_info_read(multi_, &queued))
+    {
+        if (message->msg != CURLMSG_DONE) continue;
+
+        char *priv = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &priv);
+        auto request = reinterpret_cast<Request *>(priv);
+        auto code = message->data.result;
+
+        /* Invalidates message */
+        curl_multi_remove_handle(multi_, message->easy_handle);
+        active_.erase(request);
+
+        complete(request, code);
+    }
+}
+
+void CUrlMultiHttp::Engine::resume(Request *request)
+{
+    /* An aborted transfer may be over before it gets resumed */
+    if (active_.find(request) == active_.end()) return;
+
+    /* Hands the chunk that was turned down over again, right away */
+    curl_easy_pause(request->handle_, CURLPAUSE_CONT);
+}
+
+int CUrlMultiHttp::Engine::fireTimers()
+{
+    std::vector<std::function<void()>> due;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto end = timers_.upper_bound(std::chrono::steady_clock::now());
+        for (auto it = timers_.begin(); it != end; ++it)
+        {
+            due.push_back(std::move(it->second));
+        }
+        timers_.erase(timers_.begin(), end);
+    }
+
+    /* The callbacks are free to schedule, or submit, more of them */
+    for (auto &callback : due)
+    {
+        callback();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (timers_.empty()) return MAX_WAIT_MS;
+
+    /* Rounded up, waking up early would only have the loop spin */
+    const auto left =
+        timers_.begin()->first - std::chrono::steady_clock::now();
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(left);
+    if (wait < left) ++wait;
+    return static_cast<int>(std::max<std::int64_t>(
+        0, std::min<std::int64_t>(MAX_WAIT_MS, wait.count())));
+}
+
+void CUrlMultiHttp::Engine::complete(Request *request, CURLcode code)
+{
+    auto callback = std::move(request->callback_);
+    auto result = request->finish(request->transfer_, code);
+
+    /* A detached request is owned by the engine; destroying it returns the */
+    /* handle to the pool before the callback gets the chance to reuse it.  */
+    /* A blocking request may be gone as soon as the callback returns.      */
+    if (request->detached_)
+    {
+        delete request;
+    }
+
+    callback(std::move(result));
+}
+
+CUrlMultiHttp::CUrlMultiHttp(const std::string &userAgent)
+  : CUrlHttp(userAgent), engine_(&Engine::instance())
+{
+}
+
+CUrlMultiHttp::CUrlMultiHttp(CUrlMultiHttp &&) noexcept(true) = default;
+CUrlMultiHttp &CUrlMultiHttp::
+operator=(CUrlMultiHttp &&) noexcept(true) = default;
+
+CUrlMultiHttp::~CUrlMultiHttp() = default;
+
+CUrlMultiHttp::Request::Request(CUrlHttp::Request &&request, Engine *engine)
+  : CUrlHttp::Request(std::move(request)), engine_(engine), transfer_(),
+    callback_(), detached_(false)
+{
+}
+
+CUrlMultiHttp::Request::Request(Request &&other) noexcept(true)
+  : CUrlHttp::Request(std::move(other)), engine_(other.engine_),
+    transfer_(), callback_(), detached_(false)
+{
+}
+
+CUrlMultiHttp::Request &CUrlMultiHttp::Request::
+operator=(Request &&other) noexcept(true)
+{
+    CUrlHttp::Request::operator=(std::move(other));
+    std::swap(engine_, other.engine_);
+
+    return *this;
+}
+
+CUrlMultiHttp::Request::~Request() = default;
+
+CUrlMultiHttp::http_request_result_t CUrlMultiHttp::Request::send()
+{
+    /* Waiting on the transport from the transport thread would never return */
+    if ((handle_ == nullptr) || engine_->isTransportThread())
+    {
+        return CUrlHttp::Request::send();
+    }
+
+    std::promise<http_request_result_t> promise;
+    auto result = promise.get_future();
+    callback_ = [&promise](http_request_result_t &&r) {
+        promise.set_value(std::move(r));
+    };
+    engine_->submit(this);
+
+    return result.get();
+}
+
+void CUrlMultiHttp::Request::sendAsync(completion_t callback)
+{
+    if (handle_ == nullptr)
+    {
+        callback(CUrlHttp::Request::send());
+        return;
+    }
+
+    auto request = new Request(std::move(*this));
+    request->callback_ = std::move(callback);
+    request->detached_ = true;
+    engine_->submit(request);
+}
+
+CUrlMultiHttp::Request CUrlMultiHttp::createRequest()
+{
+    Request request{ CUrlHttp::createRequest(), engine_ };
+    if ((request.handle_ != nullptr) && (maxIdleConnections() == 0))
+    {
+        /* The connections stay in the cache of the multi handle once the */
+        /* request is done, not keeping any has to be asked for.          */
+        curl_easy_setopt(request.handle_, CURLOPT_FRESH_CONNECT, 1L);
+        curl_easy_setopt(request.handle_, CURLOPT_FORBID_REUSE, 1L);
+    }
+
+    return request;
+}
+
+void CUrlMultiHttp::schedule(milliseconds_t delay,
+                             std::function<void()> callback)
+{
+    engine_->schedule(std::chrono::steady_clock::now() + delay,
+                      std::move(callback));
+}
+
+bool CUrlMultiHttp::isTransportThread() const
+{
+    return engine_->isTransportThread();
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#include "libgearbox_json_stream_p.h"
+
+#include <utility>
+
+using namespace gearbox;
+
+JsonArrayStream::JsonArrayStream(std::vector<std::string> path,
+                                 element_handler_t handler)
+  : path_(std::move(path)), handler_(std::move(handler)), levels_(),
+    inString_(false), escaped_(false), readingKey_(false), key_(),
+    elementDepth_(0), element_(), remainder_(), failed_(false)
+{
+}
+
+void JsonArrayStream::feed(const char *data, std::size_t size)
+{
+    for (std::size_t it = 0; (it < size) && !failed_; ++it)
+    {
+        const char c = data[it];
+
+        if (inString_)
+        {
+            if (escaped_)
+            {
+                escaped_ = false;
+            }
+            else if (c == '\\')
+            {
+                escaped_ = true;
+            }
+            else if (c == '"')
+            {
+                inString_ = false;
+                if (readingKey_)
+                {
+                    levels_.back().key = std::move(key_);
+                    key_.clear();
+                    readingKey_ = false;
+                }
+            }
+
+            /* Keys are only compared to the path, escapes are kept as is */
+            if (readingKey_) key_ += c;
+
+            if (auto destination = this->destination()) *destination += c;
+            continue;
+        }
+
+        switch (c)
+        {
+            case '"':
+                inString_ = true;
+                readingKey_ = !levels_.empty() && !levels_.back().array &&
+                              levels_.back().expectingKey;
+                break;
+            case '{':
+            case '[':
+            {
+                const bool array = (c == '[');
+                const bool found = array && (elementDepth_ == 0) && atPath();
+                const bool elementStart =
+                    (elementDepth_ != 0) && (levels_.size() == elementDepth_);
+
+                if (elementStart) element_.clear();
+                levels_.push_back({ array, !array, std::string() });
+                if (auto destination = this->destination()) *destination += c;
+                if (found) elementDepth_ = levels_.size();
+                continue;
+            }
+            case '}':
+            case ']':
+            {
+                if (levels_.empty() || (levels_.back().array != (c == ']')))
+                {
+                    failed_ = true;
+                    continue;
+                }
+
+                levels_.pop_back();
+                if (elementDepth_ == 0)
+                {
+                    remainder_ += c;
+                }
+                else if (levels_.size() == elementDepth_ - 1)
+                {
+                    /* The array itself closes */
+                    elementDepth_ = 0;
+                    remainder_ += c;
+                }
+                else
+                {
+                    element_ += c;
+                    if (levels_.size() == elementDepth_)
+                    {
+                        handler_(std::move(element_));
+                        element_.clear();
+                    }
+                }
+                continue;
+            }
+            case ':':
+                if (!levels_.empty() && !levels_.back().array)
+                {
+                    levels_.back().expectingKey = false;
+                }
+                break;
+            case ',':
+                if (!levels_.empty() && !levels_.back().array)
+                {
+                    levels_.back().expectingKey = true;
+                }
+                break;
+            default:
+                break;
+        }
+
+        if (auto destination = this->destination()) *destination += c;
+    }
+}
+
+bool JsonArrayStream::atPath() const
+{
+    if (levels_.size() != path_.size()) return false;
+
+    for (std::size_t it = 0; it < levels_.size(); ++it)
+    {
+        if (levels_[it].array || (levels_[it].key != path_[it])) return false;
+    }
+
+    return true;
+}
+
+std::string *JsonArrayStream::destination()
+{
+    if (elementDepth_ == 0) return &remainder_;
+
+    /* Separators between the elements are dropped along with the elements */
+    return (levels_.size() > elementDepth_) ? &element_ : nullptr;
+}
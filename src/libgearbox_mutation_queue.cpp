@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#include "libgearbox_mutation_queue_p.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+using namespace gearbox;
+
+namespace
+{
+    /* Whichever of these comes last decides if a torrent runs */
+    bool changesRunState(const std::string &method)
+    {
+        return (method == "torrent-start") || (method == "torrent-start-now") ||
+               (method == "torrent-stop");
+    }
+
+    bool touches(const MutationQueue::Batch &batch, std::int32_t id)
+    {
+        for (const auto &mutation : batch.mutations)
+        {
+            const auto &ids = mutation.ids;
+            if (std::find(ids.begin(), ids.end(), id) != ids.end()) return true;
+        }
+
+        return false;
+    }
+
+    /* Returns the index of the last batch that touches id, or -1 */
+    std::ptrdiff_t lastTouching(
+        const std::vector<MutationQueue::Batch> &batches,
+        std::int32_t id)
+    {
+        for (auto it = static_cast<std::ptrdiff_t>(batches.size()); it-- > 0;)
+        {
+            if (touches(batches[static_cast<std::size_t>(it)], id)) return it;
+        }
+
+        return -1;
+    }
+}
+
+std::vector<std::int32_t> MutationQueue::Batch::ids() const
+{
+    std::vector<std::int32_t> result;
+    std::unordered_set<std::int32_t> seen;
+
+    for (const auto &mutation : mutations)
+    {
+        for (auto id : mutation.ids)
+        {
+            if (seen.insert(id).second) result.push_back(id);
+        }
+    }
+
+    return result;
+}
+
+MutationQueue::MutationQueue()
+  : window_(0), mutex_(), closed_(), deadline_(), open_(false), batches_()
+{
+}
+
+std::chrono::milliseconds MutationQueue::window() const
+{
+    return std::chrono::milliseconds(window_.load(std::memory_order_relaxed));
+}
+
+void MutationQueue::setWindow(std::chrono::milliseconds window)
+{
+    window_.store(window.count(), std::memory_order_relaxed);
+    if (window.count() > 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (open_)
+    {
+        deadline_ = std::chrono::steady_clock::now();
+        closed_.notify_all();
+    }
+}
+
+bool MutationQueue::push(Mutation &&mutation)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<Mutation> taken;
+    supersede(mutation, taken);
+
+    /* Merged into an earlier batch the mutation would go out before the */
+    /* later ones that touch the same ids, it needs a batch of its own.  */
+    std::ptrdiff_t bound = 0;
+    for (auto id : mutation.ids)
+    {
+        bound = std::max(bound, lastTouching(batches_, id));
+    }
+
+    auto target = batches_.end();
+    for (auto it = static_cast<std::ptrdiff_t>(batches_.size()); it-- > bound;)
+    {
+        const auto &batch = batches_[static_cast<std::size_t>(it)];
+        if ((batch.method == mutation.method) &&
+            (batch.arguments == mutation.arguments))
+        {
+            target = batches_.begin() + it;
+            break;
+        }
+    }
+    if (target == batches_.end())
+    {
+        batches_.push_back({ mutation.method, mutation.arguments, {} });
+        target = std::prev(batches_.end());
+    }
+
+    target->mutations.push_back(std::move(mutation));
+    std::move(taken.begin(), taken.end(),
+              std::back_inserter(target->mutations));
+
+    if (open_) return false;
+
+    open_ = true;
+    deadline_ = std::chrono::steady_clock::now() + window();
+    return true;
+}
+
+std::vector<MutationQueue::Batch> MutationQueue::collect()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    /* The deadline is brought forward if the queue gets disabled */
+    while (std::chrono::steady_clock::now() < deadline_)
+    {
+        closed_.wait_until(lock, deadline_);
+    }
+
+    open_ = false;
+    auto batches = std::move(batches_);
+    batches_.clear();
+
+    return batches;
+}
+
+std::vector<MutationQueue::Batch> MutationQueue::collectDue()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_ || (std::chrono::steady_clock::now() < deadline_)) return {};
+
+    open_ = false;
+    auto batches = std::move(batches_);
+    batches_.clear();
+
+    return batches;
+}
+
+std::chrono::milliseconds MutationQueue::remaining()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!open_) return std::chrono::milliseconds(0);
+
+    const auto left = deadline_ - std::chrono::steady_clock::now();
+    if (left <= left.zero()) return std::chrono::milliseconds(0);
+
+    auto rounded = std::chrono::duration_cast<std::chrono::milliseconds>(left);
+    if (rounded < left) ++rounded;
+    return rounded;
+}
+
+void MutationQueue::supersede(Mutation &mutation, std::vector<Mutation> &taken)
+{
+    if (!changesRunState(mutation.method)) return;
+
+    for (auto id : mutation.ids)
+    {
+        const auto last = lastTouching(batches_, id);
+        if (last < 0) continue;
+
+        auto &batch = batches_[static_cast<std::size_t>(last)];
+        if ((batch.method == mutation.method) ||
+            !changesRunState(batch.method))
+        {
+            continue;
+        }
+
+        /* Mutations that are left with nothing to do complete along with */
+        /* the one that took their place.                                  */
+        auto &mutations = batch.mutations;
+        for (auto it = mutations.begin(); it != mutations.end();)
+        {
+            auto &ids = it->ids;
+            if (ids.empty())
+            {
+                ++it;
+                continue;
+            }
+
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+            if (ids.empty())
+            {
+                taken.push_back(std::move(*it));
+                it = mutations.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        const bool pending = std::any_of(
+            mutations.begin(), mutations.end(),
+            [](const Mutation &m) { return !m.ids.empty(); });
+        if (!pending)
+        {
+            std::move(mutations.begin(), mutations.end(),
+                      std::back_inserter(taken));
+            batches_.erase(batches_.begin() + last);
+        }
+    }
+}
@@ -53,6 +53,22 @@
     Unless they fall into the above category or otherwise noted, methods should
     \b not be considered thread-safe.
 
+    Each of the methods that create HTTP requests takes an optional
+    gearbox::CallOptions. A call given a deadline has until then to complete,
+    regardless of gearbox::Session::timeout, and one made with a
+    gearbox::CancellationToken can be cancelled from any thread. Either way
+    the call stops promptly, the transfer is aborted and whatever was received
+    so far is released, and it returns an error instead of partial data.
+
+    ```
+    gearbox::CancellationToken token;
+    auto torrents = session.torrentsAsync(
+        gearbox::CallOptions(token).setTimeout(2000));
+
+    // From the UI thread, when the list is no longer needed
+    token.cancel();
+    ```
+
     Example (without error checking):
     ```
     gearbox::Session session {
@@ -81,8 +97,17 @@
 
 #include "libgearbox_session.h"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <fmt/format.h>
 #include <formats/json_format.h>
@@ -100,7 +125,240 @@ namespace
     constexpr std::uint16_t SESSION_TAG{ 33872 };
     constexpr std::int32_t DEFAULT_TIMEOUT{ 5000 };
     constexpr std::int32_t RETRY_COUNT{ 5 };
+    constexpr std::size_t MAX_QUEUED_TORRENTS{ 64 };
     constexpr const char USER_AGENT[]{ "libGearbox/" LIBGEARBOX_VERSION_STR };
+    constexpr const char SESSION_ID_HEADER[]{ "X-Transmission-Session-Id" };
+
+    /* Appends all that is written through it to the string */
+    class AppendBuffer : public std::streambuf
+    {
+    public:
+        explicit AppendBuffer(std::string &output) : output_(output) {}
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                output_.push_back(traits_type::to_char_type(c));
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *data, std::streamsize size) override
+        {
+            output_.append(data, static_cast<std::size_t>(size));
+            return size;
+        }
+
+    private:
+        std::string &output_;
+    };
+
+    ReturnType<Session::Statistics> toStatistics(session::Response &&response)
+    {
+        Session::Statistics retValue;
+        if (!response.error)
+        {
+            session::Statistics stats;
+            JsonFormat jsonFormat(response.get_arguments());
+            sequential::from_format(jsonFormat, stats);
+            retValue = { stats.get_torrentCount(),
+                         stats.get_activeTorrentCount(),
+                         stats.get_pausedTorrentCount(),
+                         stats.get_downloadSpeed(), stats.get_uploadSpeed() };
+        }
+
+        return ReturnType<Session::Statistics>(std::move(response.error),
+                                               std::move(retValue));
+    }
+
+    ReturnType<std::vector<Torrent>> toTorrents(
+        const std::weak_ptr<SessionPrivate> &session,
+        session::Response &&response,
+        const CallOptions &options)
+    {
+        std::vector<Torrent> retValue;
+        std::vector<TorrentPrivate> torrents;
+
+        if (!response.error)
+        {
+            torrents = TorrentPrivate::decode(response.get_arguments(), session);
+            retValue.reserve(torrents.size());
+            for (std::size_t it = 0; it < torrents.size(); ++it)
+            {
+                if ((it % session::INTERRUPTION_CHECK_INTERVAL == 0) &&
+                    session::interrupted(options))
+                {
+                    response.error = session::interruption(options);
+                    retValue.clear();
+                    break;
+                }
+
+                auto torrent = new TorrentPrivate(std::move(torrents[it]));
+                torrent->session_ = session;
+                retValue.emplace_back(torrent);
+            }
+        }
+
+        return ReturnType<std::vector<Torrent>>(std::move(response.error),
+                                                std::move(retValue));
+    }
+
+    ReturnType<std::vector<std::int32_t>> toRemovedIds(
+        session::Response &&response)
+    {
+        std::vector<std::int32_t> ids;
+        TorrentPrivate::Response torrentResponse;
+
+        if (!response.error)
+        {
+            JsonFormat jsonFormat;
+            jsonFormat.fromJson(response.get_arguments());
+            sequential::from_format(jsonFormat, torrentResponse);
+            ids = torrentResponse.get_removed();
+        }
+
+        return ReturnType<std::vector<std::int32_t>>(std::move(response.error),
+                                                     std::move(ids));
+    }
+
+    nlohmann::json torrentsRequest(FieldSet fields = FieldSet::all(),
+                                   bool tableFormat = false)
+    {
+        nlohmann::json requestValues;
+        requestValues["fields"] =
+            TorrentPrivate::attribute_names(fields | Torrent::Field::Id);
+        if (tableFormat) requestValues["format"] = "table";
+        return requestValues;
+    }
+
+    nlohmann::json recentlyRemovedRequest()
+    {
+        nlohmann::json requestValues;
+        requestValues["ids"] = "recently-active";
+        requestValues["fields"] = TorrentPrivate::attribute_names();
+        return requestValues;
+    }
+
+    nlohmann::json updateTorrentStatsRequest(
+        const std::vector<std::reference_wrapper<Torrent>> &torrents,
+        FieldSet fields,
+        bool tableFormat)
+    {
+        std::vector<std::int32_t> ids;
+        ids.reserve(torrents.size());
+        for (const Torrent &t : torrents) ids.push_back(t.id());
+
+        nlohmann::json requestValues;
+        requestValues["ids"] = ids;
+        requestValues["fields"] =
+            TorrentPrivate::attribute_names(fields | Torrent::Field::Id);
+        if (tableFormat) requestValues["format"] = "table";
+        return requestValues;
+    }
+
+    /* The rows of a torrent-get response by id, along with the table of */
+    /* the header they came with. Each thread that refreshes torrents    */
+    /* keeps one and reuses it from one poll to the next.                */
+    struct RowIndex
+    {
+        nlohmann::json header;
+        TorrentPrivate::Table table{ nlohmann::json::array() };
+        std::vector<std::pair<std::int32_t, std::size_t>> rows;
+
+        /* The first of the rows with id, nullptr if there is none */
+        const std::size_t *find(std::int32_t id) const
+        {
+            const auto row = std::lower_bound(
+                rows.begin(), rows.end(), std::make_pair(id, std::size_t{ 0 }));
+            return ((row != rows.end()) && (row->first == id)) ? &row->second :
+                                                                  nullptr;
+        }
+    };
+
+    RowIndex &rowIndex()
+    {
+        thread_local RowIndex index;
+        return index;
+    }
+
+    MutationQueue::Mutation mutation(const std::string &method,
+                                     nlohmann::json arguments,
+                                     const CallOptions &options,
+                                     MutationQueue::completion_t done)
+    {
+        MutationQueue::Mutation result;
+        result.method = method;
+        result.ids = arguments["ids"].get<std::vector<std::int32_t>>();
+        arguments.erase("ids");
+        result.arguments = arguments.dump();
+        result.options = options;
+        result.done = std::move(done);
+        return result;
+    }
+
+    /* Ends the mutations that were interrupted while queued and takes them */
+    /* out of batch. Returns the error those they took over end with.       */
+    Error dropInterrupted(MutationQueue::Batch &batch)
+    {
+        Error interruption;
+        auto &mutations = batch.mutations;
+        for (auto it = mutations.begin(); it != mutations.end();)
+        {
+            if (!session::interrupted(it->options))
+            {
+                ++it;
+                continue;
+            }
+
+            auto error = session::interruption(it->options);
+            if (!interruption)
+            {
+                interruption =
+                    Error(error.errorCode(), std::string(error.message()));
+            }
+            it->done(std::move(error));
+            it = mutations.erase(it);
+        }
+
+        return interruption;
+    }
+
+    void completeMutations(MutationQueue::Batch &batch, const Error &error)
+    {
+        for (auto &mutation : batch.mutations)
+        {
+            mutation.done(
+                Error(error.errorCode(), std::string(error.message())));
+        }
+    }
+
+    /* The merged call of batch, null if none of its mutations is left */
+    nlohmann::json mergedArguments(const MutationQueue::Batch &batch)
+    {
+        const auto ids = batch.ids();
+        if (ids.empty()) return nullptr;
+
+        auto arguments = json::parse(batch.arguments);
+        arguments["ids"] = ids;
+        return arguments;
+    }
+}
+
+Error session::interruption(const CallOptions &options)
+{
+    if (options.cancelled())
+    {
+        return Error(Error::Code::GearboxCallCancelled, "Call cancelled");
+    }
+    if (options.expired())
+    {
+        return Error(Error::Code::RequestOperationTimedOut,
+                     "Deadline exceeded");
+    }
+
+    return Error();
 }
 
 SessionPrivate::SessionPrivate(const std::string &host,
@@ -109,7 +367,8 @@ SessionPrivate::SessionPrivate(const std::string &host,
                                bool authenticationRequired,
                                const std::string &username,
                                const std::string &password)
-  : sessionId_("dummy"), http_(USER_AGENT)
+  : sessionToken_(), http_(USER_AGENT), maxTorrentsPerCall_(0),
+    mutations_(), tableFormat_(true)
 {
     http_.setHost(host);
     http_.setPath(path);
@@ -117,6 +376,7 @@ SessionPrivate::SessionPrivate(const std::string &host,
     http_.setUsername(username);
     http_.setPassword(password);
     http_.setTimeout(std::chrono::milliseconds(DEFAULT_TIMEOUT));
+    http_.setCapturedHeaders({ SESSION_ID_HEADER, "Content-Length" });
     if (!authenticationRequired) http_.disableAuthentication();
 }
 
@@ -126,7 +386,8 @@ SessionPrivate::SessionPrivate(std::string &&host,
                                bool authenticationRequired,
                                std::string &&username,
                                std::string &&password)
-  : sessionId_("dummy"), http_(USER_AGENT)
+  : sessionToken_(), http_(USER_AGENT), maxTorrentsPerCall_(0),
+    mutations_(), tableFormat_(true)
 {
     http_.setHost(std::move(host));
     http_.setPath(std::move(path));
@@ -134,21 +395,24 @@ SessionPrivate::SessionPrivate(std::string &&host,
     http_.setUsername(std::move(username));
     http_.setPassword(std::move(password));
     http_.setTimeout(std::chrono::milliseconds(DEFAULT_TIMEOUT));
+    http_.setCapturedHeaders({ SESSION_ID_HEADER, "Content-Length" });
     if (!authenticationRequired) http_.disableAuthentication();
 }
 
 session::Response SessionPrivate::sendRequest(const std::string &method,
-                                              nlohmann::json arguments)
+                                              nlohmann::json arguments,
+                                              const CallOptions &options)
 {
-    session::Request request(arguments, method, SESSION_TAG);
     session::Response response;
-    JsonFormat jsonFormat;
-    sequential::to_format(jsonFormat, request);
+    response.error = session::interruption(options);
+    if (response.error)
+    {
+        logResponse(method, arguments, response);
+        return response;
+    }
 
-    LOG_DEBUG("Requesting \"{}\": \n{}", method, jsonFormat.output().dump(4));
-    auto r = http_.createRequest();
-    r.setHeader({ "Content-Type", "application/json" });
-    r.setBody(jsonFormat.output().dump());
+    /* Every attempt sends the body serialized into r the once */
+    auto r = createRequest(method, arguments);
 
     /* As per the Transmission documentation:                                   */
     /* Most Transmission RPC servers require a X-Transmission-Session-Id        */
@@ -159,50 +423,463 @@ session::Response SessionPrivate::sendRequest(const std::string &method,
     /* right X-Transmission-Session-Id in its own headers.                      */
     /* So, the correct way to handle a 409 response is to update your           */
     /* X-Transmission-Session-Id and to resend the previous request.            */
+    /* Concurrent requests share the one token, see SessionToken.               */
     for (std::int32_t it = 0; it < RETRY_COUNT; ++it)
     {
-        r.setHeader({ "X-Transmission-Session-Id", sessionId_ });
+        /* The leader of an asynchronous call completes on the transport */
+        /* thread, a call made from there can't wait for it.             */
+        SessionToken::Ticket ticket;
+        if (http_.isTransportThread())
+        {
+            sessionToken_.acquireNow(ticket);
+        }
+        else if (!sessionToken_.acquire(ticket, options))
+        {
+            response.error = session::interruption(options);
+            break;
+        }
+
+        if (!ticket.value.empty())
+        {
+            r.setHeader({ SESSION_ID_HEADER, ticket.value });
+        }
+        applyCallOptions(r, options);
+
         auto &&result = r.send();
+        if (processResult(result, ticket, response, options)) break;
+    }
+
+    logResponse(method, arguments, response);
+
+    return response;
+}
+
+void SessionPrivate::sendRequestAsync(std::shared_ptr<PendingCall> call)
+{
+    /* Nothing is sent for a call that is over before it started */
+    call->response.error = session::interruption(call->options);
+    if (call->response.error)
+    {
+        logResponse(call->method, call->arguments, call->response);
+        call->callback(std::move(call->response));
+        return;
+    }
+
+    /* Rather than block, the call is sent again once the token is known */
+    auto self = shared_from_this();
+    if (!sessionToken_.tryAcquire(call->ticket, [self, call]() {
+            self->sendRequestAsync(call);
+        }))
+    {
+        return;
+    }
+
+    auto r = createRequest(call->method, call->arguments);
+    if (!call->ticket.value.empty())
+    {
+        r.setHeader({ SESSION_ID_HEADER, call->ticket.value });
+    }
+    applyCallOptions(r, call->options);
+
+    if (call->stream)
+    {
+        auto stream = call->stream.get();
+        http_.setBodyHandler(r, [stream](const char *data, std::size_t size) {
+            stream->feed(data, size);
+        });
+        if (call->shouldPause) http_.setPauseHandler(r, call->shouldPause);
+    }
+
+    /* Keeps the session alive until the call completes */
+    http_.sendAsync(
+        std::move(r), [self, call](gearbox::http::RequestResult &&result) {
+            if (!self->processResult(result, call->ticket, call->response,
+                                     call->options, call->stream.get()) &&
+                (++call->attempt < RETRY_COUNT))
+            {
+                self->sendRequestAsync(call);
+                return;
+            }
+
+            self->logResponse(call->method, call->arguments, call->response);
+            call->callback(std::move(call->response));
+        });
+}
+
+void SessionPrivate::streamRequest(
+    const std::string &method,
+    nlohmann::json arguments,
+    std::vector<std::string> path,
+    JsonArrayStream::element_handler_t onElement,
+    gearbox::http::pause_handler_t shouldPause,
+    std::function<void(session::Response &&)> callback,
+    const CallOptions &options)
+{
+    auto call = std::make_shared<PendingCall>();
+    call->method = method;
+    call->arguments = std::move(arguments);
+    call->options = options;
+    call->callback = std::move(callback);
+    call->stream.reset(
+        new JsonArrayStream(std::move(path), std::move(onElement)));
+    call->shouldPause = std::move(shouldPause);
+    sendRequestAsync(call);
+}
+
+std::vector<Session::BatchResult> SessionPrivate::sendBatch(
+    const std::string &method,
+    const std::vector<std::int32_t> &ids,
+    const nlohmann::json &arguments,
+    const CallOptions &options)
+{
+    std::vector<Session::BatchResult> results;
+
+    /* Once interrupted the calls that are left end without being sent */
+    for (auto &chunk : splitIds(ids))
+    {
+        auto request = arguments;
+        request["ids"] = chunk;
+        auto response = sendRequest(method, std::move(request), options);
+        results.push_back({ std::move(chunk), std::move(response.error) });
+    }
+
+    return results;
+}
+
+Future<std::vector<Session::BatchResult>> SessionPrivate::sendBatchAsync(
+    const std::string &method,
+    const std::vector<std::int32_t> &ids,
+    const nlohmann::json &arguments,
+    const CallOptions &options)
+{
+    using results_t = std::vector<Session::BatchResult>;
+
+    struct Batch
+    {
+        std::mutex mutex;
+        results_t results;
+        std::size_t pending = 0;
+    };
+
+    auto state = std::make_shared<FutureState<results_t, results_t>>(
+        [](results_t &&results) { return std::move(results); });
+
+    auto chunks = splitIds(ids);
+    if (chunks.empty())
+    {
+        state->setValue(results_t());
+        return Future<results_t>(std::move(state));
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->results.resize(chunks.size());
+    batch->pending = chunks.size();
+    for (std::size_t it = 0; it < chunks.size(); ++it)
+    {
+        auto call = std::make_shared<PendingCall>();
+        call->method = method;
+        call->arguments = arguments;
+        call->arguments["ids"] = chunks[it];
+        call->options = options;
+        call->callback = [batch, state, it](session::Response &&response) {
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->results[it].error = std::move(response.error);
+            if (--batch->pending > 0) return;
+
+            lock.unlock();
+            state->setValue(std::move(batch->results));
+        };
+        batch->results[it].ids = std::move(chunks[it]);
+        sendRequestAsync(call);
+    }
+
+    return Future<results_t>(std::move(state));
+}
+
+Error SessionPrivate::sendMutation(const std::string &method,
+                                   nlohmann::json arguments,
+                                   const CallOptions &options)
+{
+    if (mutations_.window().count() == 0)
+    {
+        /* What was queued before the queue got disabled goes out first */
+        sendMutations(mutations_.collectDue());
+        return std::move(
+            sendRequest(method, std::move(arguments), options).error);
+    }
+
+    auto state = std::make_shared<FutureState<Error, Error>>(
+        [](Error &&error) { return std::move(error); });
+    queueMutation(method, std::move(arguments), options,
+                  [state](Error &&error) { state->setValue(std::move(error)); },
+                  false);
+
+    return Future<Error>(std::move(state)).get();
+}
 
-        if (result.error)
+Future<Error> SessionPrivate::sendMutationAsync(const std::string &method,
+                                                nlohmann::json arguments,
+                                                const CallOptions &options)
+{
+    auto state = std::make_shared<FutureState<Error, Error>>(
+        [](Error &&error) { return std::move(error); });
+    auto done = [state](Error &&error) { state->setValue(std::move(error)); };
+
+    if (mutations_.window().count() == 0)
+    {
+        auto batches = mutations_.collectDue();
+        if (batches.empty())
         {
-            LOG_DEBUG("Error: {}", static_cast<std::string>(result.error));
-            response.error =
-                Error(static_cast<Error::Code>(result.error.errorCode),
-                      result.error.message);
-            break;
+            return sendRequestAsync<Error>(
+                method, std::move(arguments),
+                [](session::Response &&response) {
+                    return std::move(response.error);
+                },
+                options);
         }
 
-        if (result.status == gearbox::http::Status::Conflict)
+        /* What was queued before the queue got disabled goes out first, */
+        /* the mutation follows it in a batch of its own.                */
+        auto last = mutation(method, std::move(arguments), options, done);
+        batches.push_back({ last.method, last.arguments, {} });
+        batches.back().mutations.push_back(std::move(last));
+        sendMutationsAsync(
+            std::make_shared<std::vector<MutationQueue::Batch>>(
+                std::move(batches)));
+
+        return Future<Error>(std::move(state));
+    }
+
+    queueMutation(method, std::move(arguments), options, done, true);
+
+    return Future<Error>(std::move(state));
+}
+
+std::vector<std::vector<std::int32_t>> SessionPrivate::splitIds(
+    const std::vector<std::int32_t> &ids) const
+{
+    std::vector<std::vector<std::int32_t>> chunks;
+
+    const auto size = (maxTorrentsPerCall_ > 0) ?
+                          static_cast<std::size_t>(maxTorrentsPerCall_) :
+                          ids.size();
+    for (std::size_t begin = 0; begin < ids.size(); begin += size)
+    {
+        const auto end = std::min(begin + size, ids.size());
+        chunks.emplace_back(ids.begin() + begin, ids.begin() + end);
+    }
+
+    return chunks;
+}
+
+void SessionPrivate::queueMutation(const std::string &method,
+                                   nlohmann::json arguments,
+                                   const CallOptions &options,
+                                   MutationQueue::completion_t done,
+                                   bool detached)
+{
+    if (!mutations_.push(
+            mutation(method, std::move(arguments), options, std::move(done))))
+    {
+        return;
+    }
+
+    if (!detached)
+    {
+        sendMutations(mutations_.collect());
+        return;
+    }
+
+    /* Keeps the session alive until the window is flushed */
+    auto self = shared_from_this();
+    http_.schedule(mutations_.remaining(), [self]() {
+        self->sendMutationsAsync(
+            std::make_shared<std::vector<MutationQueue::Batch>>(
+                self->mutations_.collectDue()));
+    });
+}
+
+void SessionPrivate::sendMutations(std::vector<MutationQueue::Batch> batches)
+{
+    for (auto &batch : batches)
+    {
+        /* The merged call belongs to none of the mutations, it is bounded */
+        /* by the timeout of the session rather than their deadlines.      */
+        auto error = dropInterrupted(batch);
+        auto arguments = mergedArguments(batch);
+        if (!arguments.is_null())
         {
-            sessionId_ = result.response.headers["X-Transmission-Session-Id"];
-            continue;
+            error = std::move(
+                sendRequest(batch.method, std::move(arguments)).error);
         }
 
-        if (result.status == gearbox::http::Status::OK)
+        completeMutations(batch, error);
+    }
+}
+
+void SessionPrivate::sendMutationsAsync(
+    std::shared_ptr<std::vector<MutationQueue::Batch>> batches,
+    std::size_t index)
+{
+    for (; index < batches->size(); ++index)
+    {
+        auto &batch = (*batches)[index];
+        auto interruption = dropInterrupted(batch);
+        auto arguments = mergedArguments(batch);
+        if (arguments.is_null())
         {
-            LOG_DEBUG("{}", result.response.text);
-            jsonFormat.parse(result.response.text);
-            sequential::from_format(jsonFormat, response);
+            completeMutations(batch, interruption);
+            continue;
+        }
+
+        auto call = std::make_shared<PendingCall>();
+        call->method = batch.method;
+        call->arguments = std::move(arguments);
+
+        /* The batches go out in order, each once the previous one is done */
+        auto self = shared_from_this();
+        call->callback = [self, batches, index](session::Response &&response) {
+            completeMutations((*batches)[index], response.error);
+            self->sendMutationsAsync(batches, index + 1);
+        };
+        sendRequestAsync(call);
+        return;
+    }
+}
+
+void SessionPrivate::writeRequestBody(std::string &body,
+                                      const std::string &method,
+                                      const nlohmann::json &arguments) const
+{
+    LOG_DEBUG("Requesting \"{}\": \n{}", method, arguments.dump(4));
+
+    /* Same as session::Request through JsonFormat, without the json of the */
+    /* whole request and the string it is dumped to on the way.             */
+    AppendBuffer buffer(body);
+    std::ostream stream(&buffer);
+    /* Keeps the lookup of << to std and nlohmann, the global namespace may */
+    /* hold overloads that json would have to be checked against.           */
+    using std::operator<<;
+    stream << "{\"arguments\":" << arguments << ",\"method\":" << json(method)
+           << ",\"tag\":" << json(SESSION_TAG) << '}';
+}
+
+HttpRequestHandler::Request SessionPrivate::createRequest(
+    const std::string &method,
+    const nlohmann::json &arguments)
+{
+    auto r = http_.createRequest();
+    r.setHeader({ "Content-Type", "application/json" });
+    http_.writeBody(r, [this, &method, &arguments](std::string &body) {
+        writeRequestBody(body, method, arguments);
+    });
+
+    return r;
+}
+
+void SessionPrivate::applyCallOptions(HttpRequestHandler::Request &request,
+                                      const CallOptions &options)
+{
+    if (options.hasDeadline())
+    {
+        /* A timeout of 0 would mean no timeout at all */
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            options.deadline() - CallOptions::clock_t::now());
+        http_.setTimeout(request,
+                         std::max(remaining, std::chrono::milliseconds(1)));
+    }
+
+    if (options.hasCancellationToken())
+    {
+        http_.setAbortHandler(request,
+                              [options]() { return options.cancelled(); });
+    }
+}
+
+bool SessionPrivate::processResult(gearbox::http::RequestResult &result,
+                                   const SessionToken::Ticket &ticket,
+                                   session::Response &response,
+                                   const CallOptions &options,
+                                   JsonArrayStream *stream)
+{
+    const bool conflict =
+        !result.error && (result.status == gearbox::http::Status::Conflict);
+    if (conflict)
+    {
+        sessionToken_.replace(ticket,
+                              result.response.headers[SESSION_ID_HEADER]);
+    }
+    else
+    {
+        sessionToken_.release(ticket, !result.error);
+    }
+
+    /* Whatever became of the transfer, a call that was cancelled or ran */
+    /* past its deadline ends there, its response is not even parsed.    */
+    response.error = session::interruption(options);
+    if (response.error)
+    {
+        LOG_DEBUG("Interrupted: {}", response.error.message());
+        return true;
+    }
+
+    if (result.error)
+    {
+        LOG_DEBUG("Error: {}", static_cast<std::string>(result.error));
+        response.error = Error(static_cast<Error::Code>(result.error.errorCode),
+                               result.error.message);
+        return true;
+    }
 
-            auto &result = response.get_result();
-            if (result != "success" && !result.empty())
+    if (conflict) return false;
+
+    if (result.status == gearbox::http::Status::OK)
+    {
+        LOG_DEBUG("Received {} bytes, {} once decoded", result.bytes.received,
+                  result.bytes.decoded);
+        LOG_DEBUG("{}", result.response.text);
+        JsonFormat jsonFormat;
+        if (stream != nullptr)
+        {
+            /* Nothing is left in the text if the body was streamed, backends */
+            /* that can't stream have the whole of it there instead.          */
+            stream->feed(result.response.text.data(),
+                         result.response.text.size());
+            if (stream->failed())
             {
-                response.error = std::make_pair(Error::Code::UnknownError,
-                                                std::move(result));
+                response.error =
+                    Error(Error::Code::UnknownError, "Malformed response");
+                return true;
             }
-
-            break;
+            jsonFormat.parse(stream->remainder());
         }
         else
+        {
+            jsonFormat.parse(result.response.text);
+        }
+        sequential::from_format(jsonFormat, response);
+
+        auto &result = response.get_result();
+        if (result != "success" && !result.empty())
         {
             response.error =
-                std::make_pair(static_cast<Error::Code>(result.status.code()),
-                               result.status.name());
-            break;
+                std::make_pair(Error::Code::UnknownError, std::move(result));
         }
     }
+    else
+    {
+        response.error =
+            std::make_pair(static_cast<Error::Code>(result.status.code()),
+                           result.status.name());
+    }
+
+    return true;
+}
 
+void SessionPrivate::logResponse(const std::string &method,
+                                 const nlohmann::json &arguments,
+                                 const session::Response &response) const
+{
     if (response.error)
         LOG_ERROR(
             "Error '{} {}' while issuing method call '{}' with arguments\n'{}'",
@@ -212,8 +889,6 @@ session::Response SessionPrivate::sendRequest(const std::string &method,
         LOG_DEBUG("Method call '{}' result '{}' for tag '{}':\n{}", method,
                   response.get_result(), response.get_tag(),
                   response.get_arguments().dump(4));
-
-    return response;
 }
 
 /*!
@@ -246,16 +921,38 @@ session::Response SessionPrivate::sendRequest(const std::string &method,
     \brief When passed to gearbox::Session::setSSLErrorHandling, all SSL-related errors are reported
 
     \var gearbox::Session::Ignore
-    \brief When passed to gearbox::Session::setSSLErrorHandling, all SSL-related errors are ignored 
+    \brief When passed to gearbox::Session::setSSLErrorHandling, all SSL-related errors are ignored
 */
 
 /*!
-    \class gearbox::Session::Statistics
-    \brief Represents a collection of statistics from the server
+    \enum gearbox::Session::Compression
+    \brief Verbose boolean type for response compression
+
+    \var gearbox::Session::Enabled
+    \brief Responses may be compressed by the server
+
+    \var gearbox::Session::Disabled
+    \brief Responses are always sent uncompressed
 */
 
 /*!
-    \var gearbox::Session::Statistics::totalTorrentCount
+    \enum gearbox::Session::HttpVersion
+    \brief Enumerates the versions of the HTTP protocol a session can use
+
+    \var gearbox::Session::Http1_1
+    \brief Requests are sent over HTTP/1.1, each on a connection of its own
+
+    \var gearbox::Session::Http2
+    \brief Requests are sent over HTTP/2 and share a multiplexed connection
+*/
+
+/*!
+    \class gearbox::Session::Statistics
+    \brief Represents a collection of statistics from the server
+*/
+
+/*!
+    \var gearbox::Session::Statistics::totalTorrentCount
 
     The total number of torrents, in all states; stopped, checking, downloading,
     seeding, queued.
@@ -285,236 +982,891 @@ session::Response SessionPrivate::sendRequest(const std::string &method,
     The overall upload speed, in bytes.
 */
 
+/*!
+    \class gearbox::Session::ConnectionStatistics
+    \brief Counts how the connections used by a session came to be
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::reusedConnections
+
+    The number of requests that were sent over an already open connection.
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::newConnections
+
+    The number of connections that had to be opened to send requests.
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::receivedBytes
+
+    The number of response body bytes received, as sent by the server; when
+    the responses are compressed this is their compressed size.
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::decodedBytes
+
+    The number of response body bytes after decompression.
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::dnsLookups
+
+    The number of host name lookups that could not be answered from the DNS
+    cache.
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::connectionHitRate
+
+    The share, between 0 and 1, of requests that were sent over an already
+    open connection.
+*/
+
+/*!
+    \var gearbox::Session::ConnectionStatistics::dnsHitRate
+
+    The share, between 0 and 1, of new connections whose host name was
+    found in the DNS cache.
+*/
+
 /*!
     Constructs an empty gearbox::Session
 */
-Session::Session()
-  : priv_(new SessionPrivate("", DEFAULT_PATH, -1, false, "", ""))
+Session::Session()
+  : priv_(new SessionPrivate("", DEFAULT_PATH, -1, false, "", ""))
+{
+}
+
+/*!
+    Move constructor
+*/
+Session::Session(Session &&other) : priv_(std::move(other.priv_)) {}
+
+/*!
+    Move asignment operator
+*/
+Session &Session::operator=(Session &&other)
+{
+    priv_ = std::move(other.priv_);
+
+    return *this;
+}
+
+/*!
+    Constructs a gearbox::Session with the supplied information
+
+    All parameters, except for the \c host, are optional.
+    If passing a \c username and \c password but setting \c authentication to
+    gearbox::Session::Authentication::None they will be stored but ignored.
+    This means that you can turn on authentication later via
+    gearbox::Session::setAuthentication and the cached \c username and
+    \c password are used.
+
+    Unless specified, the \c port is automatically detected from the supplied
+    \c host parameter, 443 for HTTPS and 80 otherwise. This behaviour can be
+    enforced by passing gearbox::Session::PORT_AUTODETECT as this parameter.
+
+    For more information about the format in which the host and path are
+    expected see their respective documentation, gearbox::Session::setHost and
+    gearbox::Session::setPath
+*/
+Session::Session(const std::string &host,
+                 const std::string &path,
+                 std::int32_t port,
+                 Authentication authentication,
+                 const std::string &username,
+                 const std::string &password)
+  : priv_(new SessionPrivate(host,
+                             path,
+                             port,
+                             authentication == Authentication::Required,
+                             username,
+                             password))
+{
+}
+
+/*!
+    Constructs a gearbox::Session with the supplied information
+
+    All parameters, except for the \c host, are optional.
+    If passing a \c username and \c password but setting \c authentication to
+    gearbox::Session::Authentication::None they will be stored but ignored.
+    This means that you can turn on authentication later via
+    gearbox::Session::setAuthentication and the cached \c username and
+    \c password are used.
+
+    Unless specified, the \c port is automatically detected from the supplied
+    \c host parameter, 443 for HTTPS and 80 otherwise. This behaviour can be
+    enforced by passing gearbox::Session::PORT_AUTODETECT as this parameter.
+
+    For more information about the format in which the host and path are
+    expected see their respective documentation, gearbox::Session::setHost and
+    gearbox::Session::setPath
+
+    This constructor moves the data into the instance, instead of copying it
+    as the previous one.
+*/
+Session::Session(std::string &&host,
+                 std::string &&path,
+                 std::int32_t port,
+                 Authentication authentication,
+                 std::string &&username,
+                 std::string &&password)
+  : priv_(new SessionPrivate(host,
+                             path,
+                             port,
+                             authentication == Authentication::Required,
+                             username,
+                             password))
+{
+}
+
+/*!
+    Returns a set of statistics from the server.
+
+    This method is thread-safe.
+*/
+ReturnType<Session::Statistics> Session::statistics(
+    const CallOptions &options) const
+{
+    return toStatistics(
+        priv_->sendRequest("session-stats", nlohmann::json(), options));
+}
+
+/*!
+    Returns a list of all active and inactive torrents on the server.
+
+    The lifetime of these objects is tied to the gearbox::Session wich returns
+    them.
+
+    The torrents are asked for in the "table" format, a header row with the
+    names of the fields followed by a row of values for each torrent, which
+    is about half the size of the usual list of objects and is decoded by
+    position. Daemons that don't support it answer with objects, and are not
+    asked for it again for as long as the session lives.
+
+    This method is thread-safe.
+*/
+ReturnType<std::vector<Torrent>> Session::torrents(
+    const CallOptions &options) const
+{
+    return toTorrents(
+        priv_,
+        priv_->sendRequest("torrent-get",
+                           torrentsRequest(FieldSet::all(),
+                                           priv_->tableFormat()),
+                           options),
+        options);
+}
+
+/*!
+    Same as gearbox::Session::torrents but only requests the supplied
+    \c fields, gearbox::Torrent::Field::Id is always requested. The other
+    attributes of the returned torrents hold default values.
+
+    Asking for only what is displayed keeps both the daemon's serialization
+    and the decoding of the response proportional to the fields that are
+    used, e.g.:
+    ```
+    session.torrents(gearbox::Torrent::Field::Name |
+                     gearbox::Torrent::Field::PercentDone);
+    ```
+
+    This method is thread-safe.
+*/
+ReturnType<std::vector<Torrent>> Session::torrents(
+    FieldSet fields,
+    const CallOptions &options) const
+{
+    return toTorrents(
+        priv_,
+        priv_->sendRequest("torrent-get",
+                           torrentsRequest(fields, priv_->tableFormat()),
+                           options),
+        options);
+}
+
+/*!
+    Returns a list of gearbox::Torrent::id that were "recently" removed from
+    the server.
+
+    This method is thread-safe.
+*/
+ReturnType<std::vector<std::int32_t>> Session::recentlyRemoved(
+    const CallOptions &options) const
+{
+    return toRemovedIds(
+        priv_->sendRequest("torrent-get", recentlyRemovedRequest(), options));
+}
+
+/*!
+    Updates the data associated with the supplied gearbox::Torrent(s).
+
+    The response format is negotiated the same way as by
+    gearbox::Session::torrents.
+
+    This method is thread-safe.
+*/
+Error Session::updateTorrentStats(
+    std::vector<std::reference_wrapper<Torrent>> &torrents,
+    const CallOptions &options)
+{
+    return updateTorrentStats(torrents, FieldSet::all(), options);
+}
+
+/*!
+    Same as gearbox::Session::updateTorrentStats but only requests, and
+    updates, the supplied \c fields; the other attributes of the torrents
+    keep the values they had.
+
+    This method is thread-safe.
+*/
+Error Session::updateTorrentStats(
+    std::vector<std::reference_wrapper<Torrent>> &torrents,
+    FieldSet fields,
+    const CallOptions &options)
+{
+    return updateTorrentStats(
+        priv_, torrents, fields,
+        priv_->sendRequest("torrent-get",
+                           updateTorrentStatsRequest(torrents, fields,
+                                                     priv_->tableFormat()),
+                           options),
+        options);
+}
+
+/*!
+    Invokes callback with each of the torrents on the server, same as those
+    returned by gearbox::Session::torrents, as soon as it is received.
+
+    The response is parsed while it is still coming in, one torrent at a time,
+    so neither the whole response nor the whole list of torrents is ever held
+    in memory: while the callback lags behind, the transfer is held back once
+    a few dozen torrents are waiting to be parsed. The callback is invoked
+    from the calling thread which blocks until the response is complete.
+
+    If an error is returned the callback may already have been invoked for
+    some of the torrents.
+
+    A cancelled call, or one that runs past its deadline, returns as soon as
+    the callback returns, while the transfer is aborted in the background.
+
+    This method is thread-safe.
+*/
+Error Session::forEachTorrent(const std::function<void(Torrent &&)> &callback,
+                              const CallOptions &options) const
+{
+    struct Queue
+    {
+        std::mutex mutex;
+        std::condition_variable ready;
+        std::condition_variable room;
+        std::deque<std::string> elements;
+        /* Set while the shared transport has the transfer paused */
+        std::function<void()> resume;
+        bool done = false;
+        bool abandoned = false;
+        Error error;
+    };
+
+    auto queue = std::make_shared<Queue>();
+    auto self = priv_;
+    priv_->streamRequest(
+        "torrent-get", torrentsRequest(), { "arguments", "torrents" },
+        [queue, self](std::string &&element) {
+            std::unique_lock<std::mutex> lock(queue->mutex);
+            /* A transfer on a thread of its own can wait for room, one on */
+            /* the shared transport is paused before it gets here.         */
+            if (!self->http_.isTransportThread())
+            {
+                queue->room.wait(lock, [&queue]() {
+                    return queue->abandoned ||
+                           (queue->elements.size() < MAX_QUEUED_TORRENTS);
+                });
+            }
+            if (queue->abandoned) return;
+            queue->elements.push_back(std::move(element));
+            queue->ready.notify_one();
+        },
+        [queue](const std::function<void()> &resume) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            if (queue->abandoned ||
+                (queue->elements.size() < MAX_QUEUED_TORRENTS))
+            {
+                return false;
+            }
+            queue->resume = resume;
+            return true;
+        },
+        [queue](session::Response &&response) {
+            std::lock_guard<std::mutex> lock(queue->mutex);
+            queue->error = std::move(response.error);
+            queue->done = true;
+            queue->ready.notify_one();
+        },
+        options);
+
+    /* Torrents are parsed here, while the next ones are being received. */
+    /* Waiting stops at the deadline, a cancellation ends it as soon as  */
+    /* the transfer is aborted.                                          */
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    for (;;)
+    {
+        auto available = [&queue]() {
+            return queue->done || !queue->elements.empty();
+        };
+        if (options.hasDeadline())
+        {
+            queue->ready.wait_until(lock, options.deadline(), available);
+        }
+        else
+        {
+            queue->ready.wait(lock, available);
+        }
+
+        if (session::interrupted(options))
+        {
+            /* Whatever was received so far goes with the queue, a paused */
+            /* transfer is resumed for it to be aborted.                  */
+            queue->abandoned = true;
+            queue->elements.clear();
+            std::function<void()> resume;
+            resume.swap(queue->resume);
+            queue->room.notify_one();
+            lock.unlock();
+
+            if (resume) resume();
+            return session::interruption(options);
+        }
+        if (queue->elements.empty()) break;
+
+        auto element = std::move(queue->elements.front());
+        queue->elements.pop_front();
+        queue->room.notify_one();
+
+        /* Half way through leaves the transport room for a chunk or two */
+        std::function<void()> resume;
+        if (queue->elements.size() <= MAX_QUEUED_TORRENTS / 2)
+        {
+            resume.swap(queue->resume);
+        }
+        lock.unlock();
+
+        if (resume) resume();
+
+        JsonFormat jsonFormat;
+        jsonFormat.fromJson(json::parse(element));
+        auto torrent = new TorrentPrivate();
+        sequential::from_format(jsonFormat, *torrent);
+        torrent->session_ = priv_;
+        callback(Torrent(torrent));
+
+        lock.lock();
+    }
+
+    return std::move(queue->error);
+}
+
+/*!
+    Starts the supplied torrents, see gearbox::Torrent::start.
+
+    Unlike calling the method on each of the torrents, which takes a round
+    trip per torrent, all of them are handled by a single call; or by one
+    call for every gearbox::Session::maxTorrentsPerCall of them, one after
+    the other. Each of the calls is reported on, along with the ids that
+    were sent with it, in the order in which they were sent. Nothing is
+    sent for an empty list.
+
+    Torrents are addressed by id, either directly or through a list of
+    gearbox::Torrent, in which case invalid torrents are left out.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::startTorrents(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("torrent-start", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Starts the supplied torrents ignoring the queue, see
+    gearbox::Torrent::startNow.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::startTorrentsNow(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("torrent-start-now", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Stops the supplied torrents, see gearbox::Torrent::stop.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::stopTorrents(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("torrent-stop", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Verifies the downloaded data of the supplied torrents, see
+    gearbox::Torrent::verify.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::verifyTorrents(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("torrent-verify", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Asks the trackers of the supplied torrents for more peers, see
+    gearbox::Torrent::askForMorePeers.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::askForMorePeers(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("torrent-reannounce", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Removes the supplied torrents from the server, see gearbox::Torrent::remove.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::removeTorrents(
+    const TorrentIds &torrents,
+    Torrent::LocalDataAction action,
+    const CallOptions &options)
+{
+    nlohmann::json arguments;
+    arguments["delete-local-data"] =
+        (action == Torrent::LocalDataAction::DeleteFiles);
+    return priv_->sendBatch("torrent-remove", torrents.ids(), arguments,
+                            options);
+}
+
+/*!
+    Moves the supplied torrents one position up in the queue.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::queueMoveUp(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("queue-move-up", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Moves the supplied torrents one position down in the queue.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::queueMoveDown(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("queue-move-down", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Moves the supplied torrents to the top of the queue.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::queueMoveTop(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("queue-move-top", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Moves the supplied torrents to the bottom of the queue.
+
+    The torrents are sent the same way as by
+    gearbox::Session::startTorrents.
+
+    This method is thread-safe.
+*/
+std::vector<Session::BatchResult> Session::queueMoveBottom(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatch("queue-move-bottom", torrents.ids(),
+                            nlohmann::json(), options);
+}
+
+/*!
+    Same as gearbox::Session::statistics but returns immediately, the result
+    is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<ReturnType<Session::Statistics>> Session::statisticsAsync(
+    const CallOptions &options) const
+{
+    return priv_->sendRequestAsync<ReturnType<Statistics>>(
+        "session-stats", nlohmann::json(), &toStatistics, options);
+}
+
+/*!
+    Same as gearbox::Session::torrents but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<ReturnType<std::vector<Torrent>>> Session::torrentsAsync(
+    const CallOptions &options) const
+{
+    return torrentsAsync(FieldSet::all(), options);
+}
+
+/*!
+    Same as gearbox::Session::torrents(gearbox::FieldSet, const
+    gearbox::CallOptions &) but returns immediately, the result is delivered
+    through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<ReturnType<std::vector<Torrent>>> Session::torrentsAsync(
+    FieldSet fields,
+    const CallOptions &options) const
+{
+    std::weak_ptr<SessionPrivate> session = priv_;
+    return priv_->sendRequestAsync<ReturnType<std::vector<Torrent>>>(
+        "torrent-get", torrentsRequest(fields, priv_->tableFormat()),
+        [session, options](session::Response &&response) {
+            return toTorrents(session, std::move(response), options);
+        },
+        options);
+}
+
+/*!
+    Same as gearbox::Session::recentlyRemoved but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<ReturnType<std::vector<std::int32_t>>> Session::recentlyRemovedAsync(
+    const CallOptions &options) const
+{
+    return priv_->sendRequestAsync<ReturnType<std::vector<std::int32_t>>>(
+        "torrent-get", recentlyRemovedRequest(), &toRemovedIds, options);
+}
+
+/*!
+    Same as gearbox::Session::updateTorrentStats but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    The supplied gearbox::Torrent(s) are updated by whichever thread consumes
+    the future, they have to stay alive, and should not be touched, until it
+    is ready.
+
+    This method is thread-safe.
+*/
+Future<Error> Session::updateTorrentStatsAsync(
+    std::vector<std::reference_wrapper<Torrent>> &torrents,
+    const CallOptions &options)
+{
+    return updateTorrentStatsAsync(torrents, FieldSet::all(), options);
+}
+
+/*!
+    Same as gearbox::Session::updateTorrentStats, with the supplied
+    \c fields, but returns immediately, the result is delivered through the
+    returned gearbox::Future.
+
+    The same restrictions as for gearbox::Session::updateTorrentStatsAsync
+    apply to the supplied gearbox::Torrent(s).
+
+    This method is thread-safe.
+*/
+Future<Error> Session::updateTorrentStatsAsync(
+    std::vector<std::reference_wrapper<Torrent>> &torrents,
+    FieldSet fields,
+    const CallOptions &options)
+{
+    std::weak_ptr<SessionPrivate> session = priv_;
+    return priv_->sendRequestAsync<Error>(
+        "torrent-get",
+        updateTorrentStatsRequest(torrents, fields, priv_->tableFormat()),
+        [session, torrents, fields,
+         options](session::Response &&response) mutable {
+            return updateTorrentStats(session, torrents, fields,
+                                      std::move(response), options);
+        },
+        options);
+}
+
+/*!
+    Same as gearbox::Session::startTorrents but returns immediately, the
+    result is delivered through the returned gearbox::Future. All of the
+    calls are in flight at the same time.
+
+    This method is thread-safe.
+*/
+Future<std::vector<Session::BatchResult>> Session::startTorrentsAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
 {
+    return priv_->sendBatchAsync("torrent-start", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Move constructor
-*/
-Session::Session(Session &&other) : priv_(std::move(other.priv_)) {}
+    Same as gearbox::Session::startTorrentsNow but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
-/*!
-    Move asignment operator
+    This method is thread-safe.
 */
-Session &Session::operator=(Session &&other)
+Future<std::vector<Session::BatchResult>> Session::startTorrentsNowAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
 {
-    priv_ = std::move(other.priv_);
-
-    return *this;
+    return priv_->sendBatchAsync("torrent-start-now", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Constructs a gearbox::Session with the supplied information
-
-    All parameters, except for the \c host, are optional.
-    If passing a \c username and \c password but setting \c authentication to
-    gearbox::Session::Authentication::None they will be stored but ignored.
-    This means that you can turn on authentication later via
-    gearbox::Session::setAuthentication and the cached \c username and
-    \c password are used.
-
-    Unless specified, the \c port is automatically detected from the supplied
-    \c host parameter, 443 for HTTPS and 80 otherwise. This behaviour can be
-    enforced by passing gearbox::Session::PORT_AUTODETECT as this parameter.
+    Same as gearbox::Session::stopTorrents but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
-    For more information about the format in which the host and path are
-    expected see their respective documentation, gearbox::Session::setHost and
-    gearbox::Session::setPath
+    This method is thread-safe.
 */
-Session::Session(const std::string &host,
-                 const std::string &path,
-                 std::int32_t port,
-                 Authentication authentication,
-                 const std::string &username,
-                 const std::string &password)
-  : priv_(new SessionPrivate(host,
-                             path,
-                             port,
-                             authentication == Authentication::Required,
-                             username,
-                             password))
+Future<std::vector<Session::BatchResult>> Session::stopTorrentsAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
 {
+    return priv_->sendBatchAsync("torrent-stop", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Constructs a gearbox::Session with the supplied information
-
-    All parameters, except for the \c host, are optional.
-    If passing a \c username and \c password but setting \c authentication to
-    gearbox::Session::Authentication::None they will be stored but ignored.
-    This means that you can turn on authentication later via
-    gearbox::Session::setAuthentication and the cached \c username and
-    \c password are used.
+    Same as gearbox::Session::verifyTorrents but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
-    Unless specified, the \c port is automatically detected from the supplied
-    \c host parameter, 443 for HTTPS and 80 otherwise. This behaviour can be
-    enforced by passing gearbox::Session::PORT_AUTODETECT as this parameter.
-
-    For more information about the format in which the host and path are
-    expected see their respective documentation, gearbox::Session::setHost and
-    gearbox::Session::setPath
-
-    This constructor moves the data into the instance, instead of copying it
-    as the previous one.
+    This method is thread-safe.
 */
-Session::Session(std::string &&host,
-                 std::string &&path,
-                 std::int32_t port,
-                 Authentication authentication,
-                 std::string &&username,
-                 std::string &&password)
-  : priv_(new SessionPrivate(host,
-                             path,
-                             port,
-                             authentication == Authentication::Required,
-                             username,
-                             password))
+Future<std::vector<Session::BatchResult>> Session::verifyTorrentsAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
 {
+    return priv_->sendBatchAsync("torrent-verify", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Returns a set of statistics from the server.
+    Same as gearbox::Session::askForMorePeers but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
     This method is thread-safe.
 */
-ReturnType<Session::Statistics> Session::statistics() const
+Future<std::vector<Session::BatchResult>> Session::askForMorePeersAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
 {
-    Session::Statistics retValue;
-    session::Response response(priv_->sendRequest("session-stats"));
-    if (!response.error)
-    {
-        session::Statistics stats;
-        JsonFormat jsonFormat(response.get_arguments());
-        sequential::from_format(jsonFormat, stats);
-        retValue = { stats.get_torrentCount(), stats.get_activeTorrentCount(),
-                     stats.get_pausedTorrentCount(), stats.get_downloadSpeed(),
-                     stats.get_uploadSpeed() };
-    }
-
-    return ReturnType<Session::Statistics>(std::move(response.error),
-                                           std::move(retValue));
+    return priv_->sendBatchAsync("torrent-reannounce", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Returns a list of all active and inactive torrents on the server.
-
-    The lifetime of these objects is tied to the gearbox::Session wich returns
-    them.
+    Same as gearbox::Session::removeTorrents but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
     This method is thread-safe.
 */
-ReturnType<std::vector<Torrent>> Session::torrents() const
+Future<std::vector<Session::BatchResult>> Session::removeTorrentsAsync(
+    const TorrentIds &torrents,
+    Torrent::LocalDataAction action,
+    const CallOptions &options)
 {
-    std::vector<Torrent> retValue;
-    std::vector<TorrentPrivate> torrents;
-    TorrentPrivate::Response torrentResponse;
-
-    const auto &fields = TorrentPrivate::attribute_names();
-    nlohmann::json requestValues;
-    requestValues["fields"] = fields;
-    session::Response response(
-        priv_->sendRequest("torrent-get", requestValues));
+    nlohmann::json arguments;
+    arguments["delete-local-data"] =
+        (action == Torrent::LocalDataAction::DeleteFiles);
+    return priv_->sendBatchAsync("torrent-remove", torrents.ids(), arguments,
+                                 options);
+}
 
-    if (!response.error)
-    {
-        JsonFormat jsonFormat;
-        jsonFormat.fromJson(response.get_arguments());
-        sequential::from_format(jsonFormat, torrentResponse);
-        torrents = torrentResponse.get_torrents();
-        for (TorrentPrivate &torrentPriv : torrents)
-        {
-            auto torrent = new TorrentPrivate(std::move(torrentPriv));
-            torrent->session_ = this->priv_;
-            retValue.emplace_back(torrent);
-        }
-    }
+/*!
+    Same as gearbox::Session::queueMoveUp but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
-    return ReturnType<std::vector<Torrent>>(std::move(response.error),
-                                            std::move(retValue));
+    This method is thread-safe.
+*/
+Future<std::vector<Session::BatchResult>> Session::queueMoveUpAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatchAsync("queue-move-up", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Returns a list of gearbox::Torrent::id that were "recently" removed from
-    the server.
+    Same as gearbox::Session::queueMoveDown but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
     This method is thread-safe.
 */
-ReturnType<std::vector<std::int32_t>> Session::recentlyRemoved() const
+Future<std::vector<Session::BatchResult>> Session::queueMoveDownAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
 {
-    std::vector<std::int32_t> ids;
-    TorrentPrivate::Response torrentResponse;
-
-    const auto &fields = TorrentPrivate::attribute_names();
-    nlohmann::json requestValues;
-    requestValues["ids"] = "recently-active";
-    requestValues["fields"] = fields;
-    session::Response response(
-        priv_->sendRequest("torrent-get", requestValues));
+    return priv_->sendBatchAsync("queue-move-down", torrents.ids(),
+                                 nlohmann::json(), options);
+}
 
-    if (!response.error)
-    {
-        JsonFormat jsonFormat;
-        jsonFormat.fromJson(response.get_arguments());
-        sequential::from_format(jsonFormat, torrentResponse);
-        ids = torrentResponse.get_removed();
-    }
+/*!
+    Same as gearbox::Session::queueMoveTop but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
-    return ReturnType<std::vector<std::int32_t>>(std::move(response.error),
-                                                 std::move(ids));
+    This method is thread-safe.
+*/
+Future<std::vector<Session::BatchResult>> Session::queueMoveTopAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatchAsync("queue-move-top", torrents.ids(),
+                                 nlohmann::json(), options);
 }
 
 /*!
-    Updates the data associated with the supplied gearbox::Torrent(s).
+    Same as gearbox::Session::queueMoveBottom but returns immediately, the
+    result is delivered through the returned gearbox::Future.
 
     This method is thread-safe.
 */
+Future<std::vector<Session::BatchResult>> Session::queueMoveBottomAsync(
+    const TorrentIds &torrents,
+    const CallOptions &options)
+{
+    return priv_->sendBatchAsync("queue-move-bottom", torrents.ids(),
+                                 nlohmann::json(), options);
+}
+
 Error Session::updateTorrentStats(
-    std::vector<std::reference_wrapper<Torrent>> &torrents)
+    const std::weak_ptr<SessionPrivate> &session,
+    std::vector<std::reference_wrapper<Torrent>> &torrents,
+    FieldSet fields,
+    session::Response &&response,
+    const CallOptions &options)
 {
-    std::vector<std::int32_t> ids;
-    ids.reserve(torrents.size());
-    for (Torrent &t : torrents) ids.push_back(t.id());
+    if (response.error) return std::move(response.error);
+
+    /* The response is indexed once instead of being scanned for each of */
+    /* the torrents. The index keeps its capacity, polling the same      */
+    /* torrents over and over allocates nothing to look them up.         */
+    auto &index = rowIndex();
+    index.rows.clear();
+
+    /* The torrents are refreshed in place, only the fields that changed */
+    /* are written. Torrents that are already refreshed stay that way,   */
+    /* an interrupted update leaves the rest of them as they were.       */
+    auto refreshAll = [&](const auto &refresh) {
+        std::size_t count = 0;
+        for (Torrent &t : torrents)
+        {
+            if ((count++ % session::INTERRUPTION_CHECK_INTERVAL == 0) &&
+                session::interrupted(options))
+            {
+                return session::interruption(options);
+            }
+
+            auto row = index.find(t.id());
+            if (row == nullptr)
+            {
+                t.priv_.reset();
+                continue;
+            }
 
-    TorrentPrivate::Response torrentResponse;
+            refresh(*t.priv_, *row);
+            t.priv_->session_ = session;
+        }
 
-    const auto &fields = TorrentPrivate::attribute_names();
-    nlohmann::json requestValues;
-    requestValues["ids"] = ids;
-    requestValues["fields"] = fields;
-    session::Response response(
-        priv_->sendRequest("torrent-get", requestValues));
+        return Error();
+    };
 
-    if (!response.error)
+    const auto &arguments = response.get_arguments();
+    if (auto rows = TorrentPrivate::tableRows(arguments, session))
     {
-        JsonFormat jsonFormat;
-        jsonFormat.fromJson(response.get_arguments());
-        sequential::from_format(jsonFormat, torrentResponse);
+        /* The daemon answers every poll with the same header */
+        if (rows->front() != index.header)
+        {
+            index.header = rows->front();
+            index.table = TorrentPrivate::Table(index.header);
+        }
 
-        auto &updatedTorrents = torrentResponse.get_torrents();
-        for (Torrent &t : torrents)
+        const auto &table = index.table;
+        for (std::size_t it = 1; it < rows->size(); ++it)
         {
-            bool found = false;
-            for (auto &torrentPriv : updatedTorrents)
-            {
-                if (torrentPriv.get_id() == t.id())
-                {
-                    auto torrent = new TorrentPrivate(std::move(torrentPriv));
-                    torrent->session_ = this->priv_;
-                    t.priv_.reset(torrent);
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) t.priv_.reset();
+            const auto id = table.id((*rows)[it]);
+            if (id >= 0) index.rows.emplace_back(id, it);
         }
+        std::sort(index.rows.begin(), index.rows.end());
+
+        return refreshAll([&](TorrentPrivate &priv, std::size_t index) {
+            table.refresh((*rows)[index], priv, fields);
+        });
     }
 
-    return std::move(response.error);
+    auto updatedTorrents = TorrentPrivate::decode(arguments, session);
+    for (std::size_t it = 0; it < updatedTorrents.size(); ++it)
+    {
+        index.rows.emplace_back(updatedTorrents[it].get_id(), it);
+    }
+    std::sort(index.rows.begin(), index.rows.end());
+
+    return refreshAll([&](TorrentPrivate &priv, std::size_t index) {
+        priv.refresh(std::move(updatedTorrents[index]), fields);
+    });
 }
 
 /*!
@@ -699,3 +2051,366 @@ void Session::setSSLErrorHandling(Session::SSLErrorHandling value)
     priv_->http_.setSSLErrorHandling(
         static_cast<gearbox::http::SSLErrorHandling>(value));
 }
+
+/*!
+    Returns whether the server is allowed to compress its responses.
+*/
+bool Session::compressionEnabled() const
+{
+#ifdef LIBGEARBOX_HTTP_COMPRESSION
+    return priv_->http_.compressionEnabled();
+#else
+    return false;
+#endif
+}
+
+/*!
+    Sets whether the server is allowed to compress its responses.
+
+    When enabled requests advertise gzip and deflate through the
+    Accept-Encoding header and compressed responses are decoded as they
+    arrive. Lists of torrents, and of files, compress very well which pays off
+    on slow links; for a daemon on the same host it can be worth disabling to
+    save the CPU time. The savings are reported by
+    gearbox::Session::connectionStatistics. This option defaults to
+    Session::Compression::Enabled.
+
+    Currently only the cURL based backend (Linux) supports compression.
+*/
+void Session::setCompression(Session::Compression value)
+{
+#ifdef LIBGEARBOX_HTTP_COMPRESSION
+    if (value == Session::Compression::Enabled)
+    {
+        priv_->http_.enableCompression();
+    }
+    else
+    {
+        priv_->http_.disableCompression();
+    }
+#else
+    static_cast<void>(value);
+#endif
+}
+
+/*!
+    Returns the version of the HTTP protocol used when making requests.
+*/
+Session::HttpVersion Session::httpVersion() const
+{
+#ifdef LIBGEARBOX_HTTP2
+    return static_cast<Session::HttpVersion>(priv_->http_.httpVersion());
+#else
+    return Session::HttpVersion::Http1_1;
+#endif
+}
+
+/*!
+    Sets the version of the HTTP protocol that is to be used when making
+    requests.
+
+    With Session::HttpVersion::Http2 requests that are in flight at the same
+    time are multiplexed over a single connection, instead of each opening a
+    connection of its own. This is mostly useful when the daemon sits behind
+    a reverse proxy that supports HTTP/2. For HTTPS hosts HTTP/2 is
+    negotiated and HTTP/1.1 is used if the server does not support it; for
+    plain HTTP hosts the server has to speak HTTP/2 directly. This option
+    defaults to Session::HttpVersion::Http1_1.
+
+    Currently only the cURL based backend (Linux) supports HTTP/2, and
+    requests are only multiplexed when it is built with LIBGEARBOX_CURL_MULTI.
+*/
+void Session::setHttpVersion(Session::HttpVersion value)
+{
+#ifdef LIBGEARBOX_HTTP2
+    priv_->http_.setHttpVersion(static_cast<gearbox::http::Version>(value));
+#else
+    static_cast<void>(value);
+#endif
+}
+
+/*!
+    Returns the path of the Unix domain socket that requests are sent
+    through, empty if they go to the host directly.
+*/
+const std::string &Session::unixSocketPath() const
+{
+#ifdef LIBGEARBOX_HTTP_UNIX_SOCKET
+    return priv_->http_.unixSocketPath();
+#else
+    static const std::string none;
+    return none;
+#endif
+}
+
+/*!
+    Sets the path of a Unix domain socket through which requests are sent,
+    instead of opening a TCP connection to the host.
+
+    This is meant for a daemon, or a proxy in front of it, that runs on the
+    same machine and listens on a Unix domain socket; it saves the overhead
+    of going through the loopback interface on every request. The host,
+    port and path are still used to build the request itself, e.g. for the
+    Host header. An empty path, the default, connects to the host.
+
+    Currently only the cURL based backend (Linux) supports Unix domain
+    sockets.
+*/
+void Session::setUnixSocketPath(const std::string &path)
+{
+#ifdef LIBGEARBOX_HTTP_UNIX_SOCKET
+    priv_->http_.setUnixSocketPath(path);
+#else
+    static_cast<void>(path);
+#endif
+}
+
+/*!
+    Returns the maximum number of idle connections that are kept open
+    between requests.
+*/
+std::int32_t Session::maxIdleConnections() const
+{
+#ifdef LIBGEARBOX_HTTP_CONNECTION_POOL
+    return static_cast<std::int32_t>(priv_->http_.maxIdleConnections());
+#else
+    return 0;
+#endif
+}
+
+/*!
+    Sets the maximum number of idle connections that are kept open between
+    requests.
+
+    Once a request completes its connection is kept alive, so that the next
+    request skips the TCP, and for HTTPS the TLS, handshake. Each request that
+    is in flight at the same time needs its own connection, so this should be
+    roughly the number of requests that are expected to run in parallel.
+    Setting this to 0 closes the connection after each request. This value
+    defaults to 4.
+
+    Currently only the cURL based backend (Linux) pools connections.
+*/
+void Session::setMaxIdleConnections(std::int32_t value)
+{
+#ifdef LIBGEARBOX_HTTP_CONNECTION_POOL
+    priv_->http_.setMaxIdleConnections(
+        static_cast<std::size_t>(value > 0 ? value : 0));
+#else
+    static_cast<void>(value);
+#endif
+}
+
+/*!
+    Returns the time, in milliseconds, after which an idle connection is
+    closed.
+*/
+std::int32_t Session::idleConnectionTimeout() const
+{
+#ifdef LIBGEARBOX_HTTP_CONNECTION_POOL
+    return static_cast<std::int32_t>(
+        priv_->http_.idleConnectionTimeout().count());
+#else
+    return 0;
+#endif
+}
+
+/*!
+    Sets the time, in milliseconds, after which an idle connection is closed.
+
+    This should be lower than the keep-alive timeout of the server, or of any
+    proxy in front of it, otherwise requests end up being sent over
+    connections that the other end has already given up on. This value
+    defaults to 30000ms.
+
+    Currently only the cURL based backend (Linux) pools connections.
+*/
+void Session::setIdleConnectionTimeout(std::int32_t value)
+{
+#ifdef LIBGEARBOX_HTTP_CONNECTION_POOL
+    priv_->http_.setIdleConnectionTimeout(std::chrono::milliseconds(value));
+#else
+    static_cast<void>(value);
+#endif
+}
+
+/*!
+    Returns the maximum number of torrents that a bulk mutation, e.g.
+    gearbox::Session::stopTorrents, sends along with a single call.
+*/
+std::int32_t Session::maxTorrentsPerCall() const
+{
+    return priv_->maxTorrentsPerCall_;
+}
+
+/*!
+    Sets the maximum number of torrents that a bulk mutation, e.g.
+    gearbox::Session::stopTorrents, sends along with a single call. Longer
+    lists are split up into several calls.
+
+    Smaller calls keep the request bodies, and the time the server spends
+    on each of them, bounded. Setting this to 0 sends every torrent with
+    the one call, which is the default.
+*/
+void Session::setMaxTorrentsPerCall(std::int32_t value)
+{
+    priv_->maxTorrentsPerCall_ = (value > 0) ? value : 0;
+}
+
+/*!
+    Returns the window, in milliseconds, within which mutations of single
+    torrents are coalesced; 0 if they are not.
+*/
+std::int32_t Session::coalescingWindow() const
+{
+    return static_cast<std::int32_t>(priv_->mutations_.window().count());
+}
+
+/*!
+    Has the mutations of single torrents, e.g. gearbox::Torrent::start or
+    gearbox::Torrent::setWantedFiles, that are made within \c value
+    milliseconds of the first of them merged into as few calls as possible.
+
+    Mutations with the same method and arguments become one call with the
+    ids of all of them, a start and a stop of the same torrent collapse into
+    whichever came last. The calls are sent once the window is over, in the
+    order in which the mutations were made, and every caller still gets the
+    result of the call its mutation ended up in. This trades a delay of up
+    to \c value milliseconds for one round trip instead of one per
+    mutation, which adds up when a UI or a script fires many of them.
+
+    A mutation that is cancelled, or runs past its deadline, while it waits
+    for the window to close is not sent. The merged calls are bounded by
+    gearbox::Session::timeout.
+
+    Setting this to 0, the default, sends every mutation on its own, right
+    away; whatever was waiting for the window is sent immediately.
+*/
+void Session::setCoalescingWindow(std::int32_t value)
+{
+    priv_->mutations_.setWindow(
+        std::chrono::milliseconds((value > 0) ? value : 0));
+}
+
+/*!
+    Returns how many requests reused an open connection, how many
+    connections had to be opened and how many response bytes were received,
+    before and after decompression, since the session was created.
+
+    This method is thread-safe.
+*/
+Session::ConnectionStatistics Session::connectionStatistics() const
+{
+#ifdef LIBGEARBOX_HTTP_CONNECTION_POOL
+    auto statistics = priv_->http_.connectionStatistics();
+
+    const auto requests = static_cast<double>(statistics.reusedConnections +
+                                              statistics.newConnections);
+    const auto connectionHitRate =
+        (requests > 0) ? statistics.reusedConnections / requests : 0.0;
+
+    /* Connections made over a Unix domain socket need no lookup either */
+    const auto dnsHitRate =
+        (statistics.newConnections > statistics.dnsLookups) ?
+            static_cast<double>(statistics.newConnections -
+                                statistics.dnsLookups) /
+                statistics.newConnections :
+            0.0;
+
+    return { statistics.reusedConnections,
+             statistics.newConnections,
+             statistics.receivedBytes,
+             statistics.decodedBytes,
+             statistics.dnsLookups,
+             connectionHitRate,
+             dnsHitRate };
+#else
+    return { 0, 0, 0, 0, 0, 0.0, 0.0 };
+#endif
+}
+
+/*!
+    Makes the session send its requests through the connections of other,
+    and share its DNS cache and TLS sessions, instead of keeping its own.
+
+    This is meant for several sessions talking to the same host, e.g. one
+    per worker thread or per user; only the first of them has to resolve the
+    host and negotiate TLS, the others pick up the open connections. The
+    connection pool settings, gearbox::Session::setMaxIdleConnections and
+    gearbox::Session::setIdleConnectionTimeout, and the connection
+    statistics are from then on those of the shared pool. Every other
+    setting, e.g. the credentials, stays specific to each session.
+
+    Sharing is thread-safe, the sessions involved can be used from different
+    threads at the same time. Requests that are in flight when this is called
+    complete on the connections they started on.
+
+    Currently only the cURL based backend (Linux) pools connections.
+*/
+void Session::shareConnections(const Session &other)
+{
+#ifdef LIBGEARBOX_HTTP_CONNECTION_POOL
+    priv_->http_.shareConnectionPool(other.priv_->http_);
+#else
+    static_cast<void>(other);
+#endif
+}
+
+/*!
+    \class gearbox::Session::TorrentIds
+    \brief The torrents a bulk mutation, e.g. gearbox::Session::stopTorrents,
+    is applied to.
+
+    Implicitly constructed from a list of ids, or from a list of
+    gearbox::Torrent, the invalid ones of which are left out.
+*/
+
+/*!
+    Constructs the list from the supplied ids.
+*/
+Session::TorrentIds::TorrentIds(std::vector<std::int32_t> ids)
+  : ids_(std::move(ids))
+{
+}
+
+/*!
+    Constructs the list from the supplied ids.
+*/
+Session::TorrentIds::TorrentIds(std::initializer_list<std::int32_t> ids)
+  : ids_(ids)
+{
+}
+
+/*!
+    Constructs the list from the ids of the supplied valid torrents.
+*/
+Session::TorrentIds::TorrentIds(const std::vector<Torrent> &torrents) : ids_()
+{
+    ids_.reserve(torrents.size());
+    for (const auto &torrent : torrents)
+    {
+        if (torrent.valid()) ids_.push_back(torrent.id());
+    }
+}
+
+/*!
+    Constructs the list from the ids of the supplied valid torrents.
+*/
+Session::TorrentIds::TorrentIds(
+    const std::vector<std::reference_wrapper<Torrent>> &torrents)
+  : ids_()
+{
+    ids_.reserve(torrents.size());
+    for (const Torrent &torrent : torrents)
+    {
+        if (torrent.valid()) ids_.push_back(torrent.id());
+    }
+}
+
+/*!
+    Returns the ids of the torrents.
+*/
+const std::vector<std::int32_t> &Session::TorrentIds::ids() const
+{
+    return ids_;
+}
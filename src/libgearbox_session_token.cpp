@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+#include "libgearbox_session_token_p.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+using namespace gearbox;
+
+namespace
+{
+    /* Cancellation comes without a notification, a request waiting for */
+    /* the token checks for it this often.                               */
+    constexpr std::chrono::milliseconds WAIT_INTERVAL{ 50 };
+}
+
+SessionToken::SessionToken()
+  : sequence_(0), size_(0), words_(), known_(false), mutex_(), learnt_(),
+    overflow_(), learning_(false), waiting_()
+{
+    for (auto &word : words_)
+    {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool SessionToken::tryAcquire(Ticket &ticket, resume_t resume)
+{
+    ticket.leader = false;
+    if (!known_.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!known_.load(std::memory_order_relaxed))
+        {
+            if (learning_)
+            {
+                if (resume) waiting_.push_back(std::move(resume));
+                return false;
+            }
+
+            learning_ = true;
+            ticket.leader = true;
+        }
+    }
+
+    ticket.generation = read(ticket.value);
+    return true;
+}
+
+bool SessionToken::acquire(Ticket &ticket, const CallOptions &options)
+{
+    while (!tryAcquire(ticket))
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (learning_ && !known_.load(std::memory_order_relaxed))
+        {
+            if (options.cancelled() || options.expired()) return false;
+
+            auto until = CallOptions::clock_t::now() + WAIT_INTERVAL;
+            if (options.hasDeadline())
+            {
+                until = std::min(until, options.deadline());
+            }
+            learnt_.wait_until(lock, until);
+        }
+    }
+
+    return true;
+}
+
+void SessionToken::acquireNow(Ticket &ticket)
+{
+    if (tryAcquire(ticket)) return;
+
+    /* A 409 replaces the token all the same, the leader is left to it */
+    ticket.generation = read(ticket.value);
+}
+
+void SessionToken::replace(const Ticket &ticket, const std::string &value)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    /* Only the token the request was sent with is replaced; if another */
+    /* request got to it first the current one is already newer.        */
+    if (sequence_.load(std::memory_order_relaxed) / 2 == ticket.generation)
+    {
+        write(value);
+    }
+    known_.store(true, std::memory_order_release);
+
+    if (ticket.leader)
+    {
+        learning_ = false;
+        wakeUp(lock);
+    }
+}
+
+void SessionToken::release(const Ticket &ticket, bool responded)
+{
+    if (!ticket.leader) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    /* Without a response nothing was learnt, the next request leads */
+    if (responded) known_.store(true, std::memory_order_release);
+    learning_ = false;
+    wakeUp(lock);
+}
+
+std::uint64_t SessionToken::replacements() const
+{
+    return sequence_.load(std::memory_order_acquire) / 2;
+}
+
+std::uint64_t SessionToken::read(std::string &value) const
+{
+    std::array<std::uint64_t, WORD_COUNT> words;
+    for (;;)
+    {
+        const auto before = sequence_.load(std::memory_order_acquire);
+        if ((before & 1) == 0)
+        {
+            const auto size = size_.load(std::memory_order_relaxed);
+            if (size > MAX_SIZE)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                value = overflow_;
+                return sequence_.load(std::memory_order_relaxed) / 2;
+            }
+
+            const auto count = (size + 7) / 8;
+            for (std::size_t it = 0; it < count; ++it)
+            {
+                words[it] = words_[it].load(std::memory_order_relaxed);
+            }
+
+            /* Nothing was written while the words were copied if the */
+            /* sequence is still the same.                            */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before)
+            {
+                value.assign(reinterpret_cast<const char *>(words.data()),
+                             size);
+                return before / 2;
+            }
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+void SessionToken::write(const std::string &value)
+{
+    /* An odd sequence tells readers that a write is underway */
+    const auto sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (value.size() > MAX_SIZE)
+    {
+        overflow_ = value;
+    }
+    else
+    {
+        std::array<std::uint64_t, WORD_COUNT> words{};
+        std::memcpy(words.data(), value.data(), value.size());
+        for (std::size_t it = 0; it < (value.size() + 7) / 8; ++it)
+        {
+            words_[it].store(words[it], std::memory_order_relaxed);
+        }
+    }
+    size_.store(value.size(), std::memory_order_relaxed);
+
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void SessionToken::wakeUp(std::unique_lock<std::mutex> &lock)
+{
+    std::vector<resume_t> waiting;
+    waiting.swap(waiting_);
+    lock.unlock();
+
+    learnt_.notify_all();
+    for (auto &resume : waiting)
+    {
+        resume();
+    }
+}
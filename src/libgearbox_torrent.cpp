@@ -48,17 +48,25 @@
 
     Methods are also provided to alter the state of the torrent with regards to
     status, content, peers etc.
+
+    Every method that makes an HTTP request takes an optional
+    gearbox::CallOptions, through which the call can be given a deadline or be
+    cancelled while it is in flight; see gearbox::Session.
 */
 
 #include "libgearbox_torrent.h"
 
+#include <algorithm>
+#include <iterator>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 #include <formats/json_format.h>
 
 #include "libgearbox_folder.h"
 #include "libgearbox_folder_p.h"
+#include "libgearbox_future_p.h"
 #include "libgearbox_logger_p.h"
 #include "libgearbox_session_p.h"
 #include "libgearbox_torrent_p.h"
@@ -69,6 +77,209 @@ namespace
 {
     constexpr const char *INVALID_SESSION{ "Invalid session" };
     constexpr const char *INVALID_TORRENT{ "Invalid torrent" };
+
+    Error toError(session::Response &&response)
+    {
+        return std::move(response.error);
+    }
+
+    nlohmann::json idsRequest(std::int32_t id)
+    {
+        nlohmann::json request;
+        request["ids"] = { id };
+        return request;
+    }
+
+    nlohmann::json filesRequest(std::int32_t id)
+    {
+        TorrentPrivate::Files::Request fileRequest;
+        fileRequest.set_ids({ id });
+        JsonFormat jsonFileRequest;
+        sequential::to_format(jsonFileRequest, fileRequest);
+        return jsonFileRequest.output();
+    }
+
+    nlohmann::json fileIndicesRequest(std::int32_t id,
+                                      const char *key,
+                                      const std::vector<std::size_t> &indices)
+    {
+        nlohmann::json request;
+        request["ids"] = { id };
+        request[key] = indices;
+        return request;
+    }
+
+    nlohmann::json moveRequest(std::int32_t id,
+                               const std::string &path,
+                               Torrent::MoveType move)
+    {
+        JsonFormat jsonFormat;
+        TorrentPrivate::MoveRequest request;
+        request.set_ids({ id });
+        request.set_location(path);
+        request.set_move(
+            (move == Torrent::MoveType::MoveToNewLocation) ? true : false);
+        sequential::to_format(jsonFormat, request);
+        return jsonFormat.output();
+    }
+
+    nlohmann::json updateRequest(std::int32_t id, FieldSet fields)
+    {
+        nlohmann::json request;
+        request["ids"] = { id };
+        request["fields"] =
+            TorrentPrivate::attribute_names(fields | Torrent::Field::Id);
+        return request;
+    }
+
+    /* Cells of the wrong type are skipped, same as missing keys in the */
+    /* object format. Returns true if the value changed.                 */
+    template <typename T>
+    bool refreshCell(const nlohmann::json &cell, T &value)
+    {
+        if (!cell.is_number()) return false;
+
+        const auto received = cell.get<T>();
+        if (received == value) return false;
+        value = received;
+        return true;
+    }
+
+    /* Strings are copied into the capacity they already have */
+    bool refreshCell(const nlohmann::json &cell, std::string &value)
+    {
+        if (!cell.is_string()) return false;
+
+        const auto &received = cell.get_ref<const std::string &>();
+        if (received == value) return false;
+        value = received;
+        return true;
+    }
+
+    using column_decoder_t = bool (*)(TorrentPrivate &,
+                                      const nlohmann::json &);
+
+#define TABLE_COLUMN(attribute)                                 \
+    [](TorrentPrivate &torrent, const nlohmann::json &cell) {   \
+        return refreshCell(cell, torrent.get_##attribute());    \
+    }
+
+    /* In the same order as the attributes of TorrentPrivate */
+    const column_decoder_t COLUMN_DECODERS[] = {
+        TABLE_COLUMN(id),           TABLE_COLUMN(name),
+        TABLE_COLUMN(haveValid),    TABLE_COLUMN(percentDone),
+        TABLE_COLUMN(uploadRatio),  TABLE_COLUMN(uploadedEver),
+        TABLE_COLUMN(rateDownload), TABLE_COLUMN(rateUpload),
+        TABLE_COLUMN(status),       TABLE_COLUMN(totalSize),
+        TABLE_COLUMN(downloadDir),  TABLE_COLUMN(eta),
+        TABLE_COLUMN(queuePosition)
+    };
+
+#undef TABLE_COLUMN
+
+    static_assert(sizeof(COLUMN_DECODERS) / sizeof(COLUMN_DECODERS[0]) ==
+                      static_cast<std::size_t>(Torrent::Field::Count),
+                  "Every field needs a column decoder");
+
+    using field_comparator_t = bool (*)(const TorrentPrivate &,
+                                        const TorrentPrivate &);
+
+#define FIELD_COMPARATOR(attribute)                                  \
+    [](const TorrentPrivate &lhs, const TorrentPrivate &rhs) {       \
+        return lhs.get_##attribute() == rhs.get_##attribute();       \
+    }
+
+    /* In the same order as the attributes of TorrentPrivate */
+    const field_comparator_t FIELD_COMPARATORS[] = {
+        FIELD_COMPARATOR(id),           FIELD_COMPARATOR(name),
+        FIELD_COMPARATOR(haveValid),    FIELD_COMPARATOR(percentDone),
+        FIELD_COMPARATOR(uploadRatio),  FIELD_COMPARATOR(uploadedEver),
+        FIELD_COMPARATOR(rateDownload), FIELD_COMPARATOR(rateUpload),
+        FIELD_COMPARATOR(status),       FIELD_COMPARATOR(totalSize),
+        FIELD_COMPARATOR(downloadDir),  FIELD_COMPARATOR(eta),
+        FIELD_COMPARATOR(queuePosition)
+    };
+
+#undef FIELD_COMPARATOR
+
+    static_assert(sizeof(FIELD_COMPARATORS) / sizeof(FIELD_COMPARATORS[0]) ==
+                      static_cast<std::size_t>(Torrent::Field::Count),
+                  "Every field needs a comparator");
+
+    Error applyUpdate(std::unique_ptr<TorrentPrivate> &priv,
+                      FieldSet fields,
+                      session::Response &&response)
+    {
+        if (!response.error)
+        {
+            JsonFormat jsonFormat;
+            TorrentPrivate::Response torrentResponse;
+            std::vector<TorrentPrivate> torrents;
+
+            jsonFormat.fromJson(response.get_arguments());
+            sequential::from_format(jsonFormat, torrentResponse);
+            torrents = std::move(torrentResponse.get_torrents());
+            for (TorrentPrivate &torrentPriv : torrents)
+            {
+                priv->refresh(std::move(torrentPriv), fields);
+            }
+        }
+
+        return std::move(response.error);
+    }
+
+    /* Checks the torrent and its session the same way the blocking calls */
+    /* do; failures are delivered through an already fulfilled future.    */
+    template <typename T>
+    Future<T> sendRequestAsync(const TorrentPrivate *priv,
+                               const char *method,
+                               nlohmann::json request,
+                               std::function<T(session::Response &&)> transform,
+                               const CallOptions &options)
+    {
+        session::Response response;
+
+        if (priv == nullptr)
+        {
+            LOG_ERROR("Invalid torrent while requesting \"{}\"", method);
+            response.error =
+                std::make_pair(Error::Code::GearboxTorrentInvalid, INVALID_TORRENT);
+        }
+        else if (auto session = priv->session_.lock())
+        {
+            return session->sendRequestAsync<T>(method, std::move(request),
+                                                std::move(transform), options);
+        }
+        else
+        {
+            LOG_ERROR("Invalid session while requesting \"{}\" for id '{}'",
+                      method, priv->get_id());
+            response.error = std::make_pair(Error::Code::GearboxSessionInvalid,
+                                            INVALID_SESSION);
+        }
+
+        return makeReadyFuture<session::Response, T>(std::move(response),
+                                                     std::move(transform));
+    }
+
+    /* Same as sendRequestAsync, for the mutations the session may coalesce */
+    Future<Error> sendMutationAsync(const TorrentPrivate *priv,
+                                    const char *method,
+                                    nlohmann::json request,
+                                    const CallOptions &options)
+    {
+        if (priv != nullptr)
+        {
+            if (auto session = priv->session_.lock())
+            {
+                return session->sendMutationAsync(method, std::move(request),
+                                                  options);
+            }
+        }
+
+        return sendRequestAsync<Error>(priv, method, std::move(request),
+                                       &toError, options);
+    }
 }
 
 TorrentPrivate::TorrentPrivate() : attributes(), session_() {}
@@ -101,6 +312,173 @@ TorrentPrivate &TorrentPrivate::operator=(const TorrentPrivate &other)
     return *this;
 }
 
+std::vector<const char *> TorrentPrivate::attribute_names(FieldSet fields)
+{
+    const auto names = attribute_names();
+
+    std::vector<const char *> result;
+    for (std::size_t it = 0; it < names.size(); ++it)
+    {
+        if (fields.contains(static_cast<Torrent::Field>(it)))
+        {
+            result.push_back(names[it]);
+        }
+    }
+
+    return result;
+}
+
+TorrentPrivate::Table::Table(const nlohmann::json &header)
+  : fields_(header.size(), Torrent::Field::Count), idColumn_(header.size())
+{
+    /* The names are only looked up once, the rows are decoded by position */
+    const auto names = attribute_names();
+    for (std::size_t column = 0; column < header.size(); ++column)
+    {
+        if (!header[column].is_string()) continue;
+        const auto &name = header[column].get_ref<const std::string &>();
+        for (std::size_t it = 0; it < names.size(); ++it)
+        {
+            if (name == names[it])
+            {
+                fields_[column] = static_cast<Torrent::Field>(it);
+                break;
+            }
+        }
+        if (fields_[column] == Torrent::Field::Id) idColumn_ = column;
+    }
+}
+
+std::int32_t TorrentPrivate::Table::id(const nlohmann::json &row) const
+{
+    if (!row.is_array() || (idColumn_ >= row.size())) return -1;
+
+    const auto &cell = row[idColumn_];
+    return cell.is_number() ? cell.get<std::int32_t>() : -1;
+}
+
+FieldSet TorrentPrivate::Table::refresh(const nlohmann::json &row,
+                                        TorrentPrivate &torrent,
+                                        FieldSet fields) const
+{
+    FieldSet result;
+    if (!row.is_array()) return result;
+
+    const auto cells = std::min(row.size(), fields_.size());
+    for (std::size_t column = 0; column < cells; ++column)
+    {
+        const auto field = fields_[column];
+        if ((field == Torrent::Field::Count) || !fields.contains(field))
+        {
+            continue;
+        }
+
+        const auto index = static_cast<std::size_t>(field);
+        if (COLUMN_DECODERS[index](torrent, row[column]))
+        {
+            result = result | field;
+        }
+    }
+
+    return result;
+}
+
+const nlohmann::json *TorrentPrivate::tableRows(
+    const nlohmann::json &arguments,
+    const std::weak_ptr<SessionPrivate> &session)
+{
+    /* Daemons that don't know the "table" format answer with objects */
+    auto torrents = arguments.find("torrents");
+    if ((torrents != arguments.end()) && torrents->is_array() &&
+        !torrents->empty())
+    {
+        if (torrents->front().is_array()) return &*torrents;
+
+        if (auto priv = session.lock()) priv->disableTableFormat();
+    }
+
+    return nullptr;
+}
+
+std::vector<TorrentPrivate> TorrentPrivate::fromTable(
+    const nlohmann::json &rows)
+{
+    std::vector<TorrentPrivate> result;
+    if (!rows.is_array() || rows.empty() || !rows.front().is_array())
+    {
+        return result;
+    }
+
+    const Table table(rows.front());
+    result.reserve(rows.size() - 1);
+    for (auto row = std::next(rows.begin()); row != rows.end(); ++row)
+    {
+        if (!row->is_array()) continue;
+
+        result.emplace_back();
+        table.refresh(*row, result.back());
+    }
+
+    return result;
+}
+
+std::vector<TorrentPrivate> TorrentPrivate::decode(
+    const nlohmann::json &arguments,
+    const std::weak_ptr<SessionPrivate> &session)
+{
+    if (auto rows = tableRows(arguments, session)) return fromTable(*rows);
+
+    JsonFormat jsonFormat;
+    Response response;
+    jsonFormat.fromJson(arguments);
+    sequential::from_format(jsonFormat, response);
+    return std::move(response.get_torrents());
+}
+
+FieldSet TorrentPrivate::differences(const TorrentPrivate &other) const
+{
+    FieldSet result;
+    for (std::size_t it = 0;
+         it < static_cast<std::size_t>(Torrent::Field::Count); ++it)
+    {
+        if (!FIELD_COMPARATORS[it](*this, other))
+        {
+            result = result | static_cast<Torrent::Field>(it);
+        }
+    }
+
+    return result;
+}
+
+void TorrentPrivate::update(TorrentPrivate &&other, FieldSet fields)
+{
+    assign(std::move(other), fields,
+           std::make_index_sequence<static_cast<std::size_t>(
+               Torrent::Field::Count)>());
+}
+
+FieldSet TorrentPrivate::refresh(TorrentPrivate &&other, FieldSet fields)
+{
+    const auto changed = differences(other) & fields;
+    if (!changed.empty()) update(std::move(other), changed);
+
+    return changed;
+}
+
+template <std::size_t... Index>
+void TorrentPrivate::assign(TorrentPrivate &&other,
+                            FieldSet fields,
+                            std::index_sequence<Index...>)
+{
+    using expand = int[];
+    static_cast<void>(expand{
+        0, (fields.contains(static_cast<Torrent::Field>(Index)) ?
+                (std::get<Index>(attributes) =
+                     std::move(std::get<Index>(other.attributes)),
+                 0) :
+                0)... });
+}
+
 /*!
     \enum gearbox::Torrent::Status
     \brief Enumerates the possible states of a torrent.
@@ -156,6 +534,29 @@ TorrentPrivate &TorrentPrivate::operator=(const TorrentPrivate &other)
     files are also removed from the download location
 */
 
+/*!
+    \enum gearbox::Torrent::Field
+    \brief Enumerates the attributes of a torrent that can be requested on
+    their own, see gearbox::FieldSet.
+
+    Each one maps to the getter of the same meaning, e.g.
+    gearbox::Torrent::Field::DownloadSpeed to gearbox::Torrent::downloadSpeed().
+    \c Count is not a field, it is the number of fields.
+*/
+
+/*!
+    \class gearbox::FieldSet
+    \brief A set of gearbox::Torrent::Field, built at compile time.
+
+    Passed to gearbox::Session::torrents, gearbox::Session::updateTorrentStats
+    and gearbox::Torrent::update to request only the attributes that are
+    needed. Sets are combined with \c |:
+    ```
+    constexpr auto speeds = gearbox::Torrent::Field::DownloadSpeed |
+                            gearbox::Torrent::Field::UploadSpeed;
+    ```
+*/
+
 /*!
     Constructs an instance based on \c priv parameter. Only used internally
     by gearbox::Session.
@@ -214,7 +615,7 @@ bool Torrent::valid() const { return static_cast<bool>(priv_); }
 
     This method is thread-safe.
 */
-Error Torrent::start()
+Error Torrent::start(const CallOptions &options)
 {
     Error error;
 
@@ -225,8 +626,7 @@ Error Torrent::start()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-start", request);
-            error = std::move(response.error);
+            error = session->sendMutation("torrent-start", request, options);
         }
         else
         {
@@ -261,7 +661,7 @@ Error Torrent::start()
 
     This method is thread-safe.
 */
-Error Torrent::startNow()
+Error Torrent::startNow(const CallOptions &options)
 {
     Error error;
 
@@ -272,8 +672,8 @@ Error Torrent::startNow()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-start-now", request);
-            error = std::move(response.error);
+            error =
+                session->sendMutation("torrent-start-now", request, options);
         }
         else
         {
@@ -304,7 +704,7 @@ Error Torrent::startNow()
 
     This method is thread-safe.
 */
-Error Torrent::stop()
+Error Torrent::stop(const CallOptions &options)
 {
     Error error;
 
@@ -315,8 +715,7 @@ Error Torrent::stop()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-stop", request);
-            error = std::move(response.error);
+            error = session->sendMutation("torrent-stop", request, options);
         }
         else
         {
@@ -346,7 +745,7 @@ Error Torrent::stop()
 
     This method is thread-safe.
 */
-Error Torrent::verify()
+Error Torrent::verify(const CallOptions &options)
 {
     Error error;
 
@@ -357,8 +756,7 @@ Error Torrent::verify()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-verify", request);
-            error = std::move(response.error);
+            error = session->sendMutation("torrent-verify", request, options);
         }
         else
         {
@@ -389,7 +787,7 @@ Error Torrent::verify()
 
     This method is thread-safe.
 */
-Error Torrent::askForMorePeers()
+Error Torrent::askForMorePeers(const CallOptions &options)
 {
     Error error;
 
@@ -400,8 +798,8 @@ Error Torrent::askForMorePeers()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-reannounce", request);
-            error = std::move(response.error);
+            error =
+                session->sendMutation("torrent-reannounce", request, options);
         }
         else
         {
@@ -433,7 +831,7 @@ Error Torrent::askForMorePeers()
 
     This method is thread-safe.
 */
-Error Torrent::remove(LocalDataAction action)
+Error Torrent::remove(LocalDataAction action, const CallOptions &options)
 {
     Error error;
 
@@ -445,8 +843,7 @@ Error Torrent::remove(LocalDataAction action)
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-remove", request);
-            error = std::move(response.error);
+            error = session->sendMutation("torrent-remove", request, options);
         }
         else
         {
@@ -476,7 +873,7 @@ Error Torrent::remove(LocalDataAction action)
 
     This method is thread-safe.
 */
-Error Torrent::queueMoveUp()
+Error Torrent::queueMoveUp(const CallOptions &options)
 {
     Error error;
 
@@ -487,8 +884,7 @@ Error Torrent::queueMoveUp()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("queue-move-up", request);
-            error = std::move(response.error);
+            error = session->sendMutation("queue-move-up", request, options);
         }
         else
         {
@@ -518,7 +914,7 @@ Error Torrent::queueMoveUp()
 
     This method is thread-safe.
 */
-Error Torrent::queueMoveDown()
+Error Torrent::queueMoveDown(const CallOptions &options)
 {
     Error error;
 
@@ -529,8 +925,7 @@ Error Torrent::queueMoveDown()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("queue-move-down", request);
-            error = std::move(response.error);
+            error = session->sendMutation("queue-move-down", request, options);
         }
         else
         {
@@ -560,7 +955,7 @@ Error Torrent::queueMoveDown()
 
     This method is thread-safe.
 */
-Error Torrent::queueMoveTop()
+Error Torrent::queueMoveTop(const CallOptions &options)
 {
     Error error;
 
@@ -571,8 +966,7 @@ Error Torrent::queueMoveTop()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("queue-move-top", request);
-            error = std::move(response.error);
+            error = session->sendMutation("queue-move-top", request, options);
         }
         else
         {
@@ -602,7 +996,7 @@ Error Torrent::queueMoveTop()
 
     This method is thread-safe.
 */
-Error Torrent::queueMoveBottom()
+Error Torrent::queueMoveBottom(const CallOptions &options)
 {
     Error error;
 
@@ -613,8 +1007,8 @@ Error Torrent::queueMoveBottom()
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("queue-move-bottom", request);
-            error = std::move(response.error);
+            error =
+                session->sendMutation("queue-move-bottom", request, options);
         }
         else
         {
@@ -644,36 +1038,37 @@ Error Torrent::queueMoveBottom()
 
     This method is thread-safe.
 */
-Error Torrent::update()
+Error Torrent::update(const CallOptions &options)
+{
+    return update(FieldSet::all(), options);
+}
+
+/*!
+    Same as gearbox::Torrent::update but only requests, and updates, the
+    supplied \c fields; the others keep the values they had.
+
+    The daemon only has to serialize, and the torrent to decode, the fields
+    that are asked for, e.g. refreshing only the speeds of a torrent:
+    ```
+    torrent.update(gearbox::Torrent::Field::DownloadSpeed |
+                   gearbox::Torrent::Field::UploadSpeed);
+    ```
+
+    This method is thread-safe.
+*/
+Error Torrent::update(FieldSet fields, const CallOptions &options)
 {
     Error error;
 
     if (valid())
     {
-        nlohmann::json request;
-        request["ids"] = { this->id() };
-        request["fields"] = TorrentPrivate::attribute_names();
-
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-get", request);
-            error = std::move(response.error);
-            if (!error)
-            {
-                JsonFormat jsonFormat;
-                TorrentPrivate::Response torrentResponse;
-                std::vector<TorrentPrivate> torrents;
-
-                jsonFormat.fromJson(response.get_arguments());
-                sequential::from_format(jsonFormat, torrentResponse);
-                torrents = torrentResponse.get_torrents();
-                for (TorrentPrivate &torrentPriv : torrents)
-                {
-                    auto torrent = new TorrentPrivate(std::move(torrentPriv));
-                    torrent->session_ = priv_->session_;
-                    priv_.reset(torrent);
-                }
-            }
+            error = applyUpdate(
+                priv_, fields,
+                session->sendRequest("torrent-get",
+                                     updateRequest(this->id(), fields),
+                                     options));
         }
         else
         {
@@ -703,7 +1098,8 @@ Error Torrent::update()
     This method is thread-safe.
 */
 Error Torrent::setWantedFiles(
-    const std::vector<std::reference_wrapper<const File>> &files)
+    const std::vector<std::reference_wrapper<const File>> &files,
+    const CallOptions &options)
 {
     Error error;
 
@@ -720,7 +1116,7 @@ Error Torrent::setWantedFiles(
 
         if (auto session = priv_->session_.lock())
         {
-            error = session->sendRequest("torrent-set", request).error;
+            error = session->sendMutation("torrent-set", request, options);
         }
         else
         {
@@ -750,7 +1146,8 @@ Error Torrent::setWantedFiles(
     This method is thread-safe.
 */
 Error Torrent::setSkippedFiles(
-    const std::vector<std::reference_wrapper<const File>> &files)
+    const std::vector<std::reference_wrapper<const File>> &files,
+    const CallOptions &options)
 {
     Error error;
 
@@ -767,7 +1164,7 @@ Error Torrent::setSkippedFiles(
 
         if (auto session = priv_->session_.lock())
         {
-            error = session->sendRequest("torrent-set", request).error;
+            error = session->sendMutation("torrent-set", request, options);
         }
         else
         {
@@ -911,54 +1308,18 @@ int32_t Torrent::eta() const { return valid() ? priv_->get_eta() : 0; }
 
     This method is thread-safe.
 */
-ReturnType<Folder> Torrent::content() const
+ReturnType<Folder> Torrent::content(const CallOptions &options) const
 {
-    Folder result((std::string(name())));
     Error error;
 
     if (valid())
     {
-        std::vector<TorrentPrivate::Files> torrentFiles;
-        TorrentPrivate::Files::Response torrentResponse;
-
-        TorrentPrivate::Files::Request fileRequest;
-        fileRequest.set_ids({ this->id() });
-        JsonFormat jsonFileRequest;
-        sequential::to_format(jsonFileRequest, fileRequest);
-
         if (auto session = priv_->session_.lock())
         {
-            session::Response response(
-                session->sendRequest("torrent-get", jsonFileRequest.output()));
-
-            if (!response.error)
-            {
-                JsonFormat jsonFormat;
-                jsonFormat.fromJson(response.get_arguments());
-                sequential::from_format(jsonFormat, torrentResponse);
-                torrentFiles = torrentResponse.get_torrents();
-                for (TorrentPrivate::Files &tf : torrentFiles)
-                {
-                    const auto &files = tf.get_files();
-                    const auto &fileStats = tf.get_fileStats();
-                    const auto length = files.size();
-
-                    for (std::size_t it = 0; it < length; ++it)
-                    {
-                        result.priv_->addPath(
-                            files.at(it).get_name(), it,
-                            files.at(it).get_bytesCompleted(),
-                            files.at(it).get_length(),
-                            fileStats.at(it).get_wanted(),
-                            static_cast<File::Priority>(
-                                fileStats.at(it).get_priority()));
-                    }
-                }
-            }
-            else
-            {
-                error = std::move(response.error);
-            }
+            return toContent(name(),
+                             session->sendRequest("torrent-get",
+                                                  filesRequest(id()), options),
+                             options);
         }
         else
         {
@@ -975,7 +1336,7 @@ ReturnType<Folder> Torrent::content() const
             std::make_pair(Error::Code::GearboxTorrentInvalid, INVALID_TORRENT);
     }
 
-    return ReturnType<Folder>{ std::move(error), std::move(result) };
+    return ReturnType<Folder>{ std::move(error), Folder(name()) };
 }
 
 /*!
@@ -994,57 +1355,17 @@ ReturnType<Folder> Torrent::content() const
 
     This method is thread-safe.
 */
-ReturnType<std::vector<File>> Torrent::files() const
+ReturnType<std::vector<File>> Torrent::files(const CallOptions &options) const
 {
-    std::vector<File> result;
     Error error;
 
     if (valid())
     {
-        std::vector<TorrentPrivate::Files> torrentFiles;
-        TorrentPrivate::Files::Response torrentResponse;
-
-        TorrentPrivate::Files::Request fileRequest;
-        fileRequest.set_ids({ this->id() });
-        JsonFormat jsonFileRequest;
-        sequential::to_format(jsonFileRequest, fileRequest);
-
         if (auto session = priv_->session_.lock())
         {
-            session::Response response(
-                session->sendRequest("torrent-get", jsonFileRequest.output()));
-
-            if (!response.error)
-            {
-                JsonFormat jsonFormat;
-                jsonFormat.fromJson(response.get_arguments());
-                sequential::from_format(jsonFormat, torrentResponse);
-                torrentFiles = torrentResponse.get_torrents();
-                for (TorrentPrivate::Files &tf : torrentFiles)
-                {
-                    auto &files = tf.get_files();
-                    const auto &fileStats = tf.get_fileStats();
-                    const auto length = files.size();
-
-                    for (std::size_t it = 0; it < length; ++it)
-                    {
-                        File f{
-                            std::move(files.at(it).get_name()),
-                            files.at(it).get_bytesCompleted(),
-                            files.at(it).get_length(),
-                            fileStats.at(it).get_wanted(),
-                            static_cast<File::Priority>(
-                                fileStats.at(it).get_priority()),
-                        };
-                        f.id_ = it;
-                        result.push_back(std::move(f));
-                    }
-                }
-            }
-            else
-            {
-                error = std::move(response.error);
-            }
+            return toFiles(session->sendRequest("torrent-get",
+                                                filesRequest(id()), options),
+                           options);
         }
         else
         {
@@ -1061,7 +1382,7 @@ ReturnType<std::vector<File>> Torrent::files() const
             std::make_pair(Error::Code::GearboxTorrentInvalid, INVALID_TORRENT);
     }
 
-    return ReturnType<std::vector<File>>(std::move(error), std::move(result));
+    return ReturnType<std::vector<File>>(std::move(error), {});
 }
 
 /*!
@@ -1091,7 +1412,8 @@ int32_t Torrent::queuePosition() const
 
     This method is thread-safe.
 */
-Error Torrent::setQueuePosition(int32_t position)
+Error Torrent::setQueuePosition(int32_t position,
+                                const CallOptions &options)
 {
     Error error;
 
@@ -1103,7 +1425,8 @@ Error Torrent::setQueuePosition(int32_t position)
 
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-set", request);
+            auto response =
+                session->sendRequest("torrent-set", request, options);
             error = std::move(response.error);
         }
         else
@@ -1146,25 +1469,19 @@ std::string Torrent::downloadDir() const
 
     This method is thread-safe.
 */
-Error Torrent::setDownloadDir(const std::string &path, MoveType move)
+Error Torrent::setDownloadDir(const std::string &path,
+                              MoveType move,
+                              const CallOptions &options)
 {
     Error error;
 
     if (valid())
     {
-        JsonFormat jsonFormat;
-        TorrentPrivate::MoveRequest moveRequest;
-        moveRequest.set_ids({ this->id() });
-        moveRequest.set_location(path);
-        moveRequest.set_move(
-            (move == Torrent::MoveType::MoveToNewLocation) ? true : false);
-        sequential::to_format(jsonFormat, moveRequest);
-
         if (auto session = priv_->session_.lock())
         {
-            auto response = session->sendRequest("torrent-set-location",
-                                                 jsonFormat.output());
-            error = std::move(response.error);
+            error = session->sendMutation(
+                "torrent-set-location", moveRequest(this->id(), path, move),
+                options);
         }
         else
         {
@@ -1186,3 +1503,350 @@ Error Torrent::setDownloadDir(const std::string &path, MoveType move)
 
     return error;
 }
+
+/*!
+    Same as gearbox::Torrent::start but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::startAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "torrent-start", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::startNow but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::startNowAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "torrent-start-now", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::stop but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::stopAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "torrent-stop", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::verify but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::verifyAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "torrent-verify", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::askForMorePeers but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::askForMorePeersAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "torrent-reannounce",
+                             idsRequest(id()), options);
+}
+
+/*!
+    Same as gearbox::Torrent::remove but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::removeAsync(LocalDataAction action,
+                                   const CallOptions &options)
+{
+    auto request = idsRequest(id());
+    request["delete-local-data"] = (action == LocalDataAction::DeleteFiles);
+
+    return sendMutationAsync(priv_.get(), "torrent-remove", std::move(request),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::queueMoveUp but returns immediately, the result
+    is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::queueMoveUpAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "queue-move-up", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::queueMoveDown but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::queueMoveDownAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "queue-move-down", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::queueMoveTop but returns immediately, the result
+    is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::queueMoveTopAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "queue-move-top", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::queueMoveBottom but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::queueMoveBottomAsync(const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "queue-move-bottom", idsRequest(id()),
+                             options);
+}
+
+/*!
+    Same as gearbox::Torrent::update but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    The cached data is updated by whichever thread consumes the future, the
+    torrent has to stay alive, and should not be touched, until it is ready.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::updateAsync(const CallOptions &options)
+{
+    return updateAsync(FieldSet::all(), options);
+}
+
+/*!
+    Same as gearbox::Torrent::update(gearbox::FieldSet, const
+    gearbox::CallOptions &) but returns immediately, the result is delivered
+    through the returned gearbox::Future.
+
+    The cached data is updated by whichever thread consumes the future, the
+    torrent has to stay alive, and should not be touched, until it is ready.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::updateAsync(FieldSet fields, const CallOptions &options)
+{
+    return sendRequestAsync<Error>(
+        priv_.get(), "torrent-get", updateRequest(id(), fields),
+        [this, fields](session::Response &&response) {
+            return applyUpdate(priv_, fields, std::move(response));
+        },
+        options);
+}
+
+/*!
+    Same as gearbox::Torrent::setWantedFiles but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::setWantedFilesAsync(
+    const std::vector<std::reference_wrapper<const File>> &files,
+    const CallOptions &options)
+{
+    std::vector<std::size_t> indices;
+    indices.reserve(files.size());
+
+    for (const File &f : files) indices.push_back(f.id_);
+
+    return sendMutationAsync(
+        priv_.get(), "torrent-set",
+        fileIndicesRequest(id(), "files-wanted", indices), options);
+}
+
+/*!
+    Same as gearbox::Torrent::setSkippedFiles but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::setSkippedFilesAsync(
+    const std::vector<std::reference_wrapper<const File>> &files,
+    const CallOptions &options)
+{
+    std::vector<std::size_t> indices;
+    indices.reserve(files.size());
+
+    for (const File &f : files) indices.push_back(f.id_);
+
+    return sendMutationAsync(
+        priv_.get(), "torrent-set",
+        fileIndicesRequest(id(), "files-unwanted", indices), options);
+}
+
+/*!
+    Same as gearbox::Torrent::content but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<ReturnType<Folder>> Torrent::contentAsync(
+    const CallOptions &options) const
+{
+    std::string name = this->name();
+    return sendRequestAsync<ReturnType<Folder>>(
+        priv_.get(), "torrent-get", filesRequest(id()),
+        [name, options](session::Response &&response) {
+            return toContent(name, std::move(response), options);
+        },
+        options);
+}
+
+/*!
+    Same as gearbox::Torrent::files but returns immediately, the result is
+    delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<ReturnType<std::vector<File>>> Torrent::filesAsync(
+    const CallOptions &options) const
+{
+    return sendRequestAsync<ReturnType<std::vector<File>>>(
+        priv_.get(), "torrent-get", filesRequest(id()),
+        [options](session::Response &&response) {
+            return toFiles(std::move(response), options);
+        },
+        options);
+}
+
+/*!
+    Same as gearbox::Torrent::setQueuePosition but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::setQueuePositionAsync(std::int32_t position,
+                                             const CallOptions &options)
+{
+    auto request = idsRequest(id());
+    request["queuePosition"] = position;
+
+    return sendRequestAsync<Error>(priv_.get(), "torrent-set",
+                                   std::move(request), &toError, options);
+}
+
+/*!
+    Same as gearbox::Torrent::setDownloadDir but returns immediately, the
+    result is delivered through the returned gearbox::Future.
+
+    This method is thread-safe.
+*/
+Future<Error> Torrent::setDownloadDirAsync(const std::string &path,
+                                           MoveType move,
+                                           const CallOptions &options)
+{
+    return sendMutationAsync(priv_.get(), "torrent-set-location",
+                             moveRequest(id(), path, move), options);
+}
+
+ReturnType<Folder> Torrent::toContent(const std::string &name,
+                                      session::Response &&response,
+                                      const CallOptions &options)
+{
+    Folder result((std::string(name)));
+
+    if (!response.error)
+    {
+        TorrentPrivate::Files::Response torrentResponse;
+        JsonFormat jsonFormat;
+        jsonFormat.fromJson(response.get_arguments());
+        sequential::from_format(jsonFormat, torrentResponse);
+        for (TorrentPrivate::Files &tf : torrentResponse.get_torrents())
+        {
+            const auto &files = tf.get_files();
+            const auto &fileStats = tf.get_fileStats();
+            const auto length = files.size();
+
+            for (std::size_t it = 0; it < length; ++it)
+            {
+                if ((it % session::INTERRUPTION_CHECK_INTERVAL == 0) &&
+                    session::interrupted(options))
+                {
+                    return ReturnType<Folder>{ session::interruption(options),
+                                               Folder(std::string(name)) };
+                }
+
+                result.priv_->addPath(files.at(it).get_name(), it,
+                                      files.at(it).get_bytesCompleted(),
+                                      files.at(it).get_length(),
+                                      fileStats.at(it).get_wanted(),
+                                      static_cast<File::Priority>(
+                                          fileStats.at(it).get_priority()));
+            }
+        }
+    }
+
+    return ReturnType<Folder>{ std::move(response.error), std::move(result) };
+}
+
+ReturnType<std::vector<File>> Torrent::toFiles(session::Response &&response,
+                                               const CallOptions &options)
+{
+    std::vector<File> result;
+
+    if (!response.error)
+    {
+        TorrentPrivate::Files::Response torrentResponse;
+        JsonFormat jsonFormat;
+        jsonFormat.fromJson(response.get_arguments());
+        sequential::from_format(jsonFormat, torrentResponse);
+        for (TorrentPrivate::Files &tf : torrentResponse.get_torrents())
+        {
+            auto &files = tf.get_files();
+            const auto &fileStats = tf.get_fileStats();
+            const auto length = files.size();
+
+            for (std::size_t it = 0; it < length; ++it)
+            {
+                if ((it % session::INTERRUPTION_CHECK_INTERVAL == 0) &&
+                    session::interrupted(options))
+                {
+                    return ReturnType<std::vector<File>>(
+                        session::interruption(options), {});
+                }
+
+                File f{
+                    std::move(files.at(it).get_name()),
+                    files.at(it).get_bytesCompleted(),
+                    files.at(it).get_length(),
+                    fileStats.at(it).get_wanted(),
+                    static_cast<File::Priority>(
+                        fileStats.at(it).get_priority()),
+                };
+                f.id_ = it;
+                result.push_back(std::move(f));
+            }
+        }
+    }
+
+    return ReturnType<std::vector<File>>(std::move(response.error),
+                                         std::move(result));
+}
@@ -0,0 +1,600 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::TorrentIndex
+    \brief Filters, sorts, pages and groups the torrents of a
+    gearbox::TorrentSnapshot without a call to the server.
+
+    The index is built once per snapshot. The numeric fields are laid out in
+    a gearbox::TorrentTable, so that a condition reads a single array from
+    start to end, and every field gets a sort key that compares like the
+    field does: the names, in natural order, and the download directories
+    get their rank among all of them. Sorting on any field then comes down
+    to comparing integers, ties are broken by id so that the same query
+    always lists the torrents in the same order, page after page.
+
+    Queries are built with gearbox::TorrentIndex::query, e.g. the 50
+    fastest downloading torrents in a directory:
+
+    \code
+    auto fastest = index.query()
+                       .whereStatus({ gearbox::Torrent::Status::Download })
+                       .whereDownloadDir("/data/tv")
+                       .orderBy(gearbox::Torrent::Field::DownloadSpeed,
+                                gearbox::TorrentIndex::Order::Descending)
+                       .page(0, 50)
+                       .select();
+    \endcode
+
+    Only as many torrents as there are up to the end of the page are put in
+    order, the rest of those that match are just left out.
+
+    An index never changes once built, any number of threads can query it.
+*/
+
+/*!
+    \class gearbox::TorrentIndex::Query
+    \brief The conditions, order and page of a query on a
+    gearbox::TorrentIndex.
+
+    Every condition has to hold for a torrent to match. A query refers to
+    the index it was made by, which has to outlive it.
+*/
+
+#include "libgearbox_torrent_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+using namespace gearbox;
+
+namespace
+{
+    /* Calls visitor with the column of field, if the table has one */
+    template <typename Visitor>
+    bool visitColumn(const TorrentTable &table,
+                     Torrent::Field field,
+                     Visitor &&visitor)
+    {
+        switch (field)
+        {
+            default:
+                return false;
+            case Torrent::Field::Id:
+                visitor(table.ids());
+                return true;
+            case Torrent::Field::BytesDownloaded:
+                visitor(table.bytesDownloaded());
+                return true;
+            case Torrent::Field::PercentDone:
+                visitor(table.percentDone());
+                return true;
+            case Torrent::Field::DownloadSpeed:
+                visitor(table.downloadSpeeds());
+                return true;
+            case Torrent::Field::UploadSpeed:
+                visitor(table.uploadSpeeds());
+                return true;
+            case Torrent::Field::Status:
+                visitor(table.statuses());
+                return true;
+            case Torrent::Field::Size:
+                visitor(table.sizes());
+                return true;
+            case Torrent::Field::Eta:
+                visitor(table.etas());
+                return true;
+            case Torrent::Field::QueuePosition:
+                visitor(table.queuePositions());
+                return true;
+        }
+    }
+
+    /* An unsigned integer that compares like value does */
+    inline std::uint64_t sortKey(std::uint64_t value) { return value; }
+    inline std::uint64_t sortKey(std::uint8_t value) { return value; }
+    inline std::uint64_t sortKey(std::int32_t value)
+    {
+        return static_cast<std::uint32_t>(value) ^ 0x80000000u;
+    }
+    inline std::uint64_t sortKey(double value)
+    {
+        constexpr std::uint64_t SIGN{ 0x8000000000000000ull };
+
+        if (value == 0.0) value = 0.0;
+
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (bits & SIGN) ? ~bits : (bits | SIGN);
+    }
+
+    /* The name in lower case, with every run of digits prefixed by its */
+    /* length so that "Episode 9" comes before "Episode 10"             */
+    std::string collationKey(const std::string &name)
+    {
+        std::string result;
+        result.reserve(name.size() + 8);
+
+        for (std::size_t it = 0; it < name.size();)
+        {
+            const auto c = static_cast<unsigned char>(name[it]);
+            if (!std::isdigit(c))
+            {
+                result.push_back(static_cast<char>(
+                    (c < 0x80) ? std::tolower(c) : c));
+                ++it;
+                continue;
+            }
+
+            auto end = it;
+            while ((end < name.size()) &&
+                   std::isdigit(static_cast<unsigned char>(name[end])))
+            {
+                ++end;
+            }
+            while ((it + 1 < end) && (name[it] == '0')) ++it;
+
+            const auto length = std::min<std::size_t>(end - it, 0xFFFF);
+            result.push_back('\x01');
+            result.push_back(static_cast<char>(length >> 8));
+            result.push_back(static_cast<char>(length & 0xFF));
+            result.append(name, it, end - it);
+            it = end;
+        }
+
+        return result;
+    }
+
+    /* Whether directory is prefix, or one of the directories below it */
+    bool isBelow(const std::string &directory, const std::string &prefix)
+    {
+        if (directory.compare(0, prefix.size(), prefix) != 0) return false;
+
+        return (directory.size() == prefix.size()) || prefix.empty() ||
+               (prefix.back() == '/') || (directory[prefix.size()] == '/');
+    }
+
+    template <typename T, typename Compare>
+    void narrowBy(std::vector<std::uint8_t> &mask,
+                  const std::vector<T> &column,
+                  Compare compare)
+    {
+        const auto values = column.data();
+        const auto matches = mask.data();
+        const auto size = mask.size();
+
+        for (std::size_t it = 0; it < size; ++it)
+        {
+            matches[it] &= compare(static_cast<double>(values[it])) ? 1 : 0;
+        }
+    }
+
+    template <typename T>
+    void narrowBy(std::vector<std::uint8_t> &mask,
+                  const std::vector<T> &column,
+                  TorrentIndex::Comparison comparison,
+                  double value)
+    {
+        using Comparison = TorrentIndex::Comparison;
+
+        switch (comparison)
+        {
+            case Comparison::Less:
+                narrowBy(mask, column, [value](double v) { return v < value; });
+                break;
+            case Comparison::LessOrEqual:
+                narrowBy(
+                    mask, column, [value](double v) { return v <= value; });
+                break;
+            case Comparison::Equal:
+                narrowBy(
+                    mask, column, [value](double v) { return v == value; });
+                break;
+            case Comparison::NotEqual:
+                narrowBy(
+                    mask, column, [value](double v) { return v != value; });
+                break;
+            case Comparison::GreaterOrEqual:
+                narrowBy(
+                    mask, column, [value](double v) { return v >= value; });
+                break;
+            case Comparison::Greater:
+                narrowBy(mask, column, [value](double v) { return v > value; });
+                break;
+        }
+    }
+}
+
+/*!
+    Builds an index of the torrents of \c snapshot, which it holds on to.
+*/
+TorrentIndex::TorrentIndex(std::shared_ptr<const TorrentSnapshot> snapshot)
+  : snapshot_(snapshot ? std::move(snapshot)
+                       : std::make_shared<const TorrentSnapshot>()),
+    columns_(*snapshot_),
+    keys_(static_cast<std::size_t>(Torrent::Field::Count)),
+    directories_(),
+    directoryIndices_()
+{
+    const auto size = snapshot_->size();
+
+    for (auto field = 0; field < static_cast<int>(Torrent::Field::Count);
+         ++field)
+    {
+        auto &keys = keys_[static_cast<std::size_t>(field)];
+        visitColumn(columns_,
+                    static_cast<Torrent::Field>(field),
+                    [&keys](const auto &column) {
+                        keys.reserve(column.size());
+                        for (const auto value : column)
+                        {
+                            keys.push_back(sortKey(value));
+                        }
+                    });
+    }
+
+    auto &uploadRatios =
+        keys_[static_cast<std::size_t>(Torrent::Field::UploadRatio)];
+    auto &bytesUploaded =
+        keys_[static_cast<std::size_t>(Torrent::Field::BytesUploaded)];
+    uploadRatios.reserve(size);
+    bytesUploaded.reserve(size);
+    for (const auto &entry : *snapshot_)
+    {
+        uploadRatios.push_back(sortKey(entry->uploadRatio));
+        bytesUploaded.push_back(sortKey(entry->bytesUploaded));
+    }
+
+    /* Both strings are ranked once, sorting on them compares the ranks */
+    std::vector<std::uint32_t> rows(size);
+    std::iota(rows.begin(), rows.end(), 0);
+
+    std::vector<std::string> collationKeys;
+    collationKeys.reserve(size);
+    for (const auto &entry : *snapshot_)
+    {
+        collationKeys.push_back(collationKey(entry->name));
+    }
+    std::sort(rows.begin(),
+              rows.end(),
+              [this, &collationKeys](std::uint32_t lhs, std::uint32_t rhs) {
+                  const auto order =
+                      collationKeys[lhs].compare(collationKeys[rhs]);
+                  if (order != 0) return order < 0;
+
+                  const auto &lhsName = snapshot_->at(lhs).name;
+                  const auto &rhsName = snapshot_->at(rhs).name;
+                  if (lhsName != rhsName) return lhsName < rhsName;
+
+                  return lhs < rhs;
+              });
+
+    auto &nameRanks = keys_[static_cast<std::size_t>(Torrent::Field::Name)];
+    nameRanks.resize(size);
+    for (std::size_t rank = 0; rank < size; ++rank)
+    {
+        nameRanks[rows[rank]] = rank;
+    }
+
+    for (const auto &entry : *snapshot_)
+    {
+        directories_.push_back(entry->downloadDir);
+    }
+    std::sort(directories_.begin(), directories_.end());
+    directories_.erase(std::unique(directories_.begin(), directories_.end()),
+                       directories_.end());
+
+    auto &directoryRanks =
+        keys_[static_cast<std::size_t>(Torrent::Field::DownloadDir)];
+    directoryIndices_.reserve(size);
+    directoryRanks.reserve(size);
+    for (const auto &entry : *snapshot_)
+    {
+        const auto directory = std::lower_bound(
+            directories_.begin(), directories_.end(), entry->downloadDir);
+        const auto index = static_cast<std::uint32_t>(
+            std::distance(directories_.begin(), directory));
+
+        directoryIndices_.push_back(index);
+        directoryRanks.push_back(index);
+    }
+}
+
+/*!
+    Returns a query that matches every torrent of the index, ordered by id.
+*/
+TorrentIndex::Query TorrentIndex::query() const { return Query(*this); }
+
+/*!
+    Returns the number of torrents in the index.
+*/
+std::size_t TorrentIndex::size() const { return snapshot_->size(); }
+
+/*!
+    Returns the snapshot the index was built from.
+*/
+const TorrentSnapshot &TorrentIndex::snapshot() const { return *snapshot_; }
+
+TorrentIndex::Query::Query(const TorrentIndex &index)
+  : index_(&index), statuses_(std::numeric_limits<std::uint32_t>::max()),
+    conditions_(), directories_(), orderField_(Torrent::Field::Id),
+    order_(Order::Ascending), offset_(0),
+    count_(std::numeric_limits<std::size_t>::max())
+{
+}
+
+/*!
+    Keeps the torrents whose status is any of \c statuses.
+*/
+TorrentIndex::Query &
+TorrentIndex::Query::whereStatus(std::vector<Torrent::Status> statuses)
+{
+    std::uint32_t mask = 0;
+    for (const auto status : statuses)
+    {
+        const auto value = static_cast<std::uint32_t>(status);
+        if (value < 32) mask |= 1u << value;
+    }
+    statuses_ &= mask;
+
+    return *this;
+}
+
+/*!
+    Keeps the torrents for which \c field compares to \c value as
+    \c comparison says, e.g. gearbox::Torrent::Field::Size,
+    gearbox::TorrentIndex::Comparison::Greater and 1 << 30 for those larger
+    than 1 GiB. \c field is any of the numeric fields, a condition on
+    gearbox::Torrent::Field::Name or gearbox::Torrent::Field::DownloadDir
+    matches no torrent.
+*/
+TorrentIndex::Query &TorrentIndex::Query::where(Torrent::Field field,
+                                                Comparison comparison,
+                                                double value)
+{
+    conditions_.push_back(Condition{ field, comparison, value });
+    return *this;
+}
+
+/*!
+    Keeps the torrents downloaded to \c directory, or to any of the
+    directories below it.
+*/
+TorrentIndex::Query &
+TorrentIndex::Query::whereDownloadDir(std::string directory)
+{
+    while ((directory.size() > 1) && (directory.back() == '/'))
+    {
+        directory.pop_back();
+    }
+    directories_.push_back(std::move(directory));
+
+    return *this;
+}
+
+/*!
+    Orders the torrents by \c field, names in natural order, e.g. "Episode 9"
+    before "Episode 10". Torrents with the same value are ordered by id,
+    whatever the \c order.
+*/
+TorrentIndex::Query &TorrentIndex::Query::orderBy(Torrent::Field field,
+                                                  Order order)
+{
+    if (field < Torrent::Field::Count)
+    {
+        orderField_ = field;
+        order_ = order;
+    }
+
+    return *this;
+}
+
+/*!
+    Lists only \c count torrents, starting with the one at \c offset in the
+    order of the query.
+*/
+TorrentIndex::Query &TorrentIndex::Query::page(std::size_t offset,
+                                               std::size_t count)
+{
+    offset_ = offset;
+    count_ = count;
+
+    return *this;
+}
+
+/*!
+    Returns the torrents that match the query, in its order, of its page.
+*/
+std::vector<TorrentSnapshot::entry_t> TorrentIndex::Query::select() const
+{
+    const auto rows = this->rows();
+    if (offset_ >= rows.size()) return {};
+
+    const auto &keys = index_->keys_[static_cast<std::size_t>(orderField_)];
+    const auto descending = (order_ == Order::Descending);
+
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> ordered;
+    ordered.reserve(rows.size());
+    for (const auto row : rows)
+    {
+        ordered.emplace_back(descending ? ~keys[row] : keys[row], row);
+    }
+
+    /* The rows are in the order of the ids, which breaks the ties */
+    const auto end = offset_ + std::min(count_, rows.size() - offset_);
+    if (end < ordered.size())
+    {
+        std::partial_sort(ordered.begin(),
+                          ordered.begin() + static_cast<std::ptrdiff_t>(end),
+                          ordered.end());
+    }
+    else
+    {
+        std::sort(ordered.begin(), ordered.end());
+    }
+
+    std::vector<TorrentSnapshot::entry_t> result;
+    result.reserve(end - offset_);
+    auto entry = index_->snapshot_->begin();
+    for (auto it = offset_; it < end; ++it)
+    {
+        result.push_back(
+            *(entry + static_cast<std::ptrdiff_t>(ordered[it].second)));
+    }
+
+    return result;
+}
+
+/*!
+    Returns the number of torrents that match the query, on any page.
+*/
+std::size_t TorrentIndex::Query::count() const { return rows().size(); }
+
+/*!
+    Returns the number of torrents that match the query, along with their
+    total size, bytes downloaded and speeds, per download directory. The
+    groups are ordered by directory, the order and page of the query are
+    not taken into account.
+*/
+std::vector<TorrentIndex::Group> TorrentIndex::Query::groupByDownloadDir()
+    const
+{
+    std::vector<Group> groups;
+    groups.reserve(index_->directories_.size());
+    for (const auto &directory : index_->directories_)
+    {
+        groups.push_back(Group{ directory, 0, 0, 0, 0, 0 });
+    }
+
+    const auto &columns = index_->columns_;
+    for (const auto row : rows())
+    {
+        auto &group = groups[index_->directoryIndices_[row]];
+        ++group.count;
+        group.size += columns.sizes()[row];
+        group.bytesDownloaded += columns.bytesDownloaded()[row];
+        group.downloadSpeed += columns.downloadSpeeds()[row];
+        group.uploadSpeed += columns.uploadSpeeds()[row];
+    }
+
+    groups.erase(std::remove_if(groups.begin(),
+                                groups.end(),
+                                [](const Group &group) {
+                                    return group.count == 0;
+                                }),
+                 groups.end());
+
+    return groups;
+}
+
+std::vector<std::uint32_t> TorrentIndex::Query::rows() const
+{
+    const auto &columns = index_->columns_;
+    const auto size = columns.size();
+
+    std::vector<std::uint8_t> mask(size, 1);
+
+    if (statuses_ != std::numeric_limits<std::uint32_t>::max())
+    {
+        const auto statuses = columns.statuses().data();
+        const auto matches = mask.data();
+        for (std::size_t it = 0; it < size; ++it)
+        {
+            matches[it] = (statuses_ >> (statuses[it] & 0x1F)) & 1;
+        }
+    }
+
+    /* Each directory is checked once, not once per torrent */
+    if (!directories_.empty())
+    {
+        std::vector<std::uint8_t> below;
+        below.reserve(index_->directories_.size());
+        for (const auto &directory : index_->directories_)
+        {
+            below.push_back(std::all_of(directories_.begin(),
+                                        directories_.end(),
+                                        [&directory](const std::string &p) {
+                                            return isBelow(directory, p);
+                                        })
+                                ? 1
+                                : 0);
+        }
+
+        const auto indices = index_->directoryIndices_.data();
+        const auto matches = mask.data();
+        for (std::size_t it = 0; it < size; ++it)
+        {
+            matches[it] &= below[indices[it]];
+        }
+    }
+
+    for (const auto &condition : conditions_)
+    {
+        const auto found =
+            visitColumn(columns, condition.field, [&](const auto &column) {
+                narrowBy(mask, column, condition.comparison, condition.value);
+            });
+        if (found) continue;
+
+        std::vector<double> column;
+        column.reserve(size);
+        switch (condition.field)
+        {
+            default:
+                std::fill(mask.begin(), mask.end(), 0);
+                break;
+            case Torrent::Field::UploadRatio:
+                for (const auto &entry : index_->snapshot())
+                {
+                    column.push_back(entry->uploadRatio);
+                }
+                break;
+            case Torrent::Field::BytesUploaded:
+                for (const auto &entry : index_->snapshot())
+                {
+                    column.push_back(
+                        static_cast<double>(entry->bytesUploaded));
+                }
+                break;
+        }
+        if (!column.empty())
+        {
+            narrowBy(mask, column, condition.comparison, condition.value);
+        }
+    }
+
+    std::vector<std::uint32_t> result;
+    result.reserve(size);
+    for (std::size_t it = 0; it < size; ++it)
+    {
+        if (mask[it]) result.push_back(static_cast<std::uint32_t>(it));
+    }
+
+    return result;
+}
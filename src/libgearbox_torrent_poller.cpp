@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::TorrentPoller
+    \brief Keeps a gearbox::TorrentStore up to date in the background.
+
+    Instead of every torrent being fetched at the same rate, each one is
+    polled according to what it is doing:
+        - gearbox::TorrentPoller::Tier::Active: downloading or seeding with
+          a download or upload speed above 0, or being verified; polled
+          every second by default
+        - gearbox::TorrentPoller::Tier::Idle: any other torrent that isn't
+          stopped, e.g. queued or seeding to no one; every 10 seconds by
+          default
+        - gearbox::TorrentPoller::Tier::Stopped: every minute by default
+
+    The torrents that are due are refreshed with a single call, along with
+    those that would be due shortly after. A torrent moves to another tier
+    as soon as its status, or speed, changes. The store is synced as often
+    as idle torrents are polled, at most every 30 seconds, which picks up
+    torrents that were added, removed, or became active in the meantime.
+
+    The intervals are stretched as the daemon takes longer to answer: a tier
+    is polled at most every 10 round trips. Calls that fail are retried
+    after an interval that doubles with each failure in a row.
+
+    Every interval is spread by a random amount, up to 10% either way by
+    default, and the first poll waits a random part of that, so that
+    clients which start polling together, e.g. a fleet of them, don't stay
+    in step.
+
+    The store is synced from a thread of the poller. Its change handler, and
+    the error handler of the poller, are invoked from that thread. While the
+    poller is running the store must not be used from any other thread, but
+    for gearbox::TorrentStore::snapshot, nor the poller be started, or
+    destroyed, from the handlers. Both handlers can stop it.
+*/
+
+#include "libgearbox_torrent_poller.h"
+#include "libgearbox_torrent_poller_p.h"
+
+#include <algorithm>
+
+#include "libgearbox_torrent_store_p.h"
+
+using namespace gearbox;
+
+constexpr const std::int32_t TorrentPoller::DEFAULT_ACTIVE_INTERVAL;
+constexpr const std::int32_t TorrentPoller::DEFAULT_IDLE_INTERVAL;
+constexpr const std::int32_t TorrentPoller::DEFAULT_STOPPED_INTERVAL;
+constexpr const std::int32_t TorrentPoller::DEFAULT_JITTER;
+
+constexpr std::int32_t TorrentPollerPrivate::LATENCY_MULTIPLE;
+constexpr std::int32_t TorrentPollerPrivate::MAX_FAILURE_BACKOFF;
+
+TorrentPollerPrivate::TorrentPollerPrivate(TorrentStore &store)
+  : store_(store), intervals_(), jitter_(TorrentPoller::DEFAULT_JITTER),
+    latency_(0), due_(), nextSync_(), failures_(0),
+    random_(std::random_device{}()), errorHandler_(), mutex_(), wake_(),
+    stopping_(true), cancellation_(), thread_()
+{
+    intervals_[static_cast<std::size_t>(Tier::Active)] =
+        TorrentPoller::DEFAULT_ACTIVE_INTERVAL;
+    intervals_[static_cast<std::size_t>(Tier::Idle)] =
+        TorrentPoller::DEFAULT_IDLE_INTERVAL;
+    intervals_[static_cast<std::size_t>(Tier::Stopped)] =
+        TorrentPoller::DEFAULT_STOPPED_INTERVAL;
+}
+
+TorrentPollerPrivate::Tier TorrentPollerPrivate::tier(const Torrent &torrent)
+{
+    switch (torrent.status())
+    {
+        default:
+            return Tier::Idle;
+        case Torrent::Status::Stopped:
+            return Tier::Stopped;
+        case Torrent::Status::Check:
+            /* The progress of a verification changes all the time */
+            return Tier::Active;
+        case Torrent::Status::Download:
+        case Torrent::Status::Seed:
+            return ((torrent.downloadSpeed() > 0) ||
+                    (torrent.uploadSpeed() > 0))
+                       ? Tier::Active
+                       : Tier::Idle;
+    }
+}
+
+TorrentPollerPrivate::clock_t::duration TorrentPollerPrivate::interval(
+    Tier tier) const
+{
+    const clock_t::duration configured = std::chrono::milliseconds(
+        intervals_[static_cast<std::size_t>(tier)].load());
+    const clock_t::duration stretched =
+        std::chrono::microseconds(latency_.load() * LATENCY_MULTIPLE);
+
+    return std::max(configured, stretched);
+}
+
+TorrentPollerPrivate::clock_t::duration TorrentPollerPrivate::jittered(
+    clock_t::duration duration)
+{
+    const auto spread = jitter_.load() / 100.0;
+    if (spread <= 0.0) return duration;
+
+    std::uniform_real_distribution<double> factor(1.0 - spread, 1.0 + spread);
+    return std::chrono::duration_cast<clock_t::duration>(duration *
+                                                         factor(random_));
+}
+
+void TorrentPollerPrivate::observe(clock_t::duration roundTrip)
+{
+    const auto sample =
+        std::chrono::duration_cast<std::chrono::microseconds>(roundTrip)
+            .count();
+    const auto average = latency_.load();
+
+    /* The average of about the last 8 calls */
+    latency_ = (average == 0) ? sample : (average * 7 + sample) / 8;
+}
+
+TorrentPollerPrivate::clock_t::time_point TorrentPollerPrivate::poll(
+    clock_t::time_point now,
+    const CallOptions &options)
+{
+    const bool sync = !store_.synced() || (now >= nextSync_);
+
+    /* Torrents that would be due shortly after go along with the others, */
+    /* instead of in a call of their own                                  */
+    std::vector<std::int32_t> ids;
+    if (!sync)
+    {
+        const auto horizon = now + interval(Tier::Active) / 4;
+        for (const auto &torrent : due_)
+        {
+            if (torrent.second <= horizon) ids.push_back(torrent.first);
+        }
+    }
+
+    Error error;
+    if (sync || !ids.empty())
+    {
+        const auto sent = clock_t::now();
+        error = sync ? store_.sync(options) : store_.refresh(ids, options);
+        if (!error) observe(clock_t::now() - sent);
+    }
+
+    if (error)
+    {
+        /* Interrupted by TorrentPoller::stop() */
+        if (options.cancelled()) return now;
+
+        if (errorHandler_) errorHandler_(error);
+        if (error.errorCode() == Error::Code::GearboxSessionInvalid)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            return now;
+        }
+
+        failures_ = std::min(failures_ + 1, MAX_FAILURE_BACKOFF);
+        return now + jittered(interval(Tier::Active) * (1 << failures_));
+    }
+    failures_ = 0;
+
+    if (sync)
+    {
+        /* New torrents are scheduled, those that woke up are brought */
+        /* forward and those that are gone are dropped.               */
+        std::unordered_map<std::int32_t, clock_t::time_point> due;
+        due.reserve(store_.size());
+        for (const Torrent &torrent : store_.torrents())
+        {
+            const auto next = now + jittered(interval(tier(torrent)));
+            auto scheduled = due_.find(torrent.id());
+            due.emplace(torrent.id(),
+                        (scheduled != due_.end())
+                            ? std::min(scheduled->second, next)
+                            : next);
+        }
+        due_.swap(due);
+
+        const clock_t::duration syncInterval =
+            TorrentStorePrivate::RECENTLY_ACTIVE_WINDOW / 2;
+        nextSync_ =
+            now + jittered(std::min(interval(Tier::Idle), syncInterval));
+    }
+    else
+    {
+        for (const auto id : ids)
+        {
+            auto torrent = store_.find(id);
+            if (torrent == nullptr)
+            {
+                due_.erase(id);
+                continue;
+            }
+
+            due_[id] = now + jittered(interval(tier(*torrent)));
+        }
+    }
+
+    auto next = nextSync_;
+    for (const auto &torrent : due_) next = std::min(next, torrent.second);
+
+    return next;
+}
+
+void TorrentPollerPrivate::run()
+{
+    const CallOptions options(cancellation_);
+
+    /* Pollers that are started together, e.g. on a fleet of machines, */
+    /* don't start in step                                             */
+    std::uniform_real_distribution<double> delay(0.0, jitter_.load() / 100.0);
+    auto next = clock_t::now() + std::chrono::duration_cast<clock_t::duration>(
+                                     interval(Tier::Active) * delay(random_));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_until(lock, next, [this]() { return stopping_; }))
+    {
+        lock.unlock();
+        next = poll(clock_t::now(), options);
+        lock.lock();
+    }
+}
+
+/*!
+    Constructs a poller for \c store, that is not running yet. The store
+    must outlive the poller.
+*/
+TorrentPoller::TorrentPoller(TorrentStore &store)
+  : priv_(new TorrentPollerPrivate(store))
+{
+}
+
+/*!
+    Destructor, stops the poller.
+*/
+TorrentPoller::~TorrentPoller() noexcept(true) { stop(); }
+
+/*!
+    Starts polling, with a sync of the store, if the poller isn't running
+    already.
+*/
+void TorrentPoller::start()
+{
+    if (running()) return;
+
+    /* The thread of a poller that was stopped from one of the handlers, */
+    /* or by its session going away, may still be finishing up           */
+    if (priv_->thread_.joinable()) priv_->thread_.join();
+
+    priv_->stopping_ = false;
+    priv_->cancellation_ = CancellationToken();
+    priv_->thread_ = std::thread(&TorrentPollerPrivate::run, priv_.get());
+}
+
+/*!
+    Stops polling, a call that is in flight is interrupted. Returns once
+    the store is no longer being synced, unless it is called from one of the
+    handlers; the poller then stops as soon as the handler returns.
+*/
+void TorrentPoller::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(priv_->mutex_);
+        priv_->stopping_ = true;
+    }
+    priv_->cancellation_.cancel();
+    priv_->wake_.notify_all();
+
+    if (std::this_thread::get_id() == priv_->thread_.get_id()) return;
+    if (priv_->thread_.joinable()) priv_->thread_.join();
+}
+
+/*!
+    Returns true if the poller was started, and wasn't stopped since. A
+    poller stops on its own once the gearbox::Session of its store is
+    destroyed.
+*/
+bool TorrentPoller::running() const
+{
+    std::lock_guard<std::mutex> lock(priv_->mutex_);
+    return !priv_->stopping_;
+}
+
+/*!
+    Sets the handler that is given the errors of the calls the poller makes.
+    It is invoked from the thread of the poller, and must be set while the
+    poller is not running.
+*/
+void TorrentPoller::setErrorHandler(error_handler_t handler)
+{
+    priv_->errorHandler_ = std::move(handler);
+}
+
+/*!
+    Returns the interval, in milliseconds, at which the torrents of \c tier
+    are polled while the daemon answers quickly.
+*/
+std::int32_t TorrentPoller::interval(Tier tier) const
+{
+    return priv_->intervals_[static_cast<std::size_t>(tier)];
+}
+
+/*!
+    Sets the interval, in milliseconds, at which the torrents of \c tier
+    are polled. Torrents that are already scheduled pick it up once they
+    were polled again.
+*/
+void TorrentPoller::setInterval(Tier tier, std::int32_t milliseconds)
+{
+    priv_->intervals_[static_cast<std::size_t>(tier)] =
+        std::max(milliseconds, 1);
+}
+
+/*!
+    Returns by how much, in percent, the intervals are spread either way.
+*/
+std::int32_t TorrentPoller::jitter() const { return priv_->jitter_; }
+
+/*!
+    Sets by how much, in percent, the intervals are spread either way; 0
+    has the poller keep to them exactly.
+*/
+void TorrentPoller::setJitter(std::int32_t percent)
+{
+    priv_->jitter_ = std::min(std::max(percent, 0), 100);
+}
+
+/*!
+    Returns the average time, in milliseconds, the calls of the poller took
+    recently.
+*/
+std::int32_t TorrentPoller::latency() const
+{
+    return static_cast<std::int32_t>(priv_->latency_ / 1000);
+}
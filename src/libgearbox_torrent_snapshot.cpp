@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::TorrentSnapshot
+    \brief The state of every torrent of a gearbox::TorrentStore, as it was
+    at one point in time.
+
+    A snapshot never changes once it is published, any number of threads can
+    read it without locking, for as long as they hold on to it. Each entry
+    is a copy of the fields of a torrent, the entries are ordered by id.
+
+    Consecutive snapshots share the entries of the torrents that didn't
+    change in between, publishing one costs about a pointer per torrent plus
+    a copy of those that changed.
+*/
+
+#include "libgearbox_torrent_snapshot.h"
+
+#include <algorithm>
+
+using namespace gearbox;
+
+/*!
+    Constructs an empty snapshot, of version 0.
+*/
+TorrentSnapshot::TorrentSnapshot() : entries_(), version_(0) {}
+
+/*!
+    Constructs a snapshot from \c entries, which are expected to be ordered
+    by id, without repeats.
+*/
+TorrentSnapshot::TorrentSnapshot(std::vector<entry_t> entries,
+                                 std::uint64_t version)
+  : entries_(std::move(entries)), version_(version)
+{
+}
+
+/*!
+    Constructs a snapshot, of version 0, of the valid torrents of
+    \c torrents, e.g. as returned by gearbox::Session::torrents.
+*/
+TorrentSnapshot::TorrentSnapshot(const std::vector<Torrent> &torrents)
+  : TorrentSnapshot()
+{
+    entries_.reserve(torrents.size());
+    for (const auto &torrent : torrents)
+    {
+        if (torrent.valid()) entries_.push_back(entry(torrent));
+    }
+
+    std::stable_sort(entries_.begin(),
+                     entries_.end(),
+                     [](const entry_t &lhs, const entry_t &rhs) {
+                         return lhs->id < rhs->id;
+                     });
+}
+
+/*!
+    Returns an entry with the current fields of \c torrent.
+*/
+TorrentSnapshot::entry_t TorrentSnapshot::entry(const Torrent &torrent)
+{
+    return std::make_shared<const Entry>(Entry{ torrent.id(),
+                                                torrent.name(),
+                                                torrent.bytesDownloaded(),
+                                                torrent.percentDone(),
+                                                torrent.uploadRatio(),
+                                                torrent.bytesUploaded(),
+                                                torrent.downloadSpeed(),
+                                                torrent.uploadSpeed(),
+                                                torrent.status(),
+                                                torrent.size(),
+                                                torrent.downloadDir(),
+                                                torrent.eta(),
+                                                torrent.queuePosition() });
+}
+
+/*!
+    Returns the version of the snapshot, each one that is published after
+    it has a higher one.
+*/
+std::uint64_t TorrentSnapshot::version() const { return version_; }
+
+/*!
+    Returns the number of torrents in the snapshot.
+*/
+std::size_t TorrentSnapshot::size() const { return entries_.size(); }
+
+/*!
+    Returns true if the snapshot has no torrents.
+*/
+bool TorrentSnapshot::empty() const { return entries_.empty(); }
+
+/*!
+    Returns the entry at \c index, in the order of the ids.
+*/
+const TorrentSnapshot::Entry &TorrentSnapshot::at(std::size_t index) const
+{
+    return *entries_.at(index);
+}
+
+/*!
+    Returns the entry of the torrent with the supplied \c id, or nullptr if
+    there is none.
+*/
+const TorrentSnapshot::Entry *TorrentSnapshot::find(std::int32_t id) const
+{
+    auto it = std::lower_bound(
+        entries_.begin(), entries_.end(), id,
+        [](const entry_t &entry, std::int32_t value) {
+            return entry->id < value;
+        });
+
+    return ((it != entries_.end()) && ((*it)->id == id)) ? it->get()
+                                                         : nullptr;
+}
+
+/*!
+    Returns an iterator to the first entry.
+*/
+TorrentSnapshot::const_iterator TorrentSnapshot::begin() const
+{
+    return entries_.begin();
+}
+
+/*!
+    Returns an iterator past the last entry.
+*/
+TorrentSnapshot::const_iterator TorrentSnapshot::end() const
+{
+    return entries_.end();
+}
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::TorrentStore
+    \brief A local mirror of the torrents on the server.
+
+    The first call to gearbox::TorrentStore::sync fetches every torrent, each
+    one after that only asks for the torrents the server reports as recently
+    active, along with those that were removed since, and applies them to the
+    mirror. With a large number of mostly idle torrents a poll costs about as
+    much as the handful of torrents that actually changed.
+
+    The server only keeps track of recent activity for about a minute, a sync
+    that comes later than that fetches every torrent again.
+
+    The gearbox::Torrent(s) in the store are updated in place, a pointer or
+    reference to one stays valid until the torrent is removed from the
+    server, or the store is destroyed. They belong to the gearbox::Session
+    the store was created with, and can be used as any other.
+
+    Each sync compares what it receives with what the store holds, field by
+    field, and reports the torrents that were added, removed or changed, and
+    which of their fields changed, to the handler set with
+    gearbox::TorrentStore::setChangeHandler. Work that follows a sync only
+    has to be proportional to what changed.
+
+    After each sync that changed anything the store publishes a
+    gearbox::TorrentSnapshot of its torrents.
+    gearbox::TorrentStore::snapshot can be called from any thread, e.g. the
+    UI one while another thread syncs the store, without locking. Other than
+    that gearbox::TorrentStore::sync changes the torrents, none of the
+    methods are thread-safe.
+*/
+
+#include "libgearbox_torrent_store.h"
+#include "libgearbox_torrent_store_p.h"
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+#include "libgearbox_session.h"
+#include "libgearbox_torrent_p.h"
+
+using namespace gearbox;
+
+constexpr std::chrono::seconds TorrentStorePrivate::RECENTLY_ACTIVE_WINDOW;
+
+namespace
+{
+    constexpr const char *INVALID_SESSION{ "Invalid session" };
+
+    nlohmann::json syncRequest(bool full,
+                               const std::vector<std::int32_t> &ids,
+                               bool tableFormat)
+    {
+        nlohmann::json request;
+        if (!full && ids.empty()) request["ids"] = "recently-active";
+        if (!ids.empty()) request["ids"] = ids;
+        request["fields"] = TorrentPrivate::attribute_names();
+        if (tableFormat) request["format"] = "table";
+        return request;
+    }
+}
+
+TorrentStorePrivate::TorrentStorePrivate(std::weak_ptr<SessionPrivate> session)
+  : session_(std::move(session)), torrents_(), lastSync_(), synced_(false),
+    changeHandler_(), snapshot_(std::make_shared<const TorrentSnapshot>())
+{
+}
+
+std::vector<TorrentStore::Change> TorrentStorePrivate::apply(
+    const nlohmann::json &arguments,
+    bool full,
+    const std::vector<std::int32_t> &requested)
+{
+    using Kind = TorrentStore::Change::Kind;
+
+    std::vector<TorrentStore::Change> changes;
+
+    /* Known torrents are refreshed in place, only the fields that changed */
+    /* are written, with the cells of a row in the "table" format or the   */
+    /* attributes of a decoded object.                                     */
+    auto ingest = [this, &changes](std::int32_t id, const auto &refresh) {
+        auto existing = torrents_.find(id);
+        if (existing != torrents_.end())
+        {
+            const auto changed = refresh(*existing->second.priv_);
+            if (!changed.empty())
+            {
+                changes.push_back({ id, Kind::Updated, changed });
+            }
+            return;
+        }
+
+        auto priv = new TorrentPrivate();
+        refresh(*priv);
+        priv->session_ = session_;
+        torrents_.emplace(id, Torrent(priv));
+        changes.push_back({ id, Kind::Added, FieldSet::all() });
+    };
+
+    std::vector<TorrentPrivate> torrents;
+    std::unordered_set<std::int32_t> listed;
+    auto rows = TorrentPrivate::tableRows(arguments, session_);
+    if (rows != nullptr)
+    {
+        const TorrentPrivate::Table table(rows->front());
+        listed.reserve(rows->size());
+        for (auto row = std::next(rows->begin()); row != rows->end(); ++row)
+        {
+            const auto id = table.id(*row);
+            if (id < 0) continue;
+
+            listed.insert(id);
+            ingest(id, [&table, &row](TorrentPrivate &priv) {
+                return table.refresh(*row, priv);
+            });
+        }
+    }
+    else
+    {
+        torrents = TorrentPrivate::decode(arguments, session_);
+        listed.reserve(torrents.size());
+        for (auto &torrent : torrents)
+        {
+            const auto id = torrent.get_id();
+            listed.insert(id);
+            ingest(id, [&torrent](TorrentPrivate &priv) {
+                return priv.refresh(std::move(torrent), FieldSet::all());
+            });
+        }
+    }
+
+    if (full)
+    {
+        for (auto it = torrents_.begin(); it != torrents_.end();)
+        {
+            if (listed.count(it->first) == 0)
+            {
+                changes.push_back({ it->first, Kind::Removed, FieldSet() });
+                it = torrents_.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+    else
+    {
+        auto removed = arguments.find("removed");
+        if ((removed != arguments.end()) && removed->is_array())
+        {
+            for (const auto &id : *removed)
+            {
+                if (!id.is_number()) continue;
+
+                const auto removedId = id.get<std::int32_t>();
+                if (torrents_.erase(removedId) > 0)
+                {
+                    changes.push_back({ removedId, Kind::Removed, FieldSet() });
+                }
+            }
+        }
+
+        /* The server leaves out the ids it doesn't know of */
+        for (const auto id : requested)
+        {
+            if ((listed.count(id) == 0) && (torrents_.erase(id) > 0))
+            {
+                changes.push_back({ id, Kind::Removed, FieldSet() });
+            }
+        }
+    }
+
+    return changes;
+}
+
+Error TorrentStorePrivate::fetch(bool full,
+                                 const std::vector<std::int32_t> &requested,
+                                 const CallOptions &options)
+{
+    auto session = session_.lock();
+    if (!session)
+    {
+        return Error(Error::Code::GearboxSessionInvalid, INVALID_SESSION);
+    }
+
+    auto response = session->sendRequest(
+        "torrent-get",
+        syncRequest(full, requested, session->tableFormat()),
+        options);
+    if (response.error) return std::move(response.error);
+
+    auto changes = apply(response.get_arguments(), full, requested);
+    if (changes.empty()) return Error();
+
+    publish(changes);
+    if (changeHandler_) changeHandler_(changes);
+
+    return Error();
+}
+
+void TorrentStorePrivate::publish(
+    const std::vector<TorrentStore::Change> &changes)
+{
+    using changed_t = std::pair<std::int32_t, TorrentSnapshot::entry_t>;
+
+    /* The torrents that changed, ordered by id, those that are gone */
+    /* without an entry                                              */
+    std::vector<changed_t> changed;
+    changed.reserve(changes.size());
+    for (const auto &change : changes)
+    {
+        auto torrent = torrents_.find(change.id);
+        changed.emplace_back(change.id,
+                             (torrent != torrents_.end())
+                                 ? TorrentSnapshot::entry(torrent->second)
+                                 : nullptr);
+    }
+    std::stable_sort(changed.begin(),
+                     changed.end(),
+                     [](const changed_t &lhs, const changed_t &rhs) {
+                         return lhs.first < rhs.first;
+                     });
+
+    const auto previous = snapshot_.load();
+    std::vector<TorrentSnapshot::entry_t> entries;
+    entries.reserve(previous->size() + changed.size());
+
+    /* Takes the last change of an id */
+    auto next = changed.begin();
+    auto take = [&entries, &next, &changed]() {
+        while ((std::next(next) != changed.end()) &&
+               (std::next(next)->first == next->first))
+        {
+            ++next;
+        }
+        if (next->second) entries.push_back(std::move(next->second));
+        ++next;
+    };
+
+    for (const auto &entry : *previous)
+    {
+        while ((next != changed.end()) && (next->first < entry->id)) take();
+
+        if ((next != changed.end()) && (next->first == entry->id))
+        {
+            take();
+            continue;
+        }
+        entries.push_back(entry);
+    }
+    while (next != changed.end()) take();
+
+    snapshot_.publish(std::make_shared<const TorrentSnapshot>(
+        std::move(entries), previous->version() + 1));
+}
+
+/*!
+    Constructs an empty store that mirrors the torrents of \c session. The
+    store keeps working if the gearbox::Session is moved, once it is
+    destroyed gearbox::TorrentStore::sync fails with
+    gearbox::Error::Code::GearboxSessionInvalid.
+*/
+TorrentStore::TorrentStore(const Session &session)
+  : priv_(new TorrentStorePrivate(session.priv_))
+{
+}
+
+/*!
+    Destructor
+*/
+TorrentStore::~TorrentStore() noexcept(true) = default;
+
+/*!
+    Brings the store up to date with the server.
+
+    The first sync, and any that comes after a call to
+    gearbox::TorrentStore::reset or too long after the previous one, fetches
+    every torrent. The others only fetch what changed since.
+
+    A sync that fails leaves the store as it was. One that succeeds invokes
+    the change handler, from the calling thread, if anything changed.
+*/
+Error TorrentStore::sync(const CallOptions &options)
+{
+    /* Measured from before the request goes out, the server may be done */
+    /* with it at any point after that.                                  */
+    const auto now = std::chrono::steady_clock::now();
+    const bool full =
+        !priv_->synced_ ||
+        (now - priv_->lastSync_ >= TorrentStorePrivate::RECENTLY_ACTIVE_WINDOW);
+
+    auto error = priv_->fetch(full, {}, options);
+    if (error) return error;
+
+    priv_->lastSync_ = now;
+    priv_->synced_ = true;
+
+    return Error();
+}
+
+/*!
+    Updates the torrents with the supplied \c ids, and only those, whether
+    they were recently active or not. Ids that are not in the store yet are
+    added, those the server no longer knows of are removed.
+
+    Unlike gearbox::TorrentStore::sync this doesn't pick up torrents that
+    were added to the server, nor count as a sync. The change handler is
+    invoked the same way.
+*/
+Error TorrentStore::refresh(const std::vector<std::int32_t> &ids,
+                            const CallOptions &options)
+{
+    if (ids.empty()) return Error();
+
+    return priv_->fetch(false, ids, options);
+}
+
+/*!
+    Sets the handler that is given the changes of each
+    gearbox::TorrentStore::sync, once the store holds them. A torrent that
+    was added reports every field, one that was removed none. The torrents
+    can be looked up from the handler, but the store must not be synced from
+    it.
+*/
+void TorrentStore::setChangeHandler(change_handler_t handler)
+{
+    priv_->changeHandler_ = std::move(handler);
+}
+
+/*!
+    Has the next gearbox::TorrentStore::sync fetch every torrent. The
+    torrents that are still on the server at that point are kept, and
+    updated in place.
+*/
+void TorrentStore::reset() { priv_->synced_ = false; }
+
+/*!
+    Returns true if the store was synced at least once, since it was created
+    or reset.
+*/
+bool TorrentStore::synced() const { return priv_->synced_; }
+
+/*!
+    Returns the number of torrents in the store.
+*/
+std::size_t TorrentStore::size() const { return priv_->torrents_.size(); }
+
+/*!
+    Returns the torrent with the supplied \c id, or nullptr if there is none.
+*/
+Torrent *TorrentStore::find(std::int32_t id)
+{
+    auto it = priv_->torrents_.find(id);
+    return (it != priv_->torrents_.end()) ? &it->second : nullptr;
+}
+
+/*!
+    Returns the torrent with the supplied \c id, or nullptr if there is none.
+*/
+const Torrent *TorrentStore::find(std::int32_t id) const
+{
+    auto it = priv_->torrents_.find(id);
+    return (it != priv_->torrents_.end()) ? &it->second : nullptr;
+}
+
+/*!
+    Returns the latest snapshot of the torrents in the store, an empty one
+    of version 0 until the first sync that finds any.
+
+    Unlike the rest of the methods this one can be called from any thread,
+    at any time, it takes no lock and doesn't wait for a sync to be done.
+    The snapshot stays valid for as long as it is held on to.
+*/
+std::shared_ptr<const TorrentSnapshot> TorrentStore::snapshot() const
+{
+    return priv_->snapshot_.load();
+}
+
+/*!
+    Returns every torrent in the store, in no particular order.
+*/
+std::vector<std::reference_wrapper<Torrent>> TorrentStore::torrents()
+{
+    std::vector<std::reference_wrapper<Torrent>> result;
+    result.reserve(priv_->torrents_.size());
+    for (auto &torrent : priv_->torrents_) result.push_back(torrent.second);
+
+    return result;
+}
@@ -0,0 +1,499 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::TorrentTable
+    \brief The numeric fields of a list of torrents, laid out in columns.
+
+    Each field is kept in a contiguous array, e.g.
+    gearbox::TorrentTable::downloadSpeeds, with the torrents in the same
+    order in every one of them. Aggregates, like the sum of the download
+    speeds or the number of torrents per status, read a single array from
+    start to end instead of following a pointer per torrent; with a large
+    number of torrents that is the difference between streaming through
+    memory and missing the cache on every one of them.
+
+    The aggregates work on a few values at a time, in independent lanes,
+    which the compiler turns into SIMD instructions where the target has
+    them. A dashboard can compute what gearbox::Session::statistics
+    reports, and more, from torrents it already has, without a call to the
+    server.
+
+    A table is a copy, it doesn't follow the torrents it was built from.
+    Building one from a gearbox::TorrentSnapshot gives a consistent view of
+    a gearbox::TorrentStore that can be used from any thread.
+*/
+
+#include "libgearbox_torrent_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+using namespace gearbox;
+
+constexpr const std::size_t TorrentTable::STATUS_COUNT;
+
+namespace
+{
+    constexpr FieldSet COLUMNS{
+        Torrent::Field::Id | Torrent::Field::BytesDownloaded |
+        Torrent::Field::PercentDone | Torrent::Field::DownloadSpeed |
+        Torrent::Field::UploadSpeed | Torrent::Field::Status |
+        Torrent::Field::Size | Torrent::Field::Eta |
+        Torrent::Field::QueuePosition
+    };
+
+    /* The number of values the kernels work on at a time */
+    constexpr std::size_t LANES{ 4 };
+
+    template <typename Result, typename T>
+    Result sumOf(const std::vector<T> &column)
+    {
+        const auto values = column.data();
+        const auto size = column.size();
+
+        Result lanes[LANES] = {};
+        std::size_t it = 0;
+        for (; it + LANES <= size; it += LANES)
+        {
+            for (std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                lanes[lane] += values[it + lane];
+            }
+        }
+
+        Result result = 0;
+        for (; it < size; ++it) result += values[it];
+        for (const auto lane : lanes) result += lane;
+
+        return result;
+    }
+
+    /* An unsigned integer as wide as a value of the column, counting */
+    /* the values of a lane then takes a lane of the same width       */
+    template <std::size_t Width> struct Counter;
+    template <> struct Counter<1>
+    {
+        using type = std::uint8_t;
+    };
+    template <> struct Counter<2>
+    {
+        using type = std::uint16_t;
+    };
+    template <> struct Counter<4>
+    {
+        using type = std::uint32_t;
+    };
+    template <> struct Counter<8>
+    {
+        using type = std::uint64_t;
+    };
+
+    template <typename T, typename Predicate>
+    std::size_t countOf(const std::vector<T> &column, Predicate matches)
+    {
+        using counter_t = typename Counter<sizeof(T)>::type;
+
+        /* As many values as fit in 16 bytes, the counters are added up */
+        /* before those of a byte, or two, can overflow                 */
+        constexpr std::size_t COUNTER_LANES{ 16 / sizeof(T) };
+        constexpr std::size_t BLOCK_SIZE{
+            COUNTER_LANES * std::min<std::size_t>(
+                                std::numeric_limits<counter_t>::max(), 1 << 16)
+        };
+
+        const auto values = column.data();
+        const auto size = column.size();
+
+        std::size_t result = 0;
+        std::size_t it = 0;
+        while (it + COUNTER_LANES <= size)
+        {
+            const auto end = it + std::min(BLOCK_SIZE,
+                                           (size - it) / COUNTER_LANES *
+                                               COUNTER_LANES);
+
+            counter_t lanes[COUNTER_LANES] = {};
+            for (; it < end; it += COUNTER_LANES)
+            {
+                for (std::size_t lane = 0; lane < COUNTER_LANES; ++lane)
+                {
+                    lanes[lane] += matches(values[it + lane]) ? 1 : 0;
+                }
+            }
+            for (const auto lane : lanes) result += lane;
+        }
+        for (; it < size; ++it) result += matches(values[it]) ? 1 : 0;
+
+        return result;
+    }
+
+    /* The bound is rounded up to a value of the column, the comparison */
+    /* is then made in the type of the column                           */
+    template <typename T>
+    std::size_t countAtLeast(const std::vector<T> &column, double bound)
+    {
+        if (std::is_floating_point<T>::value)
+        {
+            return countOf(column, [bound](T value) { return value >= bound; });
+        }
+
+        const double threshold = std::ceil(bound);
+        const double lowest = std::numeric_limits<T>::lowest();
+        const double highest = std::numeric_limits<T>::max();
+        if (threshold <= lowest) return column.size();
+        if (threshold > highest) return 0;
+        if (threshold == highest)
+        {
+            return countOf(column, [](T value) {
+                return value == std::numeric_limits<T>::max();
+            });
+        }
+
+        const auto converted = static_cast<T>(threshold);
+        return countOf(column,
+                       [converted](T value) { return value >= converted; });
+    }
+}
+
+/*!
+    Constructs an empty table.
+*/
+TorrentTable::TorrentTable()
+  : ids_(), bytesDownloaded_(), percentDone_(), downloadSpeeds_(),
+    uploadSpeeds_(), statuses_(), sizes_(), etas_(), queuePositions_()
+{
+}
+
+/*!
+    Constructs a table from the entries of \c snapshot, ordered by id.
+*/
+TorrentTable::TorrentTable(const TorrentSnapshot &snapshot) : TorrentTable()
+{
+    reserve(snapshot.size());
+    for (const auto &entry : snapshot)
+    {
+        ids_.push_back(entry->id);
+        bytesDownloaded_.push_back(entry->bytesDownloaded);
+        percentDone_.push_back(entry->percentDone);
+        downloadSpeeds_.push_back(entry->downloadSpeed);
+        uploadSpeeds_.push_back(entry->uploadSpeed);
+        statuses_.push_back(static_cast<std::uint8_t>(entry->status));
+        sizes_.push_back(entry->size);
+        etas_.push_back(entry->eta);
+        queuePositions_.push_back(entry->queuePosition);
+    }
+}
+
+/*!
+    Constructs a table from the valid torrents of \c torrents, in the same
+    order.
+*/
+TorrentTable::TorrentTable(const std::vector<Torrent> &torrents)
+  : TorrentTable()
+{
+    reserve(torrents.size());
+    for (const auto &torrent : torrents)
+    {
+        if (torrent.valid()) append(torrent);
+    }
+}
+
+/*!
+    Constructs a table from the valid torrents of \c torrents, in the same
+    order.
+*/
+TorrentTable::TorrentTable(
+    const std::vector<std::reference_wrapper<Torrent>> &torrents)
+  : TorrentTable()
+{
+    reserve(torrents.size());
+    for (const Torrent &torrent : torrents)
+    {
+        if (torrent.valid()) append(torrent);
+    }
+}
+
+void TorrentTable::reserve(std::size_t size)
+{
+    ids_.reserve(size);
+    bytesDownloaded_.reserve(size);
+    percentDone_.reserve(size);
+    downloadSpeeds_.reserve(size);
+    uploadSpeeds_.reserve(size);
+    statuses_.reserve(size);
+    sizes_.reserve(size);
+    etas_.reserve(size);
+    queuePositions_.reserve(size);
+}
+
+void TorrentTable::append(const Torrent &torrent)
+{
+    ids_.push_back(torrent.id());
+    bytesDownloaded_.push_back(torrent.bytesDownloaded());
+    percentDone_.push_back(torrent.percentDone());
+    downloadSpeeds_.push_back(torrent.downloadSpeed());
+    uploadSpeeds_.push_back(torrent.uploadSpeed());
+    statuses_.push_back(static_cast<std::uint8_t>(torrent.status()));
+    sizes_.push_back(torrent.size());
+    etas_.push_back(torrent.eta());
+    queuePositions_.push_back(torrent.queuePosition());
+}
+
+/*!
+    Returns the number of torrents in the table.
+*/
+std::size_t TorrentTable::size() const { return ids_.size(); }
+
+/*!
+    Returns true if the table has no torrents.
+*/
+bool TorrentTable::empty() const { return ids_.empty(); }
+
+/*!
+    Returns the ids of the torrents.
+*/
+const std::vector<std::int32_t> &TorrentTable::ids() const { return ids_; }
+
+/*!
+    Returns the number of bytes downloaded, and verified, of each torrent.
+*/
+const std::vector<std::uint64_t> &TorrentTable::bytesDownloaded() const
+{
+    return bytesDownloaded_;
+}
+
+/*!
+    Returns the progress of each torrent, from 0 to 1.
+*/
+const std::vector<double> &TorrentTable::percentDone() const
+{
+    return percentDone_;
+}
+
+/*!
+    Returns the download speed of each torrent, in bytes/s.
+*/
+const std::vector<std::uint64_t> &TorrentTable::downloadSpeeds() const
+{
+    return downloadSpeeds_;
+}
+
+/*!
+    Returns the upload speed of each torrent, in bytes/s.
+*/
+const std::vector<std::uint64_t> &TorrentTable::uploadSpeeds() const
+{
+    return uploadSpeeds_;
+}
+
+/*!
+    Returns the gearbox::Torrent::Status of each torrent.
+*/
+const std::vector<std::uint8_t> &TorrentTable::statuses() const
+{
+    return statuses_;
+}
+
+/*!
+    Returns the size of each torrent, in bytes.
+*/
+const std::vector<std::uint64_t> &TorrentTable::sizes() const
+{
+    return sizes_;
+}
+
+/*!
+    Returns the estimated time, in seconds, each torrent needs to complete.
+*/
+const std::vector<std::int32_t> &TorrentTable::etas() const { return etas_; }
+
+/*!
+    Returns the position of each torrent in the queue.
+*/
+const std::vector<std::int32_t> &TorrentTable::queuePositions() const
+{
+    return queuePositions_;
+}
+
+/*!
+    Returns the sum of \c field over every torrent, for the fields counted
+    in bytes: gearbox::Torrent::Field::BytesDownloaded,
+    gearbox::Torrent::Field::DownloadSpeed,
+    gearbox::Torrent::Field::UploadSpeed and gearbox::Torrent::Field::Size.
+    Returns 0 for any other field.
+*/
+std::uint64_t TorrentTable::sum(Torrent::Field field) const
+{
+    switch (field)
+    {
+        default:
+            return 0;
+        case Torrent::Field::BytesDownloaded:
+            return sumOf<std::uint64_t>(bytesDownloaded_);
+        case Torrent::Field::DownloadSpeed:
+            return sumOf<std::uint64_t>(downloadSpeeds_);
+        case Torrent::Field::UploadSpeed:
+            return sumOf<std::uint64_t>(uploadSpeeds_);
+        case Torrent::Field::Size:
+            return sumOf<std::uint64_t>(sizes_);
+    }
+}
+
+/*!
+    Returns the average of \c field over every torrent, for any of the
+    fields that are in the table but gearbox::Torrent::Field::Id and
+    gearbox::Torrent::Field::Status. Returns 0 for any other field, or if
+    the table is empty.
+*/
+double TorrentTable::average(Torrent::Field field) const
+{
+    if (empty()) return 0.0;
+
+    double total = 0.0;
+    switch (field)
+    {
+        default:
+            return 0.0;
+        case Torrent::Field::PercentDone:
+            total = sumOf<double>(percentDone_);
+            break;
+        case Torrent::Field::Eta:
+            total = static_cast<double>(sumOf<std::int64_t>(etas_));
+            break;
+        case Torrent::Field::QueuePosition:
+            total = static_cast<double>(sumOf<std::int64_t>(queuePositions_));
+            break;
+        case Torrent::Field::BytesDownloaded:
+        case Torrent::Field::DownloadSpeed:
+        case Torrent::Field::UploadSpeed:
+        case Torrent::Field::Size:
+            total = static_cast<double>(sum(field));
+            break;
+    }
+
+    return total / static_cast<double>(size());
+}
+
+/*!
+    Returns the number of torrents in each gearbox::Torrent::Status, indexed
+    by its value. Torrents with an invalid status are not counted.
+*/
+TorrentTable::status_counts_t TorrentTable::countByStatus() const
+{
+    status_counts_t result{};
+    for (std::size_t status = 0; status < STATUS_COUNT; ++status)
+    {
+        const auto value = static_cast<std::uint8_t>(status);
+        result[status] = countOf(
+            statuses_, [value](std::uint8_t other) { return other == value; });
+    }
+
+    return result;
+}
+
+/*!
+    Returns the number of torrents whose \c field falls in each of the
+    buckets delimited by \c bounds, which are expected in ascending order.
+    The first bucket counts the values below the first bound, bucket \c i
+    those from bound \c i - 1 up to, not including, bound \c i, the last one
+    those from the last bound up.
+
+    Returns an empty list for a field that isn't in the table.
+*/
+std::vector<std::size_t> TorrentTable::histogram(
+    Torrent::Field field,
+    const std::vector<double> &bounds) const
+{
+    auto atLeast = [this, field](double bound) -> std::size_t {
+        switch (field)
+        {
+            default:
+                return 0;
+            case Torrent::Field::Id:
+                return countAtLeast(ids_, bound);
+            case Torrent::Field::BytesDownloaded:
+                return countAtLeast(bytesDownloaded_, bound);
+            case Torrent::Field::PercentDone:
+                return countAtLeast(percentDone_, bound);
+            case Torrent::Field::DownloadSpeed:
+                return countAtLeast(downloadSpeeds_, bound);
+            case Torrent::Field::UploadSpeed:
+                return countAtLeast(uploadSpeeds_, bound);
+            case Torrent::Field::Status:
+                return countAtLeast(statuses_, bound);
+            case Torrent::Field::Size:
+                return countAtLeast(sizes_, bound);
+            case Torrent::Field::Eta:
+                return countAtLeast(etas_, bound);
+            case Torrent::Field::QueuePosition:
+                return countAtLeast(queuePositions_, bound);
+        }
+    };
+
+    if (!COLUMNS.contains(field)) return {};
+
+    /* Each bucket is what is at least its lower bound, less what is at */
+    /* least its upper one                                              */
+    std::vector<std::size_t> result(bounds.size() + 1);
+    auto below = size();
+    for (std::size_t it = 0; it < bounds.size(); ++it)
+    {
+        const auto above = atLeast(bounds[it]);
+        result[it] = below - std::min(above, below);
+        below = std::min(above, below);
+    }
+    result.back() = below;
+
+    return result;
+}
+
+/*!
+    Returns what gearbox::Session::statistics would report for the torrents
+    in the table: stopped torrents count as paused, every other one as
+    active.
+*/
+Session::Statistics TorrentTable::statistics() const
+{
+    constexpr std::uint64_t MAX_SPEED{
+        std::numeric_limits<std::int32_t>::max()
+    };
+
+    const auto total = static_cast<std::int32_t>(size());
+    const auto paused = static_cast<std::int32_t>(
+        countByStatus()[static_cast<std::size_t>(Torrent::Status::Stopped)]);
+
+    Session::Statistics result{};
+    result.totalTorrentCount = total;
+    result.activeTorrentCount = total - paused;
+    result.pausedTorrentCount = paused;
+    result.downloadSpeed = static_cast<std::int32_t>(
+        std::min(sum(Torrent::Field::DownloadSpeed), MAX_SPEED));
+    result.uploadSpeed = static_cast<std::int32_t>(
+        std::min(sum(Torrent::Field::UploadSpeed), MAX_SPEED));
+
+    return result;
+}
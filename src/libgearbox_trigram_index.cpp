@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2016 Romeo Calota
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ * 
+ * Author: Romeo Calota
+ */
+
+/*!
+    \class gearbox::TrigramIndex
+    \brief Finds the texts that contain a string, regardless of case,
+    without going through every one of them.
+
+    Every text is split into the overlapping sequences of three characters
+    it is made of, its trigrams, and the index keeps, for each trigram, the
+    keys of the texts that have it. A text can only contain "s01e05" if it
+    has "s01", "01e", "1e0" and "e05", so a search intersects those four
+    lists, starting with the shortest, and only checks the few texts left.
+    Patterns of one or two characters have no trigram to narrow the
+    search, every text is checked for them.
+
+    Letters are compared regardless of case in ASCII, other characters,
+    e.g. those of a UTF-8 sequence, have to match exactly.
+
+    gearbox::TrigramIndex::update keeps the index up to date with the names
+    of the torrents of a gearbox::TorrentSnapshot, by id, or with the paths
+    of the files of a torrent, by their position in the list. Given the
+    changes reported by a gearbox::TorrentStore, only the torrents that
+    changed are looked at.
+
+    In each case a text that is the same as before is left as is. An index
+    is not safe to update from one thread while it is searched from
+    another.
+*/
+
+#include "libgearbox_trigram_index.h"
+
+#include <algorithm>
+#include <functional>
+
+using namespace gearbox;
+
+namespace
+{
+    inline char fold(char c)
+    {
+        return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a')
+                                          : c;
+    }
+
+    std::string fold(const std::string &text)
+    {
+        std::string result(text);
+        for (auto &c : result) c = fold(c);
+        return result;
+    }
+
+    /* Whether folded is text, folded */
+    bool foldsTo(const std::string &text, const std::string &folded)
+    {
+        if (text.size() != folded.size()) return false;
+
+        for (std::size_t it = 0; it < text.size(); ++it)
+        {
+            if (fold(text[it]) != folded[it]) return false;
+        }
+
+        return true;
+    }
+
+    /* The distinct trigrams of folded, in increasing order */
+    std::vector<std::uint32_t> trigrams(const std::string &folded)
+    {
+        std::vector<std::uint32_t> result;
+        if (folded.size() < 3) return result;
+
+        result.reserve(folded.size() - 2);
+        for (std::size_t it = 0; it + 2 < folded.size(); ++it)
+        {
+            result.push_back(
+                (static_cast<std::uint32_t>(
+                     static_cast<unsigned char>(folded[it]))
+                 << 16) |
+                (static_cast<std::uint32_t>(
+                     static_cast<unsigned char>(folded[it + 1]))
+                 << 8) |
+                static_cast<unsigned char>(folded[it + 2]));
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+
+        return result;
+    }
+
+    /* The first of [first, last) that is not less than value, looked */
+    /* for in steps that double, from first, until they overshoot it   */
+    template <typename Iterator, typename T, typename Less>
+    Iterator gallop(Iterator first, Iterator last, const T &value, Less less)
+    {
+        std::ptrdiff_t step = 1;
+        while ((std::distance(first, last) > step) && less(first[step], value))
+        {
+            first += step;
+            step *= 2;
+        }
+
+        return std::lower_bound(
+            first,
+            first + std::min(step + 1, std::distance(first, last)),
+            value,
+            less);
+    }
+
+    /* Keeps the keys of [first, last) that are also in keys, both in */
+    /* increasing order                                                */
+    template <typename Iterator, typename Key>
+    Iterator intersect(Iterator first,
+                       Iterator last,
+                       const std::vector<Key> &keys)
+    {
+        auto from = keys.begin();
+        auto kept = first;
+        for (; first != last; ++first)
+        {
+            from = gallop(from, keys.end(), *first, std::less<Key>());
+            if (from == keys.end()) break;
+            if (*from == *first) *kept++ = *first;
+        }
+
+        return kept;
+    }
+
+    /* The heap memory held by a string, none if it fits in the object */
+    inline std::size_t allocated(const std::string &text)
+    {
+        return (text.capacity() > std::string().capacity())
+                   ? text.capacity() + 1
+                   : 0;
+    }
+}
+
+/*!
+    Constructs an empty index.
+*/
+TrigramIndex::TrigramIndex() : documents_(), postings_() {}
+
+/*!
+    Indexes \c text under \c key, in place of the text it had before, if
+    any.
+*/
+void TrigramIndex::insert(key_t key, const std::string &text)
+{
+    assign(key, text, documents_.size());
+}
+
+/*!
+    Removes the text of \c key from the index. Returns false if there was
+    none.
+*/
+bool TrigramIndex::erase(key_t key)
+{
+    auto document = lookup(key);
+    if ((document == documents_.end()) || (document->key != key))
+    {
+        return false;
+    }
+
+    unindex(key, document->text);
+    documents_.erase(document);
+
+    return true;
+}
+
+/*!
+    Removes every text from the index.
+*/
+void TrigramIndex::clear()
+{
+    documents_.clear();
+    postings_.clear();
+}
+
+/*!
+    Indexes the names of the torrents of \c snapshot, by id, and drops the
+    torrents that are not in it. Only the names that changed are indexed
+    again.
+*/
+void TrigramIndex::update(const TorrentSnapshot &snapshot)
+{
+    /* Both are ordered by id */
+    auto entry = snapshot.begin();
+    auto kept = documents_.begin();
+    for (auto &document : documents_)
+    {
+        while ((entry != snapshot.end()) && ((*entry)->id < document.key))
+        {
+            ++entry;
+        }
+
+        if ((entry == snapshot.end()) || ((*entry)->id != document.key))
+        {
+            unindex(document.key, document.text);
+            continue;
+        }
+        if (&*kept != &document) *kept = std::move(document);
+        ++kept;
+    }
+    documents_.erase(kept, documents_.end());
+
+    std::size_t position = 0;
+    for (const auto &entry : snapshot)
+    {
+        position = assign(entry->id, entry->name, position) + 1;
+    }
+}
+
+/*!
+    Indexes the names of the torrents in \c changes, as they are in
+    \c snapshot; e.g. from a gearbox::TorrentStore::change_handler_t with
+    the gearbox::TorrentStore::snapshot published along with the changes.
+    Only torrents that were added, removed, or whose name changed are
+    looked at.
+*/
+void TrigramIndex::update(const TorrentSnapshot &snapshot,
+                          const std::vector<TorrentStore::Change> &changes)
+{
+    using Kind = TorrentStore::Change::Kind;
+
+    for (const auto &change : changes)
+    {
+        if ((change.kind == Kind::Updated) &&
+            !change.fields.contains(Torrent::Field::Name))
+        {
+            continue;
+        }
+
+        const auto entry = snapshot.find(change.id);
+        if (entry != nullptr)
+        {
+            assign(change.id, entry->name, documents_.size());
+        }
+        else
+        {
+            erase(change.id);
+        }
+    }
+}
+
+/*!
+    Indexes the paths of \c files, e.g. as returned by
+    gearbox::Torrent::files, by their position in the list. Files that are
+    no longer in the list are dropped, the paths that didn't change are
+    left as they are.
+*/
+void TrigramIndex::update(const std::vector<File> &files)
+{
+    const auto first = lookup(0);
+    const auto last = lookup(static_cast<key_t>(files.size()));
+    for (auto document = documents_.begin(); document != first; ++document)
+    {
+        unindex(document->key, document->text);
+    }
+    for (auto document = last; document != documents_.end(); ++document)
+    {
+        unindex(document->key, document->text);
+    }
+    documents_.erase(last, documents_.end());
+    documents_.erase(documents_.begin(), first);
+
+    for (std::size_t it = 0; it < files.size(); ++it)
+    {
+        assign(static_cast<key_t>(it), files[it].name(), it);
+    }
+}
+
+/*!
+    Returns the keys of the texts that contain \c pattern, regardless of
+    case, in increasing order. An empty pattern matches every text.
+*/
+std::vector<TrigramIndex::key_t> TrigramIndex::find(
+    const std::string &pattern) const
+{
+    const auto folded = fold(pattern);
+    std::vector<key_t> result;
+
+    const auto grams = trigrams(folded);
+    if (grams.empty())
+    {
+        for (const auto &document : documents_)
+        {
+            if (document.text.find(folded) != std::string::npos)
+            {
+                result.push_back(document.key);
+            }
+        }
+
+        return result;
+    }
+
+    /* The shortest list bounds the number of texts that can match */
+    std::vector<const std::vector<key_t> *> lists;
+    lists.reserve(grams.size());
+    for (const auto gram : grams)
+    {
+        auto posting = postings_.find(gram);
+        if (posting == postings_.end()) return result;
+
+        lists.push_back(&posting->second);
+    }
+    std::sort(lists.begin(),
+              lists.end(),
+              [](const std::vector<key_t> *lhs, const std::vector<key_t> *rhs) {
+                  return lhs->size() < rhs->size();
+              });
+
+    result = *lists.front();
+    for (auto list = std::next(lists.begin());
+         (list != lists.end()) && !result.empty();
+         ++list)
+    {
+        result.erase(intersect(result.begin(), result.end(), **list),
+                     result.end());
+    }
+
+    /* Having every trigram of a longer pattern doesn't mean having them */
+    /* next to each other. The texts are checked in the order they are   */
+    /* kept in.                                                          */
+    if (folded.size() > 3)
+    {
+        auto document = documents_.begin();
+        auto kept = result.begin();
+        for (const auto key : result)
+        {
+            document = gallop(document,
+                              documents_.end(),
+                              key,
+                              [](const Document &lhs, key_t rhs) {
+                                  return lhs.key < rhs;
+                              });
+            if (document->text.find(folded) != std::string::npos)
+            {
+                *kept++ = key;
+            }
+        }
+        result.erase(kept, result.end());
+    }
+
+    return result;
+}
+
+/*!
+    Returns true if there is a text indexed under \c key.
+*/
+bool TrigramIndex::contains(key_t key) const
+{
+    return std::binary_search(documents_.begin(),
+                              documents_.end(),
+                              Document{ key, std::string() },
+                              [](const Document &lhs, const Document &rhs) {
+                                  return lhs.key < rhs.key;
+                              });
+}
+
+/*!
+    Returns the number of texts in the index.
+*/
+std::size_t TrigramIndex::size() const { return documents_.size(); }
+
+/*!
+    Returns true if the index has no text.
+*/
+bool TrigramIndex::empty() const { return documents_.empty(); }
+
+/*!
+    Returns an estimate, in bytes, of the memory used by the index: the
+    texts it keeps to check the matches, the list of keys of each trigram
+    and the hash table that holds them.
+*/
+std::size_t TrigramIndex::memoryUsage() const
+{
+    /* A node of a hash table holds its value and the pointer to the next */
+    /* one, the table itself a pointer per bucket                         */
+    constexpr std::size_t POSTING_NODE{
+        sizeof(std::pair<const trigram_t, std::vector<key_t>>) + sizeof(void *)
+    };
+
+    std::size_t result = sizeof(*this);
+
+    result += documents_.capacity() * sizeof(Document);
+    for (const auto &document : documents_)
+    {
+        result += allocated(document.text);
+    }
+
+    result += postings_.bucket_count() * sizeof(void *);
+    result += postings_.size() * POSTING_NODE;
+    for (const auto &posting : postings_)
+    {
+        result += posting.second.capacity() * sizeof(key_t);
+    }
+
+    return result;
+}
+
+std::vector<TrigramIndex::Document>::iterator TrigramIndex::lookup(key_t key)
+{
+    return std::lower_bound(documents_.begin(),
+                            documents_.end(),
+                            key,
+                            [](const Document &document, key_t key) {
+                                return document.key < key;
+                            });
+}
+
+std::size_t TrigramIndex::assign(key_t key,
+                                 const std::string &text,
+                                 std::size_t hint)
+{
+    /* Keys mostly come in increasing order, e.g. ids and positions, the */
+    /* document is then right at the hint                                */
+    auto document =
+        documents_.begin() +
+        static_cast<std::ptrdiff_t>(std::min(hint, documents_.size()));
+    if (((document != documents_.end()) && (document->key < key)) ||
+        ((document != documents_.begin()) && (std::prev(document)->key >= key)))
+    {
+        document = lookup(key);
+    }
+
+    if ((document != documents_.end()) && (document->key == key))
+    {
+        if (!foldsTo(text, document->text))
+        {
+            unindex(key, document->text);
+            document->text = fold(text);
+            index(key, document->text);
+        }
+    }
+    else
+    {
+        document = documents_.insert(document, Document{ key, fold(text) });
+        index(key, document->text);
+    }
+
+    return static_cast<std::size_t>(
+        std::distance(documents_.begin(), document));
+}
+
+void TrigramIndex::index(key_t key, const std::string &folded)
+{
+    for (const auto gram : trigrams(folded))
+    {
+        auto &keys = postings_[gram];
+        if (keys.empty() || (keys.back() < key))
+        {
+            keys.push_back(key);
+            continue;
+        }
+        keys.insert(std::lower_bound(keys.begin(), keys.end(), key), key);
+    }
+}
+
+void TrigramIndex::unindex(key_t key, const std::string &folded)
+{
+    for (const auto gram : trigrams(folded))
+    {
+        auto posting = postings_.find(gram);
+        if (posting == postings_.end()) continue;
+
+        auto &keys = posting->second;
+        auto it = std::lower_bound(keys.begin(), keys.end(), key);
+        if ((it != keys.end()) && (*it == key)) keys.erase(it);
+        if (keys.empty()) postings_.erase(posting);
+    }
+}
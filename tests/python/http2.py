@@ -0,0 +1,104 @@
+import itertools
+import socketserver
+import struct
+import threading
+
+# A bare-bones HTTP/2 server, speaking cleartext HTTP/2 with prior knowledge,
+# that answers every request with 'OK HTTP/2 <connection>'. The connection
+# number tells how many connections were opened up to and including the one
+# that served the request.
+
+HOST = 'localhost'
+PORT = 9998
+
+PREFACE = b'PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n'
+
+FRAME_DATA = 0x0
+FRAME_HEADERS = 0x1
+FRAME_SETTINGS = 0x4
+FRAME_PING = 0x6
+FRAME_GOAWAY = 0x7
+
+FLAG_ACK = 0x1
+FLAG_END_STREAM = 0x1
+FLAG_END_HEADERS = 0x4
+
+SETTINGS_MAX_CONCURRENT_STREAMS = 0x3
+
+connection_counter = itertools.count(1)
+
+def encode_response_headers(content_length):
+    # ':status: 200' is entry 8 of the HPACK static table, 'content-length'
+    # is entry 28 and is sent as a literal that is not added to the index
+    value = str(content_length).encode('ascii')
+    return bytes([0x88, 0x0f, 28 - 15, len(value)]) + value
+
+class HTTP2RequestHandler(socketserver.BaseRequestHandler):
+    def setup(self):
+        self.connection_number = next(connection_counter)
+        self.write_lock = threading.Lock()
+
+    def read_exactly(self, size):
+        data = b''
+        while len(data) < size:
+            chunk = self.request.recv(size - len(data))
+            if not chunk:
+                return None
+            data += chunk
+        return data
+
+    def send_frame(self, frame_type, flags, stream_id, payload=b''):
+        header = struct.pack('>I', len(payload))[1:] + \
+                 struct.pack('>BBI', frame_type, flags, stream_id & 0x7fffffff)
+        with self.write_lock:
+            self.request.sendall(header + payload)
+
+    def respond(self, stream_id):
+        data = 'OK HTTP/2 {}'.format(self.connection_number).encode('utf-8')
+        self.send_frame(FRAME_HEADERS, FLAG_END_HEADERS, stream_id,
+                        encode_response_headers(len(data)))
+        self.send_frame(FRAME_DATA, FLAG_END_STREAM, stream_id, data)
+
+    def handle(self):
+        if self.read_exactly(len(PREFACE)) != PREFACE:
+            return
+
+        self.send_frame(FRAME_SETTINGS, 0, 0,
+                        struct.pack('>HI', SETTINGS_MAX_CONCURRENT_STREAMS, 100))
+
+        while True:
+            header = self.read_exactly(9)
+            if header is None:
+                return
+
+            length = struct.unpack('>I', b'\x00' + header[:3])[0]
+            frame_type, flags, stream_id = struct.unpack('>BBI', header[3:])
+            stream_id &= 0x7fffffff
+            payload = self.read_exactly(length) if length > 0 else b''
+            if payload is None:
+                return
+
+            # Request headers and bodies are of no interest, a stream gets
+            # its response as soon as the client is done sending it
+            if frame_type == FRAME_SETTINGS:
+                if not flags & FLAG_ACK:
+                    self.send_frame(FRAME_SETTINGS, FLAG_ACK, 0)
+            elif frame_type == FRAME_PING:
+                if not flags & FLAG_ACK:
+                    self.send_frame(FRAME_PING, FLAG_ACK, 0, payload)
+            elif frame_type == FRAME_GOAWAY:
+                return
+            elif frame_type in (FRAME_HEADERS, FRAME_DATA):
+                if flags & FLAG_END_STREAM:
+                    self.respond(stream_id)
+
+class ThreadedHTTP2Server(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+def start():
+    server = ThreadedHTTP2Server((HOST, PORT), HTTP2RequestHandler)
+    thread = threading.Thread(target=server.serve_forever)
+    thread.daemon = True
+    thread.start()
+    return server
@@ -1,11 +1,20 @@
 from http.server import HTTPServer, BaseHTTPRequestHandler
+from socketserver import ThreadingMixIn
 import base64
+import gzip
+import os
+import socket
+import socketserver
+import threading
+import time
 import gearbox_test
 
 from server import Session
+import http2
 
 HOST = 'localhost'
 PORT = 9999
+UNIX_SOCKET_PATH = '/tmp/libgearbox_test.sock'
 
 SERVER_NAME = 'Transmission'
 CONTENT_TYPE = 'application/json'
@@ -29,6 +38,21 @@ CONNECT_TEST_CODE = 200
 CONNECT_TEST_CONTENT_TYPE = 'text/plain'
 CONNECT_TEST_DATA = 'OK'
 
+COMPRESSION_TEST_PATH = '/test_compression'
+COMPRESSION_TEST_DATA = 'OK ' * 1024
+
+CHUNKED_TEST_PATH = '/test_chunked'
+CHUNKED_TEST_CHUNKS = ['OK', ' CHUNKED']
+
+SESSION_TOKEN_TEST_PATH = '/test_session_token'
+SESSION_TOKEN_HEADER = 'X-Transmission-Session-Id'
+SESSION_TOKEN_ROTATION_INTERVAL = 500
+
+SLOW_TEST_PATH = '/test_slow'
+SLOW_TEST_CHUNK = 'OK '
+SLOW_TEST_CHUNK_COUNT = 100
+SLOW_TEST_CHUNK_INTERVAL = 0.1
+
 def make_response_bad_auth():
     response = Response()
     response.code = BAD_AUTH_CODE
@@ -51,6 +75,64 @@ def make_response_test_connection():
     response.data = CONNECT_TEST_DATA
     return response
 
+def make_response_test_compression():
+    response = make_response_test_connection()
+    response.data = COMPRESSION_TEST_DATA
+    return response
+
+def send_response_test_slow(request_handler):
+    # Trickles the body for 10 seconds, a request that is still waiting for
+    # all of it long before then has been cut short by the client
+    request_handler.send_response(CONNECT_TEST_CODE)
+    request_handler.send_header('Content-Length',
+                                len(SLOW_TEST_CHUNK) * SLOW_TEST_CHUNK_COUNT)
+    request_handler.send_header('Content-Type', CONNECT_TEST_CONTENT_TYPE)
+    request_handler.end_headers()
+    try:
+        for _ in range(SLOW_TEST_CHUNK_COUNT):
+            request_handler.wfile.write(SLOW_TEST_CHUNK.encode('utf-8'))
+            request_handler.wfile.flush()
+            time.sleep(SLOW_TEST_CHUNK_INTERVAL)
+    except (BrokenPipeError, ConnectionResetError):
+        request_handler.close_connection = True
+
+class RotatingSessionToken:
+    # Same as the daemon, a request with any token but the current one gets
+    # a 409 along with the current one. The token, 'token-<n>', is replaced
+    # every SESSION_TOKEN_ROTATION_INTERVAL accepted requests.
+    lock = threading.Lock()
+    accepted = 0
+    rotations = 0
+
+def make_response_test_session_token(request):
+    response = Response()
+    with RotatingSessionToken.lock:
+        token = 'token-{}'.format(RotatingSessionToken.rotations)
+        if request.headers[SESSION_TOKEN_HEADER] == token:
+            RotatingSessionToken.accepted += 1
+            if RotatingSessionToken.accepted % SESSION_TOKEN_ROTATION_INTERVAL == 0:
+                RotatingSessionToken.rotations += 1
+            response = make_response_test_connection()
+        else:
+            response.code = 409
+            response.content_type = 'text/html; charset=ISO-8859-1'
+            response.data = '<h1>Bad X-Transmission-Session-Id</h1>'
+    response.headers[SESSION_TOKEN_HEADER] = token
+    return response
+
+def send_response_test_chunked(request_handler):
+    # Every chunk size carries an extension, which clients have to skip
+    request_handler.send_response(CONNECT_TEST_CODE)
+    request_handler.send_header('Transfer-Encoding', 'chunked')
+    request_handler.send_header('Content-Type', CONNECT_TEST_CONTENT_TYPE)
+    request_handler.end_headers()
+    for chunk in CHUNKED_TEST_CHUNKS:
+        data = chunk.encode('utf-8')
+        request_handler.wfile.write('{:x};ext=1\r\n'.format(len(data)).encode('ascii'))
+        request_handler.wfile.write(data + b'\r\n')
+        request_handler.wfile.flush()
+    request_handler.wfile.write(b'0\r\n\r\n')
+
 class Request:
     def __init__(self):
         self.headers = { }
@@ -64,17 +146,30 @@ class Response:
         self.data = ''
 
     def send(self, request_handler):
+        data = self.data.encode('utf-8')
+
         request_handler.send_response(self.code)
 
         for key, value in self.headers.items():
             request_handler.send_header(key, value)
-        request_handler.send_header('Content-Length', len(self.data))
+        accept_encoding = request_handler.headers['Accept-Encoding'] or ''
+        if 'gzip' in accept_encoding:
+            data = gzip.compress(data)
+            request_handler.send_header('Content-Encoding', 'gzip')
+        request_handler.send_header('Content-Length', len(data))
         request_handler.send_header('Content-Type', self.content_type)
         request_handler.end_headers()
 
-        request_handler.wfile.write(self.data.encode('utf-8'))
+        request_handler.wfile.write(data)
 
 class HTTPRequestHandler(BaseHTTPRequestHandler):
+    # Needs to be set before the request is parsed, otherwise the connection
+    # is closed after each response and clients can't keep it alive
+    protocol_version = 'HTTP/1.1'
+    # Headers and body are written separately, with Nagle's algorithm the
+    # body would wait for the client to acknowledge the headers
+    disable_nagle_algorithm = True
+
     def prepare(self):
         self.protocol_version = 'HTTP/1.1'
         self.server_version = SERVER_NAME
@@ -82,7 +177,6 @@ class HTTPRequestHandler(BaseHTTPRequestHandler):
 
     def address_string(self):
         host, port = self.client_address[:2]
-        self.address_string = host
         return host
 
     def is_authenticated(self):
@@ -103,6 +197,14 @@ class HTTPRequestHandler(BaseHTTPRequestHandler):
         if self.path == CONNECT_TEST_PATH:
             response = make_response_test_connection()
             response.data += ' GET'
+        elif self.path == COMPRESSION_TEST_PATH:
+            response = make_response_test_compression()
+        elif self.path == SLOW_TEST_PATH:
+            send_response_test_slow(self)
+            return
+        elif self.path == CHUNKED_TEST_PATH:
+            send_response_test_chunked(self)
+            return
         else:
             if not self.is_authenticated():
                 response = make_response_bad_auth()
@@ -124,6 +226,17 @@ class HTTPRequestHandler(BaseHTTPRequestHandler):
         if self.path == CONNECT_TEST_PATH:
             response = make_response_test_connection()
             response.data += ' ' + request.data
+            # Clients are not supposed to wait for a 100 Continue
+            if 'Expect' in self.headers:
+                response.data += ' EXPECT'
+        elif self.path == SESSION_TOKEN_TEST_PATH:
+            response = make_response_test_session_token(request)
+        elif self.path == SLOW_TEST_PATH:
+            send_response_test_slow(self)
+            return
+        elif self.path == CHUNKED_TEST_PATH:
+            send_response_test_chunked(self)
+            return
         else:
             if not self.is_authenticated():
                 response = make_response_bad_auth()
@@ -135,7 +248,39 @@ class HTTPRequestHandler(BaseHTTPRequestHandler):
 
         response.send(self)
 
+class ThreadedHTTPServer(ThreadingMixIn, HTTPServer):
+    # Kept-alive connections occupy a thread each, don't wait for them on exit
+    daemon_threads = True
+    # Asynchronous tests open a few dozen connections at once
+    request_queue_size = 128
+
+class UnixHTTPRequestHandler(HTTPRequestHandler):
+    disable_nagle_algorithm = False
+
+    # Peers of a Unix domain socket have no address
+    def address_string(self):
+        return UNIX_SOCKET_PATH
+
+def start_unix_server():
+    # Serves the same requests as the TCP server, over a Unix domain socket
+    if not hasattr(socket, 'AF_UNIX'):
+        return None
+
+    class ThreadedUnixHTTPServer(ThreadingMixIn, socketserver.UnixStreamServer):
+        daemon_threads = True
+        request_queue_size = 128
+
+    if os.path.exists(UNIX_SOCKET_PATH):
+        os.remove(UNIX_SOCKET_PATH)
+    server = ThreadedUnixHTTPServer(UNIX_SOCKET_PATH, UnixHTTPRequestHandler)
+    thread = threading.Thread(target=server.serve_forever)
+    thread.daemon = True
+    thread.start()
+    return server
+
 if __name__ == "__main__":
-    httpd = HTTPServer((HOST, PORT), HTTPRequestHandler)
+    httpd = ThreadedHTTPServer((HOST, PORT), HTTPRequestHandler)
+    http2.start()
+    start_unix_server()
     gearbox_test.server_ready()
     httpd.serve_forever()
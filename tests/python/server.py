@@ -24,8 +24,24 @@ def get_torrents(request):
         recently_active['tag'] = request['tag']
         return json.dumps(recently_active) + '\n'
     else:
-        torrents['tag'] = request['tag']
-        return json.dumps(torrents) + '\n'
+        # Like the daemon, only the requested torrents and fields are sent
+        ids = request['arguments'].get('ids')
+        fields = request['arguments'].get('fields')
+        response = dict(torrents)
+        if ids is not None or fields is not None:
+            response['arguments'] = { 'torrents': [
+                { key: value for key, value in torrent.items() if fields is None or key in fields }
+                for torrent in torrents['arguments']['torrents']
+                if ids is None or torrent['id'] in ids ] }
+        if request['arguments'].get('format') == 'table':
+            # A header row with the names of the fields, then one row of
+            # values per torrent
+            objects = response['arguments']['torrents']
+            header = list(objects[0].keys()) if objects else list(fields or [])
+            response['arguments'] = { 'torrents': [ header ] + [
+                [ torrent.get(key) for key in header ] for torrent in objects ] }
+        response['tag'] = request['tag']
+        return json.dumps(response) + '\n'
 
 def test_send_request(request):
     result = {
@@ -35,6 +51,21 @@ def test_send_request(request):
     }
     return json.dumps(result) + '\n';
 
+mutation_methods = [
+    'torrent-start', 'torrent-start-now', 'torrent-stop', 'torrent-verify',
+    'torrent-reannounce', 'torrent-remove', 'queue-move-up', 'queue-move-down',
+    'queue-move-top', 'queue-move-bottom'
+]
+def mutate_torrents(request):
+    # Negative ids stand in for torrents the server refuses to act on
+    ids = request['arguments'].get('ids', [])
+    result = {
+        'arguments': { },
+        'result': 'success' if all(id >= 0 for id in ids) else 'invalid id',
+        'tag': request['tag']
+    }
+    return json.dumps(result) + '\n'
+
 class Session:
     @staticmethod
     def handle_request(request, response):
@@ -66,6 +97,9 @@ class Session:
                         if case('torrent-get'):
                             response.data = get_torrents(request_data)
                             break
+                        if case(*mutation_methods):
+                            response.data = mutate_torrents(request_data)
+                            break
                         if case('test_send_request'):
                             response.data = test_send_request(request_data)
                             break
@@ -0,0 +1,71 @@
+#include <catch.hpp>
+
+#include <thread>
+
+#define private public
+#include <libgearbox_call_options.h>
+#include <libgearbox_call_options.cpp>
+
+TEST_CASE("Test libgearbox_call_options", "[call_options]")
+{
+    SECTION(("gearbox::CancellationToken::cancel()"))
+    {
+        CancellationToken token;
+        REQUIRE((!token.cancelled()));
+
+        /* Copies share the state of the token they were made from */
+        CancellationToken copy = token;
+        copy.cancel();
+        REQUIRE((token.cancelled()));
+
+        std::thread([token]() mutable { token.cancel(); }).join();
+        REQUIRE((token.cancelled()));
+    }
+
+    SECTION(("gearbox::CallOptions::CallOptions()"))
+    {
+        CallOptions test;
+        REQUIRE((!test.hasDeadline()));
+        REQUIRE((!test.expired()));
+        REQUIRE((!test.hasCancellationToken()));
+        REQUIRE((!test.cancelled()));
+    }
+
+    SECTION(("gearbox::CallOptions::CallOptions(const gearbox::CancellationToken &)"))
+    {
+        CancellationToken token;
+        CallOptions test(token);
+        REQUIRE((test.hasCancellationToken()));
+        REQUIRE((!test.cancelled()));
+
+        token.cancel();
+        REQUIRE((test.cancelled()));
+
+        /* Options are copied into calls, the copies follow the token too */
+        CallOptions copy = test;
+        REQUIRE((copy.cancelled()));
+    }
+
+    SECTION(("gearbox::CallOptions::setTimeout(std::int32_t)"))
+    {
+        CallOptions test;
+        test.setTimeout(60000);
+        REQUIRE((test.hasDeadline()));
+        REQUIRE((!test.expired()));
+        REQUIRE((test.deadline() > CallOptions::clock_t::now()));
+
+        test.setTimeout(0);
+        REQUIRE((test.expired()));
+    }
+
+    SECTION(("gearbox::CallOptions::setDeadline(gearbox::CallOptions::clock_t::time_point)"))
+    {
+        const auto deadline = CallOptions::clock_t::now() - std::chrono::seconds(1);
+
+        CallOptions test;
+        REQUIRE((&test.setDeadline(deadline) == &test));
+        REQUIRE((test.deadline() == deadline));
+        REQUIRE((test.expired()));
+        REQUIRE((!test.cancelled()));
+    }
+}
@@ -154,7 +154,8 @@ public:
     struct Request
     {
         bool created = true;
-        void setBody(const std::string &data);
+        std::string body;
+        void setBody(const std::string &data) { body = data; }
         void setHeaders(const http_header_array_t &headers);
         void setHeader(const http_header_t &header);
         http_request_result_t send();
@@ -335,4 +336,114 @@ TEST_CASE("Test libgearbox_http_interface", "[http]")
         auto request = itf.createRequest();
         REQUIRE((request.created));
     }
+
+    SECTION(("gearbox::http::Interface::writeBody(Request &, Writer &&)"))
+    {
+        /* Without a buffer of its own the request gets the body set */
+        auto request = itf.createRequest();
+        itf.writeBody(request, [](std::string &body) { body.append("body"); });
+        REQUIRE((request.body == "body"));
+    }
+}
+
+TEST_CASE("Test libgearbox_http_interface ResponseHeaders", "[http]")
+{
+    using gearbox::http::ResponseHeaders;
+
+    const std::string lines[] {
+        "HTTP/1.1 200 OK\r\n",
+        "Content-Length: 42\r\n",
+        "X-Transmission-Session-Id:   1234 \r\n",
+        "Content-Type: application/json\r\n",
+        "\r\n"
+    };
+
+    ResponseHeaders test;
+
+    SECTION(("gearbox::http::ResponseHeaders::parseLine(const char *, std::size_t)"))
+    {
+        for (const auto &line : lines) test.parseLine(line.data(), line.size());
+
+        REQUIRE((test.size() == 3));
+        REQUIRE((test["content-length"] == "42"));
+        REQUIRE((test["X-Transmission-Session-Id"] == "1234"));
+        REQUIRE((test["Content-Type"] == "application/json"));
+        REQUIRE((test.count("Content-Encoding") == 0));
+        REQUIRE((test["Content-Encoding"].empty()));
+
+        /* A new status line, e.g. after a redirect, starts over */
+        test.parseLine(lines[0].data(), lines[0].size());
+        REQUIRE((test.empty()));
+    }
+
+    SECTION(("gearbox::http::ResponseHeaders::setFilter(std::shared_ptr<const std::vector<std::string>>)"))
+    {
+        test.setFilter(std::make_shared<const std::vector<std::string>>(
+            std::vector<std::string> { "x-transmission-session-id" }));
+        for (const auto &line : lines) test.parseLine(line.data(), line.size());
+
+        REQUIRE((test.size() == 1));
+        REQUIRE((test["X-Transmission-Session-Id"] == "1234"));
+        REQUIRE((test.count("Content-Length") == 0));
+
+        /* Skipped headers are never copied */
+        REQUIRE((test.storage_->bytes == "X-Transmission-Session-Id1234"));
+    }
+
+    SECTION(("gearbox::http::ResponseHeaders::operator[](const char *) const"))
+    {
+        for (const auto &line : lines) test.parseLine(line.data(), line.size());
+
+        /* Values point into the buffer rather than being copied out */
+        const auto value = test["X-Transmission-Session-Id"];
+        REQUIRE((value.data >= test.storage_->bytes.data()));
+        REQUIRE((value.data + value.size <= test.storage_->bytes.data() + test.storage_->bytes.size()));
+        REQUIRE((value == std::string("1234")));
+        REQUIRE((value != "12345"));
+        REQUIRE((value.str() == "1234"));
+        REQUIRE((std::string(test["Content-Encoding"]).empty()));
+    }
+
+    SECTION(("gearbox::http::ResponseHeaders::clear()"))
+    {
+        for (const auto &line : lines) test.parseLine(line.data(), line.size());
+        const auto storage = test.storage_.get();
+        const auto capacity = test.storage_->bytes.capacity();
+
+        /* Nothing else refers to the buffer, it is kept as is */
+        test.clear();
+        REQUIRE((test.empty()));
+        REQUIRE((test.storage_.get() == storage));
+        REQUIRE((test.storage_->bytes.capacity() == capacity));
+
+        /* A copy keeps the headers it shares, the next response gets a */
+        /* buffer of its own.                                           */
+        for (const auto &line : lines) test.parseLine(line.data(), line.size());
+        const auto copy = test;
+        REQUIRE((copy.storage_ == test.storage_));
+        test.clear();
+        test.insert("key", 3, "value", 5);
+        REQUIRE((test.storage_.get() != storage));
+        REQUIRE((copy.size() == 3));
+        REQUIRE((copy["Content-Length"] == "42"));
+
+        /* Changing a copy leaves the others alone */
+        auto other = copy;
+        other.insert("Content-Length", 14, "43", 2);
+        REQUIRE((copy["Content-Length"] == "42"));
+        REQUIRE((other["Content-Length"] == "43"));
+    }
+
+    SECTION(("gearbox::http::ResponseHeaders::toMap() const"))
+    {
+        const gearbox::http::header_array_t headers { { "key1", "value1" }, { "key2", "value2" } };
+        test = headers;
+        test.insert("KEY1", 4, "value3", 6);
+
+        REQUIRE((test.size() == 2));
+        auto map = test.toMap();
+        REQUIRE((map.size() == 2));
+        REQUIRE((map.at("key1") == "value3"));
+        REQUIRE((map.at("key2") == "value2"));
+    }
 }
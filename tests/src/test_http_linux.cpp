@@ -1,6 +1,9 @@
 #ifdef PLATFORM_LINUX
 #include <catch.hpp>
 
+#include <atomic>
+#include <thread>
+
 #define private public
 #include <libgearbox_http_linux_p.h>
 #include <libgearbox_http_linux.cpp>
@@ -24,13 +27,13 @@ TEST_CASE("Test libgearbox_http_linux", "[http]")
         REQUIRE((result == data));
     }
 
-    SECTION(("<anonymous>::headerCallback(void *, std::size_t, std::size_t, gearbox::http::header_array_t *)"))
+    SECTION(("<anonymous>::headerCallback(void *, std::size_t, std::size_t, gearbox::http::ResponseHeaders *)"))
     {
         std::string header { "HTTP/1.1 200 OK" };
         std::size_t size = header.size();
         std::size_t nmemb = 1;
         void *data_ptr = const_cast<char *>(header.data());
-        gearbox::http::header_array_t result { { "dummy", "dummy" } };
+        gearbox::http::ResponseHeaders result { gearbox::http::header_array_t { { "dummy", "dummy" } } };
         headerCallback(data_ptr, size, nmemb, &result);
         REQUIRE((result.empty()));
 
@@ -55,11 +58,11 @@ TEST_CASE("Test libgearbox_http_linux", "[http]")
         headerCallback(data_ptr, size, nmemb, &result);
 
         REQUIRE((result.size() == 4));
-        REQUIRE((result.at("key1") == "value1"));
-        REQUIRE((result.at("key1") == "value1"));
-        REQUIRE((result.at("key2") == "value2"));
-        REQUIRE((result.at("key3") == "value3"));
-        REQUIRE((result.at("key4") == "value4"));
+        REQUIRE((result["key1"] == "value1"));
+        REQUIRE((result["key1"] == "value1"));
+        REQUIRE((result["key2"] == "value2"));
+        REQUIRE((result["key3"] == "value3"));
+        REQUIRE((result["key4"] == "value4"));
     }
 
     SECTION(("gearbox::CUrlHttp::CUrlHttp(const std::string &)"))
@@ -128,9 +131,39 @@ TEST_CASE("Test libgearbox_http_linux", "[http]")
         }
     }
 
-    SECTION(("gearbox::CUrlHttp::Request::setBody(const std::string &)"))
+    SECTION(("gearbox::CUrlHttp::Request::setBody(std::string &&)"))
     {
-        /* Nothing to test with current implementation */
+        using gearbox::CUrlHttp;
+
+        auto handle = curl_easy_init();
+        CUrlHttp::Request test(handle, nullptr, std::string(64, 'x'));
+        const auto *pooled = test.body_.data();
+
+        /* The pooled buffer goes back to the caller instead of a copy */
+        std::string body(32, 'b');
+        const auto *data = body.data();
+        test.setBody(std::move(body));
+        REQUIRE((test.hasBody_));
+        REQUIRE((test.body_ == std::string(32, 'b')));
+        REQUIRE((test.body_.data() == data));
+        REQUIRE((body.empty()));
+        REQUIRE((body.data() == pooled));
+    }
+
+    SECTION(("gearbox::CUrlHttp::Request::bodyBuffer()"))
+    {
+        using gearbox::CUrlHttp;
+
+        auto handle = curl_easy_init();
+        CUrlHttp::Request test(handle, nullptr, std::string(64, 'x'));
+        const auto *pooled = test.body_.data();
+
+        auto &buffer = test.bodyBuffer();
+        REQUIRE((test.hasBody_));
+        REQUIRE((buffer.empty()));
+        buffer.append("body");
+        REQUIRE((test.body_ == "body"));
+        REQUIRE((test.body_.data() == pooled));
     }
 
     SECTION(("gearbox::CUrlHttp::Request::setHeader(s)(const std::string &)"))
@@ -163,6 +196,25 @@ TEST_CASE("Test libgearbox_http_linux", "[http]")
         headers["key4"] = "value8";
         test.setHeader({ "key4", "value8" });
         REQUIRE((test.headers_ == headers));
+
+        /* The list handed to cURL is kept up to date along with the map */
+        std::vector<std::string> lines;
+        for (auto it = test.headerList_; it != nullptr; it = it->next)
+        {
+            lines.emplace_back(it->data);
+        }
+        REQUIRE((lines == std::vector<std::string>{ "key1: value4",
+                                                    "key2: value5",
+                                                    "key3: value6",
+                                                    "key4: value8",
+                                                    "Expect:" }));
+
+        test.setHeader({ "Expect", "100-continue" });
+        REQUIRE((std::string(test.headerList_->data) == "Expect: 100-continue"));
+        for (auto it = test.headerList_; it != nullptr; it = it->next)
+        {
+            REQUIRE((std::string(it->data) != "Expect:"));
+        }
     }
 
     SECTION(("gearbox::CUrlHttp::Request::send()"))
@@ -186,7 +238,466 @@ TEST_CASE("Test libgearbox_http_linux", "[http]")
         REQUIRE((result.error == 0));
         REQUIRE((result.status == CUrlHttp::http_status_t::OK));
         REQUIRE((result.response.text == "OK POST"));
+
+        /* Large enough for any version of cURL to ask for a 100 Continue */
+        const std::string body(1024 * 1024 + 1, 'x');
+        request.setBody(body);
+        result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.text == "OK " + body));
+
+        /* Nor with headers of its own */
+        request.setHeader({ "Content-Type", "text/plain" });
+        result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.text == "OK " + body));
     }
+
+    SECTION(("gearbox::CUrlHttp::ConnectionPool"))
+    {
+        using gearbox::CUrlHttp;
+
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_connection");
+
+        REQUIRE((test.maxIdleConnections() == 4));
+        REQUIRE((test.idleConnectionTimeout() == CUrlHttp::milliseconds_t { 30000 }));
+
+        /* The second request picks up the connection left by the first one */
+        for (int it = 0; it < 2; ++it)
+        {
+            auto request = test.createRequest();
+            auto result = request.send();
+            REQUIRE((result.error == 0));
+            REQUIRE((result.response.text == "OK GET"));
+        }
+        REQUIRE((test.pool_->idle.size() == 1));
+        auto statistics = test.connectionStatistics();
+        REQUIRE((statistics.newConnections == 1));
+        REQUIRE((statistics.reusedConnections == 1));
+
+        /* A reused handle must not keep the body of its previous request */
+        {
+            auto request = test.createRequest();
+            request.setBody("POST");
+            REQUIRE((request.send().response.text == "OK POST"));
+        }
+        {
+            auto request = test.createRequest();
+            REQUIRE((request.send().response.text == "OK GET"));
+        }
+
+        /* The body buffer goes back to the pool along with the handle */
+        {
+            auto request = test.createRequest();
+            request.setBody(std::string(4096, 'x'));
+            REQUIRE((request.send().error == 0));
+        }
+        REQUIRE((test.pool_->idle.back().body.empty()));
+        REQUIRE((test.pool_->idle.back().body.capacity() >= 4096));
+        {
+            auto request = test.createRequest();
+            REQUIRE((!request.hasBody_));
+            REQUIRE((request.body_.capacity() >= 4096));
+            REQUIRE((request.send().response.text == "OK GET"));
+        }
+
+        /* So does the buffer of the response headers, once the result that */
+        /* shares it is gone.                                               */
+        const void *storage = nullptr;
+        {
+            auto request = test.createRequest();
+            auto result = request.send();
+            REQUIRE((!result.response.headers.empty()));
+            storage = result.response.headers.storage_.get();
+            REQUIRE((request.responseHeaders_.storage_.get() == storage));
+        }
+        REQUIRE((test.pool_->idle.back().responseHeaders.storage_.get() == storage));
+        {
+            auto request = test.createRequest();
+            auto result = request.send();
+            REQUIRE((result.response.headers.storage_.get() == storage));
+
+            /* Still held by the result, the next response gets its own */
+            auto next = request.send();
+            REQUIRE((next.response.headers.storage_.get() != storage));
+            REQUIRE((result.response.headers.storage_.get() == storage));
+            REQUIRE((result.response.headers["Content-Type"] == next.response.headers["Content-Type"].str()));
+        }
+
+        /* Concurrent requests each need a connection of their own */
+        {
+            auto request1 = test.createRequest();
+            auto request2 = test.createRequest();
+            REQUIRE((request1.handle_ != request2.handle_));
+            REQUIRE((request1.send().error == 0));
+            REQUIRE((request2.send().error == 0));
+        }
+        REQUIRE((test.pool_->idle.size() == 2));
+
+        test.setMaxIdleConnections(0);
+        REQUIRE((test.pool_->idle.empty()));
+        statistics = test.connectionStatistics();
+        for (int it = 0; it < 2; ++it)
+        {
+            auto request = test.createRequest();
+            REQUIRE((request.send().error == 0));
+        }
+        REQUIRE((test.connectionStatistics().newConnections == statistics.newConnections + 2));
+
+        test.setMaxIdleConnections(4);
+        test.setIdleConnectionTimeout(CUrlHttp::milliseconds_t { 0 });
+        statistics = test.connectionStatistics();
+        for (int it = 0; it < 2; ++it)
+        {
+            auto request = test.createRequest();
+            REQUIRE((request.send().error == 0));
+        }
+        REQUIRE((test.connectionStatistics().newConnections == statistics.newConnections + 2));
+        REQUIRE((test.connectionStatistics().reusedConnections == statistics.reusedConnections));
+    }
+
+    SECTION(("gearbox::CUrlHttp::shareConnectionPool(const gearbox::CUrlHttp &)"))
+    {
+        using gearbox::CUrlHttp;
+
+        CUrlHttp first("user-agent");
+        CUrlHttp second("user-agent");
+        for (auto test : { &first, &second })
+        {
+            test->setHost("http://localhost");
+            test->setPort(CUrlHttp::http_port_t { 9999 });
+            test->setPath("/test_connection");
+        }
+
+        second.shareConnectionPool(first);
+        REQUIRE((first.pool_ == second.pool_));
+        REQUIRE((first.pool_->share != nullptr));
+
+        {
+            auto request = first.createRequest();
+            REQUIRE((request.send().response.text == "OK GET"));
+        }
+
+        /* The second instance neither resolves nor connects again */
+        {
+            auto request = second.createRequest();
+            request.setBody("POST");
+            REQUIRE((request.send().response.text == "OK POST"));
+        }
+        auto statistics = second.connectionStatistics();
+        REQUIRE((statistics.newConnections == 1));
+        REQUIRE((statistics.reusedConnections == 1));
+        REQUIRE((statistics.dnsLookups == 1));
+
+        /* Both instances are used from several threads at once */
+        std::vector<std::thread> threads;
+        std::atomic<int> succeeded { 0 };
+        for (int it = 0; it < 8; ++it)
+        {
+            threads.emplace_back([it, &first, &second, &succeeded]() {
+                auto &test = (it % 2 == 0) ? first : second;
+                for (int request = 0; request < 16; ++request)
+                {
+                    auto r = test.createRequest();
+                    if (r.send().response.text == "OK GET") ++succeeded;
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        REQUIRE((succeeded == 8 * 16));
+        REQUIRE((first.connectionStatistics().dnsLookups == 1));
+
+        /* The pool is switched while requests are sent from other threads */
+        CUrlHttp third("user-agent");
+        std::atomic<bool> switching { true };
+        std::thread switcher([&]() {
+            for (int it = 0; switching; ++it) second.shareConnectionPool((it % 2 == 0) ? third : first);
+        });
+        succeeded = 0;
+        threads.clear();
+        for (int it = 0; it < 4; ++it)
+        {
+            threads.emplace_back([&second, &succeeded]() {
+                for (int request = 0; request < 16; ++request)
+                {
+                    auto r = second.createRequest();
+                    if (r.send().response.text == "OK GET") ++succeeded;
+                    second.connectionStatistics();
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        switching = false;
+        switcher.join();
+        REQUIRE((succeeded == 4 * 16));
+    }
+
+    SECTION(("gearbox::CUrlHttp::enableCompression()"))
+    {
+        using gearbox::CUrlHttp;
+
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_compression");
+
+        std::string expected;
+        for (int it = 0; it < 1024; ++it) expected += "OK ";
+
+        REQUIRE((test.compressionEnabled()));
+        auto request = test.createRequest();
+        auto result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.headers["Content-Encoding"] == "gzip"));
+        REQUIRE((result.response.text == expected));
+        REQUIRE((result.bytes.decoded == expected.size()));
+        REQUIRE((result.bytes.received < result.bytes.decoded / 10));
+
+        auto statistics = test.connectionStatistics();
+        REQUIRE((statistics.receivedBytes == result.bytes.received));
+        REQUIRE((statistics.decodedBytes == result.bytes.decoded));
+
+        test.disableCompression();
+        request = test.createRequest();
+        result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.headers.count("Content-Encoding") == 0));
+        REQUIRE((result.response.text == expected));
+        REQUIRE((result.bytes.received == result.bytes.decoded));
+    }
+
+    SECTION(("gearbox::CUrlHttp::setCapturedHeaders(std::vector<std::string>)"))
+    {
+        using gearbox::CUrlHttp;
+
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_connection");
+
+        REQUIRE((test.capturedHeaders().empty()));
+        auto request = test.createRequest();
+        auto all = request.send().response.headers;
+        REQUIRE((all.count("Content-Length") == 1));
+        REQUIRE((all.count("Server") == 1));
+
+        test.setCapturedHeaders({ "content-length" });
+        REQUIRE((test.capturedHeaders().size() == 1));
+        request = test.createRequest();
+        auto result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.headers.size() == 1));
+        REQUIRE((result.response.headers["Content-Length"] == all["Content-Length"]));
+
+        test.setCapturedHeaders({});
+        request = test.createRequest();
+        REQUIRE((request.send().response.headers.size() == all.size()));
+    }
+
+    SECTION(("gearbox::CUrlHttp::setUnixSocketPath(const std::string &)"))
+    {
+        using gearbox::CUrlHttp;
+
+        /* Nothing listens on the port, the socket has to be used */
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 1 });
+        test.setPath("/test_connection");
+
+        REQUIRE((test.unixSocketPath().empty()));
+        test.setUnixSocketPath("/tmp/libgearbox_test.sock");
+        REQUIRE((test.unixSocketPath() == "/tmp/libgearbox_test.sock"));
+
+        for (int it = 0; it < 2; ++it)
+        {
+            auto request = test.createRequest();
+            auto result = request.send();
+            REQUIRE((result.error == 0));
+            REQUIRE((result.response.text == "OK GET"));
+        }
+        auto statistics = test.connectionStatistics();
+        REQUIRE((statistics.newConnections == 1));
+        REQUIRE((statistics.reusedConnections == 1));
+
+        /* A pooled handle must not keep going through the socket */
+        test.setUnixSocketPath("");
+        auto request = test.createRequest();
+        REQUIRE((request.send().error.errorCode == gearbox::http::Error::Code::ConnectionFailure));
+    }
+
+    SECTION(("gearbox::CUrlHttp::Request::setBodyHandler(gearbox::http::body_handler_t)"))
+    {
+        using gearbox::CUrlHttp;
+
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_compression");
+
+        std::string streamed;
+        auto request = test.createRequest();
+        request.setBodyHandler([&streamed](const char *data, std::size_t size) {
+            streamed.append(data, size);
+        });
+        auto result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.text.empty()));
+        REQUIRE((streamed.size() == 3 * 1024));
+        REQUIRE((result.bytes.decoded == streamed.size()));
+
+        /* Only successful responses are streamed */
+        streamed.clear();
+        test.setPath("/test_unauthorized");
+        request = test.createRequest();
+        request.setBodyHandler([&streamed](const char *data, std::size_t size) {
+            streamed.append(data, size);
+        });
+        result = request.send();
+        REQUIRE((result.status == CUrlHttp::http_status_t::Unauthorized));
+        REQUIRE((!result.response.text.empty()));
+        REQUIRE((streamed.empty()));
+
+        /* A pooled handle goes back to collecting the body as text */
+        test.setPath("/test_connection");
+        request = test.createRequest();
+        REQUIRE((request.send().response.text == "OK GET"));
+    }
+
+    SECTION(("gearbox::CUrlHttp::Request::setTimeout(gearbox::http::milliseconds_t)"))
+    {
+        using gearbox::CUrlHttp;
+
+        /* The slow response takes 10 seconds to trickle in */
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_slow");
+        test.setTimeout(CUrlHttp::milliseconds_t { 60000 });
+
+        const auto start = std::chrono::steady_clock::now();
+        auto request = test.createRequest();
+        request.setTimeout(CUrlHttp::milliseconds_t { 200 });
+        REQUIRE((request.send().error.errorCode == gearbox::http::Error::Code::OperationTimedOut));
+        REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::seconds(2)));
+
+        /* A pooled handle goes back to the timeout of the instance */
+        test.setPath("/test_connection");
+        request = test.createRequest();
+        REQUIRE((request.send().response.text == "OK GET"));
+    }
+
+    SECTION(("gearbox::CUrlHttp::Request::setAbortHandler(gearbox::http::abort_handler_t)"))
+    {
+        using gearbox::CUrlHttp;
+
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_slow");
+        test.setTimeout(CUrlHttp::milliseconds_t { 60000 });
+
+        std::atomic<bool> aborted { false };
+        std::thread canceller([&aborted]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            aborted = true;
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        std::string streamed;
+        auto request = test.createRequest();
+        request.setBodyHandler([&streamed](const char *data, std::size_t size) {
+            streamed.append(data, size);
+        });
+        request.setAbortHandler([&aborted]() { return aborted.load(); });
+        auto result = request.send();
+        canceller.join();
+
+        REQUIRE((result.error != 0));
+        REQUIRE((!streamed.empty()));
+        REQUIRE((streamed.size() < 3 * 100));
+        REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::seconds(2)));
+
+        /* A pooled handle doesn't keep the handler around */
+        test.setPath("/test_connection");
+        request = test.createRequest();
+        REQUIRE((request.send().response.text == "OK GET"));
+    }
+}
+
+/* Not run by default, select it with "[benchmark]" */
+TEST_CASE("Benchmark libgearbox_http_linux header parsing", "[.][benchmark]")
+{
+    constexpr int REQUEST_COUNT { 100000 };
+
+    const std::vector<std::string> lines {
+        "HTTP/1.1 200 OK\r\n",
+        "Server: Transmission\r\n",
+        "Date: Sun, 16 Oct 2016 10:00:00 GMT\r\n",
+        "Content-Type: application/json; charset=UTF-8\r\n",
+        "Content-Length: 65536\r\n",
+        "Content-Encoding: gzip\r\n",
+        "X-Transmission-Session-Id: 0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL\r\n",
+        "\r\n"
+    };
+
+    auto measure = [&lines](const std::shared_ptr<const std::vector<std::string>> &filter) {
+        std::size_t captured = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < REQUEST_COUNT; ++it)
+        {
+            gearbox::http::ResponseHeaders headers;
+            headers.setFilter(filter);
+            for (const auto &line : lines)
+            {
+                headerCallback(const_cast<char *>(line.data()), 1, line.size(), &headers);
+            }
+            captured += headers.size();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        REQUIRE((captured > 0));
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / REQUEST_COUNT;
+    };
+
+    const auto all = measure(nullptr);
+    const auto filtered = measure(std::make_shared<const std::vector<std::string>>(
+        std::vector<std::string> { "X-Transmission-Session-Id", "Content-Length" }));
+
+    WARN("Header parsing per request: all headers " << all << "ns, registered headers " << filtered << "ns");
+}
+
+/* Not run by default, select it with "[benchmark]" */
+TEST_CASE("Benchmark libgearbox_http_linux Unix domain socket", "[.][benchmark]")
+{
+    using gearbox::CUrlHttp;
+
+    constexpr int REQUEST_COUNT { 2000 };
+
+    /* Both go to the same test server, over kept-alive connections */
+    auto measure = [](const std::string &unixSocketPath) {
+        CUrlHttp test("user-agent");
+        test.setHost("http://localhost");
+        test.setPort(CUrlHttp::http_port_t { 9999 });
+        test.setPath("/test_connection");
+        test.setUnixSocketPath(unixSocketPath);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < REQUEST_COUNT; ++it)
+        {
+            auto request = test.createRequest();
+            request.setBody("POST");
+            REQUIRE((request.send().error == 0));
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / REQUEST_COUNT;
+    };
+
+    const auto tcp = measure("");
+    const auto unixSocket = measure("/tmp/libgearbox_test.sock");
+
+    WARN("Round trip per request: loopback TCP " << tcp << "us, Unix domain socket " << unixSocket << "us");
 }
 
 #endif // PLATFORM_LINUX
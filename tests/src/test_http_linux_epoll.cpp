@@ -0,0 +1,412 @@
+#ifdef PLATFORM_LINUX
+#include <catch.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <sys/resource.h>
+
+#define private public
+#include <libgearbox_http_linux_p.h>
+#include <libgearbox_http_linux_epoll_p.h>
+#include <libgearbox_http_linux_epoll.cpp>
+
+TEST_CASE("Test libgearbox_http_linux_epoll", "[http]")
+{
+    using gearbox::EpollHttp;
+    using Transfer = EpollHttp::Request::Transfer;
+
+    EpollHttp test("user-agent");
+    test.setHost("http://localhost");
+    test.setPort(EpollHttp::http_port_t { 9999 });
+    test.setPath("/test_connection");
+
+    SECTION(("<anonymous>::toBase64(const std::string &)"))
+    {
+        REQUIRE((toBase64("") == ""));
+        REQUIRE((toBase64("u") == "dQ=="));
+        REQUIRE((toBase64("us") == "dXM="));
+        REQUIRE((toBase64("usr") == "dXNy"));
+        REQUIRE((toBase64("username:password") == "dXNlcm5hbWU6cGFzc3dvcmQ="));
+    }
+
+    SECTION(("gearbox::EpollHttp::Request::Transfer::feed(const char *, std::size_t)"))
+    {
+        const std::string response {
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: 12\r\n"
+            "\r\n"
+            "Hello World!"
+        };
+
+        auto feed = [](Transfer &transfer, const std::string &data) {
+            return transfer.feed(data.data(), data.size());
+        };
+
+        /* One byte at a time, every line ends up split across reads */
+        Transfer transfer;
+        for (const auto c : response)
+        {
+            REQUIRE((!transfer.complete()));
+            REQUIRE((transfer.feed(&c, 1)));
+        }
+        REQUIRE((transfer.complete()));
+        REQUIRE((transfer.status == 200));
+        REQUIRE((transfer.keepAlive));
+        REQUIRE((transfer.text == "Hello World!"));
+        REQUIRE((transfer.headers["content-type"] == "text/plain"));
+
+        /* The extension of the first chunk is skipped */
+        Transfer chunked;
+        REQUIRE((feed(chunked, "HTTP/1.1 200 OK\r\n"
+                               "Transfer-Encoding: chunked\r\n"
+                               "\r\n"
+                               "5;name=value\r\nHello\r\n"
+                               "7\r\n World!\r\n"
+                               "0\r\n"
+                               "\r\n")));
+        REQUIRE((chunked.complete()));
+        REQUIRE((chunked.text == "Hello World!"));
+        REQUIRE((chunked.bodyBytes == 12));
+
+        /* Only a successful response goes to the body handler */
+        std::string streamed;
+        gearbox::http::body_handler_t handler = [&streamed](const char *data, std::size_t size) {
+            streamed.append(data, size);
+        };
+        Transfer success(&handler);
+        REQUIRE((feed(success, response)));
+        REQUIRE((streamed == "Hello World!"));
+        REQUIRE((success.text.empty()));
+
+        Transfer conflict(&handler);
+        REQUIRE((feed(conflict, "HTTP/1.1 409 Conflict\r\nContent-Length: 2\r\n\r\nNo")));
+        REQUIRE((conflict.complete()));
+        REQUIRE((conflict.text == "No"));
+        REQUIRE((streamed == "Hello World!"));
+
+        /* Without a length the body runs until the connection is closed */
+        Transfer untilClose;
+        REQUIRE((feed(untilClose, "HTTP/1.1 200 OK\r\n\r\nHello")));
+        REQUIRE((!untilClose.complete()));
+        untilClose.close();
+        REQUIRE((untilClose.complete()));
+        REQUIRE((!untilClose.keepAlive));
+        REQUIRE((untilClose.text == "Hello"));
+
+        Transfer closed;
+        REQUIRE((feed(closed, "HTTP/1.1 200 OK\r\nConnection: close\r\nContent-Length: 0\r\n\r\n")));
+        REQUIRE((closed.complete()));
+        REQUIRE((!closed.keepAlive));
+
+        Transfer invalid;
+        REQUIRE((!feed(invalid, "SSH-2.0-OpenSSH_7.4\r\n")));
+    }
+
+    SECTION(("gearbox::EpollHttp::Request::send()"))
+    {
+        {
+            auto request = test.createRequest();
+            auto result = request.send();
+            REQUIRE((result.error == 0));
+            REQUIRE((result.status == gearbox::http::Status::OK));
+            REQUIRE((result.response.text == "OK GET"));
+            REQUIRE((result.response.headers["Content-Type"] == "text/plain"));
+        }
+
+        {
+            auto request = test.createRequest();
+            request.setBody("POST");
+            REQUIRE((request.send().response.text == "OK POST"));
+        }
+
+        auto statistics = test.connectionStatistics();
+        REQUIRE((statistics.newConnections == 1));
+        REQUIRE((statistics.reusedConnections == 1));
+        REQUIRE((statistics.dnsLookups == 1));
+
+        /* The server closing a pooled connection is only noticed once a */
+        /* request is sent over it, which then goes over a new one.      */
+        REQUIRE((test.pool_->idle.size() == 1));
+        shutdown(test.pool_->idle.front().connection.socket, SHUT_RDWR);
+        {
+            auto request = test.createRequest();
+            request.setBody("POST");
+            REQUIRE((request.send().response.text == "OK POST"));
+        }
+        REQUIRE((test.connectionStatistics().newConnections == 2));
+        REQUIRE((test.connectionStatistics().dnsLookups == 1));
+
+        test.setMaxIdleConnections(0);
+        {
+            auto request = test.createRequest();
+            REQUIRE((request.send().error == 0));
+        }
+        REQUIRE((test.connectionStatistics().newConnections == 3));
+        REQUIRE((test.pool_->idle.empty()));
+
+        auto request = test.createRequest();
+        auto moved = std::move(request);
+        REQUIRE((request.send().error.errorCode == gearbox::http::Error::Code::InternalError));
+        REQUIRE((moved.send().error == 0));
+    }
+
+    SECTION(("gearbox::EpollHttp::Request::send() chunked response"))
+    {
+        test.setPath("/test_chunked");
+        auto request = test.createRequest();
+        request.setBody("POST");
+        auto result = request.send();
+        REQUIRE((result.error == 0));
+        REQUIRE((result.response.text == "OK CHUNKED"));
+
+        /* The connection is still good after the last chunk */
+        test.setPath("/test_connection");
+        REQUIRE((test.createRequest().send().response.text == "OK GET"));
+        REQUIRE((test.connectionStatistics().reusedConnections == 1));
+    }
+
+    SECTION(("gearbox::EpollHttp::enableAuthentication()"))
+    {
+        test.setPath("/transmission/rpc");
+        {
+            auto request = test.createRequest();
+            request.setBody("{}");
+            REQUIRE((request.send().status == gearbox::http::Status::Unauthorized));
+        }
+
+        test.setUsername("username");
+        test.setPassword("password");
+        REQUIRE((test.authenticationRequired()));
+        {
+            /* Authenticated, the session id is what is missing */
+            auto request = test.createRequest();
+            request.setBody("{}");
+            auto result = request.send();
+            REQUIRE((result.status == gearbox::http::Status::Conflict));
+            REQUIRE((!result.response.headers["X-Transmission-Session-Id"].empty()));
+        }
+
+        test.disableAuthentication();
+        auto request = test.createRequest();
+        request.setBody("{}");
+        REQUIRE((request.send().status == gearbox::http::Status::Unauthorized));
+    }
+
+    SECTION(("gearbox::EpollHttp::setUnixSocketPath(const std::string &)"))
+    {
+        test.setUnixSocketPath("/tmp/libgearbox_test.sock");
+        auto request = test.createRequest();
+        request.setBody("POST");
+        REQUIRE((request.send().response.text == "OK POST"));
+        REQUIRE((test.connectionStatistics().dnsLookups == 0));
+
+        test.setUnixSocketPath("/tmp/libgearbox_test.sock.missing");
+        auto result = test.createRequest().send();
+        REQUIRE((result.error.errorCode == gearbox::http::Error::Code::ConnectionFailure));
+    }
+
+    SECTION(("gearbox::EpollHttp::setHost(const std::string &)"))
+    {
+        test.setHost("https://localhost");
+        auto result = test.createRequest().send();
+        REQUIRE((result.error.errorCode == gearbox::http::Error::Code::UnsupportedProtocol));
+
+        test.setHost("http://localhost.invalid");
+        result = test.createRequest().send();
+        REQUIRE((result.error.errorCode == gearbox::http::Error::Code::HostResolutionFailure));
+    }
+
+    SECTION(("gearbox::EpollHttp::Request::setTimeout(gearbox::http::milliseconds_t)"))
+    {
+        /* The slow response takes 10 seconds to trickle in */
+        test.setPath("/test_slow");
+        test.setTimeout(std::chrono::milliseconds(60000));
+
+        auto request = test.createRequest();
+        request.setTimeout(std::chrono::milliseconds(300));
+        const auto start = std::chrono::steady_clock::now();
+        auto result = request.send();
+        REQUIRE((result.error.errorCode == gearbox::http::Error::Code::OperationTimedOut));
+        REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::seconds(2)));
+
+        /* The connection is in the middle of a response, it can't be reused */
+        REQUIRE((test.pool_->idle.empty()));
+    }
+
+    SECTION(("gearbox::EpollHttp::Request::setAbortHandler(gearbox::http::abort_handler_t)"))
+    {
+        test.setPath("/test_slow");
+        test.setTimeout(std::chrono::milliseconds(60000));
+
+        std::atomic<bool> aborted { false };
+        auto request = test.createRequest();
+        request.setAbortHandler([&aborted]() { return aborted.load(); });
+
+        std::thread abort([&aborted]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            aborted = true;
+        });
+        const auto start = std::chrono::steady_clock::now();
+        auto result = request.send();
+        abort.join();
+        REQUIRE((result.error != 0));
+        REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::seconds(1)));
+    }
+}
+
+namespace
+{
+    /* Answers every request with the same small RPC response, over kept-alive */
+    /* connections and as quickly as it can; with the Python test server the   */
+    /* server would be all that gets measured.                                  */
+    class StandInServer
+    {
+    public:
+        StandInServer() : listener_(socket(AF_INET, SOCK_STREAM, 0)), port_(0)
+        {
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t size = sizeof(address);
+            bind(listener_, reinterpret_cast<sockaddr *>(&address), size);
+            listen(listener_, 16);
+            getsockname(listener_, reinterpret_cast<sockaddr *>(&address), &size);
+            port_ = ntohs(address.sin_port);
+
+            acceptor_ = std::thread([this]() {
+                for (;;)
+                {
+                    const auto client = accept(listener_, nullptr, nullptr);
+                    if (client < 0) return;
+
+                    int noDelay = 1;
+                    setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    clients_.push_back(client);
+                    workers_.emplace_back(&StandInServer::serve, client);
+                }
+            });
+        }
+
+        ~StandInServer()
+        {
+            shutdown(listener_, SHUT_RDWR);
+            acceptor_.join();
+            close(listener_);
+
+            for (auto client : clients_) shutdown(client, SHUT_RDWR);
+            for (auto &worker : workers_) worker.join();
+            for (auto client : clients_) close(client);
+        }
+
+        int port() const { return port_; }
+
+    private:
+        static void serve(int client)
+        {
+            static const std::string body { "{\"arguments\":{\"torrents\":[]},\"result\":\"success\"}" };
+            static const std::string response {
+                "HTTP/1.1 200 OK\r\n"
+                "Server: Transmission\r\n"
+                "Content-Type: application/json; charset=UTF-8\r\n"
+                "X-Transmission-Session-Id: 0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                "\r\n" + body
+            };
+
+            std::string input;
+            char buffer[16384];
+            for (;;)
+            {
+                const auto received = recv(client, buffer, sizeof(buffer), 0);
+                if (received <= 0) return;
+                input.append(buffer, static_cast<std::size_t>(received));
+
+                for (;;)
+                {
+                    const auto headerEnd = input.find("\r\n\r\n");
+                    if (headerEnd == std::string::npos) break;
+
+                    std::size_t contentLength = 0;
+                    const auto field = input.find("Content-Length: ");
+                    if ((field != std::string::npos) && (field < headerEnd))
+                    {
+                        contentLength = std::stoul(input.substr(field + 16));
+                    }
+                    if (input.size() < headerEnd + 4 + contentLength) break;
+
+                    input.erase(0, headerEnd + 4 + contentLength);
+                    send(client, response.data(), response.size(), MSG_NOSIGNAL);
+                }
+            }
+        }
+
+    private:
+        int listener_;
+        int port_;
+        std::thread acceptor_;
+        std::mutex mutex_;
+        std::vector<int> clients_;
+        std::vector<std::thread> workers_;
+    };
+
+    std::chrono::microseconds threadCpuTime()
+    {
+        rusage usage {};
+        getrusage(RUSAGE_THREAD, &usage);
+        return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+               std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+}
+
+/* Not run by default, select it with "[benchmark]" */
+TEST_CASE("Benchmark libgearbox_http_linux_epoll against libgearbox_http_linux", "[.][benchmark]")
+{
+    constexpr int WARMUP_COUNT { 200 };
+    constexpr int REQUEST_COUNT { 20000 };
+
+    StandInServer server;
+    const std::string body { "{\"arguments\":{\"fields\":[\"id\",\"name\"]},\"method\":\"torrent-get\",\"tag\":1}" };
+
+    /* Requests are sent one after the other from this thread, only the CPU */
+    /* time of this thread is accounted for, the server has threads of its  */
+    /* own.                                                                 */
+    auto measure = [&](auto &&http) {
+        http.setHost("http://127.0.0.1");
+        http.setPort(server.port());
+        http.setPath("/transmission/rpc");
+        http.setUsername("username");
+        http.setPassword("password");
+
+        auto sendRequest = [&]() {
+            auto request = http.createRequest();
+            request.setHeader({ "Content-Type", "application/json" });
+            request.setHeader({ "X-Transmission-Session-Id", "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKL" });
+            request.setBody(body);
+            REQUIRE((request.send().error == 0));
+        };
+
+        for (int it = 0; it < WARMUP_COUNT; ++it) sendRequest();
+
+        const auto cpuStart = threadCpuTime();
+        const auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < REQUEST_COUNT; ++it) sendRequest();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+        const auto cpu = threadCpuTime() - cpuStart;
+
+        return std::make_pair(static_cast<long>(REQUEST_COUNT / elapsed.count()),
+                              static_cast<double>(cpu.count()) / REQUEST_COUNT);
+    };
+
+    const auto curl = measure(gearbox::CUrlHttp("user-agent"));
+    const auto epoll = measure(gearbox::EpollHttp("user-agent"));
+
+    WARN("cURL: " << curl.first << " requests/s, " << curl.second << "us CPU per request; "
+         "epoll: " << epoll.first << " requests/s, " << epoll.second << "us CPU per request");
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,268 @@
+#ifdef PLATFORM_LINUX
+#include <catch.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define private public
+#include <libgearbox_http_linux_multi_p.h>
+#include <libgearbox_http_linux_multi.cpp>
+
+TEST_CASE("Test libgearbox_http_linux_multi", "[http]")
+{
+    using gearbox::CUrlMultiHttp;
+
+    CUrlMultiHttp test("user-agent");
+    test.setHost("http://localhost");
+    test.setPort(CUrlMultiHttp::http_port_t { 9999 });
+    test.setPath("/test_connection");
+
+    SECTION(("gearbox::CUrlMultiHttp::Request::send()"))
+    {
+        {
+            auto request = test.createRequest();
+            auto result = request.send();
+            REQUIRE((result.error == 0));
+            REQUIRE((result.status == gearbox::http::Status::OK));
+            REQUIRE((result.response.text == "OK GET"));
+        }
+
+        /* The connection of the first request ends up in the shared cache */
+        {
+            auto request = test.createRequest();
+            request.setBody("POST");
+            REQUIRE((request.send().response.text == "OK POST"));
+        }
+
+        auto statistics = test.connectionStatistics();
+        REQUIRE((statistics.newConnections == 1));
+        REQUIRE((statistics.reusedConnections == 1));
+
+        test.setMaxIdleConnections(0);
+        {
+            auto request = test.createRequest();
+            REQUIRE((request.send().error == 0));
+        }
+        REQUIRE((test.connectionStatistics().newConnections == 2));
+
+        auto request = test.createRequest();
+        auto moved = std::move(request);
+        REQUIRE((request.send().error.errorCode == gearbox::http::Error::Code::InternalError));
+        REQUIRE((moved.send().error == 0));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::Request::sendAsync(completion_t)"))
+    {
+        constexpr int REQUEST_COUNT { 64 };
+
+        std::mutex mutex;
+        std::condition_variable done;
+        int completed = 0;
+        std::atomic<int> succeeded { 0 };
+        std::atomic<int> onTransportThread { 0 };
+
+        for (int it = 0; it < REQUEST_COUNT; ++it)
+        {
+            auto request = test.createRequest();
+            request.sendAsync([&](gearbox::http::RequestResult &&result) {
+                if (!result.error && (result.response.text == "OK GET")) ++succeeded;
+                if (test.engine_->isTransportThread()) ++onTransportThread;
+
+                std::lock_guard<std::mutex> lock(mutex);
+                ++completed;
+                done.notify_one();
+            });
+            REQUIRE((request.handle_ == nullptr));
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        REQUIRE((done.wait_for(lock, std::chrono::seconds(30), [&]() { return completed == REQUEST_COUNT; })));
+        REQUIRE((succeeded == REQUEST_COUNT));
+        REQUIRE((onTransportThread == REQUEST_COUNT));
+
+        /* More requests in flight than pooled handles, the rest is discarded */
+        REQUIRE((test.pool_->idle.size() <= test.maxIdleConnections()));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::Request::send() from the transport thread"))
+    {
+        std::promise<std::string> nested;
+        auto result = nested.get_future();
+
+        auto request = test.createRequest();
+        request.sendAsync([&](gearbox::http::RequestResult &&) {
+            /* Would never complete if it waited on the transport thread */
+            auto inner = test.createRequest();
+            nested.set_value(inner.send().response.text);
+        });
+
+        REQUIRE((result.wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        REQUIRE((result.get() == "OK GET"));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::schedule(gearbox::http::milliseconds_t, std::function<void()>)"))
+    {
+        std::mutex mutex;
+        std::vector<int> fired;
+        std::promise<bool> last;
+        auto result = last.get_future();
+
+        const auto start = std::chrono::steady_clock::now();
+        test.schedule(std::chrono::milliseconds(200), [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            fired.push_back(2);
+            last.set_value(test.isTransportThread());
+        });
+        test.schedule(std::chrono::milliseconds(100), [&]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            fired.push_back(1);
+        });
+        REQUIRE((!test.isTransportThread()));
+
+        /* Well before the transport would wake up on its own */
+        REQUIRE((result.wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        REQUIRE((result.get()));
+        REQUIRE((std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(200)));
+        REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::milliseconds(900)));
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE((fired == std::vector<int>{ 1, 2 }));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::Request::setAbortHandler(gearbox::http::abort_handler_t)"))
+    {
+        /* The slow response takes 10 seconds to trickle in */
+        test.setPath("/test_slow");
+        test.setTimeout(std::chrono::milliseconds(60000));
+
+        std::atomic<bool> aborted { false };
+        std::promise<gearbox::http::RequestResult> completed;
+        auto result = completed.get_future();
+
+        auto request = test.createRequest();
+        request.setAbortHandler([&aborted]() { return aborted.load(); });
+        request.sendAsync([&completed](gearbox::http::RequestResult &&r) {
+            completed.set_value(std::move(r));
+        });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        aborted = true;
+        REQUIRE((result.wait_for(std::chrono::seconds(2)) == std::future_status::ready));
+        REQUIRE((result.get().error != 0));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::Request::setPauseHandler(gearbox::http::pause_handler_t)"))
+    {
+        test.setPath("/test_chunked");
+
+        std::mutex mutex;
+        std::string streamed;
+        std::function<void()> resume;
+        std::promise<void> paused;
+        std::promise<gearbox::http::RequestResult> completed;
+        auto result = completed.get_future();
+
+        auto request = test.createRequest();
+        request.setBodyHandler([&](const char *data, std::size_t size) {
+            std::lock_guard<std::mutex> lock(mutex);
+            streamed.append(data, size);
+        });
+        request.setPauseHandler([&](const std::function<void()> &r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (resume) return false;
+            resume = r;
+            paused.set_value();
+            return true;
+        });
+        request.sendAsync([&completed](gearbox::http::RequestResult &&r) {
+            completed.set_value(std::move(r));
+        });
+
+        /* The transport goes on with everything else meanwhile */
+        REQUIRE((paused.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        std::promise<void> fired;
+        test.schedule(std::chrono::milliseconds(0), [&fired]() { fired.set_value(); });
+        REQUIRE((fired.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready));
+        REQUIRE((result.wait_for(std::chrono::milliseconds(200)) == std::future_status::timeout));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            REQUIRE((streamed.empty()));
+        }
+
+        /* From a thread other than the transport */
+        resume();
+        REQUIRE((result.wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        REQUIRE((result.get().error == 0));
+        REQUIRE((streamed == "OK CHUNKED"));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::Request::setPauseHandler(gearbox::http::pause_handler_t) then abort"))
+    {
+        test.setPath("/test_chunked");
+
+        std::atomic<bool> aborted { false };
+        std::promise<void> paused;
+        std::promise<gearbox::http::RequestResult> completed;
+        auto result = completed.get_future();
+
+        auto request = test.createRequest();
+        request.setBodyHandler([](const char *, std::size_t) {});
+        request.setPauseHandler([&paused](const std::function<void()> &) {
+            paused.set_value();
+            return true;
+        });
+        request.setAbortHandler([&aborted]() { return aborted.load(); });
+        request.sendAsync([&completed](gearbox::http::RequestResult &&r) {
+            completed.set_value(std::move(r));
+        });
+
+        /* Never resumed, the transfer is still polled for being aborted */
+        REQUIRE((paused.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        aborted = true;
+        REQUIRE((result.wait_for(std::chrono::seconds(3)) == std::future_status::ready));
+        REQUIRE((result.get().error != 0));
+    }
+
+    SECTION(("gearbox::CUrlMultiHttp::setHttpVersion(gearbox::http::Version)"))
+    {
+        constexpr int REQUEST_COUNT { 16 };
+
+        /* The HTTP/2 stand-in answers with the number of the connection */
+        /* that served the request                                       */
+        test.setPort(CUrlMultiHttp::http_port_t { 9998 });
+        test.setHttpVersion(gearbox::http::Version::Http2);
+        REQUIRE((test.httpVersion() == gearbox::http::Version::Http2));
+
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<std::string> responses;
+
+        for (int it = 0; it < REQUEST_COUNT; ++it)
+        {
+            auto request = test.createRequest();
+            request.setBody("POST");
+            request.sendAsync([&](gearbox::http::RequestResult &&result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                responses.push_back(result.error ? result.error.message : result.response.text);
+                done.notify_one();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        REQUIRE((done.wait_for(lock, std::chrono::seconds(30), [&]() { return responses.size() == REQUEST_COUNT; })));
+        for (const auto &response : responses)
+        {
+            REQUIRE((response == responses.front()));
+        }
+
+        /* Every request in flight shares the first connection */
+        auto statistics = test.connectionStatistics();
+        REQUIRE((statistics.newConnections == 1));
+        REQUIRE((statistics.reusedConnections == REQUEST_COUNT - 1));
+    }
+}
+
+#endif // PLATFORM_LINUX
@@ -0,0 +1,61 @@
+#include <catch.hpp>
+
+#define private public
+#include <libgearbox_json_stream_p.h>
+#include <libgearbox_json_stream.cpp>
+
+TEST_CASE("Test libgearbox_json_stream", "[json]")
+{
+    const std::string document {
+        R"({"arguments":{"key":"\"]}","torrents":[{"id":0,"name":"}]\"{"}, )"
+        R"({"id":1,"files":[1,[2]]}]},"result":"success"})"
+    };
+
+    std::vector<std::string> elements;
+    gearbox::JsonArrayStream test({ "arguments", "torrents" }, [&elements](std::string &&element) {
+        elements.push_back(std::move(element));
+    });
+
+    SECTION(("gearbox::JsonArrayStream::feed(const char *, std::size_t)"))
+    {
+        test.feed(document.data(), document.size());
+
+        REQUIRE((!test.failed()));
+        REQUIRE((elements.size() == 2));
+        REQUIRE((elements.at(0) == R"({"id":0,"name":"}]\"{"})"));
+        REQUIRE((elements.at(1) == R"({"id":1,"files":[1,[2]]})"));
+        REQUIRE((test.remainder() == R"({"arguments":{"key":"\"]}","torrents":[]},"result":"success"})"));
+        REQUIRE((test.element_.empty()));
+    }
+
+    SECTION(("gearbox::JsonArrayStream::feed(const char *, std::size_t) one character at a time"))
+    {
+        for (const char c : document)
+        {
+            test.feed(&c, 1);
+        }
+
+        REQUIRE((!test.failed()));
+        REQUIRE((elements.size() == 2));
+        REQUIRE((elements.at(1) == R"({"id":1,"files":[1,[2]]})"));
+        REQUIRE((test.remainder() == R"({"arguments":{"key":"\"]}","torrents":[]},"result":"success"})"));
+    }
+
+    SECTION(("gearbox::JsonArrayStream::feed(const char *, std::size_t) without the array"))
+    {
+        const std::string other { R"({"arguments":{"removed":[1,2]},"result":"success"})" };
+        test.feed(other.data(), other.size());
+
+        REQUIRE((!test.failed()));
+        REQUIRE((elements.empty()));
+        REQUIRE((test.remainder() == other));
+    }
+
+    SECTION(("gearbox::JsonArrayStream::failed() const"))
+    {
+        const std::string malformed { R"({"arguments":]})" };
+        test.feed(malformed.data(), malformed.size());
+
+        REQUIRE((test.failed()));
+    }
+}
@@ -0,0 +1,135 @@
+#include <catch.hpp>
+
+#include <chrono>
+#include <thread>
+
+#define private public
+#include <libgearbox_mutation_queue_p.h>
+#include <libgearbox_mutation_queue.cpp>
+
+namespace
+{
+    gearbox::MutationQueue::Mutation mutation(const std::string &method,
+                                              std::vector<std::int32_t> ids,
+                                              const std::string &arguments = "null")
+    {
+        gearbox::MutationQueue::Mutation result;
+        result.method = method;
+        result.arguments = arguments;
+        result.ids = std::move(ids);
+        return result;
+    }
+}
+
+TEST_CASE("Test libgearbox_mutation_queue", "[session]")
+{
+    using gearbox::MutationQueue;
+
+    MutationQueue queue;
+    queue.setWindow(std::chrono::milliseconds(50));
+    REQUIRE((queue.window() == std::chrono::milliseconds(50)));
+
+    SECTION(("gearbox::MutationQueue::push(gearbox::MutationQueue::Mutation &&)"))
+    {
+        /* Only the first mutation of a window makes its caller the leader */
+        REQUIRE((queue.push(mutation("torrent-start", { 1 }))));
+        REQUIRE((!queue.push(mutation("torrent-start", { 2, 1 }))));
+        REQUIRE((!queue.push(mutation("torrent-set", { 1 }, R"({"files-wanted":[0]})"))));
+        REQUIRE((!queue.push(mutation("torrent-set", { 2 }, R"({"files-wanted":[1]})"))));
+        REQUIRE((!queue.push(mutation("torrent-set", { 3 }, R"({"files-wanted":[0]})"))));
+
+        auto batches = queue.collect();
+        REQUIRE((batches.size() == 3));
+        REQUIRE((batches.at(0).method == "torrent-start"));
+        REQUIRE((batches.at(0).mutations.size() == 2));
+        REQUIRE((batches.at(0).ids() == std::vector<std::int32_t>{ 1, 2 }));
+        REQUIRE((batches.at(1).ids() == std::vector<std::int32_t>{ 1, 3 }));
+        REQUIRE((batches.at(2).ids() == std::vector<std::int32_t>{ 2 }));
+
+        /* The next mutation opens a new window */
+        REQUIRE((queue.push(mutation("torrent-stop", { 1 }))));
+        REQUIRE((queue.collect().size() == 1));
+    }
+
+    SECTION(("gearbox::MutationQueue::supersede(gearbox::MutationQueue::Mutation &, std::vector<gearbox::MutationQueue::Mutation> &)"))
+    {
+        queue.push(mutation("torrent-start", { 1, 2 }));
+        queue.push(mutation("torrent-verify", { 3 }));
+        queue.push(mutation("torrent-stop", { 1 }));
+        queue.push(mutation("torrent-start-now", { 3 }));
+        queue.push(mutation("torrent-stop", { 2 }));
+
+        /* The start is left with nothing to do and rides along with the */
+        /* stops; a start-now can't overtake the verify of its torrent.   */
+        auto batches = queue.collect();
+        REQUIRE((batches.size() == 3));
+        REQUIRE((batches.at(0).method == "torrent-verify"));
+        REQUIRE((batches.at(1).method == "torrent-stop"));
+        REQUIRE((batches.at(1).ids() == std::vector<std::int32_t>{ 1, 2 }));
+        REQUIRE((batches.at(1).mutations.size() == 3));
+        REQUIRE((batches.at(1).mutations.back().method == "torrent-start"));
+        REQUIRE((batches.at(1).mutations.back().ids.empty()));
+        REQUIRE((batches.at(2).method == "torrent-start-now"));
+
+        /* Back and forth ends up as the last of them */
+        queue.push(mutation("torrent-start", { 4 }));
+        queue.push(mutation("torrent-stop", { 4 }));
+        queue.push(mutation("torrent-start", { 4 }));
+        batches = queue.collect();
+        REQUIRE((batches.size() == 1));
+        REQUIRE((batches.at(0).method == "torrent-start"));
+        REQUIRE((batches.at(0).ids() == std::vector<std::int32_t>{ 4 }));
+        REQUIRE((batches.at(0).mutations.size() == 3));
+
+        /* Other mutations are kept in order */
+        queue.push(mutation("torrent-start", { 5 }));
+        queue.push(mutation("torrent-remove", { 5 }, R"({"delete-local-data":false})"));
+        queue.push(mutation("torrent-start", { 6 }));
+        queue.push(mutation("torrent-start", { 5 }));
+        batches = queue.collect();
+        REQUIRE((batches.size() == 3));
+        REQUIRE((batches.at(0).ids() == std::vector<std::int32_t>{ 5, 6 }));
+        REQUIRE((batches.at(1).method == "torrent-remove"));
+        REQUIRE((batches.at(2).ids() == std::vector<std::int32_t>{ 5 }));
+    }
+
+    SECTION(("gearbox::MutationQueue::collect()"))
+    {
+        auto start = std::chrono::steady_clock::now();
+        queue.push(mutation("torrent-start", { 1 }));
+        queue.collect();
+        REQUIRE((std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(50)));
+
+        /* Disabling the queue closes the window right away */
+        queue.setWindow(std::chrono::milliseconds(60000));
+        start = std::chrono::steady_clock::now();
+        queue.push(mutation("torrent-start", { 1 }));
+        std::thread disable([&queue]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            queue.setWindow(std::chrono::milliseconds(0));
+        });
+        REQUIRE((queue.collect().size() == 1));
+        REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::seconds(10)));
+        disable.join();
+    }
+
+    SECTION(("gearbox::MutationQueue::collectDue()"))
+    {
+        REQUIRE((queue.remaining() == std::chrono::milliseconds(0)));
+
+        queue.push(mutation("torrent-start", { 1 }));
+        const auto remaining = queue.remaining();
+        REQUIRE((remaining > std::chrono::milliseconds(0)));
+        REQUIRE((remaining <= std::chrono::milliseconds(50)));
+        REQUIRE((queue.collectDue().empty()));
+
+        /* Still open, the mutation joins the same window */
+        REQUIRE((!queue.push(mutation("torrent-start", { 2 }))));
+        std::this_thread::sleep_for(remaining);
+        auto batches = queue.collectDue();
+        REQUIRE((batches.size() == 1));
+        REQUIRE((batches.at(0).ids() == std::vector<std::int32_t>{ 1, 2 }));
+        REQUIRE((queue.remaining() == std::chrono::milliseconds(0)));
+        REQUIRE((queue.collectDue().empty()));
+    }
+}
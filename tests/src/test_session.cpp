@@ -1,5 +1,11 @@
 #include <catch.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <numeric>
+#include <thread>
+
 #define private public
 #include <libgearbox_session.h>
 #include <libgearbox_session.cpp>
@@ -27,7 +33,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             password
         );
 
-        REQUIRE((test.sessionId_ == "dummy"));
+        REQUIRE((test.sessionToken_.replacements() == 0));
         REQUIRE((test.http_.host() == url));
         REQUIRE((test.http_.path() == path));
         REQUIRE((test.http_.port() == port));
@@ -55,7 +61,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             std::string(password)
         );
 
-        REQUIRE((test.sessionId_ == "dummy"));
+        REQUIRE((test.sessionToken_.replacements() == 0));
         REQUIRE((test.http_.host() == url));
         REQUIRE((test.http_.path() == path));
         REQUIRE((test.http_.port() == port));
@@ -65,6 +71,26 @@ TEST_CASE("Test libgearbox_session", "[session]")
         REQUIRE((test.http_.timeout() == http::milliseconds_t { DEFAULT_TIMEOUT }));
     }
 
+    SECTION(("gearbox::SessionPrivate::disableTableFormat()"))
+    {
+        auto test = std::make_shared<SessionPrivate>(std::string("http://localhost"), std::string("/transmission/rpc"), 9999, false, std::string(), std::string());
+        REQUIRE((test->tableFormat()));
+        REQUIRE((torrentsRequest(gearbox::FieldSet::all(), test->tableFormat())["format"] == "table"));
+
+        auto table = TorrentPrivate::decode(nlohmann::json::parse(R"({ "torrents": [ [ "name", "id" ], [ "torrent", 7 ] ] })"), test);
+        REQUIRE((table.size() == 1));
+        REQUIRE((table.at(0).get_id() == 7));
+        REQUIRE((table.at(0).get_name() == "torrent"));
+        REQUIRE((test->tableFormat()));
+
+        /* A daemon that doesn't know the format answers with objects */
+        auto objects = TorrentPrivate::decode(nlohmann::json::parse(R"({ "torrents": [ { "id": 8, "name": "torrent" } ] })"), test);
+        REQUIRE((objects.size() == 1));
+        REQUIRE((objects.at(0).get_id() == 8));
+        REQUIRE((!test->tableFormat()));
+        REQUIRE((torrentsRequest(gearbox::FieldSet::all(), test->tableFormat()).count("format") == 0));
+    }
+
     SECTION(("gearbox::SessionPrivate::sendRequest(const std::string &, nlohmann::json)"))
     {
         SessionPrivate test(
@@ -82,6 +108,31 @@ TEST_CASE("Test libgearbox_session", "[session]")
         REQUIRE((response.get_arguments().value<int>("args", -1) == 0));
     }
 
+#if defined(LIBGEARBOX_CURL_MULTI)
+    SECTION(("gearbox::SessionPrivate::sendRequest(const std::string &, nlohmann::json, const gearbox::CallOptions &) from the transport thread"))
+    {
+        auto test = std::make_shared<SessionPrivate>(std::string("http://localhost"), gearbox::Session::DEFAULT_PATH, 9999, true, std::string("username"), std::string("password"));
+
+        /* An asynchronous call is out learning the token, it completes on */
+        /* the transport thread that the continuation below blocks.        */
+        SessionToken::Ticket pending;
+        REQUIRE((test->sessionToken_.tryAcquire(pending)));
+        REQUIRE((pending.leader));
+
+        std::promise<gearbox::session::Response> sync;
+        auto result = sync.get_future();
+        test->http_.sendAsync(test->createRequest("session-stats", {}), [&test, &sync](http::RequestResult &&) {
+            sync.set_value(test->sendRequest("session-stats", {}));
+        });
+
+        REQUIRE((result.wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        auto response = result.get();
+        REQUIRE((!response.error));
+        REQUIRE((response.get_result() == "success"));
+        test->sessionToken_.release(pending, true);
+    }
+#endif
+
     {
         using gearbox::Session;
 
@@ -92,7 +143,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = test.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == ""));
                 REQUIRE((impl.path() == Session::DEFAULT_PATH));
                 REQUIRE((impl.port() == -1));
@@ -111,7 +162,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = testMove.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == ""));
                 REQUIRE((impl.path() == Session::DEFAULT_PATH));
                 REQUIRE((impl.port() == -1));
@@ -131,7 +182,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = test.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == ""));
                 REQUIRE((impl.path() == Session::DEFAULT_PATH));
                 REQUIRE((impl.port() == -1));
@@ -167,7 +218,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = test.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == url));
                 REQUIRE((impl.path() == path));
                 REQUIRE((impl.port() == port));
@@ -192,7 +243,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = test.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == url));
                 REQUIRE((impl.path() == path));
                 REQUIRE((impl.port() == port));
@@ -228,7 +279,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = test.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == url));
                 REQUIRE((impl.path() == path));
                 REQUIRE((impl.port() == port));
@@ -253,7 +304,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             if (test.priv_ != nullptr)
             {
                 auto &impl = test.priv_->http_;
-                REQUIRE((test.priv_->sessionId_ == "dummy"));
+                REQUIRE((test.priv_->sessionToken_.replacements() == 0));
                 REQUIRE((impl.host() == url));
                 REQUIRE((impl.path() == path));
                 REQUIRE((impl.port() == port));
@@ -287,6 +338,94 @@ TEST_CASE("Test libgearbox_session", "[session]")
             REQUIRE((stats.value.uploadSpeed == 42));
         }
 
+        SECTION(("gearbox::Session::statistics(const gearbox::CallOptions &) const"))
+        {
+            /* Nothing is sent for a call that is over before it started */
+            gearbox::CancellationToken token;
+            token.cancel();
+            auto stats = test.statistics(token);
+            REQUIRE((stats.error.errorCode() == Error::Code::GearboxCallCancelled));
+
+            stats = test.statistics(gearbox::CallOptions().setTimeout(0));
+            REQUIRE((stats.error.errorCode() == Error::Code::RequestOperationTimedOut));
+            REQUIRE((test.connectionStatistics().newConnections == 0));
+
+            /* The slow response takes 10 seconds to trickle in */
+            test.setPath("/test_slow");
+            const auto start = std::chrono::steady_clock::now();
+            stats = test.statistics(gearbox::CallOptions().setTimeout(300));
+            REQUIRE((stats.error.errorCode() == Error::Code::RequestOperationTimedOut));
+            REQUIRE((std::chrono::steady_clock::now() - start < std::chrono::seconds(2)));
+
+            gearbox::CancellationToken slowToken;
+            auto slowStats = test.statisticsAsync(slowToken);
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            slowToken.cancel();
+            REQUIRE((slowStats.waitFor(std::chrono::seconds(2))));
+            REQUIRE((slowStats.get().error.errorCode() == Error::Code::GearboxCallCancelled));
+        }
+
+        SECTION(("gearbox::Session::connectionStatistics() const"))
+        {
+            /* The first request gets a 409 and is retried over the same connection */
+            REQUIRE((!test.statistics().error));
+            REQUIRE((!test.statistics().error));
+
+            auto statistics = test.connectionStatistics();
+            REQUIRE((statistics.newConnections == 1));
+            REQUIRE((statistics.reusedConnections == 2));
+
+            test.setMaxIdleConnections(0);
+            REQUIRE((test.maxIdleConnections() == 0));
+            REQUIRE((!test.statistics().error));
+            REQUIRE((test.connectionStatistics().newConnections == 2));
+
+            test.setIdleConnectionTimeout(1000);
+            REQUIRE((test.idleConnectionTimeout() == 1000));
+
+            /* Responses are gzip-ed by the test server when the client allows it */
+            statistics = test.connectionStatistics();
+            REQUIRE((test.compressionEnabled()));
+            REQUIRE((statistics.receivedBytes < statistics.decodedBytes));
+
+            test.setCompression(Session::Compression::Disabled);
+            REQUIRE((!test.compressionEnabled()));
+        }
+
+        SECTION(("gearbox::Session::shareConnections(const gearbox::Session &)"))
+        {
+            Session other(
+                "http://localhost",
+                gearbox::Session::DEFAULT_PATH,
+                9999,
+                Session::Authentication::Required,
+                "username",
+                "password"
+            );
+            other.shareConnections(test);
+
+            REQUIRE((!test.statistics().error));
+            REQUIRE((!other.statistics().error));
+
+            /* One connection and one lookup served both sessions */
+            auto statistics = other.connectionStatistics();
+            REQUIRE((statistics.newConnections == 1));
+            REQUIRE((statistics.dnsLookups == 1));
+            REQUIRE((statistics.connectionHitRate > 0.5));
+            REQUIRE((test.connectionStatistics().reusedConnections == statistics.reusedConnections));
+        }
+
+        SECTION(("gearbox::Session::setUnixSocketPath(const std::string &)"))
+        {
+            REQUIRE((test.unixSocketPath().empty()));
+
+            /* Nothing listens on the port, the socket has to be used */
+            test.setPort(1);
+            test.setUnixSocketPath("/tmp/libgearbox_test.sock");
+            REQUIRE((test.unixSocketPath() == "/tmp/libgearbox_test.sock"));
+            REQUIRE((!test.statistics().error));
+        }
+
         SECTION(("gearbox::Session::torrents() const"))
         {
             auto torrents = test.torrents();
@@ -310,6 +449,22 @@ TEST_CASE("Test libgearbox_session", "[session]")
             REQUIRE((t.queuePosition() == 0));
         }
 
+        SECTION(("gearbox::Session::forEachTorrent(const std::function<void(gearbox::Torrent &&)> &) const"))
+        {
+            std::vector<Torrent> torrents;
+            auto error = test.forEachTorrent([&torrents](Torrent &&t) {
+                torrents.push_back(std::move(t));
+            });
+
+            REQUIRE((!error));
+            REQUIRE((torrents.size() == 1));
+            auto &t = torrents.at(0);
+            REQUIRE((t.valid()));
+            REQUIRE((t.name() == "torrent"));
+            REQUIRE((t.downloadDir() == "/path/to/downloads"));
+            REQUIRE((t.queuePosition() == 0));
+        }
+
         SECTION(("gearbox::Session::recentlyRemoved() const"))
         {
             auto removed = test.recentlyRemoved();
@@ -338,7 +493,7 @@ TEST_CASE("Test libgearbox_session", "[session]")
             test.updateTorrentStats(torrents);
 
             REQUIRE((torrents.size() == 1));
-            REQUIRE((t.priv_.get() != priv));
+            REQUIRE((t.priv_.get() == priv));
             REQUIRE((t.valid()));
             REQUIRE((t.id() == 0));
             REQUIRE((t.name() == "torrent"));
@@ -354,6 +509,211 @@ TEST_CASE("Test libgearbox_session", "[session]")
             REQUIRE((t.eta() == 12345));
             REQUIRE((t.queuePosition() == 0));
         }
+
+        SECTION(("gearbox::Session::torrents(gearbox::FieldSet) const"))
+        {
+            /* The server only sends the fields that were asked for */
+            auto torrents = test.torrents(Torrent::Field::Name | Torrent::Field::PercentDone);
+
+            REQUIRE((!torrents.error));
+            REQUIRE((torrents.value.size() == 1));
+            auto &t = torrents.value.at(0);
+            REQUIRE((t.id() == 0));
+            REQUIRE((t.name() == "torrent"));
+            REQUIRE((t.percentDone() == 0.8));
+            REQUIRE((t.downloadDir().empty()));
+        }
+
+        SECTION(("gearbox::Session::updateTorrentStats(std::vector<std::reference_wrapper<gearbox::Torrent>> &, gearbox::FieldSet)"))
+        {
+            auto priv = new TorrentPrivate();
+            std::get<0> (priv->attributes) = 0;
+            std::get<1> (priv->attributes).set_value("kept");
+            std::get<6> (priv->attributes) = 0;
+            std::get<7> (priv->attributes) = 0;
+            priv->session_ = test.priv_;
+            Torrent t(priv);
+            std::vector<std::reference_wrapper<Torrent>> torrents = { t };
+            REQUIRE((!test.updateTorrentStats(torrents, Torrent::Field::DownloadSpeed | Torrent::Field::UploadSpeed)));
+
+            REQUIRE((t.valid()));
+            REQUIRE((t.downloadSpeed() == 12345));
+            REQUIRE((t.uploadSpeed() == 1234));
+            REQUIRE((t.name() == "kept"));
+
+            REQUIRE((!t.update(Torrent::Field::DownloadDir)));
+            REQUIRE((t.downloadDir() == "/path/to/downloads"));
+            REQUIRE((t.name() == "kept"));
+
+            REQUIRE((!t.updateAsync(gearbox::FieldSet::all()).get()));
+            REQUIRE((t.name() == "torrent"));
+        }
+
+        SECTION(("gearbox::Session::stopTorrents(const gearbox::Session::TorrentIds &)"))
+        {
+            std::vector<std::int32_t> ids(2000);
+            std::iota(ids.begin(), ids.end(), 0);
+
+            auto results = test.stopTorrents(ids);
+            REQUIRE((results.size() == 1));
+            REQUIRE((results.at(0).ids == ids));
+            REQUIRE((results.at(0).error.errorCode() == Error::Code::Ok));
+
+            /* Only the call with the id the server refuses fails */
+            test.setMaxTorrentsPerCall(500);
+            REQUIRE((test.maxTorrentsPerCall() == 500));
+            ids.at(1200) = -1;
+            results = test.stopTorrents(ids);
+            REQUIRE((results.size() == 4));
+            for (std::size_t it = 0; it < results.size(); ++it)
+            {
+                REQUIRE((results.at(it).ids.size() == 500));
+                REQUIRE((results.at(it).ids.front() == static_cast<std::int32_t>(it * 500)));
+                REQUIRE((static_cast<bool>(results.at(it).error) == (it == 2)));
+            }
+            REQUIRE((results.at(2).error.message() == "invalid id"));
+
+            /* Invalid torrents are left out */
+            auto torrents = test.torrents();
+            torrents.value.emplace_back(nullptr);
+            results = test.removeTorrents(torrents.value, Torrent::LocalDataAction::DeleteFiles);
+            REQUIRE((results.size() == 1));
+            REQUIRE((results.at(0).ids == std::vector<std::int32_t>{ 0 }));
+            REQUIRE((!results.at(0).error));
+
+            /* Nothing is sent for an empty list */
+            const auto requests = test.connectionStatistics();
+            REQUIRE((test.verifyTorrents({}).empty()));
+            REQUIRE((test.connectionStatistics().reusedConnections == requests.reusedConnections));
+        }
+
+        SECTION(("gearbox::Session::queueMoveTopAsync(const gearbox::Session::TorrentIds &)"))
+        {
+            test.setMaxTorrentsPerCall(3);
+            auto results = test.queueMoveTopAsync({ 1, 2, 3, 4, -5, 6, 7 }).get();
+            REQUIRE((results.size() == 3));
+            REQUIRE((!results.at(0).error));
+            REQUIRE((results.at(1).ids == std::vector<std::int32_t>{ 4, -5, 6 }));
+            REQUIRE((results.at(1).error.errorCode() == Error::Code::UnknownError));
+            REQUIRE((results.at(2).ids == std::vector<std::int32_t>{ 7 }));
+            REQUIRE((!results.at(2).error));
+
+            REQUIRE((test.askForMorePeersAsync({}).get().empty()));
+        }
+
+        SECTION(("gearbox::Session::setCoalescingWindow(std::int32_t)"))
+        {
+            /* Only the mutations are counted once the token is known */
+            REQUIRE((!test.statistics().error));
+            test.setCoalescingWindow(100);
+            REQUIRE((test.coalescingWindow() == 100));
+
+            std::vector<Torrent> torrents;
+            for (std::int32_t id = 0; id < 32; ++id)
+            {
+                auto priv = new TorrentPrivate();
+                std::get<0>(priv->attributes) = id;
+                priv->session_ = test.priv_;
+                torrents.emplace_back(priv);
+            }
+
+            auto requests = [&test]() {
+                auto statistics = test.connectionStatistics();
+                return statistics.newConnections + statistics.reusedConnections;
+            };
+            const auto before = requests();
+
+            /* The first and the last torrent are stopped before they ever start */
+            std::vector<gearbox::Future<Error>> results;
+            for (auto &torrent : torrents) results.push_back(torrent.startAsync());
+            results.push_back(torrents.front().stopAsync());
+            REQUIRE((!torrents.back().stop()));
+            for (auto &result : results) REQUIRE((!result.get()));
+            REQUIRE((requests() - before == 2));
+
+            /* Every caller gets the error of the call it ended up in */
+            auto priv = new TorrentPrivate();
+            std::get<0>(priv->attributes) = -1;
+            priv->session_ = test.priv_;
+            Torrent refused(priv);
+
+            auto first = torrents.front().verifyAsync();
+            auto second = refused.verifyAsync();
+            REQUIRE((first.get().message() == "invalid id"));
+            REQUIRE((second.get().message() == "invalid id"));
+            REQUIRE((requests() - before == 3));
+
+            test.setCoalescingWindow(0);
+            REQUIRE((!torrents.front().verify()));
+            REQUIRE((requests() - before == 4));
+
+            /* Once the queue is disabled, a mutation goes out only after */
+            /* those that were queued before                              */
+            test.setCoalescingWindow(10000);
+            auto queued = torrents.front().startAsync();
+            test.setCoalescingWindow(0);
+            REQUIRE((!torrents.back().stop()));
+            REQUIRE((queued.waitFor(std::chrono::seconds(0))));
+            REQUIRE((!queued.get()));
+            REQUIRE((requests() - before == 6));
+        }
+
+        SECTION(("gearbox::Session::statisticsAsync() const"))
+        {
+            auto stats = test.statisticsAsync().get();
+            REQUIRE((!stats.error));
+            REQUIRE((stats.value.totalTorrentCount == 42));
+
+            /* Every request is in flight before the first result is consumed */
+            std::vector<gearbox::Future<gearbox::ReturnType<Session::Statistics>>> futures;
+            for (int it = 0; it < 64; ++it) futures.push_back(test.statisticsAsync());
+            for (auto &future : futures)
+            {
+                auto result = future.get();
+                REQUIRE((!result.error));
+                REQUIRE((result.value.uploadSpeed == 42));
+            }
+        }
+
+        SECTION(("gearbox::Session::torrentsAsync() const"))
+        {
+            std::promise<std::string> name;
+            auto result = name.get_future();
+            test.torrentsAsync().then([&name](gearbox::ReturnType<std::vector<Torrent>> &&torrents) {
+                name.set_value((!torrents.error && (torrents.value.size() == 1)) ? torrents.value.at(0).name() : "");
+            });
+
+            REQUIRE((result.wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+            REQUIRE((result.get() == "torrent"));
+        }
+
+        SECTION(("gearbox::Session::recentlyRemovedAsync() const"))
+        {
+            auto future = test.recentlyRemovedAsync();
+            REQUIRE((future.waitFor(std::chrono::seconds(10))));
+            auto removed = future.get();
+            REQUIRE((!removed.error));
+            REQUIRE((removed.value.size() == 1));
+            REQUIRE((removed.value.at(0) == 1));
+        }
+
+        SECTION(("gearbox::Session::updateTorrentStatsAsync(std::vector<std::reference_wrapper<gearbox::Torrent>> &)"))
+        {
+            auto torrents = test.torrents();
+            REQUIRE((torrents.value.size() == 1));
+            auto &t = torrents.value.at(0);
+            auto priv = t.priv_.get();
+
+            /* The cached data is refreshed in place */
+            std::vector<std::reference_wrapper<Torrent>> update = { t };
+            REQUIRE((!test.updateTorrentStatsAsync(update).get()));
+            REQUIRE((t.priv_.get() == priv));
+            REQUIRE((t.name() == "torrent"));
+
+            REQUIRE((!t.updateAsync().get()));
+            REQUIRE((t.priv_.get() == priv));
+            REQUIRE((t.downloadDir() == "/path/to/downloads"));
+        }
     }
 
     {
@@ -410,3 +770,42 @@ TEST_CASE("Test libgearbox_session", "[session]")
         }
     }
 }
+
+TEST_CASE("Benchmark gearbox::Session::updateTorrentStats", "[.][benchmark]")
+{
+    using gearbox::Session;
+
+    for (std::int32_t count : { 1000, 10000, 100000 })
+    {
+        /* Every tenth torrent is missing from the response */
+        auto rows = nlohmann::json::array({ { "id", "name" } });
+        for (std::int32_t id = 0; id < count; ++id)
+        {
+            if (id % 10 != 0) rows.push_back({ id, "torrent" });
+        }
+        gearbox::session::Response response;
+        response.set_arguments({ { "torrents", std::move(rows) } });
+
+        std::vector<Torrent> torrents;
+        torrents.reserve(count);
+        for (std::int32_t id = 0; id < count; ++id)
+        {
+            auto priv = new TorrentPrivate();
+            std::get<0>(priv->attributes) = id;
+            torrents.emplace_back(priv);
+        }
+        std::vector<std::reference_wrapper<Torrent>> update(torrents.begin(), torrents.end());
+
+        const auto start = std::chrono::steady_clock::now();
+        auto error = Session::updateTorrentStats({}, update, gearbox::FieldSet::all(), std::move(response), gearbox::CallOptions());
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        REQUIRE((!error));
+
+        const auto returned = std::count_if(torrents.begin(), torrents.end(), [](const Torrent &t) { return t.valid(); });
+        const auto missing = count - returned;
+        REQUIRE((returned == count - count / 10));
+        REQUIRE((torrents.at(1).name() == "torrent"));
+
+        WARN(count << " torrents: " << returned << " returned, " << missing << " missing, updated in " << elapsed.count() << " us");
+    }
+}
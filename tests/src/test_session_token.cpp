@@ -0,0 +1,222 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define private public
+#include <libgearbox_session_token_p.h>
+#include <libgearbox_session_token.cpp>
+
+#ifdef PLATFORM_LINUX
+#include <libgearbox_http_linux_p.h>
+#endif
+
+TEST_CASE("Test libgearbox_session_token", "[session]")
+{
+    using gearbox::SessionToken;
+
+    SessionToken token;
+
+    SECTION(("gearbox::SessionToken::tryAcquire(gearbox::SessionToken::Ticket &, gearbox::SessionToken::resume_t)"))
+    {
+        /* Only the first request goes out while the token is unknown */
+        SessionToken::Ticket leader;
+        REQUIRE((token.tryAcquire(leader)));
+        REQUIRE((leader.leader));
+        REQUIRE((leader.value.empty()));
+
+        int resumed = 0;
+        SessionToken::Ticket other;
+        REQUIRE((!token.tryAcquire(other, [&resumed]() { ++resumed; })));
+        REQUIRE((!token.tryAcquire(other, [&resumed]() { ++resumed; })));
+
+        /* No response, the next request takes the lead */
+        token.release(leader, false);
+        REQUIRE((resumed == 2));
+        REQUIRE((token.tryAcquire(leader)));
+        REQUIRE((leader.leader));
+
+        token.replace(leader, "token-0");
+        REQUIRE((token.replacements() == 1));
+        REQUIRE((token.tryAcquire(other)));
+        REQUIRE((!other.leader));
+        REQUIRE((other.value == "token-0"));
+        REQUIRE((other.generation == 1));
+    }
+
+    SECTION(("gearbox::SessionToken::replace(const gearbox::SessionToken::Ticket &, const std::string &)"))
+    {
+        SessionToken::Ticket first;
+        REQUIRE((token.tryAcquire(first)));
+        token.replace(first, "token-0");
+
+        /* Both were sent with token-0 when it was rotated */
+        SessionToken::Ticket second;
+        SessionToken::Ticket third;
+        REQUIRE((token.tryAcquire(second)));
+        REQUIRE((token.tryAcquire(third)));
+
+        token.replace(second, "token-1");
+        REQUIRE((token.replacements() == 2));
+
+        /* Only the token it was sent with is replaced, token-2 is lost */
+        /* and comes back with the 409 of the next request.              */
+        token.replace(third, "token-2");
+        REQUIRE((token.replacements() == 2));
+        REQUIRE((token.tryAcquire(third)));
+        REQUIRE((third.value == "token-1"));
+
+        /* Tokens that don't fit the seqlock */
+        const std::string longToken(200, 'x');
+        token.replace(third, longToken);
+        REQUIRE((token.tryAcquire(third)));
+        REQUIRE((third.value == longToken));
+        token.replace(third, "token-3");
+        REQUIRE((token.tryAcquire(third)));
+        REQUIRE((third.value == "token-3"));
+    }
+
+    SECTION(("gearbox::SessionToken::acquire(gearbox::SessionToken::Ticket &, const gearbox::CallOptions &)"))
+    {
+        SessionToken::Ticket leader;
+        REQUIRE((token.tryAcquire(leader)));
+
+        std::thread learn([&token, &leader]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            token.release(leader, true);
+        });
+        SessionToken::Ticket other;
+        REQUIRE((token.acquire(other, gearbox::CallOptions())));
+        REQUIRE((!other.leader));
+        learn.join();
+
+        /* Gives up waiting once the call is interrupted */
+        SessionToken unknown;
+        REQUIRE((unknown.tryAcquire(leader)));
+        REQUIRE((!unknown.acquire(other, gearbox::CallOptions().setTimeout(100))));
+    }
+
+    SECTION(("gearbox::SessionToken::acquireNow(gearbox::SessionToken::Ticket &)"))
+    {
+        SessionToken::Ticket leader;
+        token.acquireNow(leader);
+        REQUIRE((leader.leader));
+
+        /* Goes out without a token while the leader is in flight */
+        SessionToken::Ticket other;
+        token.acquireNow(other);
+        REQUIRE((!other.leader));
+        REQUIRE((other.value.empty()));
+
+        /* Its 409 teaches the token to everyone, the leader included */
+        token.replace(other, "token-0");
+        REQUIRE((token.tryAcquire(other)));
+        REQUIRE((other.value == "token-0"));
+        token.replace(leader, "token-0");
+        REQUIRE((token.replacements() == 1));
+        token.acquireNow(other);
+        REQUIRE((!other.leader));
+        REQUIRE((other.value == "token-0"));
+    }
+}
+
+#ifdef PLATFORM_LINUX
+TEST_CASE("Test libgearbox_session_token under concurrent requests", "[session]")
+{
+    using gearbox::SessionToken;
+
+    constexpr int THREAD_COUNT { 64 };
+    constexpr int REQUEST_COUNT { 40 };
+
+    /* The server replaces its token every 500 accepted requests */
+    gearbox::CUrlHttp http("user-agent");
+    http.setHost("http://localhost");
+    http.setPort(gearbox::CUrlHttp::http_port_t { 9999 });
+    http.setPath("/test_session_token");
+    http.setMaxIdleConnections(THREAD_COUNT);
+
+    SessionToken token;
+    std::atomic<int> conflicts { 0 };
+    std::atomic<int> firstConflicts { 0 };
+    std::atomic<int> succeeded { 0 };
+
+    /* Every thread sends its first request at the same time, and only goes */
+    /* on once all of them are done with it.                               */
+    std::mutex mutex;
+    std::condition_variable started;
+    int waiting = 0;
+    auto barrier = [&](int generation) {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++waiting;
+        started.notify_all();
+        started.wait(lock, [&]() { return waiting >= generation * THREAD_COUNT; });
+    };
+
+    auto send = [&](std::atomic<int> &counter) {
+        for (int attempt = 0; attempt < 5; ++attempt)
+        {
+            /* Catch's assertions are not to be used from other threads */
+            SessionToken::Ticket ticket;
+            if (!token.acquire(ticket, gearbox::CallOptions())) return;
+
+            auto request = http.createRequest();
+            if (!ticket.value.empty()) request.setHeader({ "X-Transmission-Session-Id", ticket.value });
+            request.setBody("{}");
+            auto result = request.send();
+            if (!result.error && (result.status == gearbox::http::Status::Conflict))
+            {
+                ++counter;
+                token.replace(ticket, result.response.headers["X-Transmission-Session-Id"]);
+                continue;
+            }
+
+            token.release(ticket, !result.error);
+            if (!result.error) ++succeeded;
+            return;
+        }
+    };
+
+    std::string firstToken;
+    std::vector<std::thread> threads;
+    for (int it = 0; it < THREAD_COUNT; ++it)
+    {
+        threads.emplace_back([&, it]() {
+            barrier(1);
+            send(firstConflicts);
+            barrier(2);
+            if (it == 0)
+            {
+                SessionToken::Ticket ticket;
+                token.tryAcquire(ticket);
+                firstToken = ticket.value;
+            }
+            barrier(3);
+
+            for (int request = 1; request < REQUEST_COUNT; ++request)
+            {
+                send(conflicts);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+
+    REQUIRE((succeeded == THREAD_COUNT * REQUEST_COUNT));
+
+    /* A single request went out to learn the token */
+    REQUIRE((firstConflicts == 1));
+
+    /* Each rotation replaced the token once, the requests that were in */
+    /* flight with the previous token got a single 409 each.            */
+    SessionToken::Ticket last;
+    token.tryAcquire(last);
+    const auto rotations = std::stoul(last.value.substr(6)) - std::stoul(firstToken.substr(6));
+    REQUIRE((token.replacements() == rotations + 1));
+    REQUIRE((conflicts <= static_cast<int>(rotations) * THREAD_COUNT));
+
+    WARN("409 round trips: " << firstConflicts + conflicts << " for " << succeeded << " requests and "
+         << rotations << " token rotations");
+}
+#endif // PLATFORM_LINUX
@@ -1,9 +1,27 @@
 #include <catch.hpp>
 
+#include <cstdlib>
+#include <new>
+
 #define private public
 #include <libgearbox_torrent.h>
 #include <libgearbox_torrent.cpp>
 
+namespace
+{
+    /* Allocations made by the thread that runs the tests */
+    thread_local std::size_t allocations{ 0 };
+}
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto memory = std::malloc((size != 0) ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
 TEST_CASE("Test libgearbox_torrent", "[torrent]")
 {
     SECTION(("gearbox::Torrent::Torrent(gearbox::TorrentPrivate *)"))
@@ -23,6 +41,138 @@ TEST_CASE("Test libgearbox_torrent", "[torrent]")
         REQUIRE((!t.valid()));
     }
 
+    SECTION(("gearbox::Torrent::startAsync()"))
+    {
+        /* Failures that happen before a request is sent are ready right away */
+        Torrent invalid(nullptr);
+        auto future = invalid.startAsync();
+        REQUIRE((future.ready()));
+        REQUIRE((future.get().errorCode() == gearbox::Error::Code::GearboxTorrentInvalid));
+
+        Torrent orphan(new TorrentPrivate());
+        auto files = orphan.filesAsync();
+        REQUIRE((files.ready()));
+        auto result = files.get();
+        REQUIRE((result.error.errorCode() == gearbox::Error::Code::GearboxSessionInvalid));
+        REQUIRE((result.value.empty()));
+    }
+
+    SECTION(("gearbox::FieldSet"))
+    {
+        using gearbox::FieldSet;
+
+        constexpr auto speeds = Torrent::Field::DownloadSpeed | Torrent::Field::UploadSpeed;
+        static_assert(speeds.contains(Torrent::Field::UploadSpeed), "");
+        static_assert(!speeds.contains(Torrent::Field::Name), "");
+        static_assert((speeds & FieldSet::all()) == speeds, "");
+        static_assert(FieldSet().empty(), "");
+
+        auto names = TorrentPrivate::attribute_names(speeds | Torrent::Field::Id);
+        REQUIRE((names.size() == 3));
+        REQUIRE((std::string(names.at(0)) == "id"));
+        REQUIRE((std::string(names.at(1)) == "rateDownload"));
+        REQUIRE((std::string(names.at(2)) == "rateUpload"));
+        REQUIRE((TorrentPrivate::attribute_names(FieldSet::all()).size() == TorrentPrivate::attribute_names().size()));
+    }
+
+    SECTION(("gearbox::TorrentPrivate::fromTable(const nlohmann::json &)"))
+    {
+        auto rows = nlohmann::json::parse(R"([ [ "rateUpload", "unknown", "name", "id" ], [ 12, 1, "first", 3 ], "not a row", [ 14, 2, 15, 4 ] ])");
+        auto torrents = TorrentPrivate::fromTable(rows);
+
+        REQUIRE((torrents.size() == 2));
+        REQUIRE((torrents.at(0).get_id() == 3));
+        REQUIRE((torrents.at(0).get_name() == "first"));
+        REQUIRE((torrents.at(0).get_rateUpload() == 12));
+        REQUIRE((torrents.at(1).get_id() == 4));
+        REQUIRE((torrents.at(1).get_rateUpload() == 14));
+
+        /* A name of the wrong type is skipped */
+        REQUIRE((torrents.at(1).get_name().empty()));
+
+        REQUIRE((TorrentPrivate::fromTable(nlohmann::json::array()).empty()));
+        REQUIRE((TorrentPrivate::fromTable(nlohmann::json::parse(R"([ { "id": 1 } ])")).empty()));
+    }
+
+    SECTION(("gearbox::TorrentPrivate::Table::refresh(const nlohmann::json &, gearbox::TorrentPrivate &, gearbox::FieldSet) const"))
+    {
+        const TorrentPrivate::Table table(nlohmann::json::parse(R"([ "id", "name", "rateDownload", "downloadDir" ])"));
+        const auto first = nlohmann::json::parse(R"([ [ 1, "the name of the first torrent", 10, "/where/the/downloads/of/the/first/go" ],
+                                                      [ 2, "the name of the second torrent", 20, "/where/the/downloads/of/the/second/go" ] ])");
+        const auto second = nlohmann::json::parse(R"([ [ 1, "the new name of the first torrent", 11, "/where/the/downloads/of/the/first/go" ],
+                                                       [ 2, "the name of the second torrent", 21, "/the/second/goes/here/now" ] ])");
+        REQUIRE((table.id(first[1]) == 2));
+        REQUIRE((table.id(nlohmann::json::array()) == -1));
+
+        TorrentPrivate torrent;
+        REQUIRE((table.refresh(first[0], torrent) == (Torrent::Field::Id | Torrent::Field::Name | Torrent::Field::DownloadSpeed | Torrent::Field::DownloadDir)));
+        REQUIRE((table.refresh(first[0], torrent).empty()));
+        REQUIRE((table.refresh(second[0], torrent, Torrent::Field::DownloadSpeed) == gearbox::FieldSet(Torrent::Field::DownloadSpeed)));
+        REQUIRE((torrent.get_rateDownload() == 11));
+        REQUIRE((torrent.get_name() == "the name of the first torrent"));
+
+        /* Once the strings have grown to fit either value refreshing the */
+        /* torrents, over and over, allocates nothing                     */
+        std::vector<TorrentPrivate> torrents(2);
+        std::size_t steadyAllocations = 0;
+        for (int round = 0; round < 10; ++round)
+        {
+            const auto &rows = (round % 2 == 0) ? first : second;
+            const auto before = allocations;
+            for (std::size_t it = 0; it < torrents.size(); ++it)
+            {
+                REQUIRE((!table.refresh(rows[it], torrents[it]).empty()));
+            }
+            if (round > 1) steadyAllocations += allocations - before;
+        }
+        REQUIRE((steadyAllocations == 0));
+        REQUIRE((torrents.at(1).get_downloadDir() == "/the/second/goes/here/now"));
+    }
+
+    SECTION(("gearbox::Session::updateTorrentStats(const std::weak_ptr<gearbox::SessionPrivate> &, std::vector<std::reference_wrapper<gearbox::Torrent>> &, gearbox::FieldSet, gearbox::session::Response &&, const gearbox::CallOptions &)"))
+    {
+        const auto first = nlohmann::json::parse(R"({ "torrents": [ [ "id", "name", "rateDownload", "downloadDir" ],
+                                                                    [ 2, "the name of the second torrent", 20, "/where/the/downloads/of/the/second/go" ],
+                                                                    [ 1, "the name of the first torrent", 10, "/where/the/downloads/of/the/first/go" ] ] })");
+        const auto second = nlohmann::json::parse(R"({ "torrents": [ [ "id", "name", "rateDownload", "downloadDir" ],
+                                                                     [ 1, "the new name of the first torrent", 11, "/where/the/downloads/of/the/first/go" ],
+                                                                     [ 2, "the name of the second torrent", 21, "/the/second/goes/here/now" ] ] })");
+
+        std::vector<Torrent> torrents;
+        for (std::int32_t id = 1; id <= 2; ++id)
+        {
+            auto priv = new TorrentPrivate();
+            priv->set_id(id);
+            torrents.emplace_back(priv);
+        }
+        std::vector<std::reference_wrapper<Torrent>> polled(torrents.begin(), torrents.end());
+
+        /* The responses are made up front, only polling them is counted */
+        constexpr int ROUNDS { 10 };
+        std::vector<gearbox::session::Response> responses(ROUNDS);
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            responses[round].set_arguments((round % 2 == 0) ? first : second);
+        }
+
+        /* Once the index of the rows, and the strings of the torrents,  */
+        /* have grown to fit the response, polling it allocates nothing */
+        const std::weak_ptr<gearbox::SessionPrivate> session;
+        const gearbox::CallOptions options;
+        std::size_t steadyAllocations = 0;
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            const auto before = allocations;
+            auto error = gearbox::Session::updateTorrentStats(session, polled, gearbox::FieldSet::all(), std::move(responses[round]), options);
+            if (round > 1) steadyAllocations += allocations - before;
+            REQUIRE((!error));
+        }
+        REQUIRE((steadyAllocations == 0));
+        REQUIRE((torrents.at(0).valid()));
+        REQUIRE((torrents.at(0).priv_->get_rateDownload() == 11));
+        REQUIRE((torrents.at(1).priv_->get_downloadDir() == "/the/second/goes/here/now"));
+    }
+
     {
         auto priv = new TorrentPrivate();
         std::get<0> (priv->attributes) = 0;                       /* id */
@@ -0,0 +1,225 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define private public
+#include <libgearbox_torrent_snapshot.h>
+#include <libgearbox_torrent_table.h>
+#include <libgearbox_torrent_index.h>
+#include <libgearbox_torrent_index.cpp>
+
+namespace
+{
+    gearbox::TorrentSnapshot::entry_t entry(std::int32_t id, const std::string &name, gearbox::Torrent::Status status, std::uint64_t downloadSpeed, std::uint64_t size, const std::string &downloadDir)
+    {
+        gearbox::TorrentSnapshot::Entry result{};
+        result.id = id;
+        result.name = name;
+        result.status = status;
+        result.downloadSpeed = downloadSpeed;
+        result.uploadSpeed = downloadSpeed / 10;
+        result.size = size;
+        result.bytesDownloaded = size / 2;
+        result.uploadRatio = 0.5 * id;
+        result.downloadDir = downloadDir;
+        result.eta = (status == gearbox::Torrent::Status::Download) ? 60 : -1;
+        result.queuePosition = id;
+        return std::make_shared<const gearbox::TorrentSnapshot::Entry>(std::move(result));
+    }
+
+    std::vector<std::int32_t> ids(const std::vector<gearbox::TorrentSnapshot::entry_t> &entries)
+    {
+        std::vector<std::int32_t> result;
+        for (const auto &entry : entries) result.push_back(entry->id);
+        return result;
+    }
+}
+
+TEST_CASE("Test libgearbox_torrent_index", "[torrent_index]")
+{
+    using gearbox::Torrent;
+    using gearbox::TorrentIndex;
+    using Status = Torrent::Status;
+    using Comparison = TorrentIndex::Comparison;
+    using Order = TorrentIndex::Order;
+
+    TorrentIndex test(std::make_shared<const gearbox::TorrentSnapshot>(std::vector<gearbox::TorrentSnapshot::entry_t>{
+        entry(1, "Show S01E10", Status::Download, 300, 4000, "/data/tv"),
+        entry(2, "show s01e9", Status::Download, 100, 1000, "/data/tv/show"),
+        entry(3, "Movie", Status::Seed, 0, 8000, "/data/movies"),
+        entry(4, "Show S01E02", Status::Download, 300, 2000, "/data/tv"),
+        entry(5, "Album 007", Status::Stopped, 0, 500, "/data/television"),
+        entry(6, "Album 7b", Status::DownloadWait, 0, 500, "/data/tv/"),
+        entry(7, "album 10", Status::Download, 200, 100, "/data/tv"),
+    }, 1));
+
+    SECTION(("gearbox::TorrentIndex::TorrentIndex(std::shared_ptr<const gearbox::TorrentSnapshot>)"))
+    {
+        REQUIRE((test.size() == 7));
+        REQUIRE((test.snapshot().version() == 1));
+        REQUIRE((test.directories_ == std::vector<std::string>{ "/data/movies", "/data/television", "/data/tv", "/data/tv/", "/data/tv/show" }));
+        REQUIRE((test.directoryIndices_ == std::vector<std::uint32_t>{ 2, 4, 0, 2, 1, 3, 2 }));
+
+        REQUIRE((TorrentIndex(nullptr).size() == 0));
+        REQUIRE((TorrentIndex(nullptr).query().select().empty()));
+    }
+
+    SECTION(("gearbox::TorrentIndex::Query::select()"))
+    {
+        REQUIRE((ids(test.query().select()) == std::vector<std::int32_t>{ 1, 2, 3, 4, 5, 6, 7 }));
+
+        /* Digits are compared as numbers, letters regardless of case */
+        REQUIRE((ids(test.query().orderBy(Torrent::Field::Name).select()) == std::vector<std::int32_t>{ 5, 6, 7, 3, 4, 2, 1 }));
+
+        /* Ties are listed by id, in either order */
+        REQUIRE((ids(test.query().orderBy(Torrent::Field::DownloadSpeed, Order::Descending).select()) == std::vector<std::int32_t>{ 1, 4, 7, 2, 3, 5, 6 }));
+        REQUIRE((ids(test.query().orderBy(Torrent::Field::DownloadSpeed).select()) == std::vector<std::int32_t>{ 3, 5, 6, 2, 7, 1, 4 }));
+        REQUIRE((ids(test.query().orderBy(Torrent::Field::Eta).select()) == std::vector<std::int32_t>{ 3, 5, 6, 1, 2, 4, 7 }));
+        REQUIRE((ids(test.query().orderBy(Torrent::Field::UploadRatio, Order::Descending).select()) == std::vector<std::int32_t>{ 7, 6, 5, 4, 3, 2, 1 }));
+        REQUIRE((ids(test.query().orderBy(Torrent::Field::DownloadDir).select()) == std::vector<std::int32_t>{ 3, 5, 1, 4, 7, 6, 2 }));
+    }
+
+    SECTION(("gearbox::TorrentIndex::Query::where(gearbox::Torrent::Field, gearbox::TorrentIndex::Comparison, double)"))
+    {
+        REQUIRE((ids(test.query().whereStatus({ Status::Download, Status::Seed }).select()) == std::vector<std::int32_t>{ 1, 2, 3, 4, 7 }));
+        REQUIRE((ids(test.query().whereStatus({ Status::Download }).whereStatus({ Status::Seed }).select()).empty()));
+
+        REQUIRE((ids(test.query().where(Torrent::Field::Size, Comparison::Greater, 1000).select()) == std::vector<std::int32_t>{ 1, 3, 4 }));
+        REQUIRE((ids(test.query().where(Torrent::Field::Size, Comparison::LessOrEqual, 1000).where(Torrent::Field::DownloadSpeed, Comparison::NotEqual, 0).select()) == std::vector<std::int32_t>{ 2, 7 }));
+        REQUIRE((ids(test.query().where(Torrent::Field::UploadSpeed, Comparison::Equal, 30).select()) == std::vector<std::int32_t>{ 1, 4 }));
+        REQUIRE((ids(test.query().where(Torrent::Field::UploadRatio, Comparison::GreaterOrEqual, 3).select()) == std::vector<std::int32_t>{ 6, 7 }));
+        REQUIRE((ids(test.query().where(Torrent::Field::Eta, Comparison::Less, 0).select()) == std::vector<std::int32_t>{ 3, 5, 6 }));
+        REQUIRE((test.query().where(Torrent::Field::Name, Comparison::Equal, 0).count() == 0));
+
+        /* The directory itself and those below it, but no other that starts the same */
+        REQUIRE((ids(test.query().whereDownloadDir("/data/tv").select()) == std::vector<std::int32_t>{ 1, 2, 4, 6, 7 }));
+        REQUIRE((ids(test.query().whereDownloadDir("/data/tv/").select()) == std::vector<std::int32_t>{ 1, 2, 4, 6, 7 }));
+        REQUIRE((ids(test.query().whereDownloadDir("/data/tv/show").select()) == std::vector<std::int32_t>{ 2 }));
+        REQUIRE((test.query().whereDownloadDir("/").count() == 7));
+        REQUIRE((test.query().whereDownloadDir("/data/t").count() == 0));
+    }
+
+    SECTION(("gearbox::TorrentIndex::Query::page(std::size_t, std::size_t)"))
+    {
+        auto query = test.query().whereDownloadDir("/data/tv").orderBy(Torrent::Field::DownloadSpeed, Order::Descending);
+        REQUIRE((query.count() == 5));
+
+        std::vector<std::int32_t> pages;
+        for (std::size_t offset = 0; offset < 6; offset += 2)
+        {
+            const auto page = ids(query.page(offset, 2).select());
+            REQUIRE((page.size() <= 2));
+            pages.insert(pages.end(), page.begin(), page.end());
+        }
+        REQUIRE((pages == ids(query.page(0, 5).select())));
+        REQUIRE((pages == std::vector<std::int32_t>{ 1, 4, 7, 2, 6 }));
+
+        REQUIRE((query.page(5, 2).select().empty()));
+        REQUIRE((query.page(0, 0).select().empty()));
+        REQUIRE((query.count() == 5));
+    }
+
+    SECTION(("gearbox::TorrentIndex::Query::groupByDownloadDir()"))
+    {
+        const auto groups = test.query().whereStatus({ Status::Download, Status::DownloadWait, Status::Seed }).groupByDownloadDir();
+        REQUIRE((groups.size() == 4));
+
+        REQUIRE((groups[0].downloadDir == "/data/movies"));
+        REQUIRE((groups[0].count == 1));
+        REQUIRE((groups[0].size == 8000));
+
+        REQUIRE((groups[1].downloadDir == "/data/tv"));
+        REQUIRE((groups[1].count == 3));
+        REQUIRE((groups[1].size == 6100));
+        REQUIRE((groups[1].bytesDownloaded == 3050));
+        REQUIRE((groups[1].downloadSpeed == 800));
+        REQUIRE((groups[1].uploadSpeed == 80));
+
+        REQUIRE((groups[2].downloadDir == "/data/tv/"));
+        REQUIRE((groups[3].downloadDir == "/data/tv/show"));
+        REQUIRE((groups[3].downloadSpeed == 100));
+    }
+}
+
+TEST_CASE("Benchmark gearbox::TorrentIndex", "[.][benchmark]")
+{
+    using gearbox::Torrent;
+    using gearbox::TorrentIndex;
+    using gearbox::TorrentSnapshot;
+
+    const std::vector<std::string> directories{ "/data/movies", "/data/music", "/data/tv", "/data/tv/archive", "/data/books" };
+
+    for (const std::int32_t count : { 10000, 100000 })
+    {
+        std::vector<TorrentSnapshot::entry_t> entries;
+        entries.reserve(count);
+        for (std::int32_t it = 0; it < count; ++it)
+        {
+            const auto status = static_cast<Torrent::Status>(it % 7);
+            entries.push_back(entry(it, "Torrent " + std::to_string((it * 7919) % count), status, static_cast<std::uint64_t>((it * 104729) % 100000), 1000 + it, directories[it % directories.size()]));
+        }
+        auto snapshot = std::make_shared<const TorrentSnapshot>(std::move(entries), 1);
+
+        constexpr int ROUNDS { 20 };
+        constexpr std::size_t TOP { 50 };
+
+        /* The 50 fastest downloading torrents in /data/tv, by copying and sorting */
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::int32_t> naive;
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            std::vector<TorrentSnapshot::entry_t> matching;
+            for (const auto &entry : *snapshot)
+            {
+                if ((entry->status == Torrent::Status::Download) && (entry->downloadDir.compare(0, 8, "/data/tv") == 0)) matching.push_back(entry);
+            }
+            std::sort(matching.begin(), matching.end(), [](const TorrentSnapshot::entry_t &lhs, const TorrentSnapshot::entry_t &rhs) {
+                if (lhs->downloadSpeed != rhs->downloadSpeed) return lhs->downloadSpeed > rhs->downloadSpeed;
+                return lhs->id < rhs->id;
+            });
+            matching.resize(std::min(matching.size(), TOP));
+            naive = ids(matching);
+        }
+        const auto sorted = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        TorrentIndex index(snapshot);
+        const auto build = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        std::vector<std::int32_t> indexed;
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            indexed = ids(index.query()
+                              .whereStatus({ Torrent::Status::Download })
+                              .whereDownloadDir("/data/tv")
+                              .orderBy(Torrent::Field::DownloadSpeed, TorrentIndex::Order::Descending)
+                              .page(0, TOP)
+                              .select());
+        }
+        const auto queried = std::chrono::steady_clock::now() - start;
+
+        REQUIRE((indexed == naive));
+
+        start = std::chrono::steady_clock::now();
+        std::size_t groups = 0;
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            groups += index.query().groupByDownloadDir().size();
+        }
+        const auto grouped = std::chrono::steady_clock::now() - start;
+
+        REQUIRE((groups == ROUNDS * directories.size()));
+
+        using us = std::chrono::microseconds;
+        WARN(count << " torrents, top " << TOP << " downloading in /data/tv: "
+             << std::chrono::duration_cast<us>(sorted).count() / ROUNDS << " us copying and sorting, "
+             << std::chrono::duration_cast<us>(queried).count() / ROUNDS << " us with the index ("
+             << std::chrono::duration_cast<us>(build).count() << " us to build it), "
+             << std::chrono::duration_cast<us>(grouped).count() / ROUNDS << " us to group by directory");
+    }
+}
@@ -0,0 +1,175 @@
+#include <catch.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define private public
+#include <libgearbox_session.h>
+#include <libgearbox_torrent_p.h>
+#include <libgearbox_torrent_store.h>
+#include <libgearbox_torrent_poller.h>
+#include <libgearbox_torrent_poller_p.h>
+#include <libgearbox_torrent_poller.cpp>
+
+TEST_CASE("Test libgearbox_torrent_poller", "[torrent_poller]")
+{
+    using gearbox::Session;
+    using gearbox::Torrent;
+    using gearbox::TorrentPoller;
+    using gearbox::TorrentPollerPrivate;
+    using gearbox::TorrentStore;
+    using Tier = TorrentPoller::Tier;
+
+    Session session(
+        "http://localhost",
+        gearbox::Session::DEFAULT_PATH,
+        9999,
+        Session::Authentication::Required,
+        "username",
+        "password"
+    );
+    TorrentStore store(session);
+    TorrentPoller test(store);
+    auto &priv = *test.priv_;
+
+    SECTION(("gearbox::TorrentPollerPrivate::tier(const gearbox::Torrent &)"))
+    {
+        auto torrent = [](Torrent::Status status, std::int32_t downloadSpeed, std::int32_t uploadSpeed) {
+            auto torrentPriv = new gearbox::TorrentPrivate();
+            std::get<6>(torrentPriv->attributes) = downloadSpeed;
+            std::get<7>(torrentPriv->attributes) = uploadSpeed;
+            std::get<8>(torrentPriv->attributes) = static_cast<std::int32_t>(status);
+            return Torrent(torrentPriv);
+        };
+
+        REQUIRE((TorrentPollerPrivate::tier(torrent(Torrent::Status::Download, 1, 0)) == Tier::Active));
+        REQUIRE((TorrentPollerPrivate::tier(torrent(Torrent::Status::Seed, 0, 1)) == Tier::Active));
+        REQUIRE((TorrentPollerPrivate::tier(torrent(Torrent::Status::Check, 0, 0)) == Tier::Active));
+        REQUIRE((TorrentPollerPrivate::tier(torrent(Torrent::Status::Download, 0, 0)) == Tier::Idle));
+        REQUIRE((TorrentPollerPrivate::tier(torrent(Torrent::Status::SeedWait, 0, 0)) == Tier::Idle));
+        REQUIRE((TorrentPollerPrivate::tier(torrent(Torrent::Status::Stopped, 0, 0)) == Tier::Stopped));
+    }
+
+    SECTION(("gearbox::TorrentPollerPrivate::interval(gearbox::TorrentPoller::Tier) const"))
+    {
+        REQUIRE((test.interval(Tier::Active) == TorrentPoller::DEFAULT_ACTIVE_INTERVAL));
+        REQUIRE((priv.interval(Tier::Idle) == std::chrono::milliseconds(TorrentPoller::DEFAULT_IDLE_INTERVAL)));
+
+        /* A slow daemon stretches the intervals that are too short for it */
+        priv.observe(std::chrono::milliseconds(500));
+        REQUIRE((test.latency() == 500));
+        REQUIRE((priv.interval(Tier::Active) == std::chrono::seconds(5)));
+        REQUIRE((priv.interval(Tier::Stopped) == std::chrono::milliseconds(TorrentPoller::DEFAULT_STOPPED_INTERVAL)));
+
+        priv.observe(std::chrono::milliseconds(100));
+        REQUIRE((test.latency() == 450));
+
+        test.setInterval(Tier::Idle, 0);
+        REQUIRE((test.interval(Tier::Idle) == 1));
+    }
+
+    SECTION(("gearbox::TorrentPollerPrivate::jittered(std::chrono::steady_clock::duration)"))
+    {
+        REQUIRE((test.jitter() == TorrentPoller::DEFAULT_JITTER));
+
+        auto shortest = std::chrono::steady_clock::duration::max();
+        auto longest = std::chrono::steady_clock::duration::min();
+        for (int it = 0; it < 1000; ++it)
+        {
+            const auto interval = priv.jittered(std::chrono::seconds(10));
+            shortest = std::min(shortest, interval);
+            longest = std::max(longest, interval);
+        }
+        REQUIRE((shortest >= std::chrono::milliseconds(8999)));
+        REQUIRE((longest <= std::chrono::milliseconds(11001)));
+        REQUIRE((longest - shortest > std::chrono::seconds(1)));
+
+        test.setJitter(0);
+        REQUIRE((priv.jittered(std::chrono::seconds(10)) == std::chrono::seconds(10)));
+        test.setJitter(250);
+        REQUIRE((test.jitter() == 100));
+    }
+
+    SECTION(("gearbox::TorrentPollerPrivate::poll(std::chrono::steady_clock::time_point, const gearbox::CallOptions &)"))
+    {
+        const gearbox::CallOptions options;
+        const auto now = std::chrono::steady_clock::now();
+
+        /* The first poll syncs the store, the torrent is downloading */
+        auto next = priv.poll(now, options);
+        REQUIRE((store.synced()));
+        REQUIRE((priv.due_.size() == 1));
+        REQUIRE((next == priv.due_.at(0)));
+        REQUIRE((next >= now + std::chrono::milliseconds(899)));
+        REQUIRE((next <= now + std::chrono::milliseconds(1101)));
+        REQUIRE((priv.nextSync_ >= now + std::chrono::milliseconds(8999)));
+        REQUIRE((priv.latency_ > 0));
+
+        /* Only the torrents that are due are refreshed, those the server */
+        /* no longer knows of are dropped                                 */
+        priv.due_[7] = next;
+        const auto nextSync = priv.nextSync_;
+        next = priv.poll(next, options);
+        REQUIRE((priv.due_.size() == 1));
+        REQUIRE((priv.due_.at(0) == next));
+        REQUIRE((priv.nextSync_ == nextSync));
+        REQUIRE((store.find(0) != nullptr));
+
+        /* Nothing is due, the poll doesn't send anything */
+        REQUIRE((priv.poll(next - std::chrono::seconds(1), options) == next));
+    }
+
+    SECTION(("gearbox::TorrentPoller::start()"))
+    {
+        std::mutex mutex;
+        std::condition_variable synced;
+        bool added = false;
+        store.setChangeHandler([&](const std::vector<TorrentStore::Change> &changes) {
+            std::lock_guard<std::mutex> lock(mutex);
+            added = added || (changes.at(0).kind == TorrentStore::Change::Kind::Added);
+            synced.notify_one();
+        });
+
+        REQUIRE((!test.running()));
+        test.start();
+        REQUIRE((test.running()));
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            REQUIRE((synced.wait_for(lock, std::chrono::seconds(10), [&added]() { return added; })));
+        }
+
+        test.stop();
+        REQUIRE((!test.running()));
+        REQUIRE((store.size() == 1));
+
+        test.start();
+        REQUIRE((test.running()));
+        test.stop();
+        REQUIRE((!test.running()));
+    }
+
+    SECTION(("gearbox::TorrentPoller::setErrorHandler(gearbox::TorrentPoller::error_handler_t)"))
+    {
+        /* The poller stops on its own once the session is gone */
+        TorrentStore orphanStore(Session{});
+        TorrentPoller orphan(orphanStore);
+
+        std::promise<gearbox::Error::Code> failed;
+        auto error = failed.get_future();
+        orphan.setErrorHandler([&failed](const gearbox::Error &e) { failed.set_value(e.errorCode()); });
+
+        orphan.start();
+        REQUIRE((error.wait_for(std::chrono::seconds(10)) == std::future_status::ready));
+        REQUIRE((error.get() == gearbox::Error::Code::GearboxSessionInvalid));
+
+        for (int it = 0; (it < 100) && orphan.running(); ++it)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE((!orphan.running()));
+    }
+}
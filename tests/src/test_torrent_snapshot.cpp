@@ -0,0 +1,192 @@
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define private public
+#include <libgearbox_snapshot_cell_p.h>
+#include <libgearbox_torrent_snapshot.h>
+#include <libgearbox_torrent_snapshot.cpp>
+
+namespace
+{
+    /* Every value is the version of the snapshot, a reader that sees */
+    /* any other was given a snapshot that was being changed          */
+    struct Versioned
+    {
+        std::uint64_t version;
+        std::vector<std::uint64_t> values;
+    };
+
+    std::shared_ptr<const Versioned> versioned(std::uint64_t version)
+    {
+        return std::make_shared<const Versioned>(Versioned{ version, std::vector<std::uint64_t>(64, version) });
+    }
+
+    gearbox::TorrentSnapshot::entry_t entry(std::int32_t id, const char *name)
+    {
+        gearbox::TorrentSnapshot::Entry result{};
+        result.id = id;
+        result.name = name;
+        return std::make_shared<const gearbox::TorrentSnapshot::Entry>(std::move(result));
+    }
+}
+
+TEST_CASE("Test libgearbox_torrent_snapshot", "[torrent_snapshot]")
+{
+    using gearbox::SnapshotCell;
+    using gearbox::TorrentSnapshot;
+
+    SECTION(("gearbox::TorrentSnapshot::find(std::int32_t) const"))
+    {
+        TorrentSnapshot empty;
+        REQUIRE((empty.version() == 0));
+        REQUIRE((empty.empty()));
+        REQUIRE((empty.find(1) == nullptr));
+
+        TorrentSnapshot test({ entry(1, "first"), entry(3, "third"), entry(7, "seventh") }, 5);
+        REQUIRE((test.version() == 5));
+        REQUIRE((test.size() == 3));
+        REQUIRE((test.at(1).name == "third"));
+        REQUIRE((test.find(7)->name == "seventh"));
+        REQUIRE((test.find(1) == &test.at(0)));
+        REQUIRE((test.find(2) == nullptr));
+        REQUIRE((test.find(8) == nullptr));
+
+        std::int32_t ids = 0;
+        for (const auto &entry : test) ids += entry->id;
+        REQUIRE((ids == 11));
+    }
+
+    SECTION(("gearbox::SnapshotCell::publish(std::shared_ptr<const T>)"))
+    {
+        SnapshotCell<Versioned> cell(versioned(0));
+        auto first = cell.load();
+        REQUIRE((first->version == 0));
+
+        cell.publish(versioned(1));
+        REQUIRE((cell.load()->version == 1));
+
+        /* The previous value lives until its last reader is done with it */
+        std::weak_ptr<const Versioned> previous = first;
+        REQUIRE((first->values.back() == 0));
+        first.reset();
+        REQUIRE((previous.expired()));
+
+        /* Slots are a cache line apart without making the cell over-aligned */
+        REQUIRE((sizeof(SnapshotCell<Versioned>::Slot) == SnapshotCell<Versioned>::CACHE_LINE_SIZE));
+        REQUIRE((alignof(SnapshotCell<Versioned>) <= alignof(std::max_align_t)));
+    }
+
+    SECTION(("gearbox::SnapshotCell::load() const"))
+    {
+        constexpr int READER_COUNT { 8 };
+        constexpr std::uint64_t PUBLICATION_COUNT { 2000 };
+
+        SnapshotCell<Versioned> cell(versioned(0));
+        std::atomic<bool> done { false };
+        std::atomic<int> torn { 0 };
+        std::atomic<int> backwards { 0 };
+
+        std::vector<std::thread> readers;
+        for (int it = 0; it < READER_COUNT; ++it)
+        {
+            readers.emplace_back([&]() {
+                std::uint64_t last = 0;
+                while (!done)
+                {
+                    const auto snapshot = cell.load();
+                    for (const auto value : snapshot->values)
+                    {
+                        if (value != snapshot->version) ++torn;
+                    }
+                    if (snapshot->version < last) ++backwards;
+                    last = snapshot->version;
+                }
+            });
+        }
+
+        for (std::uint64_t version = 1; version <= PUBLICATION_COUNT; ++version)
+        {
+            cell.publish(versioned(version));
+        }
+        done = true;
+        for (auto &reader : readers) reader.join();
+
+        REQUIRE((torn == 0));
+        REQUIRE((backwards == 0));
+        REQUIRE((cell.load()->version == PUBLICATION_COUNT));
+        REQUIRE((cell.load().use_count() == 2));
+    }
+}
+
+TEST_CASE("Benchmark gearbox::SnapshotCell", "[.][benchmark]")
+{
+    using gearbox::SnapshotCell;
+
+    constexpr auto DURATION = std::chrono::milliseconds(500);
+
+    /* Each reader loads, and reads from, the latest value over and over, */
+    /* while a single writer publishes a new one every millisecond.       */
+    auto measure = [&DURATION](int readerCount, const auto &load, const auto &publish) {
+        std::atomic<bool> done { false };
+        std::atomic<std::uint64_t> loads { 0 };
+        std::atomic<std::uint64_t> publications { 0 };
+        std::atomic<std::uint64_t> checksum { 0 };
+
+        std::vector<std::thread> readers;
+        for (int it = 0; it < readerCount; ++it)
+        {
+            readers.emplace_back([&]() {
+                std::uint64_t count = 0;
+                std::uint64_t sum = 0;
+                while (!done)
+                {
+                    sum += load()->values.front();
+                    ++count;
+                }
+                loads += count;
+                checksum += sum;
+            });
+        }
+        std::thread writer([&]() {
+            for (std::uint64_t version = 1; !done; ++version)
+            {
+                publish(versioned(version));
+                ++publications;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        std::this_thread::sleep_for(DURATION);
+        done = true;
+        for (auto &reader : readers) reader.join();
+        writer.join();
+
+        return std::make_pair(loads.load() * 1000 / DURATION.count(), publications.load());
+    };
+
+    for (const int readerCount : { 1, 2, 4, 8, 16 })
+    {
+        SnapshotCell<Versioned> cell(versioned(0));
+        const auto published = measure(readerCount,
+                                       [&cell]() { return cell.load(); },
+                                       [&cell](std::shared_ptr<const Versioned> &&value) { cell.publish(std::move(value)); });
+
+        /* The same with a mutex around the shared_ptr */
+        std::mutex mutex;
+        auto current = versioned(0);
+        const auto locked = measure(readerCount,
+                                    [&]() { std::lock_guard<std::mutex> lock(mutex); return current; },
+                                    [&](std::shared_ptr<const Versioned> &&value) { std::lock_guard<std::mutex> lock(mutex); current = std::move(value); });
+
+        WARN(readerCount << " readers: " << published.first << " loads/s with SnapshotCell ("
+             << published.second << " publications), " << locked.first << " loads/s with a mutex ("
+             << locked.second << " publications)");
+    }
+}
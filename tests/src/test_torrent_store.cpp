@@ -0,0 +1,179 @@
+#include <catch.hpp>
+
+#include <vector>
+
+#define private public
+#include <libgearbox_session.h>
+#include <libgearbox_torrent_store.h>
+#include <libgearbox_torrent_store_p.h>
+#include <libgearbox_torrent_store.cpp>
+
+TEST_CASE("Test libgearbox_torrent_store", "[torrent_store]")
+{
+    using gearbox::Session;
+    using gearbox::Torrent;
+    using gearbox::TorrentStore;
+
+    SECTION(("gearbox::TorrentStorePrivate::apply(const nlohmann::json &, bool)"))
+    {
+        using Kind = TorrentStore::Change::Kind;
+
+        gearbox::TorrentStorePrivate store({});
+        auto changes = store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 1, "first" ], [ 2, "second" ], [ 3, "third" ] ] })"), true);
+        REQUIRE((store.torrents_.size() == 3));
+        REQUIRE((changes.size() == 3));
+        REQUIRE((changes.at(0).kind == Kind::Added));
+        REQUIRE((changes.at(0).fields == gearbox::FieldSet::all()));
+
+        auto first = &store.torrents_.at(1);
+        auto firstPriv = first->priv_.get();
+
+        /* Recently active torrents are updated in place, or added */
+        changes = store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 1, "renamed" ], [ 3, "third" ], [ 4, "fourth" ] ], "removed": [ 2, 5 ] })"), false);
+        REQUIRE((store.torrents_.size() == 3));
+
+        /* The torrent that is the same as before is not reported */
+        REQUIRE((changes.size() == 3));
+        REQUIRE((changes.at(0).id == 1));
+        REQUIRE((changes.at(0).kind == Kind::Updated));
+        REQUIRE((changes.at(0).fields == gearbox::FieldSet(Torrent::Field::Name)));
+        REQUIRE((changes.at(1).id == 4));
+        REQUIRE((changes.at(1).kind == Kind::Added));
+        REQUIRE((changes.at(2).id == 2));
+        REQUIRE((changes.at(2).kind == Kind::Removed));
+        REQUIRE((changes.at(2).fields.empty()));
+        REQUIRE((&store.torrents_.at(1) == first));
+        REQUIRE((first->priv_.get() == firstPriv));
+        REQUIRE((first->name() == "renamed"));
+        REQUIRE((store.torrents_.count(2) == 0));
+        REQUIRE((store.torrents_.at(4).name() == "fourth"));
+
+        /* A full response drops whatever it doesn't list */
+        changes = store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 1, "first" ] ] })"), true);
+        REQUIRE((store.torrents_.size() == 1));
+        REQUIRE((changes.size() == 3));
+        REQUIRE((&store.torrents_.at(1) == first));
+        REQUIRE((first->name() == "first"));
+
+        /* A torrent that was asked for, but not sent, is gone */
+        store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 1, "first" ], [ 2, "second" ] ] })"), true);
+        changes = store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 1, "first" ] ] })"), false, { 1, 2, 3 });
+        REQUIRE((store.torrents_.size() == 1));
+        REQUIRE((changes.size() == 1));
+        REQUIRE((changes.at(0).id == 2));
+        REQUIRE((changes.at(0).kind == Kind::Removed));
+    }
+
+    SECTION(("gearbox::TorrentStorePrivate::publish(const std::vector<gearbox::TorrentStore::Change> &)"))
+    {
+        gearbox::TorrentStorePrivate store({});
+        REQUIRE((store.snapshot_.load()->version() == 0));
+        REQUIRE((store.snapshot_.load()->empty()));
+
+        store.publish(store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 3, "third" ], [ 1, "first" ], [ 2, "second" ] ] })"), true));
+        const auto first = store.snapshot_.load();
+        REQUIRE((first->version() == 1));
+        REQUIRE((first->size() == 3));
+        REQUIRE((first->at(0).id == 1));
+        REQUIRE((first->at(2).name == "third"));
+
+        /* The torrents that didn't change keep their entries */
+        store.publish(store.apply(nlohmann::json::parse(R"({ "torrents": [ [ "id", "name" ], [ 1, "renamed" ], [ 4, "fourth" ] ], "removed": [ 2 ] })"), false));
+        const auto second = store.snapshot_.load();
+        REQUIRE((second->version() == 2));
+        REQUIRE((second->size() == 3));
+        REQUIRE((second->find(1)->name == "renamed"));
+        REQUIRE((second->find(2) == nullptr));
+        REQUIRE((second->find(3) == first->find(3)));
+        REQUIRE((second->at(2).name == "fourth"));
+
+        /* Published snapshots never change */
+        REQUIRE((first->find(1)->name == "first"));
+        REQUIRE((first->find(2) != nullptr));
+    }
+
+    Session session(
+        "http://localhost",
+        gearbox::Session::DEFAULT_PATH,
+        9999,
+        Session::Authentication::Required,
+        "username",
+        "password"
+    );
+    TorrentStore test(session);
+
+    SECTION(("gearbox::TorrentStore::sync()"))
+    {
+        REQUIRE((!test.synced()));
+        REQUIRE((test.size() == 0));
+        REQUIRE((!test.sync()));
+        REQUIRE((test.synced()));
+        REQUIRE((test.size() == 1));
+        REQUIRE((test.snapshot()->size() == 1));
+
+        auto t = test.find(0);
+        REQUIRE((t != nullptr));
+        REQUIRE((t->name() == "torrent"));
+        REQUIRE((t->downloadDir() == "/path/to/downloads"));
+        REQUIRE((test.find(1) == nullptr));
+
+        /* Nothing was recently active, the torrent is left as it was */
+        const auto snapshot = test.snapshot();
+        REQUIRE((!test.sync()));
+        REQUIRE((test.snapshot() == snapshot));
+        REQUIRE((test.find(0) == t));
+        REQUIRE((t->name() == "torrent"));
+        REQUIRE((test.torrents().size() == 1));
+
+        /* A sync that comes too late fetches everything again */
+        test.priv_->lastSync_ -= gearbox::TorrentStorePrivate::RECENTLY_ACTIVE_WINDOW;
+        REQUIRE((!test.sync()));
+        REQUIRE((test.find(0) == t));
+
+        test.reset();
+        REQUIRE((!test.synced()));
+        REQUIRE((!test.sync()));
+        REQUIRE((test.find(0) == t));
+    }
+
+    SECTION(("gearbox::TorrentStore::refresh(const std::vector<std::int32_t> &)"))
+    {
+        REQUIRE((!test.refresh({})));
+        REQUIRE((test.size() == 0));
+
+        /* Refreshing isn't a sync, but adds the torrents it gets */
+        REQUIRE((!test.refresh({ 0, 1 })));
+        REQUIRE((!test.synced()));
+        REQUIRE((test.size() == 1));
+        REQUIRE((test.find(0)->name() == "torrent"));
+        REQUIRE((test.find(1) == nullptr));
+    }
+
+    SECTION(("gearbox::TorrentStore::setChangeHandler(gearbox::TorrentStore::change_handler_t)"))
+    {
+        std::vector<std::vector<TorrentStore::Change>> reported;
+        test.setChangeHandler([&reported](const std::vector<TorrentStore::Change> &changes) {
+            reported.push_back(changes);
+        });
+
+        REQUIRE((!test.sync()));
+        REQUIRE((reported.size() == 1));
+        REQUIRE((reported.at(0).size() == 1));
+        REQUIRE((reported.at(0).at(0).id == 0));
+        REQUIRE((reported.at(0).at(0).kind == TorrentStore::Change::Kind::Added));
+
+        /* Neither a sync without changes nor a full one that brings back */
+        /* the same torrent has anything to report                        */
+        REQUIRE((!test.sync()));
+        test.reset();
+        REQUIRE((!test.sync()));
+        REQUIRE((reported.size() == 1));
+    }
+
+    SECTION(("gearbox::TorrentStore::TorrentStore(const gearbox::Session &)"))
+    {
+        TorrentStore orphan(Session{});
+        REQUIRE((orphan.sync().errorCode() == gearbox::Error::Code::GearboxSessionInvalid));
+        REQUIRE((!orphan.synced()));
+    }
+}
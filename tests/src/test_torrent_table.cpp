@@ -0,0 +1,194 @@
+#include <catch.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#define private public
+#include <libgearbox_torrent_p.h>
+#include <libgearbox_torrent_snapshot.h>
+#include <libgearbox_torrent_table.h>
+#include <libgearbox_torrent_table.cpp>
+
+namespace
+{
+    gearbox::TorrentSnapshot::entry_t entry(std::int32_t id, gearbox::Torrent::Status status, std::uint64_t downloadSpeed, std::uint64_t uploadSpeed, double percentDone, std::int32_t eta)
+    {
+        gearbox::TorrentSnapshot::Entry result{};
+        result.id = id;
+        result.status = status;
+        result.downloadSpeed = downloadSpeed;
+        result.uploadSpeed = uploadSpeed;
+        result.percentDone = percentDone;
+        result.size = 1000;
+        result.bytesDownloaded = static_cast<std::uint64_t>(percentDone * 1000);
+        result.eta = eta;
+        result.queuePosition = id;
+        return std::make_shared<const gearbox::TorrentSnapshot::Entry>(std::move(result));
+    }
+}
+
+TEST_CASE("Test libgearbox_torrent_table", "[torrent_table]")
+{
+    using gearbox::Torrent;
+    using gearbox::TorrentTable;
+    using Status = Torrent::Status;
+
+    /* Enough torrents for the kernels to go through whole lanes, and a */
+    /* few left over                                                    */
+    const gearbox::TorrentSnapshot snapshot({
+        entry(0, Status::Download, 100, 10, 0.5, 60),
+        entry(1, Status::Download, 200, 0, 0.25, 3600),
+        entry(2, Status::Seed, 0, 50, 1.0, -1),
+        entry(3, Status::Stopped, 0, 0, 0.0, -1),
+        entry(4, Status::Stopped, 0, 0, 1.0, -1),
+        entry(5, Status::Check, 0, 0, 0.75, -2),
+        entry(6, Status::DownloadWait, 0, 0, 0.0, -1),
+        entry(7, Status::Download, 300, 20, 0.5, 120),
+        entry(8, Status::Seed, 0, 70, 1.0, -1),
+    }, 1);
+    TorrentTable test(snapshot);
+
+    SECTION(("gearbox::TorrentTable::TorrentTable(const gearbox::TorrentSnapshot &)"))
+    {
+        REQUIRE((test.size() == 9));
+        REQUIRE((test.ids().at(7) == 7));
+        REQUIRE((test.downloadSpeeds().at(7) == 300));
+        REQUIRE((test.statuses().at(5) == static_cast<std::uint8_t>(Status::Check)));
+        REQUIRE((test.etas().at(1) == 3600));
+        REQUIRE((test.queuePositions().at(8) == 8));
+
+        REQUIRE((TorrentTable().empty()));
+        REQUIRE((TorrentTable().sum(Torrent::Field::Size) == 0));
+        REQUIRE((TorrentTable().average(Torrent::Field::PercentDone) == 0.0));
+    }
+
+    SECTION(("gearbox::TorrentTable::TorrentTable(const std::vector<gearbox::Torrent> &)"))
+    {
+        std::vector<Torrent> torrents;
+        for (std::int32_t it = 0; it < 3; ++it)
+        {
+            auto priv = new gearbox::TorrentPrivate();
+            std::get<0>(priv->attributes) = it;
+            std::get<6>(priv->attributes) = 10 * it;
+            std::get<8>(priv->attributes) = static_cast<std::int32_t>(Status::Download);
+            torrents.emplace_back(priv);
+        }
+        torrents.emplace_back(nullptr);
+
+        /* The invalid torrent is left out */
+        TorrentTable table(torrents);
+        REQUIRE((table.size() == 3));
+        REQUIRE((table.ids() == std::vector<std::int32_t>{ 0, 1, 2 }));
+        REQUIRE((table.sum(Torrent::Field::DownloadSpeed) == 30));
+    }
+
+    SECTION(("gearbox::TorrentTable::sum(gearbox::Torrent::Field) const"))
+    {
+        REQUIRE((test.sum(Torrent::Field::DownloadSpeed) == 600));
+        REQUIRE((test.sum(Torrent::Field::UploadSpeed) == 150));
+        REQUIRE((test.sum(Torrent::Field::Size) == 9000));
+        REQUIRE((test.sum(Torrent::Field::BytesDownloaded) == 5000));
+        REQUIRE((test.sum(Torrent::Field::Name) == 0));
+    }
+
+    SECTION(("gearbox::TorrentTable::average(gearbox::Torrent::Field) const"))
+    {
+        REQUIRE((test.average(Torrent::Field::PercentDone) == Approx(5.0 / 9)));
+        REQUIRE((test.average(Torrent::Field::QueuePosition) == Approx(4.0)));
+        REQUIRE((test.average(Torrent::Field::DownloadSpeed) == Approx(600.0 / 9)));
+        REQUIRE((test.average(Torrent::Field::Status) == 0.0));
+    }
+
+    SECTION(("gearbox::TorrentTable::countByStatus() const"))
+    {
+        const auto counts = test.countByStatus();
+        REQUIRE((counts[static_cast<std::size_t>(Status::Stopped)] == 2));
+        REQUIRE((counts[static_cast<std::size_t>(Status::CheckWait)] == 0));
+        REQUIRE((counts[static_cast<std::size_t>(Status::Check)] == 1));
+        REQUIRE((counts[static_cast<std::size_t>(Status::DownloadWait)] == 1));
+        REQUIRE((counts[static_cast<std::size_t>(Status::Download)] == 3));
+        REQUIRE((counts[static_cast<std::size_t>(Status::SeedWait)] == 0));
+        REQUIRE((counts[static_cast<std::size_t>(Status::Seed)] == 2));
+    }
+
+    SECTION(("gearbox::TorrentTable::histogram(gearbox::Torrent::Field, const std::vector<double> &) const"))
+    {
+        /* Below 0.25, [0.25, 0.5), [0.5, 1), from 1 up */
+        REQUIRE((test.histogram(Torrent::Field::PercentDone, { 0.25, 0.5, 1.0 }) == std::vector<std::size_t>{ 2, 1, 3, 3 }));
+
+        /* Bounds that aren't values of an integer column are rounded up */
+        REQUIRE((test.histogram(Torrent::Field::Eta, { -0.5, 60.5, 1e12 }) == std::vector<std::size_t>{ 6, 1, 2, 0 }));
+        REQUIRE((test.histogram(Torrent::Field::DownloadSpeed, { -1.0, 1.0 }) == std::vector<std::size_t>{ 0, 6, 3 }));
+
+        REQUIRE((test.histogram(Torrent::Field::Size, {}) == std::vector<std::size_t>{ 9 }));
+        REQUIRE((test.histogram(Torrent::Field::DownloadDir, { 1.0 }).empty()));
+    }
+
+    SECTION(("gearbox::TorrentTable::statistics() const"))
+    {
+        const auto statistics = test.statistics();
+        REQUIRE((statistics.totalTorrentCount == 9));
+        REQUIRE((statistics.activeTorrentCount == 7));
+        REQUIRE((statistics.pausedTorrentCount == 2));
+        REQUIRE((statistics.downloadSpeed == 600));
+        REQUIRE((statistics.uploadSpeed == 150));
+    }
+}
+
+TEST_CASE("Benchmark gearbox::TorrentTable", "[.][benchmark]")
+{
+    using gearbox::Torrent;
+
+    for (const std::int32_t count : { 1000, 10000, 100000 })
+    {
+        std::vector<Torrent> torrents;
+        torrents.reserve(count);
+        for (std::int32_t it = 0; it < count; ++it)
+        {
+            auto priv = new gearbox::TorrentPrivate();
+            std::get<0>(priv->attributes) = it;
+            std::get<6>(priv->attributes) = it % 1000;
+            std::get<8>(priv->attributes) = it % 7;
+            torrents.emplace_back(priv);
+        }
+
+        constexpr int ROUNDS { 100 };
+
+        /* Following a pointer per torrent */
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t scanned = 0;
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            std::size_t stopped = 0;
+            for (const auto &torrent : torrents)
+            {
+                scanned += torrent.downloadSpeed();
+                if (torrent.status() == Torrent::Status::Stopped) ++stopped;
+            }
+            scanned += stopped;
+        }
+        const auto rows = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        gearbox::TorrentTable table(torrents);
+        const auto build = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        std::uint64_t aggregated = 0;
+        for (int round = 0; round < ROUNDS; ++round)
+        {
+            aggregated += table.sum(Torrent::Field::DownloadSpeed);
+            aggregated += table.countByStatus()[static_cast<std::size_t>(Torrent::Status::Stopped)];
+        }
+        const auto columns = std::chrono::steady_clock::now() - start;
+
+        REQUIRE((aggregated == scanned));
+
+        using us = std::chrono::microseconds;
+        WARN(count << " torrents, download speed and stopped count: "
+             << std::chrono::duration_cast<us>(rows).count() / ROUNDS << " us per pass over the torrents, "
+             << std::chrono::duration_cast<us>(columns).count() / ROUNDS << " us per pass over the table ("
+             << std::chrono::duration_cast<us>(build).count() << " us to build it)");
+    }
+}
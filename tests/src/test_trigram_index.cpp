@@ -0,0 +1,228 @@
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define private public
+#include <libgearbox_file.h>
+#include <libgearbox_torrent_snapshot.h>
+#include <libgearbox_trigram_index.h>
+#include <libgearbox_trigram_index.cpp>
+
+namespace
+{
+    gearbox::TorrentSnapshot::entry_t entry(std::int32_t id, const std::string &name)
+    {
+        gearbox::TorrentSnapshot::Entry result{};
+        result.id = id;
+        result.name = name;
+        return std::make_shared<const gearbox::TorrentSnapshot::Entry>(std::move(result));
+    }
+
+    gearbox::File file(const std::string &name)
+    {
+        return gearbox::File(std::string(name), 0, 1000, true, gearbox::File::Priority::Normal);
+    }
+
+    /* What a search comes down to without an index */
+    std::vector<std::int32_t> scan(const std::vector<std::string> &texts, const std::string &pattern)
+    {
+        auto equal = [](char lhs, char rhs) { return std::tolower(static_cast<unsigned char>(lhs)) == std::tolower(static_cast<unsigned char>(rhs)); };
+
+        std::vector<std::int32_t> result;
+        for (std::size_t it = 0; it < texts.size(); ++it)
+        {
+            if (std::search(texts[it].begin(), texts[it].end(), pattern.begin(), pattern.end(), equal) != texts[it].end())
+            {
+                result.push_back(static_cast<std::int32_t>(it));
+            }
+        }
+        return result;
+    }
+}
+
+TEST_CASE("Test libgearbox_trigram_index", "[trigram_index]")
+{
+    using gearbox::TrigramIndex;
+    using Keys = std::vector<TrigramIndex::key_t>;
+
+    TrigramIndex test;
+    test.insert(3, "Show.S01E05.1080p");
+    test.insert(1, "show s01e06 720p");
+    test.insert(2, "Documentary");
+    test.insert(7, "Ubuntu 22.04 Desktop");
+
+    SECTION(("gearbox::TrigramIndex::find(const std::string &)"))
+    {
+        REQUIRE((test.size() == 4));
+        REQUIRE((test.find("S01E0") == Keys{ 1, 3 }));
+        REQUIRE((test.find("s01e05") == Keys{ 3 }));
+        REQUIRE((test.find("SHOW") == Keys{ 1, 3 }));
+        REQUIRE((test.find("p") == Keys{ 1, 3, 7 }));
+        REQUIRE((test.find("") == Keys{ 1, 2, 3, 7 }));
+        REQUIRE((test.find("22.04") == Keys{ 7 }));
+
+        /* Every trigram is there, but not next to each other */
+        REQUIRE((test.find("show s01e05").empty()));
+        REQUIRE((test.find("xyz").empty()));
+    }
+
+    SECTION(("gearbox::TrigramIndex::insert(gearbox::TrigramIndex::key_t, const std::string &)"))
+    {
+        test.insert(3, "Another Name");
+        REQUIRE((test.size() == 4));
+        REQUIRE((test.find("s01e") == Keys{ 1 }));
+        REQUIRE((test.find("another") == Keys{ 3 }));
+
+        /* The same text, but for case, is left as it is */
+        test.insert(3, "ANOTHER NAME");
+        REQUIRE((test.lookup(3)->text == "another name"));
+
+        REQUIRE((test.erase(3)));
+        REQUIRE((!test.erase(3)));
+        REQUIRE((!test.contains(3)));
+        REQUIRE((test.find("name").empty()));
+
+        /* No trigram is left without a key */
+        test.clear();
+        REQUIRE((test.empty()));
+        REQUIRE((test.postings_.empty()));
+    }
+
+    SECTION(("gearbox::TrigramIndex::update(const gearbox::TorrentSnapshot &)"))
+    {
+        const gearbox::TorrentSnapshot snapshot({ entry(1, "show s01e06 720p"), entry(2, "Documentary (Remastered)"), entry(8, "Debian") }, 1);
+        test.update(snapshot);
+
+        REQUIRE((test.size() == 3));
+        REQUIRE((!test.contains(3)));
+        REQUIRE((test.find("s01e").size() == 1));
+        REQUIRE((test.find("remaster") == Keys{ 2 }));
+        REQUIRE((test.find("debian") == Keys{ 8 }));
+        REQUIRE((test.find("ubuntu").empty()));
+
+        /* Only the torrents that changed are looked at */
+        using Change = gearbox::TorrentStore::Change;
+        const gearbox::TorrentSnapshot next({ entry(1, "Renamed"), entry(2, "Ignored"), entry(9, "Fedora") }, 2);
+        test.update(next, {
+            { 1, Change::Kind::Updated, gearbox::FieldSet(gearbox::Torrent::Field::Name) },
+            { 2, Change::Kind::Updated, gearbox::FieldSet(gearbox::Torrent::Field::DownloadSpeed) },
+            { 8, Change::Kind::Removed, gearbox::FieldSet() },
+            { 9, Change::Kind::Added, gearbox::FieldSet::all() },
+        });
+
+        REQUIRE((test.find("renamed") == Keys{ 1 }));
+        REQUIRE((test.find("remaster") == Keys{ 2 }));
+        REQUIRE((test.find("debian").empty()));
+        REQUIRE((test.find("fedora") == Keys{ 9 }));
+    }
+
+    SECTION(("gearbox::TrigramIndex::update(const std::vector<gearbox::File> &)"))
+    {
+        TrigramIndex files;
+
+        std::vector<gearbox::File> list;
+        list.push_back(file("Show/Season 1/Show.S01E01.mkv"));
+        list.push_back(file("Show/Season 1/Show.S01E02.mkv"));
+        list.push_back(file("Show/Season 2/Show.S02E01.mkv"));
+        list.push_back(file("Show/Extras/Interview.mp4"));
+        files.update(list);
+
+        REQUIRE((files.find("season 1/") == Keys{ 0, 1 }));
+        REQUIRE((files.find(".MKV") == Keys{ 0, 1, 2 }));
+
+        /* A file left out, and one renamed */
+        std::vector<gearbox::File> refreshed;
+        refreshed.push_back(file("Show/Season 1/Show.S01E01.mkv"));
+        refreshed.push_back(file("Show/Season 1/Show.S01E02.Proper.mkv"));
+        refreshed.push_back(file("Show/Season 2/Show.S02E01.mkv"));
+        files.update(refreshed);
+
+        REQUIRE((files.size() == 3));
+        REQUIRE((files.find("proper") == Keys{ 1 }));
+        REQUIRE((files.find("interview").empty()));
+    }
+
+    SECTION(("gearbox::TrigramIndex::memoryUsage()"))
+    {
+        const auto before = test.memoryUsage();
+        REQUIRE((before > sizeof(TrigramIndex)));
+
+        test.insert(10, std::string(100, 'a') + "bcdefghijklmnopqrstuvwxyz");
+        REQUIRE((test.memoryUsage() > before + 125));
+
+        test.clear();
+        REQUIRE((test.memoryUsage() < before));
+    }
+}
+
+TEST_CASE("Benchmark gearbox::TrigramIndex", "[.][benchmark]")
+{
+    using gearbox::TrigramIndex;
+
+    /* Paths like those of the files of a season pack */
+    const std::vector<std::string> shows{ "Breaking.Point", "The.Long.Night", "Northern.Lights", "Deep.Space", "Old.Harbour" };
+    const std::vector<std::string> qualities{ "720p.WEB-DL", "1080p.BluRay", "2160p.HDR.WEB" };
+
+    for (const std::int32_t count : { 10000, 100000 })
+    {
+        std::vector<std::string> texts;
+        std::size_t textBytes = 0;
+        texts.reserve(count);
+        for (std::int32_t it = 0; it < count; ++it)
+        {
+            const auto &show = shows[it % shows.size()];
+            const auto season = std::to_string(1 + (it / 100) % 40);
+            const auto episode = std::to_string(1 + it % 100);
+            texts.push_back(show + "/Season " + season + "/" + show + ".S" + season + "E" + episode + "." + qualities[it % qualities.size()] + "-GRP" + std::to_string(it % 97) + ".mkv");
+            textBytes += texts.back().size();
+        }
+
+        std::vector<gearbox::File> files;
+        files.reserve(texts.size());
+        for (const auto &text : texts) files.push_back(file(text));
+
+        auto start = std::chrono::steady_clock::now();
+        TrigramIndex index;
+        index.update(files);
+        const auto build = std::chrono::steady_clock::now() - start;
+
+        /* A refresh where a single path changed */
+        texts[static_cast<std::size_t>(count / 2)] += ".part";
+        files[static_cast<std::size_t>(count / 2)].name_ = texts[static_cast<std::size_t>(count / 2)];
+        start = std::chrono::steady_clock::now();
+        index.update(files);
+        const auto refresh = std::chrono::steady_clock::now() - start;
+
+        using us = std::chrono::microseconds;
+        for (const std::string pattern : { "night.s12e7", "2160P.HDR", "grp42.mkv", "mkv.part", "zzz" })
+        {
+            constexpr int ROUNDS { 20 };
+
+            start = std::chrono::steady_clock::now();
+            std::vector<std::int32_t> scanned;
+            for (int round = 0; round < ROUNDS; ++round) scanned = scan(texts, pattern);
+            const auto linear = std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            std::vector<std::int32_t> found;
+            for (int round = 0; round < ROUNDS; ++round) found = index.find(pattern);
+            const auto indexed = std::chrono::steady_clock::now() - start;
+
+            REQUIRE((found == scanned));
+
+            WARN(count << " paths, \"" << pattern << "\" (" << found.size() << " matches): "
+                 << std::chrono::duration_cast<us>(linear).count() / ROUNDS << " us scanning, "
+                 << std::chrono::duration_cast<us>(indexed).count() / ROUNDS << " us with the index");
+        }
+
+        WARN(count << " paths, " << textBytes / 1024 << " KiB of text: the index takes "
+             << index.memoryUsage() / 1024 << " KiB and "
+             << std::chrono::duration_cast<us>(build).count() << " us to build, "
+             << std::chrono::duration_cast<us>(refresh).count() << " us to refresh");
+    }
+}